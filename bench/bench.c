@@ -0,0 +1,411 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Measures libdbc against a DBC file, typically one written by dbc_gen.
+ *
+ * Every figure is printed on its own line as a name, a value and a unit, so
+ * runs are easy to diff and to feed into whatever tracks them.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include "libdbc.h"
+#include "libdbc_compiled.h"
+#include "libdbc_parser.h"
+
+// Every measurement is repeated for at least this long.
+#define BENCH_MIN_SECONDS (1.0)
+#define BENCH_MIN_RUNS (3U)
+#define BENCH_STREAM_PIECE (64U * 1024U)
+#define BENCH_LOOKUPS (1U << 20)
+#define BENCH_FRAMES (1U << 18)
+#define BENCH_BATCH_FRAMES (4096U)
+#define BENCH_MAX_SIGNALS (64U)
+
+#ifdef BENCH_COUNT_ALLOCS
+// Linked with --wrap, every heap allocation made by the library lands here.
+static size_t bench_allocs;
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    bench_allocs++;
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t n, size_t size) {
+    bench_allocs++;
+    return __real_calloc(n, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    bench_allocs++;
+    return __real_realloc(ptr, size);
+}
+#endif
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void report(const char* name, const double value, const char* unit) {
+    printf("%-32s %14.2f %s\n", name, value, unit);
+}
+
+static void report_peak_rss(const char* name) {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return;
+    }
+#ifdef __APPLE__
+    report(name, (double)usage.ru_maxrss / (1024.0 * 1024.0), "MiB");
+#else
+    report(name, (double)usage.ru_maxrss / 1024.0, "MiB");
+#endif
+}
+
+static void report_allocs(const char* name, const size_t allocs) {
+#ifdef BENCH_COUNT_ALLOCS
+    report(name, (double)allocs, "allocs");
+#else
+    (void)allocs;
+    printf("%-32s %14s allocs\n", name, "n/a");
+#endif
+}
+
+static void report_memory(const dbc_t dbc) {
+    dbc_memory_stats_t stats;
+    dbc_memory_stats(dbc, &stats);
+    const double mib = 1024.0 * 1024.0;
+    report("dbc_memory", (double)stats.total_bytes / mib, "MiB");
+    report("dbc_memory_strings", (double)stats.strings.bytes / mib, "MiB");
+    report("dbc_memory_signals", (double)stats.signals.bytes / mib, "MiB");
+    report("dbc_memory_indices", (double)stats.indices.bytes / mib, "MiB");
+    report("dbc_memory_slack", (double)stats.arena_slack / mib, "MiB");
+    report("arena_allocs_per_parse", (double)stats.num_allocs, "allocs");
+}
+
+static uint64_t rng_state = 1;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * UINT64_C(0x2545F4914F6CDD1D)) >> 32);
+}
+
+static char* read_file(const char* path, size_t* len) {
+    FILE* const f = fopen(path, "rb");
+    if (f == NULL) {
+        return NULL;
+    }
+
+    char* buf = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        const long size = ftell(f);
+        buf = size < 0 ? NULL : (char*)malloc((size_t)size + 1);
+        *len = (size_t)size;
+        if (buf != NULL
+            && (fseek(f, 0, SEEK_SET) != 0
+                || fread(buf, 1, *len, f) != *len)) {
+            free(buf);
+            buf = NULL;
+        }
+    }
+
+    fclose(f);
+    return buf;
+}
+
+typedef dbc_t (*bench_load_t)(const char* buf, size_t len, const void* arg);
+
+static dbc_t load_sequential(const char* buf, size_t len, const void* arg) {
+    (void)arg;
+    return dbc_parse_buffer(buf, len, NULL);
+}
+
+static dbc_t load_parallel(const char* buf, size_t len, const void* arg) {
+    (void)arg;
+    return dbc_parse_buffer_parallel(buf, len, 0, NULL);
+}
+
+static dbc_t load_streaming(const char* buf, size_t len, const void* arg) {
+    (void)arg;
+    const dbc_parser_t parser = dbc_parser_new();
+    for (size_t i = 0; i < len; i += BENCH_STREAM_PIECE) {
+        const size_t left = len - i;
+        dbc_parser_feed(parser, buf + i,
+                        left < BENCH_STREAM_PIECE ? left : BENCH_STREAM_PIECE);
+    }
+    return dbc_parser_finish(parser, NULL);
+}
+
+static dbc_t load_compiled(const char* buf, size_t len, const void* arg) {
+    (void)buf;
+    (void)len;
+    return dbc_load_compiled((const char*)arg);
+}
+
+/**
+ * @brief Loads the DBC over and over, reporting the best throughput, in
+ *        megabytes of DBC text per second.
+ */
+static void bench_load(const char* name, bench_load_t load, const char* buf,
+                       const size_t len, const void* arg) {
+    double best = 0;
+    double total = 0;
+    for (unsigned runs = 0; runs < BENCH_MIN_RUNS || total < BENCH_MIN_SECONDS;
+         runs++) {
+        const double start = now();
+        const dbc_t dbc = load(buf, len, arg);
+        const double elapsed = now() - start;
+        dbc_free(dbc);
+
+        total += elapsed;
+        const double mbps = (double)len / elapsed / 1e6;
+        best = mbps > best ? mbps : best;
+    }
+
+    report(name, best, "MB/s");
+}
+
+static size_t count_allocs(bench_load_t load, const char* buf,
+                           const size_t len, const void* arg) {
+#ifdef BENCH_COUNT_ALLOCS
+    const size_t before = bench_allocs;
+    dbc_free(load(buf, len, arg));
+    return bench_allocs - before;
+#else
+    (void)load;
+    (void)buf;
+    (void)len;
+    (void)arg;
+    return 0;
+#endif
+}
+
+static void bench_lookups(const char* name, const dbc_t dbc) {
+    const size_t num_tables = dbc_get_num_value_tables(dbc);
+    if (num_tables == 0) {
+        return;
+    }
+
+    // Looked up by name once, as an application would.
+    dbc_value_table_t* const tables =
+        (dbc_value_table_t*)malloc(num_tables * sizeof(dbc_value_table_t));
+    for (size_t i = 0; i < num_tables; i++) {
+        char table_name[32];
+        snprintf(table_name, sizeof(table_name), "Table_%zu", i);
+        tables[i] = dbc_get_value_table(dbc, table_name);
+        if (tables[i] == NULL) {
+            free(tables);
+            return;
+        }
+    }
+
+    size_t hits = 0;
+    const double start = now();
+    for (size_t i = 0; i < BENCH_LOOKUPS; i++) {
+        const uint32_t r = rng();
+        const dbc_value_table_t vt = tables[r % num_tables];
+        // Mostly hits, with the odd miss past the end of the table.
+        const size_t size = dbc_value_table_get_size(vt) + 1;
+        hits += dbc_value_table_get_desc(vt, (double)((r >> 8) % size))
+            != NULL;
+    }
+    const double elapsed = now() - start;
+
+    report(name, elapsed / BENCH_LOOKUPS * 1e9, "ns/op");
+    free(tables);
+    if (hits == 0) {
+        puts("(no lookup hit)");
+    }
+}
+
+static void bench_decode(const dbc_t dbc) {
+    const size_t num_messages = dbc_get_num_messages(dbc);
+    if (num_messages == 0) {
+        return;
+    }
+
+    uint8_t* const payloads = (uint8_t*)malloc(BENCH_BATCH_FRAMES * 8);
+    uint32_t* const ids = (uint32_t*)malloc(BENCH_FRAMES * sizeof(uint32_t));
+    double* const values =
+        (double*)malloc(BENCH_BATCH_FRAMES * BENCH_MAX_SIGNALS * sizeof(double));
+    for (size_t i = 0; i < BENCH_BATCH_FRAMES * 8; i++) {
+        payloads[i] = (uint8_t)rng();
+    }
+    for (size_t i = 0; i < BENCH_FRAMES; i++) {
+        ids[i] = dbc_message_get_id(dbc_get_message(dbc, rng() % num_messages));
+    }
+
+    // A bus: every frame a different message.
+    double sum = 0;
+    double start = now();
+    for (size_t i = 0; i < BENCH_FRAMES; i++) {
+        const uint8_t* const payload = payloads + (i % BENCH_BATCH_FRAMES) * 8;
+        dbc_decode(dbc, ids[i], payload, 8, values);
+        sum += values[0];
+    }
+    report("decode", BENCH_FRAMES / (now() - start), "frames/s");
+
+    // A log of one message, decoded a column at a time.
+    const dbc_message_t msg = dbc_get_message(dbc, 0);
+    const size_t num_signals = dbc_message_get_num_signals(msg);
+    double* columns[BENCH_MAX_SIGNALS];
+    for (size_t i = 0; i < num_signals && i < BENCH_MAX_SIGNALS; i++) {
+        columns[i] = values + i * BENCH_BATCH_FRAMES;
+    }
+    if (num_signals <= BENCH_MAX_SIGNALS
+        && dbc_message_get_size(msg) <= 8) {
+        size_t frames = 0;
+        start = now();
+        while (frames < 64 * BENCH_BATCH_FRAMES) {
+            dbc_decode_batch(dbc, dbc_message_get_id(msg), payloads,
+                             BENCH_BATCH_FRAMES, columns);
+            sum += values[0];
+            frames += BENCH_BATCH_FRAMES;
+        }
+        report("decode_batch", (double)frames / (now() - start), "frames/s");
+    }
+
+    free(payloads);
+    free(ids);
+    free(values);
+    if (sum != sum) {
+        puts("(decoded NaN)");
+    }
+}
+
+static void bench_encode(const dbc_t dbc) {
+    const size_t num_messages = dbc_get_num_messages(dbc);
+    if (num_messages == 0) {
+        return;
+    }
+
+    uint8_t* const payloads = (uint8_t*)malloc(BENCH_BATCH_FRAMES * 8);
+    uint32_t* const ids = (uint32_t*)malloc(BENCH_FRAMES * sizeof(uint32_t));
+    double* const values =
+        (double*)malloc(BENCH_BATCH_FRAMES * BENCH_MAX_SIGNALS * sizeof(double));
+    for (size_t i = 0; i < BENCH_BATCH_FRAMES * BENCH_MAX_SIGNALS; i++) {
+        values[i] = (double)(rng() % 1000);
+    }
+    for (size_t i = 0; i < BENCH_FRAMES; i++) {
+        ids[i] = dbc_message_get_id(dbc_get_message(dbc, rng() % num_messages));
+    }
+
+    // A simulation: every frame a different message.
+    unsigned check = 0;
+    double start = now();
+    for (size_t i = 0; i < BENCH_FRAMES; i++) {
+        uint8_t* const payload = payloads + (i % BENCH_BATCH_FRAMES) * 8;
+        dbc_encode(dbc, ids[i], values + i % BENCH_BATCH_FRAMES, payload, 8);
+        check += payload[0];
+    }
+    report("encode", BENCH_FRAMES / (now() - start), "frames/s");
+
+    // Many frames of one message, encoded a column at a time.
+    const dbc_message_t msg = dbc_get_message(dbc, 0);
+    const size_t num_signals = dbc_message_get_num_signals(msg);
+    const double* columns[BENCH_MAX_SIGNALS];
+    for (size_t i = 0; i < num_signals && i < BENCH_MAX_SIGNALS; i++) {
+        columns[i] = values + i * BENCH_BATCH_FRAMES;
+    }
+    if (num_signals <= BENCH_MAX_SIGNALS
+        && dbc_message_get_size(msg) <= 8) {
+        size_t frames = 0;
+        start = now();
+        while (frames < 64 * BENCH_BATCH_FRAMES) {
+            dbc_encode_batch(dbc, dbc_message_get_id(msg), columns,
+                             BENCH_BATCH_FRAMES, payloads);
+            check += payloads[0];
+            frames += BENCH_BATCH_FRAMES;
+        }
+        report("encode_batch", (double)frames / (now() - start), "frames/s");
+    }
+
+    free(payloads);
+    free(ids);
+    free(values);
+    if (check == 0) {
+        puts("(encoded only zeros)");
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s file.dbc [compiled image path]\n",
+                argv[0]);
+        return 2;
+    }
+
+    size_t len;
+    char* const buf = read_file(argv[1], &len);
+    if (buf == NULL) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer(buf, len, &status);
+    if (dbc == NULL || status >= DBC_PARSE_CRITICAL) {
+        fprintf(stderr, "%s: does not parse cleanly\n", argv[1]);
+        return 1;
+    }
+    report("file_size", (double)len / 1e6, "MB");
+    report("messages", (double)dbc_get_num_messages(dbc), "count");
+    report_peak_rss("peak_rss_after_load");
+    report_memory(dbc);
+    report_allocs("allocs_per_parse",
+                  count_allocs(load_sequential, buf, len, NULL));
+
+    bench_load("parse", load_sequential, buf, len, NULL);
+    bench_load("parse_parallel", load_parallel, buf, len, NULL);
+    bench_load("parse_streaming", load_streaming, buf, len, NULL);
+
+    char image[4096];
+    snprintf(image, sizeof(image), "%s", argc > 2 ? argv[2] : "bench.dbcc");
+    if (dbc_save_compiled(dbc, image)) {
+        report_allocs("allocs_per_compiled_load",
+                      count_allocs(load_compiled, buf, len, image));
+        bench_load("load_compiled", load_compiled, buf, len, image);
+        remove(image);
+    }
+
+    bench_lookups("value_table_lookup", dbc);
+    dbc_freeze(dbc);
+    bench_lookups("value_table_lookup_frozen", dbc);
+    bench_decode(dbc);
+    bench_encode(dbc);
+    report_peak_rss("peak_rss");
+
+    dbc_free(dbc);
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,212 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Writes a synthetic, but realistic, DBC file for the benchmarks.
+ *
+ * The same options and seed always give the same file, so numbers measured
+ * against it are comparable between releases.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NUM_NODES (16U)
+#define MESSAGE_SIZE (8U)
+#define MAX_STANDARD_MESSAGES (0x600U)
+
+typedef struct {
+    unsigned long messages;
+    unsigned long signals;
+    unsigned long tables;
+    unsigned long entries;
+    unsigned long seed;
+    const char* out;
+} gen_opts_t;
+
+static uint64_t rng_state;
+
+static uint32_t rng(void) {
+    // xorshift64*, plenty for picking layouts.
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return (uint32_t)((rng_state * UINT64_C(0x2545F4914F6CDD1D)) >> 32);
+}
+
+static uint32_t rng_below(const uint32_t n) {
+    return rng() % n;
+}
+
+static void gen_header(FILE* f, const gen_opts_t* opts) {
+    fprintf(f, "VERSION \"synthetic-%lu\"\n\n", opts->seed);
+    fputs("NS_ :\n\tNS_DESC_\n\tCM_\n\tBA_DEF_\n\tBA_\n\tVAL_\n"
+          "\tBA_DEF_DEF_\n\tVAL_TABLE_\n\n", f);
+    fputs("BS_:\n\nBU_:", f);
+    for (unsigned i = 0; i < NUM_NODES; i++) {
+        fprintf(f, " ECU_%02u", i);
+    }
+    fputs("\n\n", f);
+}
+
+static void gen_value_tables(FILE* f, const gen_opts_t* opts) {
+    for (unsigned long t = 0; t < opts->tables; t++) {
+        fprintf(f, "VAL_TABLE_ Table_%lu", t);
+        for (unsigned long e = opts->entries; e-- > 0;) {
+            fprintf(f, " %lu \"State %lu of table %lu\"", e, e, t);
+        }
+        fputs(" ;\n", f);
+    }
+    fputc('\n', f);
+}
+
+static uint32_t gen_message_id(const unsigned long idx) {
+    if (idx < MAX_STANDARD_MESSAGES) {
+        return (uint32_t)(0x100U + idx);
+    }
+
+    // Past that, J1939-looking extended IDs, bit 31 marking them extended.
+    const uint32_t pgn = 0xF000U + (uint32_t)(idx - MAX_STANDARD_MESSAGES);
+    return 0x80000000U | (6U << 26) | (pgn << 8) | (uint32_t)(idx & 0xFFU);
+}
+
+/**
+ * @brief Writes the signals of one message, packed without overlap.
+ * @return The number of signals written.
+ */
+static unsigned long gen_signals(FILE* f, const unsigned long msg,
+                                 const gen_opts_t* opts) {
+    unsigned cursor = 0;
+    unsigned long n = 0;
+    for (; n < opts->signals && cursor < MESSAGE_SIZE * 8; n++) {
+        const unsigned room = MESSAGE_SIZE * 8 - cursor;
+        const unsigned receiver = rng_below(NUM_NODES);
+
+        // Motorola signals, byte-aligned so the packing stays simple.
+        if (cursor % 8 == 0 && room >= 16 && rng_below(4) == 0) {
+            fprintf(f,
+                    " SG_ Sig_%lu_%lu : %u|16@0- (0.01,-100) [-427.68|227.67]"
+                    " \"km/h\" ECU_%02u\n",
+                    msg, n, cursor + 7, receiver);
+            cursor += 16;
+            continue;
+        }
+
+        const unsigned max_len = room < 16 ? room : 16;
+        const unsigned len = 1 + rng_below(max_len);
+        const double factor = len == 1 ? 1 : 0.125 * (1 + rng_below(8));
+        const int offset = len == 1 ? 0 : -(int)rng_below(50);
+        fprintf(f,
+                " SG_ Sig_%lu_%lu : %u|%u@1+ (%g,%d) [%d|%g] \"%s\""
+                " ECU_%02u,ECU_%02u\n",
+                msg, n, cursor, len, factor, offset, offset,
+                offset + factor * (double)((1UL << len) - 1),
+                len == 1 ? "" : "rpm", receiver, (receiver + 1) % NUM_NODES);
+        cursor += len;
+    }
+
+    return n;
+}
+
+static void gen_messages(FILE* f, const gen_opts_t* opts,
+                         unsigned long* num_signals) {
+    for (unsigned long m = 0; m < opts->messages; m++) {
+        fprintf(f, "BO_ %lu Msg_%lu: %u ECU_%02u\n",
+                (unsigned long)gen_message_id(m), m, MESSAGE_SIZE,
+                rng_below(NUM_NODES));
+        num_signals[m] = gen_signals(f, m, opts);
+        fputc('\n', f);
+    }
+}
+
+static void gen_trailer(FILE* f, const gen_opts_t* opts,
+                        const unsigned long* num_signals) {
+    fputs("BA_DEF_ BO_ \"GenMsgCycleTime\" INT 0 65535;\n"
+          "BA_DEF_DEF_ \"GenMsgCycleTime\" 100;\n", f);
+    for (unsigned long m = 0; m < opts->messages; m++) {
+        const unsigned long id = gen_message_id(m);
+        fprintf(f, "CM_ BO_ %lu \"Message %lu,\nsent every %u ms.\";\n", id,
+                m, 10U * (1 + rng_below(10)));
+        fprintf(f, "BA_ \"GenMsgCycleTime\" BO_ %lu %u;\n", id,
+                10U * (1 + rng_below(10)));
+        if (opts->entries > 0 && num_signals[m] > 0) {
+            fprintf(f, "VAL_ %lu Sig_%lu_0 1 \"On\" 0 \"Off\" ;\n", id, m);
+        }
+    }
+}
+
+static bool parse_opt(const char* arg, unsigned long* out) {
+    char* end;
+    *out = strtoul(arg, &end, 10);
+    return *arg != 0 && *end == 0;
+}
+
+static int usage(const char* argv0) {
+    fprintf(stderr,
+            "usage: %s [-m messages] [-s signals per message]"
+            " [-t value tables] [-e entries per table] [-S seed]"
+            " [-o output]\n",
+            argv0);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    gen_opts_t opts = { 1000, 8, 50, 64, 1, NULL };
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            opts.out = argv[++i];
+            continue;
+        }
+
+        unsigned long* opt = NULL;
+        if (strcmp(argv[i], "-m") == 0) {
+            opt = &opts.messages;
+        } else if (strcmp(argv[i], "-s") == 0) {
+            opt = &opts.signals;
+        } else if (strcmp(argv[i], "-t") == 0) {
+            opt = &opts.tables;
+        } else if (strcmp(argv[i], "-e") == 0) {
+            opt = &opts.entries;
+        } else if (strcmp(argv[i], "-S") == 0) {
+            opt = &opts.seed;
+        }
+        if (opt == NULL || i + 1 >= argc || !parse_opt(argv[++i], opt)) {
+            return usage(argv[0]);
+        }
+    }
+
+    FILE* const f = opts.out == NULL ? stdout : fopen(opts.out, "w");
+    unsigned long* const num_signals =
+        (unsigned long*)calloc(opts.messages + 1, sizeof(unsigned long));
+    if (f == NULL || num_signals == NULL) {
+        perror(opts.out == NULL ? argv[0] : opts.out);
+        return 1;
+    }
+
+    rng_state = opts.seed * UINT64_C(0x9E3779B97F4A7C15) + 1;
+    gen_header(f, &opts);
+    gen_value_tables(f, &opts);
+    gen_messages(f, &opts, num_signals);
+    gen_trailer(f, &opts, num_signals);
+
+    free(num_signals);
+    return fclose(f) == 0 ? 0 : 1;
+}
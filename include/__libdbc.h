@@ -2,6 +2,11 @@
 #define ____LIBDBC__
 
 #include <stdbool.h>
+#include <stddef.h>
+#include "libdbc.h"
+#include "libdbc_parser.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_strpool.h"
 
 #ifdef __GNUC__
 #define likely(x) __builtin_expect(x, true)
@@ -11,4 +16,364 @@
 #define unlikely(x) (x)
 #endif
 
+#define DBC_VECTOR_INITIAL_CAPACITY (8U)
+
+/**
+ * @brief Makes room for one more element in a pointer vector living in the
+ *        arena.
+ * @return false if the vector could not be grown.
+ */
+bool __dbc_vector_reserve(dbc_arena_t arena, void*** vec, size_t* cap,
+                          const size_t len);
+
+/*
+ * Library-internal entry points. These mirror the public constructors but
+ * take (pointer, length) views so the parser never has to terminate or copy
+ * the tokens it hands over.
+ */
+
+void __dbc_set_version_len(dbc_t dbc, const char* ver, const size_t len);
+
+/**
+ * @brief Creates a node which lives in the arena.
+ * @param name The node's name, interned by the caller. It is not copied.
+ */
+dbc_node_t __dbc_node_new_in(dbc_arena_t arena, const char* name);
+
+/**
+ * @brief Returns the bytes taken by the node. The name of a node created in
+ *        an arena is interned, and not counted.
+ */
+size_t __dbc_node_get_memory(const dbc_node_t node);
+
+/**
+ * @brief Files the node's name in the pool, for a node moving to another
+ *        dbc. A node living in an arena is pointed at the pool's copy.
+ * @return The pool's copy of the name, NULL if out of memory.
+ */
+const char* __dbc_node_adopt(dbc_node_t node, dbc_strpool_t strings);
+
+/**
+ * @brief Creates a value table whose storage, entries included, lives in the
+ *        arena.
+ * @param strings Interns the table's name and descriptions.
+ */
+dbc_value_table_t __dbc_value_table_new_in(dbc_arena_t arena,
+                                           dbc_strpool_t strings,
+                                           const char* name,
+                                           const size_t len);
+
+/**
+ * @brief Moves a value table of an absorbed dbc over in place, its name and
+ *        descriptions adopted into the pool.
+ * @return false if out of memory.
+ */
+bool __dbc_value_table_adopt(dbc_value_table_t vt, dbc_arena_t arena,
+                             dbc_strpool_t strings);
+
+/**
+ * @brief Creates a message which lives in the arena.
+ * @param strings Interns the message's, and its signals', names.
+ */
+dbc_message_t __dbc_message_new_in(dbc_arena_t arena, dbc_strpool_t strings,
+                                   const uint32_t id, const char* name,
+                                   const size_t name_len, const uint32_t size,
+                                   const char* transmitter,
+                                   const size_t transmitter_len);
+
+/**
+ * @brief Adds a signal to the message. def->name and def->unit need not be
+ *        terminated, their lengths are given.
+ */
+dbc_signal_t __dbc_message_add_signal_len(dbc_message_t msg,
+                                          const dbc_signal_def_t* def,
+                                          const size_t name_len,
+                                          const size_t unit_len);
+
+dbc_signal_t __dbc_message_find_signal_len(const dbc_message_t msg,
+                                           const char* name,
+                                           const size_t len);
+
+/**
+ * @return The index of the first signal of the message with the given name,
+ *         SIZE_MAX if there is none.
+ */
+size_t __dbc_message_find_signal_index_len(const dbc_message_t msg,
+                                           const char* name,
+                                           const size_t len);
+
+/**
+ * @return The index of the signal within the message, SIZE_MAX if it is not
+ *         the message's.
+ */
+size_t __dbc_message_get_signal_index(const dbc_message_t msg,
+                                      const dbc_signal_t sig);
+
+void __dbc_message_set_index(dbc_message_t msg, const uint32_t index);
+
+/**
+ * @return The message's index in its DBC, see dbc_get_message.
+ */
+uint32_t __dbc_message_get_index(const dbc_message_t msg);
+
+/**
+ * @brief Makes the signal multiplexed, as dbc_message_set_signal_mux, but
+ *        leaves the message's plan out of date.
+ * @param shared Whether ranges outlive the message and can be kept as is.
+ */
+bool __dbc_message_set_mux_len(dbc_message_t msg, dbc_signal_t sig,
+                               dbc_signal_t multiplexor,
+                               const dbc_mux_range_t* ranges, const size_t n,
+                               const bool shared);
+
+/**
+ * @brief Works out which signals to decode for which multiplexor values,
+ *        unless already done or the message is not multiplexed.
+ * @return false if out of memory, in which case decoding falls back to
+ *         looking at every signal.
+ */
+bool __dbc_message_build_mux(dbc_message_t msg);
+
+/**
+ * @brief Calls __dbc_message_build_mux for every message whose signals are
+ *        loaded.
+ */
+void __dbc_build_mux(dbc_t dbc);
+
+/**
+ * @brief Returns the bytes taken by the message, its signal list, its
+ *        table of signal names and its multiplexing plan. Names and units are interned, and not counted.
+ * @param num_signals Receives the number of signals loaded so far.
+ * @param sig_bytes Receives the bytes taken by them, along with their
+ *        receiver lists and multiplexor ranges.
+ */
+size_t __dbc_message_get_memory(const dbc_message_t msg, size_t* num_signals,
+                                size_t* sig_bytes);
+
+bool __dbc_value_table_insert_len(dbc_value_table_t vt, double num,
+                                  const char* desc, const size_t len);
+
+typedef void (*dbc_value_table_visitor_t)(void* ctx, const double num,
+                                          const char* desc);
+
+/**
+ * @brief Calls visit for every entry of the table, in no particular order.
+ */
+void __dbc_value_table_visit(const dbc_value_table_t vt,
+                             const dbc_value_table_visitor_t visit,
+                             void* ctx);
+
+bool __dbc_value_table_is_frozen(const dbc_value_table_t vt);
+
+/**
+ * @brief Splits the bytes taken by the table into those holding its keys,
+ *        those pointing to its descriptions, and everything else: empty
+ *        slots, the reverse index and the table itself. Keys indexing a
+ *        dense table take no bytes. The descriptions are interned, and not
+ *        counted.
+ */
+void __dbc_value_table_get_memory(const dbc_value_table_t vt, size_t* keys,
+                                  size_t* descs, size_t* overhead);
+
+dbc_node_t __dbc_add_node_len(dbc_t dbc, const char* name, const size_t len);
+
+dbc_message_t __dbc_add_message_len(dbc_t dbc, const uint32_t id,
+                                    const char* name, const size_t name_len,
+                                    const uint32_t size,
+                                    const char* transmitter,
+                                    const size_t transmitter_len);
+
+dbc_value_table_t __dbc_add_value_table_len(dbc_t dbc, const char* name,
+                                            const size_t len);
+
+dbc_value_table_t __dbc_get_value_table_at(const dbc_t dbc, const size_t idx);
+
+dbc_strpool_t __dbc_get_strpool(const dbc_t dbc);
+
+/**
+ * @brief A read-only view of a whole file.
+ *
+ * The contents are memory-mapped where the platform allows it, and read into
+ * a heap buffer otherwise.
+ */
+typedef struct {
+    const char* data;
+    size_t len;
+    bool mapped;
+} dbc_file_map_t;
+
+/**
+ * @brief Maps the file at path into memory.
+ * @return false if the file could not be opened or read.
+ */
+bool __dbc_file_map(const char* path, dbc_file_map_t* map);
+
+/**
+ * @brief Releases a mapping created by __dbc_file_map.
+ */
+void __dbc_file_unmap(dbc_file_map_t* map);
+
+/**
+ * @brief Hands a mapping over to the dbc, which unmaps it when freed. Used to
+ *        keep alive strings adopted from the mapping.
+ */
+void __dbc_keep_file_map(dbc_t dbc, const dbc_file_map_t* map);
+
+/**
+ * @brief A statement left to be parsed once more of the input is known.
+ */
+typedef struct {
+    const char* str;
+    size_t len;
+} dbc_stmt_ref_t;
+
+/**
+ * @brief Makes statements about messages the dbc does not hold be deferred,
+ *        rather than reported, for the dbc is but a piece of the whole.
+ *        Comments and attributes, which refer to objects by index, are
+ *        always deferred then.
+ */
+void __dbc_set_deferring(dbc_t dbc, const bool deferring);
+
+/**
+ * @brief Keeps the statement for __dbc_parse_deferred. It is not copied.
+ * @return false if the dbc does not defer statements, or out of memory.
+ */
+bool __dbc_defer_statement(dbc_t dbc, const char* str, const size_t len);
+
+/**
+ * @brief Hands out the deferred statements, in order, and stops deferring
+ *        any more.
+ * @param n Receives the number of statements.
+ */
+const dbc_stmt_ref_t* __dbc_take_deferred(dbc_t dbc, size_t* n);
+
+/**
+ * @brief Parses the statements deferred by the dbc, and those of the dbcs it
+ *        absorbed.
+ * @return The most severe status encountered.
+ */
+dbc_parse_status_t __dbc_parse_deferred(dbc_t dbc);
+
+/**
+ * @brief Parses the statements into the dbc, in order.
+ * @return The most severe status encountered.
+ */
+dbc_parse_status_t __dbc_parse_refs(dbc_t dbc, const dbc_stmt_ref_t* stmts,
+                                    const size_t n);
+
+/**
+ * @brief Keeps a CM_ or BA_ statement of a lazily loaded dbc until comments
+ *        or attributes are first asked for. It is not copied.
+ * @return false if out of memory.
+ */
+bool __dbc_defer_annotation(dbc_t dbc, const char* str, const size_t len);
+
+dbc_attr_def_t __dbc_add_attr_def_len(dbc_t dbc, const char* name,
+                                      const size_t len,
+                                      const dbc_object_kind_t kind,
+                                      const dbc_attr_type_t type);
+
+dbc_attr_def_t __dbc_find_attr_def_len(const dbc_t dbc, const char* name,
+                                       const size_t len);
+
+/**
+ * @brief Sets the comment of an object, replacing any it had.
+ * @param obj The index of the node or message, 0 for the network.
+ * @param sub The index of the signal within the message, 0 for other
+ *            objects.
+ * @param text The undecoded text, copied unless it lies in the file a lazily
+ *             loaded dbc is parsed out of.
+ * @return false if out of memory.
+ */
+bool __dbc_add_comment_len(dbc_t dbc, const dbc_object_kind_t kind,
+                           const uint32_t obj, const uint32_t sub,
+                           const char* text, const size_t len);
+
+/**
+ * @brief Sorts in the comments and attribute values added out of object
+ *        order, which lookups do not see until then.
+ * @return false if out of memory, in which case those are lost.
+ */
+bool __dbc_sort_annotations(dbc_t dbc);
+
+/**
+ * @return The number of comments on objects of the kind.
+ */
+size_t __dbc_get_num_comments(const dbc_t dbc, const dbc_object_kind_t kind);
+
+/**
+ * @brief Returns a comment on an object of the kind, undecoded, to go through
+ *        all of them at once.
+ * @param text Receives the undecoded text, len bytes long and not
+ *             necessarily NUL-terminated.
+ * @return false if idx is out of range.
+ */
+bool __dbc_get_comment_at(const dbc_t dbc, const dbc_object_kind_t kind,
+                          const size_t idx, uint32_t* obj, uint32_t* sub,
+                          const char** text, size_t* len);
+
+/**
+ * @return The index of the first node with the given name, SIZE_MAX if there
+ *         is none.
+ */
+size_t __dbc_find_node_index_len(const dbc_t dbc, const char* name,
+                                 const size_t len);
+
+/**
+ * @brief Appends everything held by src to dst, as if src's statements had
+ *        been parsed into dst, then frees src.
+ *
+ * src's arena is handed over to dst and its objects are moved over in place,
+ * so nothing is copied but the pointers filing them.
+ *
+ * @return false if out of memory. src is freed either way.
+ */
+bool __dbc_absorb(dbc_t dst, dbc_t src);
+
+
+/**
+ * @brief Parses every statement in the buffer into the dbc.
+ * @return The most severe status encountered.
+ */
+dbc_parse_status_t __dbc_parse_into(dbc_t dbc, const char* buf,
+                                    const size_t len);
+
+/**
+ * @brief Splits the buffer into at most n pieces that can be parsed
+ *        independently and absorbed in order.
+ *
+ * Pieces start at statement boundaries, never between a message and its
+ * signals.
+ *
+ * @param starts Receives the start of every piece, the first being buf.
+ * @return The number of pieces.
+ */
+size_t __dbc_split_statements(const char* buf, const size_t len,
+                              const size_t n, const char** starts);
+
+// The most threads any parallel parse runs on.
+#define DBC_MAX_THREADS (64U)
+
+/**
+ * @brief Picks how many threads to work on len bytes with.
+ *
+ * @param requested The most threads to use, 0 for one per online core.
+ * @param min_piece_size The fewest bytes worth a thread of their own.
+ * @return At least 1, at most DBC_MAX_THREADS.
+ */
+size_t __dbc_num_threads(const size_t requested, const size_t len,
+                         const size_t min_piece_size);
+
+/**
+ * @brief Runs the worker on every piece, each on a thread of its own.
+ *
+ * The calling thread takes the first piece itself. Should a thread fail to
+ * start, its piece is worked on here too, once the others are running.
+ *
+ * @param pieces num_pieces pieces, piece_size bytes apart.
+ */
+void __dbc_run_pieces(void* (*worker)(void*), void* pieces,
+                      const size_t piece_size, const size_t num_pieces);
+
 #endif
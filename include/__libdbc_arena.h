@@ -0,0 +1,102 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_ARENA__
+#define ____LIBDBC_ARENA__
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @typedef dbc_arena_t
+ * @brief A bump allocator.
+ *
+ * Memory is carved out of large chunks and is only ever given back all at
+ * once, when the arena itself is freed. Everything hanging off a dbc_t lives
+ * in that dbc's arena.
+ */
+typedef struct dbc_arena* dbc_arena_t;
+
+/**
+ * @brief Creates a new, empty arena.
+ * @return The arena, NULL if out of memory.
+ */
+dbc_arena_t __dbc_arena_new(void);
+
+/**
+ * @brief Frees the arena and every allocation made from it.
+ */
+void __dbc_arena_free(dbc_arena_t arena);
+
+/**
+ * @brief Hands every allocation made from other over to arena, then frees
+ *        other.
+ *
+ * The allocations stay where they are, they are only freed with arena now.
+ */
+void __dbc_arena_absorb(dbc_arena_t arena, dbc_arena_t other);
+
+/**
+ * @brief Allocates size bytes, suitably aligned for any object.
+ * @return The memory, NULL if out of memory.
+ */
+void* __dbc_arena_alloc(dbc_arena_t arena, const size_t size);
+
+/**
+ * @brief Allocates size zeroed bytes, suitably aligned for any object.
+ * @return The memory, NULL if out of memory.
+ */
+void* __dbc_arena_calloc(dbc_arena_t arena, const size_t size);
+
+/**
+ * @brief Grows an allocation.
+ *
+ * The most recent allocation grows in place when the chunk allows it.
+ * Otherwise the contents are moved and the old space is simply abandoned.
+ *
+ * @param ptr The allocation to grow, may be NULL if old_size is 0.
+ * @return The grown allocation, NULL if out of memory (ptr is untouched).
+ */
+void* __dbc_arena_realloc(dbc_arena_t arena, void* ptr,
+                          const size_t old_size, const size_t new_size);
+
+/**
+ * @brief What an arena has done, for accounting.
+ */
+typedef struct {
+    // Allocations served, including moves by realloc, but not growing in
+    // place.
+    size_t num_allocs;
+    // Chunks obtained from the heap, and their bytes, headers included.
+    size_t num_chunks;
+    size_t reserved;
+    // Bytes handed out and not abandoned by a move. The rest of reserved is
+    // slack: chunk tails, alignment padding and abandoned space.
+    size_t live;
+} dbc_arena_stats_t;
+
+void __dbc_arena_get_stats(const dbc_arena_t arena, dbc_arena_stats_t* stats);
+
+/**
+ * @brief Copies len bytes of str into the arena, NUL-terminating the copy.
+ * @return The copy, NULL if out of memory.
+ */
+char* __dbc_arena_strndup(dbc_arena_t arena, const char* str,
+                          const size_t len);
+
+#endif
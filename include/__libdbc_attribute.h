@@ -0,0 +1,158 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_ATTRIBUTE__
+#define ____LIBDBC_ATTRIBUTE__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "libdbc_attribute.h"
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_strpool.h"
+
+#define DBC_NUM_OBJECT_KINDS (4U)
+
+/**
+ * @brief The key column of a columnar table, each row holding the index of
+ *        an object and of its signal, if a message's.
+ *
+ * Rows are kept in object order, and binary searched. Rows added out of
+ * order go to an unsorted tail, which lookups do not see until it is sorted
+ * in, once the statements are parsed. A zeroed struct is a valid, empty
+ * table.
+ */
+typedef struct {
+    uint32_t* objs;
+    uint32_t* subs;
+    size_t num_rows;
+    size_t cap_rows;
+    // The rows before this are sorted, and hold no object twice.
+    size_t num_sorted;
+} dbc_object_rows_t;
+
+/**
+ * @brief Comments on objects of one kind.
+ *
+ * The text of a comment is kept as it is written in the file, escapes and
+ * all, and only decoded when asked for.
+ */
+typedef struct {
+    dbc_object_rows_t rows;
+    const char** texts;
+    size_t* lens;
+} dbc_comment_table_t;
+
+/**
+ * @brief Sets the object's comment, replacing any it had.
+ * @param text The undecoded text, which must outlive the table.
+ * @return false if out of memory.
+ */
+bool __dbc_comment_table_set(dbc_comment_table_t* table, dbc_arena_t arena,
+                             const uint32_t obj, const uint32_t sub,
+                             const char* text, const size_t len);
+
+/**
+ * @brief Finds the object's comment, undecoded.
+ * @return false if the object has none.
+ */
+bool __dbc_comment_table_find(const dbc_comment_table_t* table,
+                              const uint32_t obj, const uint32_t sub,
+                              const char** text, size_t* len);
+
+/**
+ * @brief Sorts in the comments added out of order.
+ * @return false if out of memory, in which case those are lost.
+ */
+bool __dbc_comment_table_sort(dbc_comment_table_t* table);
+
+/**
+ * @brief Decodes the text of a comment into buf, as snprintf would.
+ * @return The length of the decoded text, which may exceed cap - 1.
+ */
+size_t __dbc_comment_decode(const char* text, const size_t len, char* buf,
+                            const size_t cap);
+
+/**
+ * @brief Creates an attribute definition which lives in the arena.
+ * @param strings Interns the name, labels and string values.
+ */
+dbc_attr_def_t __dbc_attr_def_new_in(dbc_arena_t arena, dbc_strpool_t strings,
+                                     const char* name, const size_t len,
+                                     const dbc_object_kind_t kind,
+                                     const dbc_attr_type_t type);
+
+void __dbc_attr_def_set_range(dbc_attr_def_t def, const double min,
+                              const double max);
+
+bool __dbc_attr_def_add_label_len(dbc_attr_def_t def, const char* label,
+                                  const size_t len);
+
+/**
+ * @return The index of the label, SIZE_MAX if the attribute has no such
+ *         label.
+ */
+size_t __dbc_attr_def_find_label_len(const dbc_attr_def_t def,
+                                     const char* label, const size_t len);
+
+/**
+ * @brief Interns a string value of the attribute.
+ * @return The interned string, NULL if out of memory.
+ */
+const char* __dbc_attr_def_intern_len(dbc_attr_def_t def, const char* str,
+                                      const size_t len);
+
+void __dbc_attr_def_set_default(dbc_attr_def_t def,
+                                const dbc_attr_value_t* value);
+
+/**
+ * @brief Sets the attribute for the object, replacing any value it had.
+ * @return false if out of memory.
+ */
+bool __dbc_attr_def_set_value(dbc_attr_def_t def, const uint32_t obj,
+                              const uint32_t sub,
+                              const dbc_attr_value_t* value);
+
+/**
+ * @brief Sorts in the values set out of order.
+ * @return false if out of memory, in which case those are lost.
+ */
+bool __dbc_attr_def_sort(dbc_attr_def_t def);
+
+/**
+ * @brief Finds the attribute's value for the object, its default if not set.
+ * @return false if the attribute is neither set nor has a default.
+ */
+bool __dbc_attr_def_find_value(const dbc_attr_def_t def, const uint32_t obj,
+                               const uint32_t sub, dbc_attr_value_t* out);
+
+/**
+ * @brief Returns the bytes taken by the table's columns, and by the text of
+ *        its comments if texts is set.
+ */
+size_t __dbc_comment_table_get_memory(const dbc_comment_table_t* table,
+                                      const bool texts);
+
+/**
+ * @brief Returns the bytes taken by the definition and its columns. String
+ *        values are interned, and not counted.
+ */
+size_t __dbc_attr_def_get_memory(const dbc_attr_def_t def);
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_ID_INDEX__
+#define ____LIBDBC_ID_INDEX__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "libdbc_message.h"
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+
+#define ID_INDEX_STANDARD_IDS (2048U)
+
+/**
+ * @brief A slot of an open-addressing ID hash table. msg is NULL if empty.
+ */
+typedef struct {
+    uint32_t id;
+    dbc_message_t msg;
+} dbc_id_index_slot_t;
+
+typedef struct {
+    dbc_id_index_slot_t* slots;
+    size_t cap;
+    size_t size;
+} dbc_id_index_table_t;
+
+/**
+ * @brief Resolves CAN IDs to messages in constant time.
+ *
+ * 11-bit IDs index a direct-mapped table, everything else goes through a
+ * hash table. Extended messages are additionally hashed by their J1939 PGN.
+ * A zeroed index is a valid, empty one.
+ */
+typedef struct {
+    // ID_INDEX_STANDARD_IDS entries, NULL until the first standard message.
+    dbc_message_t* standard;
+    dbc_id_index_table_t extended;
+    dbc_id_index_table_t pgn;
+} dbc_id_index_t;
+
+/**
+ * @brief Adds a message to the index. A message whose ID is already taken is
+ *        not added, the first one defined wins.
+ * @return false if out of memory.
+ */
+bool __dbc_id_index_insert(dbc_id_index_t* index, dbc_arena_t arena,
+                           const dbc_message_t msg);
+
+/**
+ * @brief Releases the index's hash tables. The standard table lives in the
+ *        arena.
+ */
+void __dbc_id_index_release(dbc_id_index_t* index);
+
+/**
+ * @brief Returns the bytes taken by the index's tables.
+ * @param num_entries Receives the number of entries, a message counting once
+ *        for its ID and once for its PGN.
+ * @param heap_bytes Receives the bytes taken by the hash tables, which live
+ *        on the heap.
+ */
+size_t __dbc_id_index_get_memory(const dbc_id_index_t* index,
+                                 size_t* num_entries, size_t* heap_bytes);
+
+/**
+ * @brief Returns the J1939 PGN carried in a 29-bit CAN ID.
+ *
+ * The priority and source address are dropped, and so is the destination
+ * address of PDU1 (peer to peer) PGNs.
+ */
+static inline uint32_t __dbc_j1939_pgn(const uint32_t can_id) {
+    const uint32_t pgn = (can_id >> 8) & 0x3FFFFU;
+    const uint32_t pdu_format = (pgn >> 8) & 0xFFU;
+    return pdu_format < 240 ? pgn & 0x3FF00U : pgn;
+}
+
+/**
+ * @brief The murmur3 finalizer, spreading IDs that differ in a few low bits
+ *        over the whole table.
+ */
+static inline uint32_t __dbc_id_hash(uint32_t id) {
+    id ^= id >> 16;
+    id *= 0x85ebca6bU;
+    id ^= id >> 13;
+    id *= 0xc2b2ae35U;
+    id ^= id >> 16;
+    return id;
+}
+
+static inline dbc_message_t __dbc_id_table_find(
+    const dbc_id_index_table_t* table, const uint32_t id) {
+    if (unlikely(table->cap == 0)) {
+        return NULL;
+    }
+
+    const size_t mask = table->cap - 1;
+    for (size_t i = __dbc_id_hash(id) & mask;; i = (i + 1) & mask) {
+        const dbc_id_index_slot_t* const slot = &table->slots[i];
+        if (slot->msg == NULL || slot->id == id) {
+            return slot->msg;
+        }
+    }
+}
+
+static inline dbc_message_t __dbc_id_index_find(const dbc_id_index_t* index,
+                                                const uint32_t id) {
+    if (likely(id < ID_INDEX_STANDARD_IDS)) {
+        return index->standard == NULL ? NULL : index->standard[id];
+    }
+
+    return __dbc_id_table_find(&index->extended, id);
+}
+
+static inline dbc_message_t __dbc_id_index_find_pgn(
+    const dbc_id_index_t* index, const uint32_t can_id) {
+    return __dbc_id_table_find(&index->pgn, __dbc_j1939_pgn(can_id));
+}
+
+#endif
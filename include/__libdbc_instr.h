@@ -0,0 +1,76 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_INSTR__
+#define ____LIBDBC_INSTR__
+
+#include <stdlib.h>
+#include "libdbc_parser.h"
+
+/*
+ * Parse instrumentation, see dbc_parse_instrument. It is only built in with
+ * LIBDBC_PARSE_STATS defined, the macros below expand to nothing otherwise.
+ *
+ * Phases nest: pushing one stops the clock of the phase it interrupts, until
+ * it is popped. Time spent outside of any phase is not counted.
+ */
+
+#ifdef LIBDBC_PARSE_STATS
+
+void __dbc_instr_push(const dbc_parse_phase_t phase);
+
+void __dbc_instr_pop(void);
+
+/**
+ * @brief Counts a statement a scan came across, whether it is parsed or not.
+ * @param kw The keyword's index, below DBC_PARSE_STATS_MAX_KEYWORDS.
+ */
+void __dbc_instr_scanned(const size_t kw, const char* keyword,
+                         const size_t len);
+
+/**
+ * @brief Starts timing the parse of a statement, in the tokenize phase.
+ */
+void __dbc_instr_begin_statement(void);
+
+/**
+ * @brief Stops timing the parse of a statement, and hands it to the hook.
+ */
+void __dbc_instr_end_statement(const size_t kw, const char* str,
+                               const size_t len,
+                               const dbc_parse_status_t status);
+
+#define DBC_INSTR_PUSH(phase) __dbc_instr_push(phase)
+#define DBC_INSTR_POP() __dbc_instr_pop()
+#define DBC_INSTR_SCANNED(kw, keyword, len) \
+    __dbc_instr_scanned(kw, keyword, len)
+#define DBC_INSTR_BEGIN_STATEMENT() __dbc_instr_begin_statement()
+#define DBC_INSTR_END_STATEMENT(kw, str, len, status) \
+    __dbc_instr_end_statement(kw, str, len, status)
+
+#else
+
+#define DBC_INSTR_PUSH(phase) ((void)0)
+#define DBC_INSTR_POP() ((void)0)
+#define DBC_INSTR_SCANNED(kw, keyword, len) ((void)0)
+#define DBC_INSTR_BEGIN_STATEMENT() ((void)0)
+#define DBC_INSTR_END_STATEMENT(kw, str, len, status) ((void)0)
+
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_LAZY__
+#define ____LIBDBC_LAZY__
+
+#include <stdlib.h>
+#include "libdbc.h"
+#include "libdbc_message.h"
+#include "libdbc_parser.h"
+
+/**
+ * @typedef dbc_lazy_parse_t
+ * @brief Parses the SG_ statements of a message, deferred by a lazy load.
+ * @return The most severe status encountered.
+ */
+typedef dbc_parse_status_t (*dbc_lazy_parse_t)(dbc_message_t msg,
+                                               const char* str,
+                                               const size_t len);
+
+/**
+ * @typedef dbc_lazy_t
+ * @brief Shared by the messages of a lazily loaded dbc.
+ *
+ * Deferred statements allocate from the dbc's arena and intern into its
+ * string pool, neither of which is thread-safe, so they are parsed one at a
+ * time, under the lock.
+ */
+typedef struct dbc_lazy* dbc_lazy_t;
+
+/**
+ * @brief Creates a context for deferred statements, parsed with parse.
+ * @return The context, NULL if out of memory.
+ */
+dbc_lazy_t __dbc_lazy_new(dbc_lazy_parse_t parse);
+
+void __dbc_lazy_free(dbc_lazy_t lazy);
+
+void __dbc_lazy_lock(dbc_lazy_t lazy);
+
+void __dbc_lazy_unlock(dbc_lazy_t lazy);
+
+/**
+ * @brief Parses deferred statements. The lock must be held.
+ */
+void __dbc_lazy_parse(dbc_lazy_t lazy, dbc_message_t msg, const char* str,
+                      const size_t len);
+
+/**
+ * @brief Raises the status reported by __dbc_lazy_get_status to at least the
+ *        given one. The lock must be held.
+ */
+void __dbc_lazy_report(dbc_lazy_t lazy, const dbc_parse_status_t status);
+
+/**
+ * @return The most severe status any deferred statement was parsed with.
+ */
+dbc_parse_status_t __dbc_lazy_get_status(dbc_lazy_t lazy);
+
+/**
+ * @brief Defers parsing the message's SG_ statements until its signals are
+ *        first needed.
+ *
+ * @param str The statements, which must outlive the message.
+ */
+void __dbc_message_set_lazy(dbc_message_t msg, dbc_lazy_t lazy,
+                            const char* str, const size_t len);
+
+/**
+ * @brief Parses the message's deferred SG_ statements, if it has any.
+ *
+ * Safe to call from any number of threads at once, the statements are parsed
+ * exactly once.
+ */
+void __dbc_message_load_signals(dbc_message_t msg);
+
+/**
+ * @brief Makes the dbc lazily loaded, handing it the context its messages
+ *        share.
+ */
+void __dbc_set_lazy(dbc_t dbc, dbc_lazy_t lazy);
+
+#endif
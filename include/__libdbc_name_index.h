@@ -0,0 +1,133 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_NAME_INDEX__
+#define ____LIBDBC_NAME_INDEX__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "libdbc_message.h"
+#include "__libdbc.h"
+
+/**
+ * @brief An object filed under its name, along with the object it belongs
+ *        to, if any.
+ */
+typedef struct {
+    const char* name;
+    void* obj;
+    void* owner;
+    // The object's position among its owner's, or the DBC's, objects.
+    uint32_t pos;
+    // The next entry of the same name, plus one, 0 for the last.
+    uint32_t next;
+} dbc_name_entry_t;
+
+/**
+ * @brief Resolves names to objects in constant time, and lists the objects
+ *        whose names start with a prefix.
+ *
+ * Names are interned, so they are hashed and compared by address. Every
+ * entry is kept, in the order added, but only the first of equal names is
+ * hashed. The entries sorted by name are worked out on the first prefix
+ * query. A zeroed index is a valid, empty one.
+ */
+typedef struct {
+    // Indices into entries, plus one, 0 for empty slots.
+    uint32_t* slots;
+    size_t cap;
+    dbc_name_entry_t* entries;
+    size_t num_entries;
+    size_t cap_entries;
+    // Indices into entries, sorted by name, NULL while out of date. Built by
+    // readers, so published atomically.
+    uint32_t* sorted;
+} dbc_name_index_t;
+
+/**
+ * @brief Files the object under its name, which must be interned.
+ * @return false if out of memory.
+ */
+bool __dbc_name_index_insert(dbc_name_index_t* index, const char* name,
+                             void* obj, void* owner, const size_t pos);
+
+/**
+ * @brief Releases everything held by the index.
+ */
+void __dbc_name_index_release(dbc_name_index_t* index);
+
+/**
+ * @brief Returns the bytes taken by the index, the sorted entries included
+ *        once worked out.
+ */
+size_t __dbc_name_index_get_memory(const dbc_name_index_t* index);
+
+/**
+ * @brief Finds the first entry filed under the name. The name must be
+ *        interned in the same pool as the ones in the index.
+ * @return The entry, NULL if there is none.
+ */
+const dbc_name_entry_t* __dbc_name_index_find(const dbc_name_index_t* index,
+                                              const char* name);
+
+/**
+ * @brief Walks the entries filed under the entry's name. Past the one
+ *        __dbc_name_index_find returns, they come in no particular order.
+ * @return The next entry, NULL after the last.
+ */
+const dbc_name_entry_t* __dbc_name_index_next(const dbc_name_index_t* index,
+                                              const dbc_name_entry_t* entry);
+
+/**
+ * @brief Finds the entries whose names start with the prefix, ordered by name,
+ *        then as added.
+ *
+ * Safe to call from several threads at once, so long as nothing is inserted
+ * meanwhile.
+ *
+ * @param first Receives the first matching entry, in the order of
+ *              __dbc_name_index_sorted_at.
+ * @return The number of matching entries, or SIZE_MAX if out of memory.
+ */
+size_t __dbc_name_index_prefix(dbc_name_index_t* index, const char* prefix,
+                               size_t* first);
+
+/**
+ * @return The entry at the given position in name order. Only valid after
+ *         __dbc_name_index_prefix.
+ */
+const dbc_name_entry_t* __dbc_name_index_sorted_at(
+    const dbc_name_index_t* index, const size_t pos);
+
+/**
+ * @brief Has the message file the signals added to it in the index, along
+ *        with itself as their owner.
+ */
+void __dbc_message_set_name_index(dbc_message_t msg, dbc_name_index_t* index);
+
+/**
+ * @brief Moves a message of an absorbed dbc over in place. Its strings, and
+ *        those of its signals, are adopted into the pool, and its signals are
+ *        filed in the index.
+ * @return false if out of memory.
+ */
+bool __dbc_message_adopt(dbc_message_t msg, dbc_arena_t arena,
+                         dbc_strpool_t strings, dbc_name_index_t* index);
+
+#endif
@@ -0,0 +1,306 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_SIGNAL__
+#define ____LIBDBC_SIGNAL__
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "libdbc_signal.h"
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_strpool.h"
+
+/**
+ * @brief Where a signal's bits are and what to do with them, worked out once
+ *        when the signal is created.
+ *
+ * Extraction loads the 8 bytes starting at byte_offset, in the signal's byte
+ * order, and shifts the signal down to bit 0. A signal may straddle 9 bytes,
+ * in which case the ninth byte's bits are shifted in from spill_shift.
+ * Insertion shifts the other way, and replaces the bits under word_mask and
+ * spill_mask.
+ */
+typedef struct {
+    uint64_t mask;
+    // Only the sign bit set, 0 for unsigned signals.
+    uint64_t sign_bit;
+    double factor;
+    double offset;
+    uint16_t byte_offset;
+    uint8_t length;
+    uint8_t shift;
+    uint8_t spill_shift;
+    bool spills;
+    bool big_endian;
+    // Encoding only from here on.
+    uint8_t spill_mask;
+    uint64_t word_mask;
+    // The physical range values are clamped to, infinite if the signal has
+    // none.
+    double min;
+    double max;
+    // Raw values must stay below this in magnitude, 2^length for unsigned
+    // signals, 2^(length - 1) for signed ones.
+    double raw_limit;
+} dbc_signal_codec_t;
+
+struct dbc_signal {
+    // Kept first, decoding touches nothing else.
+    dbc_signal_codec_t codec;
+    const char* name;
+    const char* unit;
+    const char** receivers;
+    size_t num_receivers;
+    size_t cap_receivers;
+    dbc_arena_t arena;
+    dbc_strpool_t strings;
+    double min;
+    double max;
+    uint16_t start_bit;
+    uint16_t length;
+    dbc_byte_order_t byte_order;
+    bool is_signed;
+    bool is_multiplexor;
+    bool is_multiplexed;
+    // The signal's position in its message.
+    uint32_t index;
+    // A multiplexed signal is present when its multiplexor, the message's
+    // multiplexor switch unless set, reads a value in one of these ranges.
+    dbc_signal_t multiplexor;
+    const dbc_mux_range_t* mux_ranges;
+    size_t num_mux_ranges;
+};
+
+/**
+ * @brief Creates a signal which lives in the arena.
+ *
+ * def->name and def->unit need not be terminated, their lengths are given.
+ *
+ * @return The signal, NULL if the definition is invalid or out of memory.
+ */
+dbc_signal_t __dbc_signal_new_in(dbc_arena_t arena, dbc_strpool_t strings,
+                                 const dbc_signal_def_t* def,
+                                 const size_t name_len, const size_t unit_len);
+
+/**
+ * @brief Makes the signal present for the given values of a multiplexor,
+ *        rather than for its mux_value.
+ *
+ * The ranges are copied into the signal's arena, unless shared is set, in
+ * which case they must outlive it.
+ *
+ * @param multiplexor NULL for the message's multiplexor switch.
+ */
+bool __dbc_signal_set_mux_ranges(dbc_signal_t sig, dbc_signal_t multiplexor,
+                                 const dbc_mux_range_t* ranges,
+                                 const size_t n, const bool shared);
+
+/**
+ * @brief Moves a signal of an absorbed dbc over in place, its name, unit and
+ *        receivers adopted into the pool.
+ * @return false if out of memory.
+ */
+bool __dbc_signal_adopt(dbc_signal_t sig, dbc_arena_t arena,
+                        dbc_strpool_t strings);
+
+/**
+ * @brief Adds a receiving node to the signal.
+ */
+bool __dbc_signal_add_receiver_len(dbc_signal_t sig, const char* name,
+                                   const size_t len);
+
+/**
+ * @brief Loads 8 bytes of payload starting at off, zero-filling past len.
+ */
+static inline void __dbc_payload_load8(const uint8_t* payload,
+                                       const size_t len, const size_t off,
+                                       uint8_t bytes[8]) {
+    for (size_t i = 0; i < 8; i++) {
+        bytes[i] = off + i < len ? payload[off + i] : 0;
+    }
+}
+
+static inline uint64_t __dbc_bytes_le64(const uint8_t b[8]) {
+    return (uint64_t)b[0] | (uint64_t)b[1] << 8 | (uint64_t)b[2] << 16
+        | (uint64_t)b[3] << 24 | (uint64_t)b[4] << 32 | (uint64_t)b[5] << 40
+        | (uint64_t)b[6] << 48 | (uint64_t)b[7] << 56;
+}
+
+static inline uint64_t __dbc_bytes_be64(const uint8_t b[8]) {
+    return (uint64_t)b[0] << 56 | (uint64_t)b[1] << 48 | (uint64_t)b[2] << 40
+        | (uint64_t)b[3] << 32 | (uint64_t)b[4] << 24 | (uint64_t)b[5] << 16
+        | (uint64_t)b[6] << 8 | (uint64_t)b[7];
+}
+
+static inline void __dbc_store_le64(uint8_t b[8], const uint64_t word) {
+    for (size_t i = 0; i < 8; i++) {
+        b[i] = (uint8_t)(word >> (8 * i));
+    }
+}
+
+static inline void __dbc_store_be64(uint8_t b[8], const uint64_t word) {
+    for (size_t i = 0; i < 8; i++) {
+        b[i] = (uint8_t)(word >> (56 - 8 * i));
+    }
+}
+
+/**
+ * @brief Extracts the raw, sign extended bits of a signal.
+ */
+static inline uint64_t __dbc_codec_extract(const dbc_signal_codec_t* codec,
+                                           const uint8_t* payload,
+                                           const size_t len) {
+    const size_t off = codec->byte_offset;
+    uint64_t raw;
+    uint8_t spill = 0;
+    if (likely(off + 8 + codec->spills <= len)) {
+        // Assembled bytewise, compilers turn this into a single load (and a
+        // byte swap, where needed).
+        raw = codec->big_endian ? __dbc_bytes_be64(payload + off)
+                                : __dbc_bytes_le64(payload + off);
+        spill = codec->spills ? payload[off + 8] : 0;
+    } else {
+        uint8_t bytes[8];
+        __dbc_payload_load8(payload, len, off, bytes);
+        raw = codec->big_endian ? __dbc_bytes_be64(bytes)
+                                : __dbc_bytes_le64(bytes);
+        spill = codec->spills && off + 8 < len ? payload[off + 8] : 0;
+    }
+
+    if (codec->big_endian) {
+        raw = codec->spills
+            ? raw << codec->shift | (uint64_t)spill >> codec->spill_shift
+            : raw >> codec->shift;
+    } else {
+        raw = codec->spills
+            ? raw >> codec->shift | (uint64_t)spill << codec->spill_shift
+            : raw >> codec->shift;
+    }
+    raw &= codec->mask;
+
+    // Sign extension, a no-op for unsigned signals.
+    return (raw ^ codec->sign_bit) - codec->sign_bit;
+}
+
+/**
+ * @brief Replaces the bits of a signal in the payload with raw, leaving all
+ *        others be. Bytes past len are not written.
+ */
+static inline void __dbc_codec_insert(const dbc_signal_codec_t* codec,
+                                      uint64_t raw, uint8_t* payload,
+                                      const size_t len) {
+    raw &= codec->mask;
+    uint64_t bits;
+    uint8_t spill;
+    if (codec->big_endian) {
+        bits = codec->spills ? raw >> codec->shift : raw << codec->shift;
+        spill = (uint8_t)(raw << codec->spill_shift);
+    } else {
+        bits = raw << codec->shift;
+        spill = (uint8_t)(raw >> codec->spill_shift);
+    }
+    spill &= codec->spill_mask;
+
+    const size_t off = codec->byte_offset;
+    if (likely(off + 8 + codec->spills <= len)) {
+        // As with extraction, these become a load and a store.
+        uint8_t* const bytes = payload + off;
+        if (codec->big_endian) {
+            __dbc_store_be64(bytes, (__dbc_bytes_be64(bytes)
+                                     & ~codec->word_mask) | bits);
+        } else {
+            __dbc_store_le64(bytes, (__dbc_bytes_le64(bytes)
+                                     & ~codec->word_mask) | bits);
+        }
+        if (codec->spills) {
+            bytes[8] = (uint8_t)((bytes[8] & ~codec->spill_mask) | spill);
+        }
+        return;
+    }
+
+    uint8_t bytes[8];
+    __dbc_payload_load8(payload, len, off, bytes);
+    if (codec->big_endian) {
+        __dbc_store_be64(bytes, (__dbc_bytes_be64(bytes) & ~codec->word_mask)
+                                    | bits);
+    } else {
+        __dbc_store_le64(bytes, (__dbc_bytes_le64(bytes) & ~codec->word_mask)
+                                    | bits);
+    }
+    for (size_t i = 0; i < 8 && off + i < len; i++) {
+        payload[off + i] = bytes[i];
+    }
+    if (codec->spills && off + 8 < len) {
+        payload[off + 8] =
+            (uint8_t)((payload[off + 8] & ~codec->spill_mask) | spill);
+    }
+}
+
+/**
+ * @brief Decodes one signal out of n equally sized payloads.
+ *
+ * Uses SSE2 or AVX2 where the platform has them.
+ *
+ * @param len The length of every payload, bytes past it read as zero.
+ * @param stride The distance between the starts of two payloads, in bytes.
+ * @param out Receives n physical values.
+ */
+void __dbc_codec_decode_batch(const dbc_signal_codec_t* codec,
+                              const uint8_t* payloads, const size_t len,
+                              const size_t stride, const size_t n,
+                              double* out);
+
+/**
+ * @brief Converts raw bits, as returned by __dbc_codec_extract, to a physical
+ *        value.
+ */
+static inline double __dbc_codec_to_physical(const dbc_signal_codec_t* codec,
+                                             const uint64_t raw) {
+    const double value = codec->sign_bit != 0 ? (double)(int64_t)raw
+                                              : (double)raw;
+    return value * codec->factor + codec->offset;
+}
+
+/**
+ * @brief Converts a physical value to raw bits, clamping it to the signal's
+ *        range, and then to what its bits can hold. NaN clamps to the minimum.
+ */
+static inline uint64_t __dbc_codec_from_physical(
+    const dbc_signal_codec_t* codec, double value) {
+    value = value >= codec->min ? value : codec->min;
+    value = value <= codec->max ? value : codec->max;
+    const double raw = round((value - codec->offset) / codec->factor);
+
+    // Converting an out of range double is undefined, so saturate first.
+    if (codec->sign_bit != 0) {
+        if (!(raw > -codec->raw_limit)) {
+            return (uint64_t)0 - codec->sign_bit;
+        }
+        return raw >= codec->raw_limit ? codec->sign_bit - 1
+                                       : (uint64_t)(int64_t)raw;
+    }
+    if (!(raw > 0)) {
+        return 0;
+    }
+    return raw >= codec->raw_limit ? codec->mask : (uint64_t)raw;
+}
+
+#endif
@@ -0,0 +1,109 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef ____LIBDBC_STRPOOL__
+#define ____LIBDBC_STRPOOL__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "__libdbc_arena.h"
+
+#define FNV1A_OFFSET_BASIS (2166136261U)
+#define FNV1A_PRIME (16777619U)
+
+/**
+ * @typedef dbc_strpool_t
+ * @brief A string interner.
+ *
+ * Every distinct string is stored exactly once, in the pool's arena. The
+ * returned handles stay valid for as long as the arena does, and two handles
+ * from the same pool are equal if and only if the strings are.
+ */
+typedef struct dbc_strpool* dbc_strpool_t;
+
+/**
+ * @brief Hashes the len bytes at str, as the pool does.
+ */
+static inline uint32_t __dbc_strpool_hash(const char* str, const size_t len) {
+    uint32_t hash = FNV1A_OFFSET_BASIS;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= (unsigned char)str[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Creates a new, empty pool storing its strings in the arena.
+ * @return The pool, NULL if out of memory.
+ */
+dbc_strpool_t __dbc_strpool_new(dbc_arena_t arena);
+
+/**
+ * @brief Releases the pool's index. The strings live on in the arena.
+ */
+void __dbc_strpool_release(dbc_strpool_t pool);
+
+/**
+ * @brief Returns the interned copy of the len bytes at str, adding it first
+ *        if the pool has not seen it yet.
+ * @return The NUL-terminated handle, NULL if out of memory.
+ */
+const char* __dbc_strpool_intern(dbc_strpool_t pool, const char* str,
+                                 const size_t len);
+
+/**
+ * @brief Interns the len bytes at str without copying them.
+ *
+ * If the pool has not seen the string yet, str itself becomes its handle, so
+ * it must be NUL-terminated at len and outlive the pool.
+ *
+ * @return The handle, NULL if out of memory.
+ */
+const char* __dbc_strpool_adopt(dbc_strpool_t pool, const char* str,
+                                const size_t len);
+
+/**
+ * @brief Adopts the NUL-terminated *str, then points *str at its handle.
+ * @return false if out of memory, in which case *str is left as it was.
+ */
+bool __dbc_strpool_adopt_in_place(dbc_strpool_t pool, const char** str);
+
+/**
+ * @brief Returns the interned copy of the len bytes at str.
+ * @return The handle, NULL if the string was never interned.
+ */
+const char* __dbc_strpool_find(const dbc_strpool_t pool, const char* str,
+                               const size_t len);
+
+/**
+ * @brief Returns the number of distinct strings in the pool.
+ */
+size_t __dbc_strpool_get_size(const dbc_strpool_t pool);
+
+/**
+ * @brief Returns the bytes taken by the pool's strings, terminators
+ *        included, and by its hash table.
+ * @param table_bytes Receives the bytes taken by the hash table, which lives
+ *        on the heap.
+ */
+size_t __dbc_strpool_get_memory(const dbc_strpool_t pool,
+                                size_t* table_bytes);
+
+#endif
@@ -1,9 +1,13 @@
 #ifndef __LIBDBC__
 #define __LIBDBC__
 
+#include "libdbc_attribute.h"
+#include "libdbc_message.h"
 #include "libdbc_node.h"
+#include "libdbc_signal.h"
 #include "libdbc_value_table.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 /**
  * @typedef dbc_t
@@ -11,16 +15,6 @@
  */
 typedef struct dbc* dbc_t;
 
-/**
- * @typedef dbc_message_t
- * @brief A DBC Message Definition
- */
-typedef struct dbc_message* dbc_message_t;
-
-dbc_message_t dbc_message_new(dbc_node_t node);
-
-void dbc_message_free(const dbc_message_t dbc_message);
-
 /**
  * @brief Creates a new, empty DBC structure.
  */
@@ -53,13 +47,23 @@ void dbc_push_node(dbc_t, dbc_node_t);
  */
 dbc_node_t dbc_get_node(const dbc_t, const size_t);
 
+/**
+ * @brief Returns the node with the given name, NULL if there is none.
+ *
+ * Runs in constant time. If several nodes share a name, the one added first
+ * is returned.
+ */
+dbc_node_t dbc_get_node_by_name(const dbc_t, const char* name);
+
 /**
  * @brief Returns the number of registered nodes.
  */
 size_t dbc_get_num_nodes(const dbc_t);
 
 /**
- * @brief Returns the value table
+ * @brief Returns the value table with the given name, NULL if there is none.
+ *
+ * Runs in constant time.
  */
 dbc_value_table_t dbc_get_value_table(const dbc_t, const char*);
 
@@ -74,4 +78,327 @@ size_t dbc_get_num_value_tables(const dbc_t);
  */
 dbc_value_table_t dbc_add_value_table(dbc_t, const char*);
 
+/**
+ * @brief Creates a new message without any signals, returning it.
+ * @param id The message ID, DBC_MESSAGE_ID_EXTENDED set for extended IDs.
+ * @param name The name of the message.
+ * @param size The size of the payload, in bytes.
+ * @param transmitter The name of the transmitting node.
+ */
+dbc_message_t dbc_add_message(dbc_t, const uint32_t id, const char* name,
+                              const uint32_t size, const char* transmitter);
+
+/**
+ * @brief Returns the number of messages.
+ */
+size_t dbc_get_num_messages(const dbc_t);
+
+/**
+ * @brief Returns the message at the specified index.
+ */
+dbc_message_t dbc_get_message(const dbc_t, const size_t);
+
+/**
+ * @brief Returns the message with the given name, NULL if there is none.
+ *
+ * Runs in constant time. If several messages share a name, the one defined
+ * first is returned.
+ */
+dbc_message_t dbc_get_message_by_name(const dbc_t, const char* name);
+
+/**
+ * @brief Lists the messages whose names start with the given prefix, ordered
+ *        by name.
+ *
+ * The first call after messages were added sorts their names, later calls
+ * run in logarithmic time plus the number of matches.
+ *
+ * @param msgs Receives up to cap of the matching messages.
+ * @return The number of matching messages, which may exceed cap, or SIZE_MAX
+ *         if out of memory.
+ */
+size_t dbc_find_messages_by_prefix(const dbc_t, const char* prefix,
+                                   dbc_message_t* msgs, const size_t cap);
+
+/**
+ * @brief Returns the signal with the given name, out of every message, NULL
+ *        if there is none.
+ *
+ * Runs in constant time, once the signals of lazily loaded messages have
+ * been loaded, which the first call does. If several signals share a name,
+ * the one defined first is returned.
+ *
+ * @param msg If not NULL, receives the message the signal belongs to.
+ */
+dbc_signal_t dbc_get_signal_by_name(const dbc_t, const char* name,
+                                    dbc_message_t* msg);
+
+/**
+ * @brief Lists the signals, out of every message, whose names start with the
+ *        given prefix, e.g. every "BMS_Cell" voltage.
+ *
+ * Matches are ordered by name, equal names in the order defined. The first
+ * call after signals were added sorts their names, later calls run in
+ * logarithmic time plus the number of matches.
+ *
+ * @param sigs Receives up to cap of the matching signals.
+ * @param msgs If not NULL, receives the message of each signal in sigs.
+ * @return The number of matching signals, which may exceed cap, or SIZE_MAX
+ *         if out of memory.
+ */
+size_t dbc_find_signals_by_prefix(const dbc_t, const char* prefix,
+                                  dbc_signal_t* sigs, dbc_message_t* msgs,
+                                  const size_t cap);
+
+/**
+ * @brief Returns the message with the given ID, NULL if there is none.
+ *
+ * Runs in constant time. If several messages share an ID, the one defined
+ * first is returned.
+ *
+ * @param id The message ID, DBC_MESSAGE_ID_EXTENDED set for extended IDs.
+ */
+dbc_message_t dbc_get_message_by_id(const dbc_t, const uint32_t id);
+
+/**
+ * @brief Returns the extended message with the same J1939 PGN as the given
+ *        29-bit CAN ID, NULL if there is none.
+ *
+ * Priority and source address, and the destination address of PDU1 PGNs, are
+ * ignored on both sides. Runs in constant time.
+ */
+dbc_message_t dbc_get_message_by_pgn(const dbc_t, const uint32_t can_id);
+
+/**
+ * @brief Decodes a CAN frame into the physical values of its signals.
+ *
+ * Does not allocate. Bytes past len read as zero.
+ *
+ * @param can_id The frame's ID, DBC_MESSAGE_ID_EXTENDED set for extended IDs.
+ * @param payload The frame's payload.
+ * @param len The length of the payload, in bytes.
+ * @param out Receives one value per signal, in the message's signal order.
+ * @return false if no message has the given ID. out is untouched then.
+ * @see dbc_get_message_by_id
+ */
+bool dbc_decode(const dbc_t, const uint32_t can_id, const uint8_t* payload,
+                const size_t len, double* out);
+
+/**
+ * @brief Decodes many frames of the same message at once.
+ *
+ * Does not allocate.
+ *
+ * @param can_id The frames' ID, DBC_MESSAGE_ID_EXTENDED set for extended IDs.
+ * @param payloads n payloads of dbc_message_get_size bytes each, back to
+ *                 back.
+ * @param n The number of frames.
+ * @param out_columns One column per signal, in the message's signal order,
+ *                    each receiving n physical values.
+ * @return false if no message has the given ID. out_columns is untouched
+ *         then.
+ * @see dbc_message_decode_batch for payloads of other layouts.
+ */
+bool dbc_decode_batch(const dbc_t, const uint32_t can_id,
+                      const uint8_t* payloads, const size_t n,
+                      double* const* out_columns);
+
+/**
+ * @brief Encodes physical values into a CAN frame.
+ *
+ * Does not allocate. Values are clamped to their signal's range, bits no
+ * signal covers are zeroed.
+ *
+ * @param can_id The frame's ID, DBC_MESSAGE_ID_EXTENDED set for extended IDs.
+ * @param values One value per signal, in the message's signal order.
+ * @param payload Receives the frame's payload.
+ * @param len The length of the payload, bytes past it are not written.
+ * @return false if no message has the given ID. payload is untouched then.
+ * @see dbc_message_encode
+ */
+bool dbc_encode(const dbc_t, const uint32_t can_id, const double* values,
+                uint8_t* payload, const size_t len);
+
+/**
+ * @brief Encodes many frames of the same message at once.
+ *
+ * Does not allocate.
+ *
+ * @param can_id The frames' ID, DBC_MESSAGE_ID_EXTENDED set for extended IDs.
+ * @param columns One column per signal, in the message's signal order, each
+ *                holding n physical values.
+ * @param n The number of frames.
+ * @param payloads Receives n payloads of dbc_message_get_size bytes each,
+ *                 back to back.
+ * @return false if no message has the given ID. payloads is untouched then.
+ * @see dbc_message_encode_batch for payloads of other layouts.
+ */
+bool dbc_encode_batch(const dbc_t, const uint32_t can_id,
+                      const double* const* columns, const size_t n,
+                      uint8_t* payloads);
+
+/**
+ * @brief Returns the number of attribute definitions (BA_DEF_).
+ */
+size_t dbc_get_num_attr_defs(const dbc_t);
+
+/**
+ * @brief Returns the attribute definition at the specified index.
+ */
+dbc_attr_def_t dbc_get_attr_def(const dbc_t, const size_t idx);
+
+/**
+ * @brief Returns the attribute definition with the given name, NULL if there
+ *        is none.
+ */
+dbc_attr_def_t dbc_get_attr_def_by_name(const dbc_t, const char* name);
+
+/**
+ * @brief Returns the value of an attribute of the network, its default if it
+ *        is not set.
+ * @return false if there is no such network attribute, or it is neither set
+ *         nor has a default.
+ */
+bool dbc_get_network_attribute(const dbc_t, const char* name,
+                               dbc_attr_value_t* out);
+
+/**
+ * @brief Returns the value of an attribute of the node, as
+ *        dbc_get_network_attribute.
+ */
+bool dbc_get_node_attribute(const dbc_t, const dbc_node_t node,
+                            const char* name, dbc_attr_value_t* out);
+
+/**
+ * @brief Returns the value of an attribute of the message, such as
+ *        GenMsgCycleTime, as dbc_get_network_attribute.
+ */
+bool dbc_get_message_attribute(const dbc_t, const dbc_message_t msg,
+                               const char* name, dbc_attr_value_t* out);
+
+/**
+ * @brief Returns the value of an attribute of the message's signal, such as
+ *        GenSigStartValue, as dbc_get_network_attribute.
+ */
+bool dbc_get_signal_attribute(const dbc_t, const dbc_message_t msg,
+                              const dbc_signal_t sig, const char* name,
+                              dbc_attr_value_t* out);
+
+/**
+ * @brief Decodes the comment on the network (CM_) into buf.
+ *
+ * Comments are kept as written in the file and decoded on every call. Like
+ * snprintf, at most cap - 1 characters are written, and the result is
+ * terminated unless cap is 0.
+ *
+ * @return The length of the whole comment, 0 if there is none.
+ */
+size_t dbc_get_network_comment(const dbc_t, char* buf, const size_t cap);
+
+/**
+ * @brief Decodes the comment on the node, as dbc_get_network_comment.
+ */
+size_t dbc_get_node_comment(const dbc_t, const dbc_node_t node, char* buf,
+                            const size_t cap);
+
+/**
+ * @brief Decodes the comment on the message, as dbc_get_network_comment.
+ */
+size_t dbc_get_message_comment(const dbc_t, const dbc_message_t msg,
+                               char* buf, const size_t cap);
+
+/**
+ * @brief Decodes the comment on the message's signal, as
+ *        dbc_get_network_comment.
+ */
+size_t dbc_get_signal_comment(const dbc_t, const dbc_message_t msg,
+                              const dbc_signal_t sig, char* buf,
+                              const size_t cap);
+
+/**
+ * @brief Returns the DBC's own copy of a name or description.
+ *
+ * Node names, value table names and value descriptions are stored once per
+ * DBC, so every getter hands out the very same pointer for equal strings.
+ * Comparing such a pointer against the one returned here is a full string
+ * comparison.
+ *
+ * @return The DBC's copy, NULL if the DBC has no such string.
+ */
+const char* dbc_find_string(const dbc_t, const char*);
+
+/**
+ * @brief Freezes every value table in the DBC.
+ * @see dbc_value_table_freeze
+ * @return true on success, false if some table could not be frozen.
+ */
+bool dbc_freeze(dbc_t);
+
+/**
+ * @brief How much memory a part of a DBC takes.
+ */
+typedef struct {
+    /** The number of objects. */
+    size_t count;
+    /** The bytes they take. */
+    size_t bytes;
+} dbc_memory_usage_t;
+
+/**
+ * @brief Where the memory of a DBC goes, see dbc_memory_stats.
+ *
+ * Strings are stored once per DBC, and only counted under strings, however
+ * many objects refer to them.
+ */
+typedef struct {
+    /** Distinct strings, terminators included, and the table interning
+     *  them. */
+    dbc_memory_usage_t strings;
+    dbc_memory_usage_t nodes;
+    dbc_memory_usage_t value_tables;
+    /** value_tables.bytes, split into the bytes holding keys, those pointing
+     *  to descriptions, and the rest: empty slots, reverse lookups and the
+     *  tables themselves. */
+    size_t value_table_keys;
+    size_t value_table_descs;
+    size_t value_table_overhead;
+    /** Messages, along with their signal lists and multiplexing plans. */
+    dbc_memory_usage_t messages;
+    /** The signals loaded so far, along with their receiver lists and
+     *  multiplexor ranges. */
+    dbc_memory_usage_t signals;
+    /** Comments and attribute values loaded so far, along with the attribute
+     *  definitions. */
+    dbc_memory_usage_t annotations;
+    /** Lookups by ID and by name. The count is that of the entries, an
+     *  object counting once in every index it is filed in. */
+    dbc_memory_usage_t indices;
+    /** The memory the DBC's allocator took from the heap, in how many
+     *  chunks. */
+    size_t arena_bytes;
+    size_t arena_chunks;
+    /** The part of arena_bytes never handed out, or given up on: chunk
+     *  tails, alignment padding and the old copies of grown arrays. */
+    size_t arena_slack;
+    /** The number of allocations served since the DBC was created, which
+     *  right after loading is how many loading took. */
+    size_t num_allocs;
+    /** The file kept in memory for lazy loading, or to hold strings adopted
+     *  from a compiled image, 0 if none. */
+    size_t file_bytes;
+    /** Everything above taken from the heap: arena_bytes, and the hash
+     *  tables and indices living outside of the arena. file_bytes is not
+     *  included. */
+    size_t total_bytes;
+} dbc_memory_stats_t;
+
+/**
+ * @brief Works out where the memory of the DBC goes.
+ *
+ * This walks the whole DBC, and takes time in proportion to its size.
+ * Signals, comments and attributes yet to be lazily loaded are not loaded,
+ * and not counted.
+ */
+void dbc_memory_stats(const dbc_t, dbc_memory_stats_t* stats);
+
 #endif
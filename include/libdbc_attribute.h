@@ -0,0 +1,125 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LIBDBC_ATTRIBUTE__
+#define __LIBDBC_ATTRIBUTE__
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+/**
+ * @typedef dbc_object_kind_t
+ * @brief What kind of object a comment or attribute is about.
+ */
+typedef enum {
+    /** The DBC as a whole. */
+    DBC_OBJECT_NETWORK = 0,
+    DBC_OBJECT_NODE = 1,
+    DBC_OBJECT_MESSAGE = 2,
+    DBC_OBJECT_SIGNAL = 3
+} dbc_object_kind_t;
+
+/**
+ * @typedef dbc_attr_type_t
+ * @brief The type of an attribute's values.
+ */
+typedef enum {
+    DBC_ATTR_INT = 0,
+    DBC_ATTR_HEX = 1,
+    DBC_ATTR_FLOAT = 2,
+    DBC_ATTR_STRING = 3,
+    /** One of a list of labels, referred to by index. */
+    DBC_ATTR_ENUM = 4
+} dbc_attr_type_t;
+
+/**
+ * @brief The value of an attribute.
+ */
+typedef struct {
+    /** The number, or the index of the label for enums. */
+    double num;
+    /** The string, or the label for enums, NULL for numbers. */
+    const char* str;
+} dbc_attr_value_t;
+
+/**
+ * @typedef dbc_attr_def_t
+ * @brief The definition of an attribute (BA_DEF_), along with its default
+ *        (BA_DEF_DEF_) and the values objects have for it (BA_).
+ *
+ * Values are stored in columns, one row per object the attribute is set for,
+ * objects being referred to by index. Definitions live in, and die with, the
+ * DBC.
+ */
+typedef struct dbc_attr_def* dbc_attr_def_t;
+
+const char* dbc_attr_def_get_name(const dbc_attr_def_t def);
+
+/**
+ * @return The kind of object the attribute is set for.
+ */
+dbc_object_kind_t dbc_attr_def_get_object_kind(const dbc_attr_def_t def);
+
+dbc_attr_type_t dbc_attr_def_get_type(const dbc_attr_def_t def);
+
+/**
+ * @return The least value of a numeric attribute, 0 for others.
+ */
+double dbc_attr_def_get_min(const dbc_attr_def_t def);
+
+/**
+ * @return The greatest value of a numeric attribute, 0 for others.
+ */
+double dbc_attr_def_get_max(const dbc_attr_def_t def);
+
+/**
+ * @return The number of labels of an enum attribute, 0 for others.
+ */
+size_t dbc_attr_def_get_num_labels(const dbc_attr_def_t def);
+
+/**
+ * @return The label at the given index, NULL if out of range.
+ */
+const char* dbc_attr_def_get_label(const dbc_attr_def_t def,
+                                   const size_t idx);
+
+/**
+ * @brief Returns the value of objects the attribute is not set for.
+ * @return false if the attribute has no default.
+ */
+bool dbc_attr_def_get_default(const dbc_attr_def_t def,
+                              dbc_attr_value_t* out);
+
+/**
+ * @return The number of objects the attribute is set for.
+ */
+size_t dbc_attr_def_get_num_values(const dbc_attr_def_t def);
+
+/**
+ * @brief Returns a row of the attribute's values, to go through all of them
+ *        at once.
+ *
+ * @param obj Receives the index of the node or message, 0 for the network.
+ * @param sub Receives the index of the signal within the message, 0 for
+ *            other objects.
+ * @return false if idx is out of range.
+ */
+bool dbc_attr_def_get_value(const dbc_attr_def_t def, const size_t idx,
+                            size_t* obj, size_t* sub, dbc_attr_value_t* out);
+
+#endif
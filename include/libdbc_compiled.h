@@ -0,0 +1,55 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LIBDBC_COMPILED__
+#define __LIBDBC_COMPILED__
+
+#include "libdbc.h"
+#include <stdbool.h>
+
+/**
+ * @brief The version of the compiled image format. Images of any other
+ *        version are rejected by dbc_load_compiled.
+ */
+#define DBC_COMPILED_FORMAT_VERSION (3U)
+
+/**
+ * @brief Writes the DBC to a compiled image.
+ *
+ * The image is position independent and byte order neutral, so it can be
+ * shipped between machines. It is written next to path first and then
+ * renamed over it, so readers never see a half-written image.
+ *
+ * @return false if the image could not be written.
+ */
+bool dbc_save_compiled(const dbc_t dbc, const char* path);
+
+/**
+ * @brief Loads a DBC from a compiled image written by dbc_save_compiled.
+ *
+ * The image is memory-mapped and validated, no text is parsed. Strings are
+ * used in place, straight out of the mapping, which stays mapped until the
+ * DBC is freed. Frozen value tables come back frozen, comments and attributes
+ * come back as they were.
+ *
+ * @return The DBC, NULL if the image could not be read, is of another format
+ *         version or is corrupt.
+ */
+dbc_t dbc_load_compiled(const char* path);
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LIBDBC_LOG__
+#define __LIBDBC_LOG__
+
+#include "libdbc.h"
+#include "libdbc_message.h"
+#include "libdbc_parser.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @typedef dbc_log_format_t
+ * @brief The text formats CAN logs are read from.
+ */
+typedef enum {
+    /** Told apart by the first line of the log. */
+    DBC_LOG_AUTO,
+    /** candump -l, "(1436509052.249713) can0 123#DEADBEEF". */
+    DBC_LOG_CANDUMP,
+    /** Vector ASC, "0.012345 1 123 Rx d 4 DE AD BE EF". */
+    DBC_LOG_ASC
+} dbc_log_format_t;
+
+/**
+ * @typedef dbc_log_frame_t
+ * @brief A data frame read from a log.
+ *
+ * Remote and error frames are not kept.
+ */
+typedef struct {
+    /** Since the epoch for candump, since the start of measurement for ASC. */
+    uint64_t timestamp_ns;
+    /** DBC_MESSAGE_ID_EXTENDED set for extended IDs. */
+    uint32_t can_id;
+    /** The ASC channel, 0 for candump. */
+    uint8_t channel;
+    /** The length of the payload, up to 64 bytes for CAN FD. */
+    uint8_t len;
+    /** Read through dbc_log_get_payload, payloads over 8 bytes are kept
+     *  elsewhere. */
+    union {
+        uint8_t bytes[8];
+        uint64_t offset;
+    } payload;
+} dbc_log_frame_t;
+
+/**
+ * @typedef dbc_log_t
+ * @brief The frames of a log, in timestamp order.
+ */
+typedef struct dbc_log* dbc_log_t;
+
+/**
+ * @brief Reads the frames of a whole log held in memory on several threads.
+ *
+ * The buffer is split at line boundaries, every piece is lexed on its own
+ * thread and the frames are merged in timestamp order. Frames with equal
+ * timestamps keep the order they were logged in. Lines that are not frames,
+ * like headers, comments and events, are skipped.
+ *
+ * @param format The format of the log.
+ * @param num_threads The most threads to use, 0 for one per online core.
+ * @param status If not NULL, receives DBC_PARSE_CRITICAL if some frames
+ *               could not be read and were lost.
+ * @return The log, NULL only if status is DBC_PARSE_IO_ERROR.
+ */
+dbc_log_t dbc_log_read_buffer(const char* buf, size_t len,
+                              dbc_log_format_t format, size_t num_threads,
+                              dbc_parse_status_t* status);
+
+/**
+ * @brief Memory-maps and reads the log at the given path on several threads.
+ * @see dbc_log_read_buffer
+ */
+dbc_log_t dbc_log_read_file(const char* path, dbc_log_format_t format,
+                            size_t num_threads, dbc_parse_status_t* status);
+
+void dbc_log_free(dbc_log_t log);
+
+size_t dbc_log_get_num_frames(const dbc_log_t log);
+
+/**
+ * @return The frames, in timestamp order.
+ */
+const dbc_log_frame_t* dbc_log_get_frames(const dbc_log_t log);
+
+/**
+ * @return The frame's payload, frame->len bytes long.
+ */
+const uint8_t* dbc_log_get_payload(const dbc_log_t log,
+                                   const dbc_log_frame_t* frame);
+
+/**
+ * @typedef dbc_log_decode_cb_t
+ * @brief Receives a batch of decoded frames of a single message.
+ *
+ * @param timestamps_ns The frames' timestamps, in order.
+ * @param n The number of frames.
+ * @param columns One column per signal, in the message's signal order, each
+ *                holding n physical values. Only valid during the call.
+ */
+typedef void (*dbc_log_decode_cb_t)(void* ctx, const dbc_message_t msg,
+                                    const uint64_t* timestamps_ns,
+                                    const size_t n,
+                                    const double* const* columns);
+
+/**
+ * @brief Decodes every frame of the log whose message the DBC knows.
+ *
+ * The frames are decoded with dbc_decode_batch, message by message. Every
+ * message's frames arrive in timestamp order, in batches of up to 1024.
+ * Payloads shorter than their message read as zero past their end.
+ *
+ * @return false if out of memory, in which case some messages may already
+ *         have been handed to the callback.
+ */
+bool dbc_log_decode(const dbc_log_t log, const dbc_t dbc,
+                    dbc_log_decode_cb_t callback, void* ctx);
+
+#endif
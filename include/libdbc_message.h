@@ -0,0 +1,174 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LIBDBC_MESSAGE__
+#define __LIBDBC_MESSAGE__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "libdbc_signal.h"
+
+/**
+ * @brief Set in a message ID if the message uses an extended (29-bit) ID.
+ */
+#define DBC_MESSAGE_ID_EXTENDED (0x80000000U)
+
+/**
+ * @typedef dbc_message_t
+ * @brief A DBC Message Definition
+ *
+ * A message describes one CAN frame, and owns the signals packed into it.
+ * Messages are owned by their dbc_t.
+ */
+typedef struct dbc_message* dbc_message_t;
+
+/**
+ * @return The message ID, as written in the DBC file. Extended IDs have
+ *         DBC_MESSAGE_ID_EXTENDED set.
+ */
+uint32_t dbc_message_get_id(const dbc_message_t msg);
+
+/**
+ * @return The name of the message.
+ */
+const char* dbc_message_get_name(const dbc_message_t msg);
+
+/**
+ * @return The size of the payload, in bytes.
+ */
+uint32_t dbc_message_get_size(const dbc_message_t msg);
+
+/**
+ * @return The name of the transmitting node.
+ */
+const char* dbc_message_get_transmitter(const dbc_message_t msg);
+
+/**
+ * @brief Adds a new signal to the message.
+ * @return The signal, NULL if the definition is invalid or out of memory.
+ */
+dbc_signal_t dbc_message_add_signal(dbc_message_t msg,
+                                    const dbc_signal_def_t* def);
+
+/**
+ * @brief Makes a signal of the message present only when its multiplexor
+ *        holds a value within one of the ranges.
+ *
+ * Multiplexed signals which are not present decode as NaN, and are not
+ * written when encoding.
+ *
+ * @param multiplexor A multiplexor signal of the message, or NULL for the one
+ *                    returned by dbc_message_get_multiplexor.
+ * @param ranges The ranges of multiplexor values, inclusive. They are copied.
+ * @return false if either signal is unfit or out of memory.
+ */
+bool dbc_message_set_signal_mux(dbc_message_t msg, dbc_signal_t sig,
+                                dbc_signal_t multiplexor,
+                                const dbc_mux_range_t* ranges,
+                                const size_t n);
+
+/**
+ * @return The message's top multiplexor signal, the one no other signal
+ *         selects, NULL if there is none.
+ */
+dbc_signal_t dbc_message_get_multiplexor(const dbc_message_t msg);
+
+/**
+ * @return The number of signals in the message.
+ */
+size_t dbc_message_get_num_signals(const dbc_message_t msg);
+
+/**
+ * @return The first signal of the message with the given name, NULL if there
+ *         is none.
+ * @see dbc_get_signal_by_name to search every message at once.
+ */
+dbc_signal_t dbc_message_get_signal_by_name(const dbc_message_t msg,
+                                            const char* name);
+
+/**
+ * @return The signal at the given index, NULL if out of range.
+ */
+dbc_signal_t dbc_message_get_signal(const dbc_message_t msg,
+                                    const size_t idx);
+
+/**
+ * @brief Decodes every signal of the message.
+ *
+ * Does not allocate. Bytes past len read as zero. Multiplexed signals absent
+ * from the payload decode as NaN.
+ *
+ * @param out Receives the physical value of every signal, in signal order. It
+ *            must have room for dbc_message_get_num_signals values.
+ */
+void dbc_message_decode(const dbc_message_t msg, const uint8_t* payload,
+                        const size_t len, double* out);
+
+/**
+ * @brief Decodes every signal out of many frames of the message at once.
+ *
+ * Each signal is decoded across all frames before moving on to the next one,
+ * using SSE2 or AVX2 where the platform has them. Does not allocate.
+ *
+ * @param payloads The first of n payloads.
+ * @param len The length of every payload, bytes past it read as zero.
+ * @param stride The distance between the starts of two payloads, in bytes.
+ *               Pass len if the payloads are packed back to back.
+ * @param n The number of frames.
+ * @param out_columns One column per signal, in signal order, each receiving n
+ *                    physical values.
+ */
+void dbc_message_decode_batch(const dbc_message_t msg, const uint8_t* payloads,
+                              const size_t len, const size_t stride,
+                              const size_t n, double* const* out_columns);
+
+/**
+ * @brief Encodes physical values into a payload.
+ *
+ * The payload is zeroed, then every signal is stored as by dbc_signal_encode.
+ * Multiplexors are stored before the signals they select, and multiplexed
+ * signals are stored only if their multiplexor's value selects them. Does not
+ * allocate.
+ *
+ * @param values One physical value per signal, in signal order.
+ * @param len The length of the payload, bytes past it are not written.
+ */
+void dbc_message_encode(const dbc_message_t msg, const double* values,
+                        uint8_t* payload, const size_t len);
+
+/**
+ * @brief Encodes many frames of the message at once.
+ *
+ * Each signal is encoded into all frames before moving on to the next one.
+ * Does not allocate.
+ *
+ * @param columns One column per signal, in signal order, each holding n
+ *                physical values.
+ * @param n The number of frames.
+ * @param payloads The first of n payloads.
+ * @param len The length of every payload, bytes past it are not written.
+ * @param stride The distance between the starts of two payloads, in bytes.
+ *               Pass len if the payloads are packed back to back.
+ */
+void dbc_message_encode_batch(const dbc_message_t msg,
+                              const double* const* columns, const size_t n,
+                              uint8_t* payloads, const size_t len,
+                              const size_t stride);
+
+#endif
@@ -33,7 +33,9 @@ typedef struct dbc_node* dbc_node_t;
 dbc_node_t dbc_node_new(const char* name);
 
 /**
- * @brief Frees up the memory used by the DBC.
+ * @brief Frees up the memory used by the node.
+ * @note Nodes owned by a dbc_t are released together with it, calling this on
+ *       them does nothing.
  */
 void dbc_node_free(const dbc_node_t node);
 
@@ -0,0 +1,294 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LIBDBC_PARSER__
+#define __LIBDBC_PARSER__
+
+#include "libdbc.h"
+#include <stdlib.h>
+
+/**
+ * @typedef dbc_parse_status_t
+ * @brief The outcome of parsing a DBC file.
+ *
+ * The values are ordered by severity. A parse reports the most severe status
+ * encountered across all of its statements.
+ */
+typedef enum {
+    /** Every statement was understood. */
+    DBC_PARSE_SUCCESS,
+    /** Some statements did not tightly adhere to the spec, but were loaded. */
+    DBC_PARSE_MALFORMED,
+    /** Some statements could not be understood and were (partially) lost. */
+    DBC_PARSE_CRITICAL,
+    /** The input could not be read at all. */
+    DBC_PARSE_IO_ERROR
+} dbc_parse_status_t;
+
+/**
+ * @brief Parses a whole DBC file held in memory.
+ *
+ * The buffer is never written to and need not be NUL-terminated. Nothing is
+ * retained from it once this function returns.
+ *
+ * @param buf The contents of the DBC file.
+ * @param len The length of buf, in bytes.
+ * @param status If not NULL, receives the most severe status encountered.
+ * @return The parsed DBC, NULL only if status is DBC_PARSE_IO_ERROR.
+ */
+dbc_t dbc_parse_buffer(const char* buf, size_t len,
+                       dbc_parse_status_t* status);
+
+/**
+ * @brief Memory-maps and parses the DBC file at the given path.
+ *
+ * @param path The path to the DBC file.
+ * @param status If not NULL, receives the most severe status encountered.
+ * @return The parsed DBC, NULL only if status is DBC_PARSE_IO_ERROR.
+ */
+dbc_t dbc_parse_file(const char* path, dbc_parse_status_t* status);
+
+/**
+ * @typedef dbc_load_opts_t
+ * @brief Which messages to load, when only some of them are of interest.
+ *
+ * A message is loaded if its ID is included, or if an included node
+ * transmits it or receives one of its signals, unless its name matches
+ * exclude_name_glob. With neither IDs nor nodes included, every message is.
+ * Nothing is allocated for the messages left out, nor for their signals and
+ * the other statements about them.
+ */
+typedef struct {
+    /** The IDs of the messages to load, DBC_MESSAGE_ID_EXTENDED set for
+     *  extended IDs. */
+    const uint32_t* include_ids;
+    size_t num_include_ids;
+    /** The names of the nodes whose messages to load. */
+    const char* const* include_nodes;
+    size_t num_include_nodes;
+    /** Names of messages not to load, '*' matching any run of characters and
+     *  '?' any one. NULL to leave no message out. */
+    const char* exclude_name_glob;
+} dbc_load_opts_t;
+
+/**
+ * @brief Parses a whole DBC file held in memory, loading only the messages
+ *        the options ask for.
+ *
+ * Nodes and value tables are always loaded. Statements about messages that
+ * are not loaded are skipped, without affecting the status.
+ *
+ * @param opts The messages to load, NULL for all of them.
+ * @see dbc_parse_buffer
+ */
+dbc_t dbc_parse_buffer_opts(const char* buf, size_t len,
+                            const dbc_load_opts_t* opts,
+                            dbc_parse_status_t* status);
+
+/**
+ * @brief Memory-maps and parses the DBC file at the given path, loading only
+ *        the messages the options ask for.
+ *
+ * @see dbc_parse_buffer_opts
+ */
+dbc_t dbc_parse_file_opts(const char* path, const dbc_load_opts_t* opts,
+                          dbc_parse_status_t* status);
+
+/**
+ * @brief Parses a whole DBC file held in memory on several threads.
+ *
+ * The buffer is split at statement boundaries, the pieces are parsed on their
+ * own threads and the results are merged in order. The DBC is the same as
+ * dbc_parse_buffer's, nodes, value tables and messages included, in the same
+ * order. Small buffers are simply parsed on the calling thread.
+ *
+ * @param num_threads The most threads to use, 0 for one per online core.
+ * @see dbc_parse_buffer
+ */
+dbc_t dbc_parse_buffer_parallel(const char* buf, size_t len,
+                                size_t num_threads,
+                                dbc_parse_status_t* status);
+
+/**
+ * @brief Memory-maps and parses the DBC file at the given path on several
+ *        threads.
+ *
+ * @param num_threads The most threads to use, 0 for one per online core.
+ * @see dbc_parse_buffer_parallel
+ */
+dbc_t dbc_parse_file_parallel(const char* path, size_t num_threads,
+                              dbc_parse_status_t* status);
+
+/**
+ * @brief Parses a whole DBC file held in memory, deferring the signals.
+ *
+ * Messages are indexed right away, but their SG_ statements are only parsed
+ * the first time the message's signals are needed: when they are looked at,
+ * when the message is decoded, or when the DBC is saved. Likewise, comments
+ * and attributes are parsed the first time any of them is asked for. This is safe from
+ * any number of threads, so startup time and memory scale with the messages
+ * actually used rather than with the file.
+ *
+ * @param buf The contents of the DBC file, which must outlive the DBC.
+ * @param status If not NULL, receives the most severe status encountered,
+ *               deferred statements excluded, see dbc_get_lazy_status.
+ * @return The parsed DBC, NULL only if status is DBC_PARSE_IO_ERROR.
+ */
+dbc_t dbc_parse_buffer_lazy(const char* buf, size_t len,
+                            dbc_parse_status_t* status);
+
+/**
+ * @brief Memory-maps the DBC file at the given path and parses it, deferring
+ *        the signals. The file stays mapped until the DBC is freed.
+ *
+ * @see dbc_parse_buffer_lazy
+ */
+dbc_t dbc_parse_file_lazy(const char* path, dbc_parse_status_t* status);
+
+/**
+ * @return The most severe status the deferred statements of a lazily parsed
+ *         DBC have been parsed with so far, DBC_PARSE_SUCCESS for other DBCs.
+ */
+dbc_parse_status_t dbc_get_lazy_status(const dbc_t dbc);
+
+/**
+ * @typedef dbc_parser_t
+ * @brief An incremental parser, fed a DBC file a piece at a time.
+ *
+ * Pieces may be cut anywhere, even within a statement or a string. Only the
+ * statement left unfinished by a piece is kept until the next one.
+ */
+typedef struct dbc_parser* dbc_parser_t;
+
+/**
+ * @brief Creates a parser for a new DBC.
+ * @return The parser, NULL if out of memory.
+ */
+dbc_parser_t dbc_parser_new(void);
+
+/**
+ * @brief Parses the next piece of the DBC file.
+ *
+ * Nothing is retained from buf once this function returns.
+ *
+ * @return false if out of memory. The piece is lost then.
+ */
+bool dbc_parser_feed(dbc_parser_t parser, const char* buf, size_t len);
+
+/**
+ * @brief Parses whatever is left and frees the parser.
+ *
+ * @param status If not NULL, receives the most severe status encountered.
+ * @return The parsed DBC.
+ */
+dbc_t dbc_parser_finish(dbc_parser_t parser, dbc_parse_status_t* status);
+
+/**
+ * @brief Frees the parser along with the DBC it was parsing.
+ */
+void dbc_parser_free(dbc_parser_t parser);
+
+/**
+ * @brief What parsing spends its time on.
+ */
+typedef enum {
+    /** Finding where statements start and end, and which they are. */
+    DBC_PARSE_PHASE_SCAN,
+    /** Splitting statements into tokens, and whatever else their parsers do
+     *  not spend in another phase. */
+    DBC_PARSE_PHASE_TOKENIZE,
+    /** Converting numbers. */
+    DBC_PARSE_PHASE_NUMBERS,
+    /** Adding what statements define to the DBC, and to its indices. */
+    DBC_PARSE_PHASE_INSERT,
+    /** Working out lookup structures once the DBC is loaded. */
+    DBC_PARSE_PHASE_INDEX,
+    DBC_PARSE_NUM_PHASES
+} dbc_parse_phase_t;
+
+#define DBC_PARSE_STATS_MAX_KEYWORDS (48U)
+
+/**
+ * @brief What parsing made of the statements starting with one keyword.
+ */
+typedef struct {
+    /** The keyword, "" for statements that were not recognized. */
+    const char* keyword;
+    size_t count;
+    size_t bytes;
+    /** How many were parsed with DBC_PARSE_MALFORMED, and with
+     *  DBC_PARSE_CRITICAL. */
+    size_t malformed;
+    size_t critical;
+    /** The time spent parsing them, in nanoseconds. Statements which are
+     *  skipped, or left for later, take none. */
+    uint64_t ns;
+} dbc_parse_keyword_stats_t;
+
+/**
+ * @brief What parsing spent its time on, filled in by instrumented parses,
+ *        see dbc_parse_instrument.
+ */
+typedef struct {
+    /** Nanoseconds, by phase. Time is only counted towards the innermost
+     *  phase, so the phases add up to the time spent parsing. */
+    uint64_t phase_ns[DBC_PARSE_NUM_PHASES];
+    /** The statements, by keyword. Only the first num_keywords entries are
+     *  used, and those a parse did not come across have a count of 0. */
+    dbc_parse_keyword_stats_t keywords[DBC_PARSE_STATS_MAX_KEYWORDS];
+    size_t num_keywords;
+    /** The totals over all keywords. */
+    size_t count;
+    size_t bytes;
+    size_t malformed;
+    size_t critical;
+} dbc_parse_stats_t;
+
+/**
+ * @typedef dbc_parse_hook_t
+ * @brief Called by instrumented parses for every statement they parse.
+ *
+ * @param stmt The statement, keyword first, not NUL-terminated. Only valid
+ *             for the duration of the call.
+ * @param ns The time the statement took to parse, in nanoseconds.
+ */
+typedef void (*dbc_parse_hook_t)(void* ctx, const char* stmt, size_t len,
+                                 dbc_parse_status_t status, uint64_t ns);
+
+/**
+ * @brief Instruments the parses made on the calling thread from now on.
+ *
+ * Every function parsing a DBC, or a part of one, adds to stats and calls
+ * hook. Parsing comes with reading the clock a few times per statement, so
+ * instrumented parses are slower. dbc_parse_buffer_parallel parses most of
+ * the file on other threads, which are not instrumented, and neither are
+ * lazy loads made on other threads. Passing NULL for both stats and hook
+ * stops instrumenting.
+ *
+ * Instrumentation is only built in if the library is compiled with
+ * LIBDBC_PARSE_STATS defined (the parse_stats build option). Otherwise, it
+ * costs nothing, and this function does nothing.
+ *
+ * @param stats If not NULL, reset then filled in, until the next call.
+ * @param hook If not NULL, called with ctx for every statement.
+ * @return false if instrumentation is not built in.
+ */
+bool dbc_parse_instrument(dbc_parse_stats_t* stats, dbc_parse_hook_t hook,
+                          void* ctx);
+
+#endif
@@ -0,0 +1,208 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LIBDBC_SIGNAL__
+#define __LIBDBC_SIGNAL__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * @typedef dbc_signal_t
+ * @brief A DBC Signal Definition
+ *
+ * A signal is a run of bits inside of a message's payload, together with the
+ * linear conversion turning those bits into a physical value. Signals are
+ * owned by their message.
+ */
+typedef struct dbc_signal* dbc_signal_t;
+
+/**
+ * @typedef dbc_byte_order_t
+ * @brief How the bits of a signal are laid out in the payload.
+ */
+typedef enum {
+    /** Motorola, big endian. The start bit is the most significant bit. */
+    DBC_BYTE_ORDER_BIG_ENDIAN = 0,
+    /** Intel, little endian. The start bit is the least significant bit. */
+    DBC_BYTE_ORDER_LITTLE_ENDIAN = 1
+} dbc_byte_order_t;
+
+/**
+ * @brief Everything needed to define a signal.
+ */
+typedef struct {
+    const char* name;
+    /** Bit position, numbered as in the DBC file (see dbc_byte_order_t). */
+    uint16_t start_bit;
+    /** Length in bits, 1 to 64. */
+    uint16_t length;
+    dbc_byte_order_t byte_order;
+    bool is_signed;
+    double factor;
+    double offset;
+    double min;
+    double max;
+    /** The unit, may be NULL for none. */
+    const char* unit;
+    /** Whether the signal selects which multiplexed signals are present. */
+    bool is_multiplexor;
+    /** Whether the signal is only present when the message's multiplexor
+     *  reads mux_value. */
+    bool is_multiplexed;
+    uint64_t mux_value;
+} dbc_signal_def_t;
+
+/**
+ * @brief An inclusive range of raw multiplexor values.
+ */
+typedef struct {
+    uint64_t min;
+    uint64_t max;
+} dbc_mux_range_t;
+
+/**
+ * @return The name of the signal.
+ */
+const char* dbc_signal_get_name(const dbc_signal_t sig);
+
+/**
+ * @return The start bit, as numbered in the DBC file.
+ */
+uint16_t dbc_signal_get_start_bit(const dbc_signal_t sig);
+
+/**
+ * @return The length of the signal, in bits.
+ */
+uint16_t dbc_signal_get_length(const dbc_signal_t sig);
+
+/**
+ * @return The byte order of the signal.
+ */
+dbc_byte_order_t dbc_signal_get_byte_order(const dbc_signal_t sig);
+
+/**
+ * @return true if the raw value is two's complement signed.
+ */
+bool dbc_signal_is_signed(const dbc_signal_t sig);
+
+/**
+ * @return The factor of the raw to physical conversion.
+ */
+double dbc_signal_get_factor(const dbc_signal_t sig);
+
+/**
+ * @return The offset of the raw to physical conversion.
+ */
+double dbc_signal_get_offset(const dbc_signal_t sig);
+
+/**
+ * @return The minimum physical value.
+ */
+double dbc_signal_get_min(const dbc_signal_t sig);
+
+/**
+ * @return The maximum physical value.
+ */
+double dbc_signal_get_max(const dbc_signal_t sig);
+
+/**
+ * @return The unit of the signal, an empty string if it has none.
+ */
+const char* dbc_signal_get_unit(const dbc_signal_t sig);
+
+/**
+ * @return The number of nodes receiving the signal.
+ */
+size_t dbc_signal_get_num_receivers(const dbc_signal_t sig);
+
+/**
+ * @return The name of the receiver at the given index, NULL if out of range.
+ */
+const char* dbc_signal_get_receiver(const dbc_signal_t sig, const size_t idx);
+
+/**
+ * @return Whether the signal selects which multiplexed signals are present,
+ *         the 'M' in "M" or "m0M".
+ */
+bool dbc_signal_is_multiplexor(const dbc_signal_t sig);
+
+/**
+ * @return Whether the signal is only present for some values of its
+ *         multiplexor, the 'm' in "m0" or "m0M".
+ */
+bool dbc_signal_is_multiplexed(const dbc_signal_t sig);
+
+/**
+ * @return The multiplexor the signal is present for some values of, as given
+ *         by SG_MUL_VAL_. NULL if that is the message's multiplexor, see
+ *         dbc_message_get_multiplexor.
+ */
+dbc_signal_t dbc_signal_get_multiplexor(const dbc_signal_t sig);
+
+/**
+ * @return The number of multiplexor value ranges the signal is present for.
+ */
+size_t dbc_signal_get_num_mux_ranges(const dbc_signal_t sig);
+
+/**
+ * @return The multiplexor value range at the given index, an empty range
+ *         (min > max) if out of range.
+ */
+dbc_mux_range_t dbc_signal_get_mux_range(const dbc_signal_t sig,
+                                         const size_t idx);
+
+/**
+ * @brief Extracts the signal's raw bits from a payload.
+ *
+ * Bytes past len read as zero. Signed signals are sign extended.
+ *
+ * @return The raw value, to be reinterpreted as int64_t for signed signals.
+ */
+uint64_t dbc_signal_decode_raw(const dbc_signal_t sig, const uint8_t* payload,
+                               const size_t len);
+
+/**
+ * @brief Extracts the signal's physical value from a payload.
+ *
+ * Bytes past len read as zero.
+ */
+double dbc_signal_decode(const dbc_signal_t sig, const uint8_t* payload,
+                         const size_t len);
+
+/**
+ * @brief Stores raw bits as the signal's in a payload.
+ *
+ * Only the signal's bits are written, bits past its length are dropped. Bytes
+ * past len are not written.
+ */
+void dbc_signal_encode_raw(const dbc_signal_t sig, const uint64_t raw,
+                           uint8_t* payload, const size_t len);
+
+/**
+ * @brief Stores a physical value as the signal's in a payload.
+ *
+ * The value is clamped to the signal's range, unless it is empty, scaled to
+ * the nearest raw value, and clamped again to what the signal's bits can
+ * hold. Only the signal's bits are written, bytes past len are not.
+ */
+void dbc_signal_encode(const dbc_signal_t sig, const double value,
+                       uint8_t* payload, const size_t len);
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef __LIBDBC_SNAPSHOT__
+#define __LIBDBC_SNAPSHOT__
+
+#include "libdbc.h"
+#include "libdbc_parser.h"
+#include <stdbool.h>
+
+/**
+ * @typedef dbc_snapshot_t
+ * @brief A reference counted DBC that is no longer modified, and so can be
+ *        read by any number of threads at once.
+ */
+typedef struct dbc_snapshot* dbc_snapshot_t;
+
+/**
+ * @typedef dbc_handle_t
+ * @brief Publishes the current snapshot of a DBC, which dbc_reload replaces.
+ *
+ * Readers acquire the current snapshot without taking locks, and keep it for
+ * as long as they hold it, whatever is published in the meantime. A snapshot
+ * is freed once it is neither current nor held.
+ */
+typedef struct dbc_handle* dbc_handle_t;
+
+/**
+ * @brief Creates a handle publishing the DBC.
+ *
+ * The handle takes the DBC over. It must not be modified, nor freed, from
+ * here on.
+ *
+ * @return The handle, NULL if out of memory, in which case the DBC is freed.
+ */
+dbc_handle_t dbc_handle_new(dbc_t dbc);
+
+/**
+ * @brief Parses the DBC file at path and creates a handle publishing it.
+ *
+ * @param status If not NULL, receives the most severe status encountered.
+ * @return The handle, NULL if the file could not be read or out of memory.
+ */
+dbc_handle_t dbc_handle_open(const char* path, dbc_parse_status_t* status);
+
+/**
+ * @brief Releases the handle's reference to the current snapshot.
+ *
+ * Snapshots still held stay valid until released. No reload may be running.
+ */
+void dbc_handle_free(dbc_handle_t handle);
+
+/**
+ * @brief Acquires the current snapshot. Lock free, safe from any thread.
+ * @return The snapshot, to be handed back to dbc_snapshot_release.
+ */
+dbc_snapshot_t dbc_handle_acquire(dbc_handle_t handle);
+
+/**
+ * @return The DBC of the snapshot, valid until the snapshot is released.
+ */
+dbc_t dbc_snapshot_get(const dbc_snapshot_t snapshot);
+
+/**
+ * @brief Drops a reference to the snapshot, freeing it if it was the last.
+ */
+void dbc_snapshot_release(dbc_snapshot_t snapshot);
+
+/**
+ * @brief Parses the DBC file at path and publishes it in place of the
+ *        current snapshot.
+ *
+ * The file is parsed on the calling thread, while readers carry on with the
+ * current snapshot. The new one is then published with a single atomic swap,
+ * and the old one is freed once its last reader releases it. Reloads of the
+ * same handle are serialized.
+ *
+ * @param status If not NULL, receives the most severe status encountered.
+ * @return false, with the current snapshot left in place, if the file could
+ *         not be read, parsed critically wrong, or out of memory.
+ */
+bool dbc_reload(dbc_handle_t handle, const char* path,
+                dbc_parse_status_t* status);
+
+/**
+ * @brief Publishes the DBC in place of the current snapshot, as dbc_reload
+ *        does. The handle takes the DBC over.
+ * @return false if out of memory, in which case the DBC is freed.
+ */
+bool dbc_handle_publish(dbc_handle_t handle, dbc_t dbc);
+
+#endif
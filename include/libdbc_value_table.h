@@ -27,7 +27,8 @@
  * @brief The DBC Value Table.
  *
  * The DBC Value Table is a named bimap containing mappings from enum values
- * (typed as double), to enum names (typed as strings).
+ * (typed as double), to enum names (typed as strings). Both directions are
+ * hashed.
  *
  * @note This type is designed to fully encapsulate the lifetime of its
  *       children.
@@ -42,6 +43,8 @@ dbc_value_table_t dbc_value_table_new(const char* name);
 
 /**
  * @brief Frees the value table and all children members.
+ * @note Value tables owned by a dbc_t are released together with it, calling
+ *       this on them does nothing.
  * @param vt The value table to be freed.
  */
 void dbc_value_table_free(const dbc_value_table_t vt);
@@ -60,7 +63,8 @@ const char* dbc_value_table_get_name(dbc_value_table_t vt);
  * @param num The number.
  * @param desc The description for said number.
  *
- * @return true if the value has been successfully inserted
+ * @return true if the value has been successfully inserted, false if out of
+ *         memory or if the table is frozen.
  */
 bool dbc_value_table_insert(dbc_value_table_t vt,
                             double num, const char* desc);
@@ -76,7 +80,60 @@ size_t dbc_value_table_get_size(dbc_value_table_t vt);
  * @param vt The target value table.
  * @param val The target value.
  * @return The description for the given value, NULL if the value is not found.
+ *         Descriptions are interned, equal descriptions within a dbc_t (or
+ *         within a standalone table) share a single pointer.
  */
 const char* dbc_value_table_get_desc(dbc_value_table_t vt, const double val);
 
+/**
+ * @brief Returns the value with the given description.
+ *
+ * Runs in constant time. If several values share the description, the
+ * smallest one is returned.
+ *
+ * @param vt The target value table.
+ * @param desc The target description.
+ * @param out Receives the value, untouched if the description is not found.
+ * @return false if the description is not found.
+ */
+bool dbc_value_table_get_value(dbc_value_table_t vt, const char* desc,
+                               double* out);
+
+/**
+ * @brief Steps through the entries of the table.
+ *
+ * Entries come in no particular order, but in ascending order of their values
+ * once the table is frozen. Inserting while iterating may skip or repeat
+ * entries.
+ *
+ * @code
+ * size_t cursor = 0;
+ * double num;
+ * const char* desc;
+ * while (dbc_value_table_next(vt, &cursor, &num, &desc)) {
+ *     ...
+ * }
+ * @endcode
+ *
+ * @param cursor 0 to start with the first entry, moved past the returned one.
+ * @param num Receives the value of the entry.
+ * @param desc Receives the description of the entry.
+ * @return false once there are no entries left.
+ */
+bool dbc_value_table_next(dbc_value_table_t vt, size_t* cursor, double* num,
+                          const char** desc);
+
+/**
+ * @brief Compiles the table into its final, read-only layout.
+ *
+ * Tables keyed by small non-negative integers stay directly indexed, all
+ * others become a sorted key array with a parallel description array. Once
+ * frozen, a table rejects inserts and may be read from any number of threads
+ * without synchronization. Freezing a frozen table does nothing.
+ *
+ * @param vt The value table to freeze.
+ * @return true on success, false if out of memory (the table is untouched).
+ */
+bool dbc_value_table_freeze(dbc_value_table_t vt);
+
 #endif
@@ -1,33 +1,133 @@
 #include "libdbc.h"
 #include <stdlib.h>
 #include <string.h>
-#include "sds.h"
 #include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_attribute.h"
+#include "__libdbc_id_index.h"
+#include "__libdbc_lazy.h"
+#include "__libdbc_name_index.h"
+#include "__libdbc_signal.h"
+#include "__libdbc_strpool.h"
 
 #define UTF8_MAX_CHAR_WIDTH_BYTES (4U)
 
 struct dbc {
-    sds version;
+    // Owns everything below, and everything hanging off of it.
+    dbc_arena_t arena;
+    // Interns node names, table names and value descriptions.
+    dbc_strpool_t strings;
+    const char* version;
     // TODO: Missing new symbols, useless?
     // TODO: Missing Bit Timing, useless?
-    //vector nodes;
-    //vector value_tables;
-    // TODO: Missing Message Defs
+    dbc_node_t* nodes;
+    size_t num_nodes;
+    size_t cap_nodes;
+    dbc_value_table_t* value_tables;
+    size_t num_value_tables;
+    size_t cap_value_tables;
+    dbc_message_t* messages;
+    size_t num_messages;
+    size_t cap_messages;
+    dbc_id_index_t messages_by_id;
+    dbc_name_index_t nodes_by_name;
+    dbc_name_index_t value_tables_by_name;
+    dbc_name_index_t messages_by_name;
+    // Filled by the messages, signals are owned by their message.
+    dbc_name_index_t signals_by_name;
+    // Set once the signals of every lazily loaded message have been loaded,
+    // read atomically.
+    bool signals_loaded;
+    // Set if strings were adopted from a compiled image, or if statements
+    // are parsed lazily out of a mapped file.
+    dbc_file_map_t file_map;
+    // Set if signals are parsed lazily.
+    dbc_lazy_t lazy;
+    // Statements left for __dbc_parse_deferred, see __dbc_set_deferring.
+    bool deferring;
+    dbc_stmt_ref_t* deferred;
+    size_t num_deferred;
+    size_t cap_deferred;
+    // Comments, by the kind of object they are about.
+    dbc_comment_table_t comments[DBC_NUM_OBJECT_KINDS];
+    // Attribute definitions, each holding the values objects have for it.
+    dbc_attr_def_t* attr_defs;
+    size_t num_attr_defs;
+    size_t cap_attr_defs;
+    dbc_name_index_t attr_defs_by_name;
+    // The CM_ and BA_ statements of a lazily loaded dbc, parsed once comments
+    // or attributes are first asked for, see __dbc_load_annotations.
+    dbc_stmt_ref_t* lazy_annotations;
+    size_t num_lazy_annotations;
+    size_t cap_lazy_annotations;
+    // Read atomically.
+    bool annotations_loaded;
     // TODO: Missing Env Variables
     // TODO: Missing Signal Types
-    // TODO: Missing Comments
 };
 
+bool __dbc_vector_reserve(dbc_arena_t arena, void*** vec, size_t* cap,
+                          const size_t len) {
+    if (likely(len < *cap)) {
+        return true;
+    }
+
+    const size_t new_cap = *cap == 0 ? DBC_VECTOR_INITIAL_CAPACITY : *cap * 2;
+    void** new_vec = (void**)__dbc_arena_realloc(
+        arena, *vec, *cap * sizeof(void*), new_cap * sizeof(void*));
+    if (unlikely(new_vec == NULL)) {
+        return false;
+    }
+
+    *vec = new_vec;
+    *cap = new_cap;
+    return true;
+}
+
 dbc_t dbc_new() {
-    dbc_t dbc = (dbc_t)malloc(sizeof(struct dbc));
-    dbc->version = sdsempty();
+    const dbc_arena_t arena = __dbc_arena_new();
+    if (unlikely(arena == NULL)) {
+        return NULL;
+    }
+
+    dbc_t dbc = (dbc_t)__dbc_arena_calloc(arena, sizeof(struct dbc));
+    if (unlikely(dbc == NULL)) {
+        __dbc_arena_free(arena);
+        return NULL;
+    }
+    dbc->arena = arena;
+    dbc->strings = __dbc_strpool_new(arena);
+    if (unlikely(dbc->strings == NULL)) {
+        __dbc_arena_free(arena);
+        return NULL;
+    }
+    dbc->version = "";
 
     return dbc;
 }
 
+static void __dbc_release_indices(dbc_t dbc) {
+    __dbc_id_index_release(&dbc->messages_by_id);
+    __dbc_name_index_release(&dbc->nodes_by_name);
+    __dbc_name_index_release(&dbc->value_tables_by_name);
+    __dbc_name_index_release(&dbc->messages_by_name);
+    __dbc_name_index_release(&dbc->signals_by_name);
+    __dbc_name_index_release(&dbc->attr_defs_by_name);
+}
+
 void dbc_free(const dbc_t dbc) {
-    sdsfree(dbc->version);
-    free(dbc);
+    // Only nodes handed over through dbc_push_node live outside the arena.
+    for (size_t i = 0; i < dbc->num_nodes; i++) {
+        dbc_node_free(dbc->nodes[i]);
+    }
+    __dbc_strpool_release(dbc->strings);
+    __dbc_release_indices(dbc);
+    __dbc_file_unmap(&dbc->file_map);
+    if (dbc->lazy != NULL) {
+        __dbc_lazy_free(dbc->lazy);
+    }
+
+    __dbc_arena_free(dbc->arena);
 }
 
 const char* dbc_get_version(const dbc_t dbc) {
@@ -35,34 +135,775 @@ const char* dbc_get_version(const dbc_t dbc) {
 }
 
 void dbc_set_version(dbc_t dbc, const char* const ver) {
-    dbc->version = sdscpy(dbc->version, ver);
+    __dbc_set_version_len(dbc, ver, strlen(ver));
+}
+
+void __dbc_set_version_len(dbc_t dbc, const char* ver, const size_t len) {
+    // The version is set about once per file, the previous one is simply
+    // left behind in the arena.
+    const char* const copy = __dbc_arena_strndup(dbc->arena, ver, len);
+    if (likely(copy != NULL)) {
+        dbc->version = copy;
+    }
+}
+
+/**
+ * @brief Appends a node and files it under its interned name.
+ */
+static bool __dbc_file_node(dbc_t dbc, dbc_node_t node,
+                            const char* interned) {
+    if (unlikely(!__dbc_vector_reserve(dbc->arena, (void***)&dbc->nodes,
+                                       &dbc->cap_nodes, dbc->num_nodes)
+                 || !__dbc_name_index_insert(&dbc->nodes_by_name, interned,
+                                             node, NULL, dbc->num_nodes))) {
+        return false;
+    }
+
+    dbc->nodes[dbc->num_nodes++] = node;
+    return true;
 }
 
 void dbc_push_node(dbc_t dbc, dbc_node_t node) {
-    (void)dbc; (void)node; // TODO: Implement
+    // The node's own name is not interned, so it is filed under the DBC's
+    // copy.
+    const char* const name = dbc_node_get_name(node);
+    const char* const interned =
+        __dbc_strpool_intern(dbc->strings, name, strlen(name));
+    if (likely(interned != NULL)) {
+        __dbc_file_node(dbc, node, interned);
+    }
+}
+
+dbc_node_t __dbc_add_node_len(dbc_t dbc, const char* name, const size_t len) {
+    const char* const interned = __dbc_strpool_intern(dbc->strings, name, len);
+    if (unlikely(interned == NULL)) {
+        return NULL;
+    }
+
+    const dbc_node_t node = __dbc_node_new_in(dbc->arena, interned);
+    if (unlikely(node == NULL || !__dbc_file_node(dbc, node, interned))) {
+        return NULL;
+    }
+
+    return node;
 }
 
 dbc_node_t dbc_get_node(const dbc_t dbc, const size_t idx) {
-    (void)dbc; (void)idx; // TODO: Implement
-    return NULL;
+    if (unlikely(idx >= dbc->num_nodes)) {
+        return NULL;
+    }
+
+    return dbc->nodes[idx];
+}
+
+dbc_node_t dbc_get_node_by_name(const dbc_t dbc, const char* name) {
+    const dbc_name_entry_t* const entry =
+        __dbc_name_index_find(&dbc->nodes_by_name, dbc_find_string(dbc, name));
+    return entry == NULL ? NULL : (dbc_node_t)entry->obj;
 }
 
 size_t dbc_get_num_nodes(const dbc_t dbc) {
-    (void)dbc; // TODO: Implemnet
-    return 0;
+    return dbc->num_nodes;
 }
 
 dbc_value_table_t dbc_get_value_table(dbc_t dbc, const char* name) {
-    (void)dbc; (void)name; // TODO
-    return NULL;
+    const dbc_name_entry_t* const entry = __dbc_name_index_find(
+        &dbc->value_tables_by_name, dbc_find_string(dbc, name));
+    return entry == NULL ? NULL : (dbc_value_table_t)entry->obj;
+}
+
+/**
+ * @brief Appends a value table and files it under its name.
+ */
+static bool __dbc_file_value_table(dbc_t dbc, dbc_value_table_t vt) {
+    if (unlikely(!__dbc_vector_reserve(dbc->arena,
+                                       (void***)&dbc->value_tables,
+                                       &dbc->cap_value_tables,
+                                       dbc->num_value_tables)
+                 || !__dbc_name_index_insert(&dbc->value_tables_by_name,
+                                             dbc_value_table_get_name(vt), vt,
+                                             NULL, dbc->num_value_tables))) {
+        return false;
+    }
+
+    dbc->value_tables[dbc->num_value_tables++] = vt;
+    return true;
+}
+
+dbc_value_table_t __dbc_add_value_table_len(dbc_t dbc, const char* name,
+                                            const size_t len) {
+    const dbc_value_table_t vt =
+        __dbc_value_table_new_in(dbc->arena, dbc->strings, name, len);
+    if (unlikely(vt == NULL || !__dbc_file_value_table(dbc, vt))) {
+        return NULL;
+    }
+
+    return vt;
 }
 
 dbc_value_table_t dbc_add_value_table(dbc_t dbc, const char* name) {
-    (void)dbc; (void)name; // TODO
-    return NULL;
+    return __dbc_add_value_table_len(dbc, name, strlen(name));
+}
+
+dbc_value_table_t __dbc_get_value_table_at(const dbc_t dbc, const size_t idx) {
+    if (unlikely(idx >= dbc->num_value_tables)) {
+        return NULL;
+    }
+
+    return dbc->value_tables[idx];
 }
 
 size_t dbc_get_num_value_tables(const dbc_t dbc) {
-    (void)dbc; // TODO
-    return 0;
+    return dbc->num_value_tables;
+}
+
+const char* dbc_find_string(const dbc_t dbc, const char* str) {
+    // Lazily parsed signals may be interning strings right now.
+    if (dbc->lazy != NULL) {
+        __dbc_lazy_lock(dbc->lazy);
+    }
+    const char* const found =
+        __dbc_strpool_find(dbc->strings, str, strlen(str));
+    if (dbc->lazy != NULL) {
+        __dbc_lazy_unlock(dbc->lazy);
+    }
+    return found;
+}
+
+bool dbc_freeze(dbc_t dbc) {
+    bool success = true;
+    for (size_t i = 0; i < dbc->num_value_tables; i++) {
+        success &= dbc_value_table_freeze(dbc->value_tables[i]);
+    }
+
+    return success;
+}
+
+static void __dbc_usage_add(dbc_memory_usage_t* usage, const size_t count,
+                            const size_t bytes) {
+    usage->count += count;
+    usage->bytes += bytes;
+}
+
+void dbc_memory_stats(const dbc_t dbc, dbc_memory_stats_t* stats) {
+    memset(stats, 0, sizeof(*stats));
+
+    // Lazy loading may be growing any of what is looked at here.
+    if (dbc->lazy != NULL) {
+        __dbc_lazy_lock(dbc->lazy);
+    }
+
+    size_t heap_bytes;
+    size_t table_bytes;
+    __dbc_usage_add(&stats->strings, __dbc_strpool_get_size(dbc->strings),
+                    __dbc_strpool_get_memory(dbc->strings, &table_bytes));
+    heap_bytes = table_bytes;
+
+    __dbc_usage_add(&stats->nodes, dbc->num_nodes,
+                    dbc->cap_nodes * sizeof(dbc_node_t));
+    for (size_t i = 0; i < dbc->num_nodes; i++) {
+        stats->nodes.bytes += __dbc_node_get_memory(dbc->nodes[i]);
+    }
+
+    __dbc_usage_add(&stats->value_tables, dbc->num_value_tables, 0);
+    stats->value_table_overhead =
+        dbc->cap_value_tables * sizeof(dbc_value_table_t);
+    for (size_t i = 0; i < dbc->num_value_tables; i++) {
+        size_t keys;
+        size_t descs;
+        size_t overhead;
+        __dbc_value_table_get_memory(dbc->value_tables[i], &keys, &descs,
+                                     &overhead);
+        stats->value_table_keys += keys;
+        stats->value_table_descs += descs;
+        stats->value_table_overhead += overhead;
+    }
+    stats->value_tables.bytes = stats->value_table_keys
+                                + stats->value_table_descs
+                                + stats->value_table_overhead;
+
+    __dbc_usage_add(&stats->messages, dbc->num_messages,
+                    dbc->cap_messages * sizeof(dbc_message_t));
+    for (size_t i = 0; i < dbc->num_messages; i++) {
+        size_t num_signals;
+        size_t sig_bytes;
+        stats->messages.bytes += __dbc_message_get_memory(
+            dbc->messages[i], &num_signals, &sig_bytes);
+        __dbc_usage_add(&stats->signals, num_signals, sig_bytes);
+    }
+
+    // Comments are copied, unless lazily loaded out of the file.
+    for (size_t kind = 0; kind < DBC_NUM_OBJECT_KINDS; kind++) {
+        __dbc_usage_add(&stats->annotations, dbc->comments[kind].rows.num_rows,
+                        __dbc_comment_table_get_memory(&dbc->comments[kind],
+                                                       dbc->lazy == NULL));
+    }
+    stats->annotations.bytes += dbc->cap_attr_defs * sizeof(dbc_attr_def_t);
+    for (size_t i = 0; i < dbc->num_attr_defs; i++) {
+        __dbc_usage_add(&stats->annotations,
+                        dbc_attr_def_get_num_values(dbc->attr_defs[i]),
+                        __dbc_attr_def_get_memory(dbc->attr_defs[i]));
+    }
+
+    const dbc_name_index_t* const name_indices[] = {
+        &dbc->nodes_by_name, &dbc->value_tables_by_name,
+        &dbc->messages_by_name, &dbc->signals_by_name,
+        &dbc->attr_defs_by_name,
+    };
+    stats->indices.bytes = __dbc_id_index_get_memory(
+        &dbc->messages_by_id, &stats->indices.count, &table_bytes);
+    heap_bytes += table_bytes;
+    for (size_t i = 0; i < sizeof(name_indices) / sizeof(name_indices[0]);
+         i++) {
+        const size_t bytes = __dbc_name_index_get_memory(name_indices[i]);
+        __dbc_usage_add(&stats->indices, name_indices[i]->num_entries, bytes);
+        heap_bytes += bytes;
+    }
+
+    dbc_arena_stats_t arena;
+    __dbc_arena_get_stats(dbc->arena, &arena);
+    if (dbc->lazy != NULL) {
+        __dbc_lazy_unlock(dbc->lazy);
+    }
+
+    stats->arena_bytes = arena.reserved;
+    stats->arena_chunks = arena.num_chunks;
+    stats->arena_slack = arena.reserved - arena.live;
+    stats->num_allocs = arena.num_allocs;
+    stats->file_bytes = dbc->file_map.data != NULL ? dbc->file_map.len : 0;
+    stats->total_bytes = arena.reserved + heap_bytes;
+}
+
+/**
+ * @brief Appends a message and files it under its id and name.
+ */
+static bool __dbc_file_message(dbc_t dbc, dbc_message_t msg) {
+    if (unlikely(!__dbc_vector_reserve(dbc->arena, (void***)&dbc->messages,
+                                       &dbc->cap_messages, dbc->num_messages)
+                 || !__dbc_id_index_insert(&dbc->messages_by_id, dbc->arena,
+                                           msg)
+                 || !__dbc_name_index_insert(&dbc->messages_by_name,
+                                             dbc_message_get_name(msg), msg,
+                                             NULL, dbc->num_messages))) {
+        return false;
+    }
+
+    __dbc_message_set_name_index(msg, &dbc->signals_by_name);
+    __dbc_message_set_index(msg, (uint32_t)dbc->num_messages);
+    dbc->messages[dbc->num_messages++] = msg;
+    return true;
+}
+
+dbc_message_t __dbc_add_message_len(dbc_t dbc, const uint32_t id,
+                                    const char* name, const size_t name_len,
+                                    const uint32_t size,
+                                    const char* transmitter,
+                                    const size_t transmitter_len) {
+    const dbc_message_t msg =
+        __dbc_message_new_in(dbc->arena, dbc->strings, id, name, name_len,
+                             size, transmitter, transmitter_len);
+    if (unlikely(msg == NULL || !__dbc_file_message(dbc, msg))) {
+        return NULL;
+    }
+
+    return msg;
+}
+
+dbc_message_t dbc_add_message(dbc_t dbc, const uint32_t id, const char* name,
+                              const uint32_t size, const char* transmitter) {
+    return __dbc_add_message_len(dbc, id, name, strlen(name), size,
+                                 transmitter, strlen(transmitter));
+}
+
+size_t dbc_get_num_messages(const dbc_t dbc) {
+    return dbc->num_messages;
+}
+
+dbc_message_t dbc_get_message(const dbc_t dbc, const size_t idx) {
+    if (unlikely(idx >= dbc->num_messages)) {
+        return NULL;
+    }
+
+    return dbc->messages[idx];
+}
+
+dbc_message_t dbc_get_message_by_name(const dbc_t dbc, const char* name) {
+    const dbc_name_entry_t* const entry = __dbc_name_index_find(
+        &dbc->messages_by_name, dbc_find_string(dbc, name));
+    return entry == NULL ? NULL : (dbc_message_t)entry->obj;
+}
+
+/**
+ * @brief Loads the signals of every lazily loaded message, such that they are
+ *        all in the index.
+ */
+static void __dbc_load_all_signals(dbc_t dbc) {
+    if (likely(dbc->lazy == NULL
+               || __atomic_load_n(&dbc->signals_loaded, __ATOMIC_ACQUIRE))) {
+        return;
+    }
+
+    for (size_t i = 0; i < dbc->num_messages; i++) {
+        __dbc_message_load_signals(dbc->messages[i]);
+    }
+    __atomic_store_n(&dbc->signals_loaded, true, __ATOMIC_RELEASE);
+}
+
+dbc_signal_t dbc_get_signal_by_name(const dbc_t dbc, const char* name,
+                                    dbc_message_t* msg) {
+    __dbc_load_all_signals(dbc);
+    const dbc_name_entry_t* const entry = __dbc_name_index_find(
+        &dbc->signals_by_name, dbc_find_string(dbc, name));
+    if (entry == NULL) {
+        return NULL;
+    }
+
+    if (msg != NULL) {
+        *msg = (dbc_message_t)entry->owner;
+    }
+    return (dbc_signal_t)entry->obj;
+}
+
+size_t dbc_find_messages_by_prefix(const dbc_t dbc, const char* prefix,
+                                   dbc_message_t* msgs, const size_t cap) {
+    size_t first;
+    const size_t n =
+        __dbc_name_index_prefix(&dbc->messages_by_name, prefix, &first);
+    for (size_t i = 0; n != SIZE_MAX && i < n && i < cap; i++) {
+        msgs[i] = (dbc_message_t)__dbc_name_index_sorted_at(
+                      &dbc->messages_by_name, first + i)
+                      ->obj;
+    }
+    return n;
+}
+
+size_t dbc_find_signals_by_prefix(const dbc_t dbc, const char* prefix,
+                                  dbc_signal_t* sigs, dbc_message_t* msgs,
+                                  const size_t cap) {
+    __dbc_load_all_signals(dbc);
+    size_t first;
+    const size_t n =
+        __dbc_name_index_prefix(&dbc->signals_by_name, prefix, &first);
+    for (size_t i = 0; n != SIZE_MAX && i < n && i < cap; i++) {
+        const dbc_name_entry_t* const entry =
+            __dbc_name_index_sorted_at(&dbc->signals_by_name, first + i);
+        sigs[i] = (dbc_signal_t)entry->obj;
+        if (msgs != NULL) {
+            msgs[i] = (dbc_message_t)entry->owner;
+        }
+    }
+    return n;
+}
+
+size_t __dbc_find_node_index_len(const dbc_t dbc, const char* name,
+                                 const size_t len) {
+    const dbc_name_entry_t* const entry = __dbc_name_index_find(
+        &dbc->nodes_by_name, __dbc_strpool_find(dbc->strings, name, len));
+    return entry == NULL ? SIZE_MAX : entry->pos;
+}
+
+dbc_attr_def_t __dbc_add_attr_def_len(dbc_t dbc, const char* name,
+                                      const size_t len,
+                                      const dbc_object_kind_t kind,
+                                      const dbc_attr_type_t type) {
+    if (unlikely(!__dbc_vector_reserve(dbc->arena, (void***)&dbc->attr_defs,
+                                       &dbc->cap_attr_defs,
+                                       dbc->num_attr_defs))) {
+        return NULL;
+    }
+
+    const dbc_attr_def_t def =
+        __dbc_attr_def_new_in(dbc->arena, dbc->strings, name, len, kind, type);
+    if (unlikely(def == NULL
+                 || !__dbc_name_index_insert(&dbc->attr_defs_by_name,
+                                             dbc_attr_def_get_name(def), def,
+                                             NULL, dbc->num_attr_defs))) {
+        return NULL;
+    }
+
+    dbc->attr_defs[dbc->num_attr_defs++] = def;
+    return def;
+}
+
+dbc_attr_def_t __dbc_find_attr_def_len(const dbc_t dbc, const char* name,
+                                       const size_t len) {
+    const dbc_name_entry_t* const entry = __dbc_name_index_find(
+        &dbc->attr_defs_by_name, __dbc_strpool_find(dbc->strings, name, len));
+    return entry == NULL ? NULL : (dbc_attr_def_t)entry->obj;
+}
+
+bool __dbc_add_comment_len(dbc_t dbc, const dbc_object_kind_t kind,
+                           const uint32_t obj, const uint32_t sub,
+                           const char* text, const size_t len) {
+    // A lazily loaded dbc keeps its file around, anything else is parsed out
+    // of buffers which come and go.
+    const char* const kept =
+        dbc->lazy != NULL ? text : __dbc_arena_strndup(dbc->arena, text, len);
+    return kept != NULL
+        && __dbc_comment_table_set(&dbc->comments[kind], dbc->arena, obj, sub,
+                                   kept, len);
+}
+
+bool __dbc_sort_annotations(dbc_t dbc) {
+    bool success = true;
+    for (size_t i = 0; i < DBC_NUM_OBJECT_KINDS; i++) {
+        success &= __dbc_comment_table_sort(&dbc->comments[i]);
+    }
+    for (size_t i = 0; i < dbc->num_attr_defs; i++) {
+        success &= __dbc_attr_def_sort(dbc->attr_defs[i]);
+    }
+    return success;
+}
+
+/**
+ * @brief Parses the CM_ and BA_ statements of a lazily loaded dbc, unless
+ *        already done.
+ */
+static void __dbc_load_annotations(dbc_t dbc) {
+    if (likely(dbc->lazy == NULL
+               || __atomic_load_n(&dbc->annotations_loaded,
+                                  __ATOMIC_ACQUIRE))) {
+        return;
+    }
+
+    // Signals are referred to by index, and loading them takes the lock.
+    __dbc_load_all_signals(dbc);
+    __dbc_lazy_lock(dbc->lazy);
+    if (!dbc->annotations_loaded) {
+        __dbc_lazy_report(dbc->lazy,
+                          __dbc_parse_refs(dbc, dbc->lazy_annotations,
+                                           dbc->num_lazy_annotations));
+        if (unlikely(!__dbc_sort_annotations(dbc))) {
+            __dbc_lazy_report(dbc->lazy, DBC_PARSE_CRITICAL);
+        }
+        __atomic_store_n(&dbc->annotations_loaded, true, __ATOMIC_RELEASE);
+    }
+    __dbc_lazy_unlock(dbc->lazy);
+}
+
+size_t dbc_get_num_attr_defs(const dbc_t dbc) {
+    __dbc_load_annotations(dbc);
+    return dbc->num_attr_defs;
+}
+
+dbc_attr_def_t dbc_get_attr_def(const dbc_t dbc, const size_t idx) {
+    __dbc_load_annotations(dbc);
+    if (unlikely(idx >= dbc->num_attr_defs)) {
+        return NULL;
+    }
+
+    return dbc->attr_defs[idx];
+}
+
+dbc_attr_def_t dbc_get_attr_def_by_name(const dbc_t dbc, const char* name) {
+    __dbc_load_annotations(dbc);
+    return __dbc_find_attr_def_len(dbc, name, strlen(name));
+}
+
+static bool __dbc_get_attribute(const dbc_t dbc, const char* name,
+                                const dbc_object_kind_t kind,
+                                const size_t obj, const size_t sub,
+                                dbc_attr_value_t* out) {
+    const dbc_attr_def_t def = dbc_get_attr_def_by_name(dbc, name);
+    return def != NULL && obj != SIZE_MAX && sub != SIZE_MAX
+        && dbc_attr_def_get_object_kind(def) == kind
+        && __dbc_attr_def_find_value(def, (uint32_t)obj, (uint32_t)sub, out);
+}
+
+/**
+ * @return The index of the node in the dbc, SIZE_MAX if it is not the dbc's.
+ */
+static size_t __dbc_get_node_index(const dbc_t dbc, const dbc_node_t node) {
+    // Nodes pushed with dbc_push_node may share a name. The pool is read
+    // under the lock, lazily loaded signals may be interning strings.
+    for (const dbc_name_entry_t* entry = __dbc_name_index_find(
+             &dbc->nodes_by_name,
+             dbc_find_string(dbc, dbc_node_get_name(node)));
+         entry != NULL;
+         entry = __dbc_name_index_next(&dbc->nodes_by_name, entry)) {
+        if (entry->obj == node) {
+            return entry->pos;
+        }
+    }
+    return SIZE_MAX;
+}
+
+bool dbc_get_network_attribute(const dbc_t dbc, const char* name,
+                               dbc_attr_value_t* out) {
+    return __dbc_get_attribute(dbc, name, DBC_OBJECT_NETWORK, 0, 0, out);
+}
+
+bool dbc_get_node_attribute(const dbc_t dbc, const dbc_node_t node,
+                            const char* name, dbc_attr_value_t* out) {
+    return __dbc_get_attribute(dbc, name, DBC_OBJECT_NODE,
+                               __dbc_get_node_index(dbc, node), 0, out);
+}
+
+bool dbc_get_message_attribute(const dbc_t dbc, const dbc_message_t msg,
+                               const char* name, dbc_attr_value_t* out) {
+    return __dbc_get_attribute(dbc, name, DBC_OBJECT_MESSAGE,
+                               __dbc_message_get_index(msg), 0, out);
+}
+
+bool dbc_get_signal_attribute(const dbc_t dbc, const dbc_message_t msg,
+                              const dbc_signal_t sig, const char* name,
+                              dbc_attr_value_t* out) {
+    return __dbc_get_attribute(dbc, name, DBC_OBJECT_SIGNAL,
+                               __dbc_message_get_index(msg),
+                               __dbc_message_get_signal_index(msg, sig), out);
+}
+
+static size_t __dbc_get_comment(const dbc_t dbc, const dbc_object_kind_t kind,
+                                const size_t obj, const size_t sub, char* buf,
+                                const size_t cap) {
+    __dbc_load_annotations(dbc);
+    const char* text = "";
+    size_t len = 0;
+    if (obj != SIZE_MAX && sub != SIZE_MAX) {
+        __dbc_comment_table_find(&dbc->comments[kind], (uint32_t)obj,
+                                 (uint32_t)sub, &text, &len);
+    }
+    return __dbc_comment_decode(text, len, buf, cap);
+}
+
+size_t __dbc_get_num_comments(const dbc_t dbc, const dbc_object_kind_t kind) {
+    __dbc_load_annotations(dbc);
+    return dbc->comments[kind].rows.num_rows;
+}
+
+bool __dbc_get_comment_at(const dbc_t dbc, const dbc_object_kind_t kind,
+                          const size_t idx, uint32_t* obj, uint32_t* sub,
+                          const char** text, size_t* len) {
+    __dbc_load_annotations(dbc);
+    const dbc_comment_table_t* const table = &dbc->comments[kind];
+    if (unlikely(idx >= table->rows.num_rows)) {
+        return false;
+    }
+
+    *obj = table->rows.objs[idx];
+    *sub = table->rows.subs[idx];
+    *text = table->texts[idx];
+    *len = table->lens[idx];
+    return true;
+}
+
+size_t dbc_get_network_comment(const dbc_t dbc, char* buf, const size_t cap) {
+    return __dbc_get_comment(dbc, DBC_OBJECT_NETWORK, 0, 0, buf, cap);
+}
+
+size_t dbc_get_node_comment(const dbc_t dbc, const dbc_node_t node,
+                            char* buf, const size_t cap) {
+    return __dbc_get_comment(dbc, DBC_OBJECT_NODE,
+                             __dbc_get_node_index(dbc, node), 0, buf, cap);
+}
+
+size_t dbc_get_message_comment(const dbc_t dbc, const dbc_message_t msg,
+                               char* buf, const size_t cap) {
+    return __dbc_get_comment(dbc, DBC_OBJECT_MESSAGE,
+                             __dbc_message_get_index(msg), 0, buf, cap);
+}
+
+size_t dbc_get_signal_comment(const dbc_t dbc, const dbc_message_t msg,
+                              const dbc_signal_t sig, char* buf,
+                              const size_t cap) {
+    return __dbc_get_comment(dbc, DBC_OBJECT_SIGNAL,
+                             __dbc_message_get_index(msg),
+                             __dbc_message_get_signal_index(msg, sig), buf,
+                             cap);
+}
+
+dbc_message_t dbc_get_message_by_id(const dbc_t dbc, const uint32_t id) {
+    return __dbc_id_index_find(&dbc->messages_by_id, id);
+}
+
+dbc_message_t dbc_get_message_by_pgn(const dbc_t dbc, const uint32_t can_id) {
+    return __dbc_id_index_find_pgn(&dbc->messages_by_id, can_id);
+}
+
+bool dbc_decode(const dbc_t dbc, const uint32_t can_id, const uint8_t* payload,
+                const size_t len, double* out) {
+    const dbc_message_t msg = __dbc_id_index_find(&dbc->messages_by_id, can_id);
+    if (unlikely(msg == NULL)) {
+        return false;
+    }
+
+    dbc_message_decode(msg, payload, len, out);
+    return true;
+}
+
+bool dbc_decode_batch(const dbc_t dbc, const uint32_t can_id,
+                      const uint8_t* payloads, const size_t n,
+                      double* const* out_columns) {
+    const dbc_message_t msg = __dbc_id_index_find(&dbc->messages_by_id, can_id);
+    if (unlikely(msg == NULL)) {
+        return false;
+    }
+
+    const size_t size = dbc_message_get_size(msg);
+    dbc_message_decode_batch(msg, payloads, size, size, n, out_columns);
+    return true;
+}
+
+bool dbc_encode(const dbc_t dbc, const uint32_t can_id, const double* values,
+                uint8_t* payload, const size_t len) {
+    const dbc_message_t msg = __dbc_id_index_find(&dbc->messages_by_id, can_id);
+    if (unlikely(msg == NULL)) {
+        return false;
+    }
+
+    dbc_message_encode(msg, values, payload, len);
+    return true;
+}
+
+bool dbc_encode_batch(const dbc_t dbc, const uint32_t can_id,
+                      const double* const* columns, const size_t n,
+                      uint8_t* payloads) {
+    const dbc_message_t msg = __dbc_id_index_find(&dbc->messages_by_id, can_id);
+    if (unlikely(msg == NULL)) {
+        return false;
+    }
+
+    const size_t size = dbc_message_get_size(msg);
+    dbc_message_encode_batch(msg, columns, n, payloads, size, size);
+    return true;
+}
+
+dbc_strpool_t __dbc_get_strpool(const dbc_t dbc) {
+    return dbc->strings;
+}
+
+void __dbc_set_lazy(dbc_t dbc, dbc_lazy_t lazy) {
+    dbc->lazy = lazy;
+}
+
+dbc_parse_status_t dbc_get_lazy_status(const dbc_t dbc) {
+    return dbc->lazy == NULL ? DBC_PARSE_SUCCESS
+                             : __dbc_lazy_get_status(dbc->lazy);
+}
+
+void __dbc_keep_file_map(dbc_t dbc, const dbc_file_map_t* map) {
+    __dbc_file_unmap(&dbc->file_map);
+    dbc->file_map = *map;
+}
+
+void __dbc_set_deferring(dbc_t dbc, const bool deferring) {
+    dbc->deferring = deferring;
+}
+
+/**
+ * @brief Appends a statement to a vector of them living in the arena.
+ */
+static bool __dbc_push_stmt_ref(dbc_arena_t arena, dbc_stmt_ref_t** refs,
+                                size_t* num, size_t* cap, const char* str,
+                                const size_t len) {
+    if (*num == *cap) {
+        const size_t new_cap =
+            *cap == 0 ? DBC_VECTOR_INITIAL_CAPACITY : *cap * 2;
+        dbc_stmt_ref_t* const grown = (dbc_stmt_ref_t*)__dbc_arena_realloc(
+            arena, *refs, *cap * sizeof(dbc_stmt_ref_t),
+            new_cap * sizeof(dbc_stmt_ref_t));
+        if (unlikely(grown == NULL)) {
+            return false;
+        }
+        *refs = grown;
+        *cap = new_cap;
+    }
+
+    (*refs)[*num].str = str;
+    (*refs)[*num].len = len;
+    (*num)++;
+    return true;
+}
+
+bool __dbc_defer_statement(dbc_t dbc, const char* str, const size_t len) {
+    if (!dbc->deferring) {
+        return false;
+    }
+    return __dbc_push_stmt_ref(dbc->arena, &dbc->deferred, &dbc->num_deferred,
+                               &dbc->cap_deferred, str, len);
+}
+
+bool __dbc_defer_annotation(dbc_t dbc, const char* str, const size_t len) {
+    return __dbc_push_stmt_ref(dbc->arena, &dbc->lazy_annotations,
+                               &dbc->num_lazy_annotations,
+                               &dbc->cap_lazy_annotations, str, len);
+}
+
+const dbc_stmt_ref_t* __dbc_take_deferred(dbc_t dbc, size_t* n) {
+    // The storage stays in the arena, it is only forgotten about.
+    const dbc_stmt_ref_t* const deferred = dbc->deferred;
+    *n = dbc->num_deferred;
+    dbc->deferring = false;
+    dbc->deferred = NULL;
+    dbc->num_deferred = 0;
+    dbc->cap_deferred = 0;
+    return deferred;
+}
+
+/**
+ * @brief Moves the objects of an absorbed dbc over, re-pointing them at the
+ * dbc's arena, pool and indices rather than copying them.
+ */
+static bool __dbc_absorb_objects(dbc_t dst, dbc_t src) {
+    if (src->version[0] != 0) {
+        dst->version = src->version;
+    }
+
+    // From here on dst owns the nodes, including any pushed from the heap.
+    const size_t num_nodes = src->num_nodes;
+    src->num_nodes = 0;
+    for (size_t i = 0; i < num_nodes; i++) {
+        const dbc_node_t node = src->nodes[i];
+        const char* const interned = __dbc_node_adopt(node, dst->strings);
+        if (unlikely(interned == NULL
+                     || !__dbc_file_node(dst, node, interned))) {
+            for (size_t j = i; j < num_nodes; j++) {
+                dbc_node_free(src->nodes[j]);
+            }
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < src->num_value_tables; i++) {
+        const dbc_value_table_t vt = src->value_tables[i];
+        if (unlikely(!__dbc_value_table_adopt(vt, dst->arena, dst->strings)
+                     || !__dbc_file_value_table(dst, vt))) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < src->num_messages; i++) {
+        const dbc_message_t msg = src->messages[i];
+        if (unlikely(!__dbc_message_adopt(msg, dst->arena, dst->strings,
+                                          &dst->signals_by_name)
+                     || !__dbc_file_message(dst, msg))) {
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < src->num_deferred; i++) {
+        if (unlikely(!__dbc_defer_statement(dst, src->deferred[i].str,
+                                            src->deferred[i].len))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool __dbc_absorb(dbc_t dst, dbc_t src) {
+    // Hand the arena over first, the adopted objects live in there.
+    const dbc_arena_t arena = src->arena;
+    __dbc_arena_absorb(dst->arena, arena);
+    src->arena = NULL;
+
+    const bool success = __dbc_absorb_objects(dst, src);
+
+    __dbc_strpool_release(src->strings);
+    __dbc_release_indices(src);
+    __dbc_file_unmap(&src->file_map);
+    if (src->lazy != NULL) {
+        __dbc_lazy_free(src->lazy);
+    }
+    return success;
 }
@@ -0,0 +1,221 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "__libdbc_arena.h"
+#include <stdint.h>
+#include <string.h>
+#include "__libdbc.h"
+
+#define ARENA_ALIGN (16U)
+#define ARENA_MIN_CHUNK_SIZE (16U * 1024U)
+#define ARENA_MAX_CHUNK_SIZE (1024U * 1024U)
+// Requests larger than this get a chunk of their own, so that they do not
+// waste the tail of the current chunk.
+#define ARENA_LARGE_ALLOC (ARENA_MAX_CHUNK_SIZE / 4U)
+
+struct dbc_arena_chunk {
+    struct dbc_arena_chunk* prev;
+    size_t size;
+    size_t used;
+    // Keeps data aligned to ARENA_ALIGN on every sane ABI.
+    long double align;
+    unsigned char data[];
+};
+
+struct dbc_arena {
+    struct dbc_arena_chunk* head;
+    size_t next_chunk_size;
+    // Statistics only, see __dbc_arena_get_stats. live counts the bytes asked
+    // for, less those abandoned by moves.
+    size_t num_allocs;
+    size_t live;
+};
+
+static inline size_t __dbc_arena_align_up(const size_t size) {
+    return (size + (ARENA_ALIGN - 1)) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static struct dbc_arena_chunk* __dbc_arena_chunk_new(const size_t size) {
+    struct dbc_arena_chunk* const chunk = (struct dbc_arena_chunk*)malloc(
+        sizeof(struct dbc_arena_chunk) + size);
+    if (unlikely(chunk == NULL)) {
+        return NULL;
+    }
+
+    chunk->prev = NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    return chunk;
+}
+
+dbc_arena_t __dbc_arena_new(void) {
+    const dbc_arena_t arena = (dbc_arena_t)malloc(sizeof(struct dbc_arena));
+    if (unlikely(arena == NULL)) {
+        return NULL;
+    }
+
+    arena->head = NULL;
+    arena->next_chunk_size = ARENA_MIN_CHUNK_SIZE;
+    arena->num_allocs = 0;
+    arena->live = 0;
+    return arena;
+}
+
+void __dbc_arena_free(dbc_arena_t arena) {
+    struct dbc_arena_chunk* chunk = arena->head;
+    while (chunk != NULL) {
+        struct dbc_arena_chunk* const prev = chunk->prev;
+        free(chunk);
+        chunk = prev;
+    }
+
+    free(arena);
+}
+
+void __dbc_arena_absorb(dbc_arena_t arena, dbc_arena_t other) {
+    struct dbc_arena_chunk* const head = other->head;
+    arena->num_allocs += other->num_allocs;
+    arena->live += other->live;
+    free(other);
+    if (head == NULL) {
+        return;
+    }
+    if (arena->head == NULL) {
+        arena->head = head;
+        return;
+    }
+
+    // Like dedicated chunks, the absorbed ones go behind the head, which
+    // keeps serving allocations.
+    struct dbc_arena_chunk* tail = head;
+    while (tail->prev != NULL) {
+        tail = tail->prev;
+    }
+    tail->prev = arena->head->prev;
+    arena->head->prev = head;
+}
+
+static void* __dbc_arena_alloc_slow(dbc_arena_t arena, const size_t size) {
+    if (size >= ARENA_LARGE_ALLOC) {
+        struct dbc_arena_chunk* const chunk = __dbc_arena_chunk_new(size);
+        if (unlikely(chunk == NULL)) {
+            return NULL;
+        }
+        chunk->used = size;
+
+        // Slide the dedicated chunk in behind the head, so the head keeps
+        // serving small allocations.
+        if (arena->head == NULL) {
+            arena->head = chunk;
+        } else {
+            chunk->prev = arena->head->prev;
+            arena->head->prev = chunk;
+        }
+        return chunk->data;
+    }
+
+    // Chunks grow geometrically, so large files need few of them while tiny
+    // files stay tiny.
+    size_t chunk_size = arena->next_chunk_size;
+    while (chunk_size < size) {
+        chunk_size *= 2;
+    }
+    if (arena->next_chunk_size < ARENA_MAX_CHUNK_SIZE) {
+        arena->next_chunk_size *= 2;
+    }
+
+    struct dbc_arena_chunk* const chunk = __dbc_arena_chunk_new(chunk_size);
+    if (unlikely(chunk == NULL)) {
+        return NULL;
+    }
+    chunk->prev = arena->head;
+    chunk->used = size;
+    arena->head = chunk;
+    return chunk->data;
+}
+
+void* __dbc_arena_alloc(dbc_arena_t arena, const size_t size) {
+    const size_t aligned = __dbc_arena_align_up(size == 0 ? 1 : size);
+    struct dbc_arena_chunk* const head = arena->head;
+    arena->num_allocs++;
+    arena->live += size;
+    if (likely(head != NULL && head->size - head->used >= aligned)) {
+        void* const ptr = head->data + head->used;
+        head->used += aligned;
+        return ptr;
+    }
+
+    return __dbc_arena_alloc_slow(arena, aligned);
+}
+
+void* __dbc_arena_calloc(dbc_arena_t arena, const size_t size) {
+    void* const ptr = __dbc_arena_alloc(arena, size);
+    if (likely(ptr != NULL)) {
+        memset(ptr, 0, size);
+    }
+    return ptr;
+}
+
+void* __dbc_arena_realloc(dbc_arena_t arena, void* ptr,
+                          const size_t old_size, const size_t new_size) {
+    if (new_size <= old_size) {
+        return ptr;
+    }
+
+    struct dbc_arena_chunk* const head = arena->head;
+    if (ptr != NULL && head != NULL) {
+        const size_t old_aligned = __dbc_arena_align_up(old_size);
+        const size_t new_aligned = __dbc_arena_align_up(new_size);
+        unsigned char* const last = head->data + head->used - old_aligned;
+        if ((unsigned char*)ptr == last
+            && head->size - head->used >= new_aligned - old_aligned) {
+            head->used += new_aligned - old_aligned;
+            arena->live += new_size - old_size;
+            return ptr;
+        }
+    }
+
+    void* const new_ptr = __dbc_arena_alloc(arena, new_size);
+    if (likely(new_ptr != NULL) && old_size != 0) {
+        memcpy(new_ptr, ptr, old_size);
+        arena->live -= old_size;
+    }
+    return new_ptr;
+}
+
+void __dbc_arena_get_stats(const dbc_arena_t arena, dbc_arena_stats_t* stats) {
+    stats->num_allocs = arena->num_allocs;
+    stats->num_chunks = 0;
+    stats->reserved = 0;
+    for (const struct dbc_arena_chunk* chunk = arena->head; chunk != NULL;
+         chunk = chunk->prev) {
+        stats->num_chunks++;
+        stats->reserved += sizeof(struct dbc_arena_chunk) + chunk->size;
+    }
+    stats->live = arena->live;
+}
+
+char* __dbc_arena_strndup(dbc_arena_t arena, const char* str,
+                          const size_t len) {
+    char* const copy = (char*)__dbc_arena_alloc(arena, len + 1);
+    if (likely(copy != NULL)) {
+        memcpy(copy, str, len);
+        copy[len] = 0;
+    }
+    return copy;
+}
@@ -0,0 +1,470 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libdbc_attribute.h"
+#include <string.h>
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_attribute.h"
+#include "__libdbc_strpool.h"
+
+#define ROWS_INITIAL_CAPACITY (16U)
+
+struct dbc_attr_def {
+    const char* name;
+    dbc_object_kind_t kind;
+    dbc_attr_type_t type;
+    double min;
+    double max;
+    const char** labels;
+    size_t num_labels;
+    size_t cap_labels;
+    bool has_default;
+    dbc_attr_value_t default_value;
+    dbc_arena_t arena;
+    dbc_strpool_t strings;
+    // One row per object the attribute is set for.
+    dbc_object_rows_t rows;
+    double* nums;
+    const char** strs;
+};
+
+static inline int __dbc_object_rows_cmp(const dbc_object_rows_t* rows,
+                                        const size_t row, const uint32_t obj,
+                                        const uint32_t sub) {
+    if (rows->objs[row] != obj) {
+        return rows->objs[row] < obj ? -1 : 1;
+    }
+    if (rows->subs[row] != sub) {
+        return rows->subs[row] < sub ? -1 : 1;
+    }
+    return 0;
+}
+
+/**
+ * @return The object's row, SIZE_MAX if there is none among the sorted ones.
+ */
+static size_t __dbc_object_rows_find(const dbc_object_rows_t* rows,
+                                     const uint32_t obj, const uint32_t sub) {
+    size_t lo = 0;
+    size_t hi = rows->num_sorted;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (__dbc_object_rows_cmp(rows, mid, obj, sub) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo < rows->num_sorted
+            && __dbc_object_rows_cmp(rows, lo, obj, sub) == 0
+        ? lo
+        : SIZE_MAX;
+}
+
+/**
+ * @brief Finds the object's row, adding one if there is none.
+ *
+ * Files written by tools list objects in order, so rows are appended in
+ * order and replaced in place. Once one comes out of order, the rest are
+ * appended to the unsorted tail, for __dbc_object_rows_sort.
+ *
+ * @param columns The table's other columns, grown along with the keys.
+ * @param sizes The size of an element of each of the columns.
+ * @return The row, SIZE_MAX if out of memory.
+ */
+static size_t __dbc_object_rows_add(dbc_object_rows_t* rows,
+                                    dbc_arena_t arena, const uint32_t obj,
+                                    const uint32_t sub, void** columns,
+                                    const size_t* sizes,
+                                    const size_t num_columns) {
+    const bool in_order = rows->num_sorted == rows->num_rows;
+    if (likely(in_order)) {
+        const size_t found = __dbc_object_rows_find(rows, obj, sub);
+        if (found != SIZE_MAX) {
+            return found;
+        }
+    }
+
+    if (unlikely(rows->num_rows == rows->cap_rows)) {
+        const size_t cap = rows->cap_rows;
+        const size_t new_cap = cap == 0 ? ROWS_INITIAL_CAPACITY : cap * 2;
+        uint32_t* const objs = (uint32_t*)__dbc_arena_realloc(
+            arena, rows->objs, cap * sizeof(uint32_t),
+            new_cap * sizeof(uint32_t));
+        if (unlikely(objs == NULL)) {
+            return SIZE_MAX;
+        }
+        rows->objs = objs;
+        uint32_t* const subs = (uint32_t*)__dbc_arena_realloc(
+            arena, rows->subs, cap * sizeof(uint32_t),
+            new_cap * sizeof(uint32_t));
+        if (unlikely(subs == NULL)) {
+            return SIZE_MAX;
+        }
+        rows->subs = subs;
+        for (size_t i = 0; i < num_columns; i++) {
+            void* const column = __dbc_arena_realloc(
+                arena, columns[i], cap * sizes[i], new_cap * sizes[i]);
+            if (unlikely(column == NULL)) {
+                return SIZE_MAX;
+            }
+            columns[i] = column;
+        }
+        rows->cap_rows = new_cap;
+    }
+
+    const size_t row = rows->num_rows;
+    if (likely(in_order)
+        && (row == 0 || __dbc_object_rows_cmp(rows, row - 1, obj, sub) < 0)) {
+        rows->num_sorted++;
+    }
+    rows->objs[row] = obj;
+    rows->subs[row] = sub;
+    rows->num_rows++;
+    return row;
+}
+
+typedef struct {
+    uint32_t obj;
+    uint32_t sub;
+    uint32_t row;
+} dbc_row_key_t;
+
+static int __dbc_row_key_cmp(const void* a, const void* b) {
+    const dbc_row_key_t* const x = (const dbc_row_key_t*)a;
+    const dbc_row_key_t* const y = (const dbc_row_key_t*)b;
+    if (x->obj != y->obj) {
+        return x->obj < y->obj ? -1 : 1;
+    }
+    if (x->sub != y->sub) {
+        return x->sub < y->sub ? -1 : 1;
+    }
+    return x->row < y->row ? -1 : 1;
+}
+
+/**
+ * @brief Rearranges the column such that its i-th element is the one of row
+ *        keys[i].row.
+ */
+static void __dbc_object_rows_gather(void* column, const size_t size,
+                                     const dbc_row_key_t* keys,
+                                     const size_t n, char* scratch) {
+    const char* const src = (const char*)column;
+    for (size_t i = 0; i < n; i++) {
+        memcpy(scratch + i * size, src + keys[i].row * size, size);
+    }
+    memcpy(column, scratch, n * size);
+}
+
+/**
+ * @brief Sorts the unsorted tail in, the later of rows for the same object
+ *        replacing the earlier.
+ * @return false if out of memory, in which case the tail is dropped.
+ */
+static bool __dbc_object_rows_sort(dbc_object_rows_t* rows, void** columns,
+                                   const size_t* sizes,
+                                   const size_t num_columns) {
+    if (likely(rows->num_sorted == rows->num_rows)) {
+        return true;
+    }
+
+    const size_t n = rows->num_rows;
+    size_t widest = sizeof(uint32_t);
+    for (size_t i = 0; i < num_columns; i++) {
+        widest = sizes[i] > widest ? sizes[i] : widest;
+    }
+    dbc_row_key_t* const keys =
+        (dbc_row_key_t*)malloc(n * sizeof(dbc_row_key_t));
+    char* const scratch = (char*)malloc(n * widest);
+    if (unlikely(keys == NULL || scratch == NULL)) {
+        free(keys);
+        free(scratch);
+        rows->num_rows = rows->num_sorted;
+        return false;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        keys[i].obj = rows->objs[i];
+        keys[i].sub = rows->subs[i];
+        keys[i].row = (uint32_t)i;
+    }
+    qsort(keys, n, sizeof(dbc_row_key_t), __dbc_row_key_cmp);
+
+    // Equal objects are ordered as added, the last of them is kept.
+    size_t m = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (i + 1 < n && keys[i + 1].obj == keys[i].obj
+            && keys[i + 1].sub == keys[i].sub) {
+            continue;
+        }
+        keys[m++] = keys[i];
+    }
+
+    __dbc_object_rows_gather(rows->objs, sizeof(uint32_t), keys, m, scratch);
+    __dbc_object_rows_gather(rows->subs, sizeof(uint32_t), keys, m, scratch);
+    for (size_t i = 0; i < num_columns; i++) {
+        __dbc_object_rows_gather(columns[i], sizes[i], keys, m, scratch);
+    }
+    rows->num_rows = m;
+    rows->num_sorted = m;
+
+    free(keys);
+    free(scratch);
+    return true;
+}
+
+bool __dbc_comment_table_set(dbc_comment_table_t* table, dbc_arena_t arena,
+                             const uint32_t obj, const uint32_t sub,
+                             const char* text, const size_t len) {
+    void* columns[] = { (void*)table->texts, table->lens };
+    const size_t sizes[] = { sizeof(const char*), sizeof(size_t) };
+    const size_t row =
+        __dbc_object_rows_add(&table->rows, arena, obj, sub, columns, sizes,
+                              sizeof(sizes) / sizeof(sizes[0]));
+    table->texts = (const char**)columns[0];
+    table->lens = (size_t*)columns[1];
+    if (unlikely(row == SIZE_MAX)) {
+        return false;
+    }
+
+    table->texts[row] = text;
+    table->lens[row] = len;
+    return true;
+}
+
+bool __dbc_comment_table_find(const dbc_comment_table_t* table,
+                              const uint32_t obj, const uint32_t sub,
+                              const char** text, size_t* len) {
+    const size_t row = __dbc_object_rows_find(&table->rows, obj, sub);
+    if (row == SIZE_MAX) {
+        return false;
+    }
+
+    *text = table->texts[row];
+    *len = table->lens[row];
+    return true;
+}
+
+bool __dbc_comment_table_sort(dbc_comment_table_t* table) {
+    void* columns[] = { (void*)table->texts, table->lens };
+    const size_t sizes[] = { sizeof(const char*), sizeof(size_t) };
+    return __dbc_object_rows_sort(&table->rows, columns, sizes,
+                                  sizeof(sizes) / sizeof(sizes[0]));
+}
+
+size_t __dbc_comment_decode(const char* text, const size_t len, char* buf,
+                            const size_t cap) {
+    size_t n = 0;
+    for (size_t i = 0; i < len; i++, n++) {
+        // A backslash escapes whatever follows it.
+        if (text[i] == '\\' && i + 1 < len) {
+            i++;
+        }
+        if (n + 1 < cap) {
+            buf[n] = text[i];
+        }
+    }
+
+    if (cap > 0) {
+        buf[n < cap ? n : cap - 1] = '\0';
+    }
+    return n;
+}
+
+dbc_attr_def_t __dbc_attr_def_new_in(dbc_arena_t arena, dbc_strpool_t strings,
+                                     const char* name, const size_t len,
+                                     const dbc_object_kind_t kind,
+                                     const dbc_attr_type_t type) {
+    const dbc_attr_def_t def = (dbc_attr_def_t)__dbc_arena_calloc(
+        arena, sizeof(struct dbc_attr_def));
+    if (unlikely(def == NULL)) {
+        return NULL;
+    }
+
+    def->name = __dbc_strpool_intern(strings, name, len);
+    if (unlikely(def->name == NULL)) {
+        return NULL;
+    }
+    def->kind = kind;
+    def->type = type;
+    def->arena = arena;
+    def->strings = strings;
+    return def;
+}
+
+void __dbc_attr_def_set_range(dbc_attr_def_t def, const double min,
+                              const double max) {
+    def->min = min;
+    def->max = max;
+}
+
+bool __dbc_attr_def_add_label_len(dbc_attr_def_t def, const char* label,
+                                  const size_t len) {
+    if (unlikely(!__dbc_vector_reserve(def->arena, (void***)&def->labels,
+                                       &def->cap_labels, def->num_labels))) {
+        return false;
+    }
+
+    const char* const interned = __dbc_strpool_intern(def->strings, label, len);
+    if (unlikely(interned == NULL)) {
+        return false;
+    }
+    def->labels[def->num_labels++] = interned;
+    return true;
+}
+
+size_t __dbc_attr_def_find_label_len(const dbc_attr_def_t def,
+                                     const char* label, const size_t len) {
+    for (size_t i = 0; i < def->num_labels; i++) {
+        if (strncmp(def->labels[i], label, len) == 0
+            && def->labels[i][len] == '\0') {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+const char* __dbc_attr_def_intern_len(dbc_attr_def_t def, const char* str,
+                                      const size_t len) {
+    return __dbc_strpool_intern(def->strings, str, len);
+}
+
+void __dbc_attr_def_set_default(dbc_attr_def_t def,
+                                const dbc_attr_value_t* value) {
+    def->default_value = *value;
+    def->has_default = true;
+}
+
+bool __dbc_attr_def_set_value(dbc_attr_def_t def, const uint32_t obj,
+                              const uint32_t sub,
+                              const dbc_attr_value_t* value) {
+    void* columns[] = { def->nums, (void*)def->strs };
+    const size_t sizes[] = { sizeof(double), sizeof(const char*) };
+    const size_t row =
+        __dbc_object_rows_add(&def->rows, def->arena, obj, sub, columns, sizes,
+                              sizeof(sizes) / sizeof(sizes[0]));
+    def->nums = (double*)columns[0];
+    def->strs = (const char**)columns[1];
+    if (unlikely(row == SIZE_MAX)) {
+        return false;
+    }
+
+    def->nums[row] = value->num;
+    def->strs[row] = value->str;
+    return true;
+}
+
+bool __dbc_attr_def_sort(dbc_attr_def_t def) {
+    void* columns[] = { def->nums, (void*)def->strs };
+    const size_t sizes[] = { sizeof(double), sizeof(const char*) };
+    return __dbc_object_rows_sort(&def->rows, columns, sizes,
+                                  sizeof(sizes) / sizeof(sizes[0]));
+}
+
+bool __dbc_attr_def_find_value(const dbc_attr_def_t def, const uint32_t obj,
+                               const uint32_t sub, dbc_attr_value_t* out) {
+    const size_t row = __dbc_object_rows_find(&def->rows, obj, sub);
+    if (row == SIZE_MAX) {
+        return dbc_attr_def_get_default(def, out);
+    }
+
+    out->num = def->nums[row];
+    out->str = def->strs[row];
+    return true;
+}
+
+size_t __dbc_comment_table_get_memory(const dbc_comment_table_t* table,
+                                      const bool texts) {
+    size_t bytes = table->rows.cap_rows
+                   * (2 * sizeof(uint32_t) + sizeof(const char*)
+                      + sizeof(size_t));
+    if (texts) {
+        for (size_t i = 0; i < table->rows.num_rows; i++) {
+            bytes += table->lens[i] + 1;
+        }
+    }
+    return bytes;
+}
+
+size_t __dbc_attr_def_get_memory(const dbc_attr_def_t def) {
+    return sizeof(struct dbc_attr_def) + def->cap_labels * sizeof(const char*)
+           + def->rows.cap_rows
+                 * (2 * sizeof(uint32_t) + sizeof(double)
+                    + sizeof(const char*));
+}
+
+const char* dbc_attr_def_get_name(const dbc_attr_def_t def) {
+    return def->name;
+}
+
+dbc_object_kind_t dbc_attr_def_get_object_kind(const dbc_attr_def_t def) {
+    return def->kind;
+}
+
+dbc_attr_type_t dbc_attr_def_get_type(const dbc_attr_def_t def) {
+    return def->type;
+}
+
+double dbc_attr_def_get_min(const dbc_attr_def_t def) {
+    return def->min;
+}
+
+double dbc_attr_def_get_max(const dbc_attr_def_t def) {
+    return def->max;
+}
+
+size_t dbc_attr_def_get_num_labels(const dbc_attr_def_t def) {
+    return def->num_labels;
+}
+
+const char* dbc_attr_def_get_label(const dbc_attr_def_t def,
+                                   const size_t idx) {
+    if (unlikely(idx >= def->num_labels)) {
+        return NULL;
+    }
+
+    return def->labels[idx];
+}
+
+bool dbc_attr_def_get_default(const dbc_attr_def_t def,
+                              dbc_attr_value_t* out) {
+    if (!def->has_default) {
+        return false;
+    }
+
+    *out = def->default_value;
+    return true;
+}
+
+size_t dbc_attr_def_get_num_values(const dbc_attr_def_t def) {
+    return def->rows.num_rows;
+}
+
+bool dbc_attr_def_get_value(const dbc_attr_def_t def, const size_t idx,
+                            size_t* obj, size_t* sub, dbc_attr_value_t* out) {
+    if (unlikely(idx >= def->rows.num_rows)) {
+        return false;
+    }
+
+    *obj = def->rows.objs[idx];
+    *sub = def->rows.subs[idx];
+    out->num = def->nums[idx];
+    out->str = def->strs[idx];
+    return true;
+}
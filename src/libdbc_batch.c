@@ -0,0 +1,190 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "__libdbc.h"
+#include "__libdbc_signal.h"
+
+#if defined(__SSE2__)
+#define LIBDBC_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+// AVX2 is picked at runtime, so that builds for generic x86 use it, too.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LIBDBC_HAVE_AVX2
+#include <immintrin.h>
+#endif
+
+// Frames are decoded this many at a time, so the raw words stay in L1.
+#define BATCH_CHUNK (256U)
+// The vector kernels convert integers to doubles by adding them into the
+// mantissa of this number, which only works while they fit in 51 bits.
+#define BATCH_MAGIC_BITS (0x4338000000000000ULL)
+#define BATCH_MAGIC (6755399441055744.0)
+#define BATCH_MAX_VECTOR_LENGTH (51U)
+
+/**
+ * @brief Loads the words a signal sits in, one per frame.
+ *
+ * Signals straddling nine bytes are fully shifted into place here, all others
+ * are left for the kernels to shift.
+ */
+static void __dbc_batch_load(const dbc_signal_codec_t* codec,
+                             const uint8_t* payloads, const size_t len,
+                             const size_t stride, const size_t n,
+                             uint64_t* words) {
+    const size_t off = codec->byte_offset;
+    const bool in_bounds = off + 8 + codec->spills <= len;
+
+    // Keep the byte order decision out of the loops, so each one is nothing
+    // but loads.
+    if (likely(in_bounds && !codec->spills)) {
+        if (codec->big_endian) {
+            for (size_t i = 0; i < n; i++) {
+                words[i] = __dbc_bytes_be64(payloads + i * stride + off);
+            }
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                words[i] = __dbc_bytes_le64(payloads + i * stride + off);
+            }
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        words[i] = __dbc_codec_extract(codec, payloads + i * stride, len);
+    }
+}
+
+/**
+ * @return How far the kernels have to shift the loaded words.
+ */
+static inline unsigned __dbc_batch_shift(const dbc_signal_codec_t* codec,
+                                         const size_t len) {
+    const bool in_bounds =
+        (size_t)codec->byte_offset + 8 + codec->spills <= len;
+    return in_bounds && !codec->spills ? codec->shift : 0;
+}
+
+static void __dbc_batch_convert_scalar(const dbc_signal_codec_t* codec,
+                                       const unsigned shift,
+                                       const uint64_t* words, const size_t n,
+                                       double* out) {
+    const uint64_t mask = codec->mask;
+    const uint64_t sign_bit = codec->sign_bit;
+    for (size_t i = 0; i < n; i++) {
+        const uint64_t raw = ((words[i] >> shift & mask) ^ sign_bit) - sign_bit;
+        out[i] = __dbc_codec_to_physical(codec, raw);
+    }
+}
+
+#ifdef LIBDBC_HAVE_SSE2
+static size_t __dbc_batch_convert_sse2(const dbc_signal_codec_t* codec,
+                                       const unsigned shift,
+                                       const uint64_t* words, const size_t n,
+                                       double* out) {
+    const __m128i count = _mm_cvtsi32_si128((int)shift);
+    const __m128i mask = _mm_set1_epi64x((long long)codec->mask);
+    const __m128i sign_bit = _mm_set1_epi64x((long long)codec->sign_bit);
+    const __m128i magic_bits = _mm_set1_epi64x((long long)BATCH_MAGIC_BITS);
+    const __m128d magic = _mm_set1_pd(BATCH_MAGIC);
+    const __m128d factor = _mm_set1_pd(codec->factor);
+    const __m128d offset = _mm_set1_pd(codec->offset);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        __m128i raw = _mm_loadu_si128((const __m128i*)(words + i));
+        raw = _mm_and_si128(_mm_srl_epi64(raw, count), mask);
+        raw = _mm_sub_epi64(_mm_xor_si128(raw, sign_bit), sign_bit);
+        const __m128d value = _mm_sub_pd(
+            _mm_castsi128_pd(_mm_add_epi64(raw, magic_bits)), magic);
+        _mm_storeu_pd(out + i, _mm_add_pd(_mm_mul_pd(value, factor), offset));
+    }
+
+    return i;
+}
+#endif
+
+#ifdef LIBDBC_HAVE_AVX2
+__attribute__((target("avx2")))
+static size_t __dbc_batch_convert_avx2(const dbc_signal_codec_t* codec,
+                                       const unsigned shift,
+                                       const uint64_t* words, const size_t n,
+                                       double* out) {
+    const __m128i count = _mm_cvtsi32_si128((int)shift);
+    const __m256i mask = _mm256_set1_epi64x((long long)codec->mask);
+    const __m256i sign_bit = _mm256_set1_epi64x((long long)codec->sign_bit);
+    const __m256i magic_bits =
+        _mm256_set1_epi64x((long long)BATCH_MAGIC_BITS);
+    const __m256d magic = _mm256_set1_pd(BATCH_MAGIC);
+    const __m256d factor = _mm256_set1_pd(codec->factor);
+    const __m256d offset = _mm256_set1_pd(codec->offset);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i raw = _mm256_loadu_si256((const __m256i*)(words + i));
+        raw = _mm256_and_si256(_mm256_srl_epi64(raw, count), mask);
+        raw = _mm256_sub_epi64(_mm256_xor_si256(raw, sign_bit), sign_bit);
+        const __m256d value = _mm256_sub_pd(
+            _mm256_castsi256_pd(_mm256_add_epi64(raw, magic_bits)), magic);
+        _mm256_storeu_pd(out + i,
+                         _mm256_add_pd(_mm256_mul_pd(value, factor), offset));
+    }
+
+    return i;
+}
+#endif
+
+/**
+ * @brief Converts a chunk of loaded words with the widest kernel available.
+ */
+static void __dbc_batch_convert(const dbc_signal_codec_t* codec,
+                                const unsigned shift, const uint64_t* words,
+                                const size_t n, double* out) {
+    size_t done = 0;
+    if (codec->length <= BATCH_MAX_VECTOR_LENGTH) {
+#ifdef LIBDBC_HAVE_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+            done = __dbc_batch_convert_avx2(codec, shift, words, n, out);
+        }
+#endif
+#ifdef LIBDBC_HAVE_SSE2
+        done += __dbc_batch_convert_sse2(codec, shift, words + done, n - done,
+                                         out + done);
+#endif
+    }
+
+    __dbc_batch_convert_scalar(codec, shift, words + done, n - done,
+                               out + done);
+}
+
+void __dbc_codec_decode_batch(const dbc_signal_codec_t* codec,
+                              const uint8_t* payloads, const size_t len,
+                              const size_t stride, const size_t n,
+                              double* out) {
+    uint64_t words[BATCH_CHUNK];
+    const unsigned shift = __dbc_batch_shift(codec, len);
+    for (size_t i = 0; i < n; i += BATCH_CHUNK) {
+        const size_t chunk = n - i < BATCH_CHUNK ? n - i : BATCH_CHUNK;
+        __dbc_batch_load(codec, payloads + i * stride, len, stride, chunk,
+                         words);
+        __dbc_batch_convert(codec, shift, words, chunk, out + i);
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define LIBDBC_HAVE_MMAP
+#endif
+
+#include "__libdbc.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef LIBDBC_HAVE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// An empty file cannot be mapped, but it is still a perfectly valid (if
+// useless) DBC, so hand out a zero-length view of this instead.
+static const char EMPTY_FILE[1] = "";
+
+#ifdef LIBDBC_HAVE_MMAP
+bool __dbc_file_map(const char* path, dbc_file_map_t* map) {
+    const int fd = open(path, O_RDONLY);
+    if (unlikely(fd < 0)) {
+        return false;
+    }
+
+    struct stat st;
+    if (unlikely(fstat(fd, &st) != 0)) {
+        close(fd);
+        return false;
+    }
+
+    map->len = (size_t)st.st_size;
+    map->mapped = map->len != 0;
+    if (!map->mapped) {
+        map->data = EMPTY_FILE;
+        close(fd);
+        return true;
+    }
+
+    void* const data = mmap(NULL, map->len, PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping holds its own reference to the file.
+    close(fd);
+    if (unlikely(data == MAP_FAILED)) {
+        return false;
+    }
+
+#ifdef POSIX_MADV_SEQUENTIAL
+    posix_madvise(data, map->len, POSIX_MADV_SEQUENTIAL);
+#endif
+
+    map->data = (const char*)data;
+    return true;
+}
+
+void __dbc_file_unmap(dbc_file_map_t* map) {
+    if (map->mapped) {
+        munmap((void*)map->data, map->len);
+    }
+    map->data = NULL;
+    map->len = 0;
+    map->mapped = false;
+}
+#else
+bool __dbc_file_map(const char* path, dbc_file_map_t* map) {
+    FILE* const f = fopen(path, "rb");
+    if (unlikely(f == NULL)) {
+        return false;
+    }
+
+    if (fseek(f, 0, SEEK_END) != 0) {
+        fclose(f);
+        return false;
+    }
+    const long size = ftell(f);
+    if (unlikely(size < 0 || fseek(f, 0, SEEK_SET) != 0)) {
+        fclose(f);
+        return false;
+    }
+
+    map->len = (size_t)size;
+    map->mapped = map->len != 0;
+    if (!map->mapped) {
+        map->data = EMPTY_FILE;
+        fclose(f);
+        return true;
+    }
+
+    char* const data = (char*)malloc(map->len);
+    if (unlikely(data == NULL || fread(data, 1, map->len, f) != map->len)) {
+        free(data);
+        fclose(f);
+        return false;
+    }
+
+    fclose(f);
+    map->data = data;
+    return true;
+}
+
+void __dbc_file_unmap(dbc_file_map_t* map) {
+    if (map->mapped) {
+        free((void*)map->data);
+    }
+    map->data = NULL;
+    map->len = 0;
+    map->mapped = false;
+}
+#endif
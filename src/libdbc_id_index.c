@@ -0,0 +1,116 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "__libdbc_id_index.h"
+#include <string.h>
+
+#define ID_INDEX_INITIAL_CAPACITY (16U)
+
+static dbc_id_index_slot_t* __dbc_id_table_probe(dbc_id_index_slot_t* slots,
+                                                 const size_t cap,
+                                                 const uint32_t id) {
+    const size_t mask = cap - 1;
+    for (size_t i = __dbc_id_hash(id) & mask;; i = (i + 1) & mask) {
+        if (slots[i].msg == NULL || slots[i].id == id) {
+            return &slots[i];
+        }
+    }
+}
+
+static bool __dbc_id_table_insert(dbc_id_index_table_t* table,
+                                  const uint32_t id, const dbc_message_t msg) {
+    // Keep the load factor under 1/2, so probe sequences stay short.
+    if (unlikely((table->size + 1) * 2 > table->cap)) {
+        const size_t new_cap =
+            table->cap == 0 ? ID_INDEX_INITIAL_CAPACITY : table->cap * 2;
+        dbc_id_index_slot_t* const new_slots = (dbc_id_index_slot_t*)calloc(
+            new_cap, sizeof(dbc_id_index_slot_t));
+        if (unlikely(new_slots == NULL)) {
+            return false;
+        }
+
+        for (size_t i = 0; i < table->cap; i++) {
+            if (table->slots[i].msg != NULL) {
+                *__dbc_id_table_probe(new_slots, new_cap,
+                                      table->slots[i].id) = table->slots[i];
+            }
+        }
+
+        free(table->slots);
+        table->slots = new_slots;
+        table->cap = new_cap;
+    }
+
+    dbc_id_index_slot_t* const slot =
+        __dbc_id_table_probe(table->slots, table->cap, id);
+    if (slot->msg == NULL) {
+        slot->id = id;
+        slot->msg = msg;
+        table->size++;
+    }
+    return true;
+}
+
+bool __dbc_id_index_insert(dbc_id_index_t* index, dbc_arena_t arena,
+                           const dbc_message_t msg) {
+    const uint32_t id = dbc_message_get_id(msg);
+    if (id < ID_INDEX_STANDARD_IDS) {
+        if (unlikely(index->standard == NULL)) {
+            index->standard = (dbc_message_t*)__dbc_arena_calloc(
+                arena, ID_INDEX_STANDARD_IDS * sizeof(dbc_message_t));
+            if (unlikely(index->standard == NULL)) {
+                return false;
+            }
+        }
+
+        if (index->standard[id] == NULL) {
+            index->standard[id] = msg;
+        }
+        return true;
+    }
+
+    if (unlikely(!__dbc_id_table_insert(&index->extended, id, msg))) {
+        return false;
+    }
+    if ((id & DBC_MESSAGE_ID_EXTENDED) != 0) {
+        return __dbc_id_table_insert(&index->pgn, __dbc_j1939_pgn(id), msg);
+    }
+    return true;
+}
+
+void __dbc_id_index_release(dbc_id_index_t* index) {
+    free(index->extended.slots);
+    free(index->pgn.slots);
+    memset(&index->extended, 0, sizeof(index->extended));
+    memset(&index->pgn, 0, sizeof(index->pgn));
+}
+
+size_t __dbc_id_index_get_memory(const dbc_id_index_t* index,
+                                 size_t* num_entries, size_t* heap_bytes) {
+    *num_entries = index->extended.size + index->pgn.size;
+    *heap_bytes = (index->extended.cap + index->pgn.cap)
+                  * sizeof(dbc_id_index_slot_t);
+    size_t bytes = *heap_bytes;
+    if (index->standard != NULL) {
+        bytes += ID_INDEX_STANDARD_IDS * sizeof(dbc_message_t);
+        for (size_t i = 0; i < ID_INDEX_STANDARD_IDS; i++) {
+            *num_entries += index->standard[i] != NULL;
+        }
+    }
+    return bytes;
+}
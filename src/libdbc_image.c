@@ -0,0 +1,1025 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libdbc_compiled.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "__libdbc.h"
+#include "__libdbc_attribute.h"
+#include "__libdbc_signal.h"
+#include "__libdbc_strpool.h"
+
+/*
+ * A compiled image is a header followed by sections of fixed-size records.
+ * Everything is little endian, and objects refer to each other, and to
+ * strings, by index, never by address.
+ *
+ * header     see IMAGE_HEADER_SIZE and the IMAGE_SECTION_* indices
+ * strings    u32 offset into string data, u32 length
+ * data       the strings, each followed by a NUL
+ * nodes      u32 name
+ * tables     u32 name, u32 first entry, u32 entries, u32 flags
+ * entries    f64 value, u32 description, u32 padding
+ * messages   u32 id, u32 size, u32 name, u32 transmitter,
+ *            u32 first signal, u32 signals
+ * signals    u32 name, u32 unit, u16 start bit, u16 length, u8 byte order,
+ *            u8 signedness, u8 mux flags, u8 padding, f64 factor,
+ *            f64 offset, f64 min, f64 max, u32 first receiver,
+ *            u32 receivers, u32 multiplexor, u32 first mux range,
+ *            u32 mux ranges, u32 padding
+ * receivers  u32 name
+ * ranges     u64 min, u64 max
+ * attr defs  u32 name, u8 object kind, u8 type, u8 has default, u8 padding,
+ *            f64 min, f64 max, f64 default number, u32 default string,
+ *            u32 first label, u32 labels, u32 first value, u32 values,
+ *            u32 padding
+ * labels     u32 name
+ * values     u32 object, u32 signal, f64 number, u32 string, u32 padding
+ * comments   u8 object kind, u8 padding[3], u32 object, u32 signal,
+ *            u32 undecoded text
+ *
+ * A signal's multiplexor is the index of another signal of its message,
+ * IMAGE_NO_MULTIPLEXOR for the message's switch. Attribute values without a
+ * string, numbers that is, have IMAGE_NO_STRING for theirs.
+ */
+
+static const char IMAGE_MAGIC[8] = { 'l', 'i', 'b', 'd', 'b', 'c', 0x1A, '\n' };
+
+enum {
+    IMAGE_SECTION_STRINGS,
+    IMAGE_SECTION_DATA,
+    IMAGE_SECTION_NODES,
+    IMAGE_SECTION_TABLES,
+    IMAGE_SECTION_ENTRIES,
+    IMAGE_SECTION_MESSAGES,
+    IMAGE_SECTION_SIGNALS,
+    IMAGE_SECTION_RECEIVERS,
+    IMAGE_SECTION_RANGES,
+    IMAGE_SECTION_ATTR_DEFS,
+    IMAGE_SECTION_LABELS,
+    IMAGE_SECTION_VALUES,
+    IMAGE_SECTION_COMMENTS,
+    IMAGE_NUM_SECTIONS
+};
+
+static const size_t IMAGE_RECORD_SIZES[IMAGE_NUM_SECTIONS] = {
+    8, 1, 4, 16, 16, 24, 72, 4, 16, 56, 4, 24, 16
+};
+
+// magic, u32 format version, u32 header size, u64 file size, u32 checksum,
+// u32 version string, then a u64 offset and u64 count per section.
+#define IMAGE_SECTIONS_OFFSET (32U)
+#define IMAGE_HEADER_SIZE (IMAGE_SECTIONS_OFFSET + IMAGE_NUM_SECTIONS * 16U)
+#define IMAGE_TABLE_FROZEN (1U)
+#define IMAGE_SIGNAL_MULTIPLEXOR (1U)
+#define IMAGE_SIGNAL_MULTIPLEXED (2U)
+#define IMAGE_NO_MULTIPLEXOR UINT32_MAX
+#define IMAGE_NO_STRING UINT32_MAX
+#define IMAGE_INITIAL_CAPACITY (4096U)
+
+static uint32_t __dbc_image_checksum(const uint8_t* data, const size_t len) {
+    uint32_t hash = FNV1A_OFFSET_BASIS;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= data[i];
+        hash *= FNV1A_PRIME;
+    }
+    return hash;
+}
+
+/* Writing */
+
+typedef struct {
+    uint8_t* data;
+    size_t len;
+    size_t cap;
+    bool failed;
+} dbc_image_buf_t;
+
+static uint8_t* __dbc_image_buf_grow(dbc_image_buf_t* buf, const size_t len) {
+    if (unlikely(buf->failed)) {
+        return NULL;
+    }
+
+    if (buf->len + len > buf->cap) {
+        size_t new_cap = buf->cap == 0 ? IMAGE_INITIAL_CAPACITY : buf->cap;
+        while (new_cap < buf->len + len) {
+            new_cap *= 2;
+        }
+        uint8_t* const new_data = (uint8_t*)realloc(buf->data, new_cap);
+        if (unlikely(new_data == NULL)) {
+            buf->failed = true;
+            return NULL;
+        }
+        buf->data = new_data;
+        buf->cap = new_cap;
+    }
+
+    uint8_t* const out = buf->data + buf->len;
+    buf->len += len;
+    return out;
+}
+
+static void __dbc_image_put(dbc_image_buf_t* buf, const uint64_t val,
+                            const size_t width) {
+    uint8_t* const out = __dbc_image_buf_grow(buf, width);
+    if (likely(out != NULL)) {
+        for (size_t i = 0; i < width; i++) {
+            out[i] = (uint8_t)(val >> (8 * i));
+        }
+    }
+}
+
+static void __dbc_image_put_f64(dbc_image_buf_t* buf, const double val) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    __dbc_image_put(buf, bits, 8);
+}
+
+/**
+ * @brief Numbers the strings of a DBC as they are written.
+ *
+ * Strings are deduplicated by address, which is as good as by content, as the
+ * DBC interns them.
+ */
+typedef struct {
+    const char** ptrs;
+    uint32_t* ids;
+    size_t cap;
+    dbc_image_buf_t strings;
+    dbc_image_buf_t data;
+    uint32_t num_strings;
+} dbc_image_strings_t;
+
+static inline size_t __dbc_image_ptr_hash(const char* ptr) {
+    uint64_t x = (uint64_t)(uintptr_t)ptr;
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    return (size_t)x;
+}
+
+static bool __dbc_image_strings_grow(dbc_image_strings_t* st) {
+    const size_t new_cap = st->cap == 0 ? IMAGE_INITIAL_CAPACITY : st->cap * 2;
+    const char** const ptrs = (const char**)calloc(new_cap, sizeof(char*));
+    uint32_t* const ids = (uint32_t*)calloc(new_cap, sizeof(uint32_t));
+    if (unlikely(ptrs == NULL || ids == NULL)) {
+        free(ptrs);
+        free(ids);
+        return false;
+    }
+
+    for (size_t i = 0; i < st->cap; i++) {
+        if (st->ptrs[i] == NULL) {
+            continue;
+        }
+        size_t j = __dbc_image_ptr_hash(st->ptrs[i]) & (new_cap - 1);
+        while (ptrs[j] != NULL) {
+            j = (j + 1) & (new_cap - 1);
+        }
+        ptrs[j] = st->ptrs[i];
+        ids[j] = st->ids[i];
+    }
+
+    free(st->ptrs);
+    free(st->ids);
+    st->ptrs = ptrs;
+    st->ids = ids;
+    st->cap = new_cap;
+    return true;
+}
+
+/**
+ * @brief Appends a string to the image, whether or not it is in already.
+ * @param str len bytes, which need not be NUL-terminated.
+ * @return Its index.
+ */
+static uint32_t __dbc_image_put_string(dbc_image_strings_t* st,
+                                       const char* str, const size_t len) {
+    __dbc_image_put(&st->strings, st->data.len, 4);
+    __dbc_image_put(&st->strings, len, 4);
+    uint8_t* const out = __dbc_image_buf_grow(&st->data, len + 1);
+    if (likely(out != NULL)) {
+        memcpy(out, str, len);
+        out[len] = '\0';
+    }
+    return st->num_strings++;
+}
+
+static uint32_t __dbc_image_string_id(dbc_image_strings_t* st,
+                                      const char* str) {
+    if (unlikely((st->num_strings + 1) * 2 > st->cap)
+        && unlikely(!__dbc_image_strings_grow(st))) {
+        st->strings.failed = true;
+        return 0;
+    }
+
+    size_t i = __dbc_image_ptr_hash(str) & (st->cap - 1);
+    for (; st->ptrs[i] != NULL; i = (i + 1) & (st->cap - 1)) {
+        if (st->ptrs[i] == str) {
+            return st->ids[i];
+        }
+    }
+
+    st->ptrs[i] = str;
+    st->ids[i] = st->num_strings;
+    return __dbc_image_put_string(st, str, strlen(str));
+}
+
+typedef struct {
+    dbc_image_buf_t* entries;
+    dbc_image_strings_t* strings;
+    uint32_t count;
+} dbc_image_entries_ctx_t;
+
+static void __dbc_image_put_entry(void* ctx, const double num,
+                                  const char* desc) {
+    dbc_image_entries_ctx_t* const ec = (dbc_image_entries_ctx_t*)ctx;
+    __dbc_image_put_f64(ec->entries, num);
+    __dbc_image_put(ec->entries, __dbc_image_string_id(ec->strings, desc), 4);
+    __dbc_image_put(ec->entries, 0, 4);
+    ec->count++;
+}
+
+/**
+ * @return The index of the signal's multiplexor among the message's signals,
+ *         IMAGE_NO_MULTIPLEXOR if it has none of its own.
+ */
+static uint32_t __dbc_image_multiplexor(const dbc_message_t msg,
+                                        const dbc_signal_t sig) {
+    const dbc_signal_t mux = dbc_signal_get_multiplexor(sig);
+    for (size_t i = 0; mux != NULL && i < dbc_message_get_num_signals(msg);
+         i++) {
+        if (dbc_message_get_signal(msg, i) == mux) {
+            return (uint32_t)i;
+        }
+    }
+    return IMAGE_NO_MULTIPLEXOR;
+}
+
+static void __dbc_image_put_signal(dbc_image_buf_t* buf,
+                                   dbc_image_strings_t* strings,
+                                   dbc_image_buf_t* receivers,
+                                   dbc_image_buf_t* ranges,
+                                   const dbc_message_t msg,
+                                   const dbc_signal_t sig) {
+    __dbc_image_put(buf, __dbc_image_string_id(strings,
+                                               dbc_signal_get_name(sig)), 4);
+    __dbc_image_put(buf, __dbc_image_string_id(strings,
+                                               dbc_signal_get_unit(sig)), 4);
+    __dbc_image_put(buf, dbc_signal_get_start_bit(sig), 2);
+    __dbc_image_put(buf, dbc_signal_get_length(sig), 2);
+    __dbc_image_put(buf, dbc_signal_get_byte_order(sig), 1);
+    __dbc_image_put(buf, dbc_signal_is_signed(sig), 1);
+    __dbc_image_put(buf,
+                    (dbc_signal_is_multiplexor(sig) ? IMAGE_SIGNAL_MULTIPLEXOR
+                                                    : 0)
+                        | (dbc_signal_is_multiplexed(sig)
+                               ? IMAGE_SIGNAL_MULTIPLEXED
+                               : 0),
+                    1);
+    __dbc_image_put(buf, 0, 1);
+    __dbc_image_put_f64(buf, dbc_signal_get_factor(sig));
+    __dbc_image_put_f64(buf, dbc_signal_get_offset(sig));
+    __dbc_image_put_f64(buf, dbc_signal_get_min(sig));
+    __dbc_image_put_f64(buf, dbc_signal_get_max(sig));
+
+    const size_t num_receivers = dbc_signal_get_num_receivers(sig);
+    __dbc_image_put(buf, receivers->len / 4, 4);
+    __dbc_image_put(buf, num_receivers, 4);
+    for (size_t i = 0; i < num_receivers; i++) {
+        __dbc_image_put(receivers,
+                        __dbc_image_string_id(
+                            strings, dbc_signal_get_receiver(sig, i)), 4);
+    }
+
+    const size_t num_ranges = dbc_signal_get_num_mux_ranges(sig);
+    __dbc_image_put(buf, __dbc_image_multiplexor(msg, sig), 4);
+    __dbc_image_put(buf, ranges->len / 16, 4);
+    __dbc_image_put(buf, num_ranges, 4);
+    __dbc_image_put(buf, 0, 4);
+    for (size_t i = 0; i < num_ranges; i++) {
+        const dbc_mux_range_t range = dbc_signal_get_mux_range(sig, i);
+        __dbc_image_put(ranges, range.min, 8);
+        __dbc_image_put(ranges, range.max, 8);
+    }
+}
+
+static void __dbc_image_put_attr_value(dbc_image_buf_t* buf,
+                                       dbc_image_strings_t* strings,
+                                       const dbc_attr_value_t* value) {
+    __dbc_image_put_f64(buf, value->num);
+    __dbc_image_put(buf,
+                    value->str == NULL
+                        ? IMAGE_NO_STRING
+                        : __dbc_image_string_id(strings, value->str),
+                    4);
+}
+
+static void __dbc_image_put_attr_def(dbc_image_buf_t* buf,
+                                     dbc_image_strings_t* strings,
+                                     dbc_image_buf_t* labels,
+                                     dbc_image_buf_t* values,
+                                     const dbc_attr_def_t def) {
+    dbc_attr_value_t value = { 0, NULL };
+    const bool has_default = dbc_attr_def_get_default(def, &value);
+    __dbc_image_put(buf, __dbc_image_string_id(strings,
+                                               dbc_attr_def_get_name(def)), 4);
+    __dbc_image_put(buf, dbc_attr_def_get_object_kind(def), 1);
+    __dbc_image_put(buf, dbc_attr_def_get_type(def), 1);
+    __dbc_image_put(buf, has_default, 1);
+    __dbc_image_put(buf, 0, 1);
+    __dbc_image_put_f64(buf, dbc_attr_def_get_min(def));
+    __dbc_image_put_f64(buf, dbc_attr_def_get_max(def));
+    __dbc_image_put_attr_value(buf, strings, &value);
+
+    const size_t num_labels = dbc_attr_def_get_num_labels(def);
+    __dbc_image_put(buf, labels->len / 4, 4);
+    __dbc_image_put(buf, num_labels, 4);
+    for (size_t i = 0; i < num_labels; i++) {
+        __dbc_image_put(labels,
+                        __dbc_image_string_id(strings,
+                                              dbc_attr_def_get_label(def, i)),
+                        4);
+    }
+
+    const size_t num_values = dbc_attr_def_get_num_values(def);
+    __dbc_image_put(buf,
+                    values->len / IMAGE_RECORD_SIZES[IMAGE_SECTION_VALUES], 4);
+    __dbc_image_put(buf, num_values, 4);
+    __dbc_image_put(buf, 0, 4);
+    for (size_t i = 0; i < num_values; i++) {
+        size_t obj;
+        size_t sub;
+        dbc_attr_def_get_value(def, i, &obj, &sub, &value);
+        __dbc_image_put(values, obj, 4);
+        __dbc_image_put(values, sub, 4);
+        __dbc_image_put_attr_value(values, strings, &value);
+        __dbc_image_put(values, 0, 4);
+    }
+}
+
+static bool __dbc_image_write(const char* path,
+                              dbc_image_buf_t sections[IMAGE_NUM_SECTIONS],
+                              const uint32_t version_id) {
+    // Lay the sections out back to back, each 8-byte aligned.
+    uint64_t offsets[IMAGE_NUM_SECTIONS];
+    uint64_t size = IMAGE_HEADER_SIZE;
+    for (size_t i = 0; i < IMAGE_NUM_SECTIONS; i++) {
+        offsets[i] = size;
+        size = (size + sections[i].len + 7) & ~(uint64_t)7;
+    }
+
+    dbc_image_buf_t image = { NULL, 0, 0, false };
+    uint8_t* const magic = __dbc_image_buf_grow(&image, sizeof(IMAGE_MAGIC));
+    if (unlikely(magic == NULL)) {
+        return false;
+    }
+    memcpy(magic, IMAGE_MAGIC, sizeof(IMAGE_MAGIC));
+    __dbc_image_put(&image, DBC_COMPILED_FORMAT_VERSION, 4);
+    __dbc_image_put(&image, IMAGE_HEADER_SIZE, 4);
+    __dbc_image_put(&image, size, 8);
+    __dbc_image_put(&image, 0, 4); // The checksum, filled in below.
+    __dbc_image_put(&image, version_id, 4);
+    for (size_t i = 0; i < IMAGE_NUM_SECTIONS; i++) {
+        __dbc_image_put(&image, offsets[i], 8);
+        __dbc_image_put(&image, sections[i].len / IMAGE_RECORD_SIZES[i], 8);
+    }
+    for (size_t i = 0; i < IMAGE_NUM_SECTIONS; i++) {
+        uint8_t* const out = __dbc_image_buf_grow(
+            &image, (size_t)(offsets[i] - image.len) + sections[i].len);
+        if (likely(out != NULL)) {
+            memset(out, 0, (size_t)(offsets[i] - (uint64_t)(out - image.data)));
+            if (sections[i].len > 0) {
+                memcpy(image.data + offsets[i], sections[i].data,
+                       sections[i].len);
+            }
+        }
+    }
+    uint8_t* const tail =
+        __dbc_image_buf_grow(&image, (size_t)(size - image.len));
+    if (unlikely(image.failed)) {
+        free(image.data);
+        return false;
+    }
+    memset(tail, 0, (size_t)(image.data + image.len - tail));
+
+    const uint32_t checksum = __dbc_image_checksum(
+        image.data + IMAGE_HEADER_SIZE, image.len - IMAGE_HEADER_SIZE);
+    for (size_t i = 0; i < 4; i++) {
+        image.data[24 + i] = (uint8_t)(checksum >> (8 * i));
+    }
+
+    // Write next to the target and move it into place once complete.
+    const size_t path_len = strlen(path);
+    char* const tmp_path = (char*)malloc(path_len + sizeof(".tmp"));
+    if (unlikely(tmp_path == NULL)) {
+        free(image.data);
+        return false;
+    }
+    memcpy(tmp_path, path, path_len);
+    memcpy(tmp_path + path_len, ".tmp", sizeof(".tmp"));
+
+    FILE* const f = fopen(tmp_path, "wb");
+    bool success = f != NULL;
+    if (likely(success)) {
+        success = fwrite(image.data, 1, image.len, f) == image.len;
+        success &= fclose(f) == 0;
+    }
+    if (likely(success)) {
+        success = rename(tmp_path, path) == 0;
+    }
+    if (unlikely(!success)) {
+        remove(tmp_path);
+    }
+
+    free(tmp_path);
+    free(image.data);
+    return success;
+}
+
+bool dbc_save_compiled(const dbc_t dbc, const char* path) {
+    dbc_image_buf_t sections[IMAGE_NUM_SECTIONS];
+    memset(sections, 0, sizeof(sections));
+    dbc_image_strings_t strings;
+    memset(&strings, 0, sizeof(strings));
+
+    const uint32_t version_id =
+        __dbc_image_string_id(&strings, dbc_get_version(dbc));
+
+    for (size_t i = 0; i < dbc_get_num_nodes(dbc); i++) {
+        const char* const name = dbc_node_get_name(dbc_get_node(dbc, i));
+        __dbc_image_put(&sections[IMAGE_SECTION_NODES],
+                        __dbc_image_string_id(&strings, name), 4);
+    }
+
+    for (size_t i = 0; i < dbc_get_num_value_tables(dbc); i++) {
+        const dbc_value_table_t vt = __dbc_get_value_table_at(dbc, i);
+        dbc_image_buf_t* const tables = &sections[IMAGE_SECTION_TABLES];
+        dbc_image_entries_ctx_t ctx = {
+            &sections[IMAGE_SECTION_ENTRIES], &strings, 0
+        };
+        const size_t first = ctx.entries->len / 16;
+        __dbc_value_table_visit(vt, __dbc_image_put_entry, &ctx);
+
+        __dbc_image_put(tables, __dbc_image_string_id(
+                                    &strings, dbc_value_table_get_name(vt)),
+                        4);
+        __dbc_image_put(tables, first, 4);
+        __dbc_image_put(tables, ctx.count, 4);
+        __dbc_image_put(tables,
+                        __dbc_value_table_is_frozen(vt) ? IMAGE_TABLE_FROZEN
+                                                        : 0,
+                        4);
+    }
+
+    for (size_t i = 0; i < dbc_get_num_messages(dbc); i++) {
+        const dbc_message_t msg = dbc_get_message(dbc, i);
+        dbc_image_buf_t* const messages = &sections[IMAGE_SECTION_MESSAGES];
+        dbc_image_buf_t* const signals = &sections[IMAGE_SECTION_SIGNALS];
+        const size_t num_signals = dbc_message_get_num_signals(msg);
+
+        __dbc_image_put(messages, dbc_message_get_id(msg), 4);
+        __dbc_image_put(messages, dbc_message_get_size(msg), 4);
+        __dbc_image_put(messages,
+                        __dbc_image_string_id(&strings,
+                                              dbc_message_get_name(msg)),
+                        4);
+        __dbc_image_put(messages,
+                        __dbc_image_string_id(
+                            &strings, dbc_message_get_transmitter(msg)),
+                        4);
+        __dbc_image_put(messages,
+                        signals->len / IMAGE_RECORD_SIZES[IMAGE_SECTION_SIGNALS],
+                        4);
+        __dbc_image_put(messages, num_signals, 4);
+        for (size_t j = 0; j < num_signals; j++) {
+            __dbc_image_put_signal(signals, &strings,
+                                   &sections[IMAGE_SECTION_RECEIVERS],
+                                   &sections[IMAGE_SECTION_RANGES], msg,
+                                   dbc_message_get_signal(msg, j));
+        }
+    }
+
+    for (size_t i = 0; i < dbc_get_num_attr_defs(dbc); i++) {
+        __dbc_image_put_attr_def(&sections[IMAGE_SECTION_ATTR_DEFS], &strings,
+                                 &sections[IMAGE_SECTION_LABELS],
+                                 &sections[IMAGE_SECTION_VALUES],
+                                 dbc_get_attr_def(dbc, i));
+    }
+
+    // Comments are written as they are in the file, escapes and all.
+    for (size_t kind = 0; kind < DBC_NUM_OBJECT_KINDS; kind++) {
+        dbc_image_buf_t* const comments = &sections[IMAGE_SECTION_COMMENTS];
+        uint32_t obj;
+        uint32_t sub;
+        const char* text;
+        size_t len;
+        for (size_t i = 0;
+             __dbc_get_comment_at(dbc, (dbc_object_kind_t)kind, i, &obj, &sub,
+                                  &text, &len);
+             i++) {
+            __dbc_image_put(comments, kind, 1);
+            __dbc_image_put(comments, 0, 3);
+            __dbc_image_put(comments, obj, 4);
+            __dbc_image_put(comments, sub, 4);
+            __dbc_image_put(comments,
+                            __dbc_image_put_string(&strings, text, len), 4);
+        }
+    }
+
+    sections[IMAGE_SECTION_STRINGS] = strings.strings;
+    sections[IMAGE_SECTION_DATA] = strings.data;
+    bool failed = false;
+    for (size_t i = 0; i < IMAGE_NUM_SECTIONS; i++) {
+        failed |= sections[i].failed;
+    }
+
+    const bool success = !failed
+        && __dbc_image_write(path, sections, version_id);
+    for (size_t i = 0; i < IMAGE_NUM_SECTIONS; i++) {
+        free(sections[i].data);
+    }
+    free(strings.ptrs);
+    free(strings.ids);
+    return success;
+}
+
+/* Reading */
+
+typedef struct {
+    const uint8_t* base;
+    uint64_t offset;
+    uint64_t count;
+} dbc_image_section_t;
+
+static inline uint64_t __dbc_image_get(const uint8_t* ptr,
+                                       const size_t width) {
+    uint64_t val = 0;
+    for (size_t i = 0; i < width; i++) {
+        val |= (uint64_t)ptr[i] << (8 * i);
+    }
+    return val;
+}
+
+static inline double __dbc_image_get_f64(const uint8_t* ptr) {
+    const uint64_t bits = __dbc_image_get(ptr, 8);
+    double val;
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+static inline const uint8_t* __dbc_image_record(
+    const dbc_image_section_t* sections, const size_t section,
+    const uint64_t idx) {
+    return sections[section].base + sections[section].offset
+        + idx * IMAGE_RECORD_SIZES[section];
+}
+
+/**
+ * @brief Checks that the header is sane and that every section lies within
+ *        the image.
+ */
+static bool __dbc_image_validate(const uint8_t* data, const size_t len,
+                                 dbc_image_section_t* sections) {
+    if (unlikely(len < IMAGE_HEADER_SIZE
+                 || memcmp(data, IMAGE_MAGIC, sizeof(IMAGE_MAGIC)) != 0
+                 || __dbc_image_get(data + 8, 4) != DBC_COMPILED_FORMAT_VERSION
+                 || __dbc_image_get(data + 12, 4) != IMAGE_HEADER_SIZE
+                 || __dbc_image_get(data + 16, 8) != len)) {
+        return false;
+    }
+
+    // The header is not covered by the checksum, so the sections must lie
+    // exactly where __dbc_image_write puts them, back to back.
+    uint64_t end = IMAGE_HEADER_SIZE;
+    for (size_t i = 0; i < IMAGE_NUM_SECTIONS; i++) {
+        const uint8_t* const header = data + IMAGE_SECTIONS_OFFSET + i * 16;
+        sections[i].base = data;
+        sections[i].offset = __dbc_image_get(header, 8);
+        sections[i].count = __dbc_image_get(header + 8, 8);
+        if (unlikely(sections[i].offset != end
+                     || sections[i].count
+                            > (len - sections[i].offset)
+                                  / IMAGE_RECORD_SIZES[i])) {
+            return false;
+        }
+        end = (end + sections[i].count * IMAGE_RECORD_SIZES[i] + 7)
+              & ~(uint64_t)7;
+    }
+
+    return end == len
+        && __dbc_image_get(data + 24, 4)
+        == __dbc_image_checksum(data + IMAGE_HEADER_SIZE,
+                                len - IMAGE_HEADER_SIZE);
+}
+
+/**
+ * @brief Adopts every string of the image into the DBC's string pool.
+ * @return false if some string lies outside of the string data.
+ */
+static bool __dbc_image_load_strings(const dbc_t dbc,
+                                     const dbc_image_section_t* sections,
+                                     const char** strings) {
+    const dbc_image_section_t* const data = &sections[IMAGE_SECTION_DATA];
+    const char* const chars = (const char*)data->base + data->offset;
+    for (uint64_t i = 0; i < sections[IMAGE_SECTION_STRINGS].count; i++) {
+        const uint8_t* const rec =
+            __dbc_image_record(sections, IMAGE_SECTION_STRINGS, i);
+        const uint64_t off = __dbc_image_get(rec, 4);
+        const uint64_t len = __dbc_image_get(rec + 4, 4);
+        if (unlikely(off + len >= data->count || chars[off + len] != 0)) {
+            return false;
+        }
+
+        strings[i] = __dbc_strpool_adopt(__dbc_get_strpool(dbc), chars + off,
+                                         (size_t)len);
+        if (unlikely(strings[i] == NULL)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Looks up a string by its index in the image.
+ * @return false if there is no such string.
+ */
+static inline bool __dbc_image_string(const dbc_image_section_t* sections,
+                                      const char** strings,
+                                      const uint8_t* ptr, const char** out) {
+    const uint64_t id = __dbc_image_get(ptr, 4);
+    if (unlikely(id >= sections[IMAGE_SECTION_STRINGS].count)) {
+        return false;
+    }
+    *out = strings[id];
+    return true;
+}
+
+/**
+ * @brief Checks that the records [first, first + count) exist.
+ */
+static inline bool __dbc_image_range(const dbc_image_section_t* sections,
+                                     const size_t section,
+                                     const uint64_t first,
+                                     const uint64_t count) {
+    return first <= sections[section].count
+        && count <= sections[section].count - first;
+}
+
+static bool __dbc_image_load_signal(const dbc_message_t msg,
+                                    const dbc_image_section_t* sections,
+                                    const char** strings, const uint8_t* rec) {
+    dbc_signal_def_t def;
+    if (unlikely(!__dbc_image_string(sections, strings, rec, &def.name)
+                 || !__dbc_image_string(sections, strings, rec + 4,
+                                        &def.unit))) {
+        return false;
+    }
+    def.start_bit = (uint16_t)__dbc_image_get(rec + 8, 2);
+    def.length = (uint16_t)__dbc_image_get(rec + 10, 2);
+    def.byte_order = rec[12] == DBC_BYTE_ORDER_LITTLE_ENDIAN
+        ? DBC_BYTE_ORDER_LITTLE_ENDIAN
+        : DBC_BYTE_ORDER_BIG_ENDIAN;
+    def.is_signed = rec[13] != 0;
+    def.is_multiplexor = (rec[14] & IMAGE_SIGNAL_MULTIPLEXOR) != 0;
+    // Multiplexed signals get their ranges once all signals are in.
+    def.is_multiplexed = false;
+    def.mux_value = 0;
+    def.factor = __dbc_image_get_f64(rec + 16);
+    def.offset = __dbc_image_get_f64(rec + 24);
+    def.min = __dbc_image_get_f64(rec + 32);
+    def.max = __dbc_image_get_f64(rec + 40);
+
+    const uint64_t first = __dbc_image_get(rec + 48, 4);
+    const uint64_t count = __dbc_image_get(rec + 52, 4);
+    if (unlikely(!__dbc_image_range(sections, IMAGE_SECTION_RECEIVERS, first,
+                                    count))) {
+        return false;
+    }
+
+    const dbc_signal_t sig = __dbc_message_add_signal_len(
+        msg, &def, strlen(def.name), strlen(def.unit));
+    if (unlikely(sig == NULL)) {
+        return false;
+    }
+
+    for (uint64_t i = first; i < first + count; i++) {
+        const char* receiver;
+        if (unlikely(!__dbc_image_string(
+                         sections, strings,
+                         __dbc_image_record(sections, IMAGE_SECTION_RECEIVERS,
+                                            i),
+                         &receiver)
+                     || !__dbc_signal_add_receiver_len(sig, receiver,
+                                                       strlen(receiver)))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Makes the signal multiplexed as the record says, once all of the
+ *        message's signals are loaded.
+ */
+static bool __dbc_image_load_mux(const dbc_message_t msg,
+                                 const dbc_signal_t sig,
+                                 const dbc_image_section_t* sections,
+                                 const uint8_t* rec) {
+    if ((rec[14] & IMAGE_SIGNAL_MULTIPLEXED) == 0) {
+        return true;
+    }
+
+    const uint64_t mux = __dbc_image_get(rec + 56, 4);
+    const uint64_t first = __dbc_image_get(rec + 60, 4);
+    const uint64_t count = __dbc_image_get(rec + 64, 4);
+    if (unlikely((mux != IMAGE_NO_MULTIPLEXOR
+                  && mux >= dbc_message_get_num_signals(msg))
+                 || !__dbc_image_range(sections, IMAGE_SECTION_RANGES, first,
+                                       count))) {
+        return false;
+    }
+
+    dbc_mux_range_t* const ranges = (dbc_mux_range_t*)malloc(
+        (size_t)(count == 0 ? 1 : count) * sizeof(dbc_mux_range_t));
+    if (unlikely(ranges == NULL)) {
+        return false;
+    }
+    for (uint64_t i = 0; i < count; i++) {
+        const uint8_t* const range =
+            __dbc_image_record(sections, IMAGE_SECTION_RANGES, first + i);
+        ranges[i].min = __dbc_image_get(range, 8);
+        ranges[i].max = __dbc_image_get(range + 8, 8);
+    }
+
+    const bool success = __dbc_message_set_mux_len(
+        msg, sig,
+        mux == IMAGE_NO_MULTIPLEXOR
+            ? NULL
+            : dbc_message_get_signal(msg, (size_t)mux),
+        ranges, (size_t)count, false);
+    free(ranges);
+    return success;
+}
+
+static bool __dbc_image_load_objects(const dbc_t dbc,
+                                     const dbc_image_section_t* sections,
+                                     const char** strings) {
+    const char* name;
+    for (uint64_t i = 0; i < sections[IMAGE_SECTION_NODES].count; i++) {
+        const uint8_t* const rec =
+            __dbc_image_record(sections, IMAGE_SECTION_NODES, i);
+        if (unlikely(!__dbc_image_string(sections, strings, rec, &name)
+                     || __dbc_add_node_len(dbc, name, strlen(name)) == NULL)) {
+            return false;
+        }
+    }
+
+    for (uint64_t i = 0; i < sections[IMAGE_SECTION_TABLES].count; i++) {
+        const uint8_t* const rec =
+            __dbc_image_record(sections, IMAGE_SECTION_TABLES, i);
+        const uint64_t first = __dbc_image_get(rec + 4, 4);
+        const uint64_t count = __dbc_image_get(rec + 8, 4);
+        if (unlikely(!__dbc_image_string(sections, strings, rec, &name)
+                     || !__dbc_image_range(sections, IMAGE_SECTION_ENTRIES,
+                                           first, count))) {
+            return false;
+        }
+
+        const dbc_value_table_t vt =
+            __dbc_add_value_table_len(dbc, name, strlen(name));
+        if (unlikely(vt == NULL)) {
+            return false;
+        }
+        for (uint64_t j = first; j < first + count; j++) {
+            const uint8_t* const entry =
+                __dbc_image_record(sections, IMAGE_SECTION_ENTRIES, j);
+            const char* desc;
+            if (unlikely(!__dbc_image_string(sections, strings, entry + 8,
+                                             &desc)
+                         || !__dbc_value_table_insert_len(
+                             vt, __dbc_image_get_f64(entry), desc,
+                             strlen(desc)))) {
+                return false;
+            }
+        }
+        if ((__dbc_image_get(rec + 12, 4) & IMAGE_TABLE_FROZEN) != 0
+            && unlikely(!dbc_value_table_freeze(vt))) {
+            return false;
+        }
+    }
+
+    for (uint64_t i = 0; i < sections[IMAGE_SECTION_MESSAGES].count; i++) {
+        const uint8_t* const rec =
+            __dbc_image_record(sections, IMAGE_SECTION_MESSAGES, i);
+        const char* transmitter;
+        const uint64_t first = __dbc_image_get(rec + 16, 4);
+        const uint64_t count = __dbc_image_get(rec + 20, 4);
+        if (unlikely(!__dbc_image_string(sections, strings, rec + 8, &name)
+                     || !__dbc_image_string(sections, strings, rec + 12,
+                                            &transmitter)
+                     || !__dbc_image_range(sections, IMAGE_SECTION_SIGNALS,
+                                           first, count))) {
+            return false;
+        }
+
+        const dbc_message_t msg = __dbc_add_message_len(
+            dbc, (uint32_t)__dbc_image_get(rec, 4), name, strlen(name),
+            (uint32_t)__dbc_image_get(rec + 4, 4), transmitter,
+            strlen(transmitter));
+        if (unlikely(msg == NULL)) {
+            return false;
+        }
+        for (uint64_t j = first; j < first + count; j++) {
+            if (unlikely(!__dbc_image_load_signal(
+                    msg, sections, strings,
+                    __dbc_image_record(sections, IMAGE_SECTION_SIGNALS, j)))) {
+                return false;
+            }
+        }
+        for (uint64_t j = first; j < first + count; j++) {
+            if (unlikely(!__dbc_image_load_mux(
+                    msg, dbc_message_get_signal(msg, (size_t)(j - first)),
+                    sections,
+                    __dbc_image_record(sections, IMAGE_SECTION_SIGNALS, j)))) {
+                return false;
+            }
+        }
+    }
+
+    __dbc_build_mux(dbc);
+    return true;
+}
+
+/**
+ * @brief Reads an attribute value, its string looked up in the image.
+ * @return false if there is no such string.
+ */
+static bool __dbc_image_attr_value(const dbc_image_section_t* sections,
+                                   const char** strings, const uint8_t* rec,
+                                   dbc_attr_value_t* out) {
+    out->num = __dbc_image_get_f64(rec);
+    out->str = NULL;
+    return __dbc_image_get(rec + 8, 4) == IMAGE_NO_STRING
+        || __dbc_image_string(sections, strings, rec + 8, &out->str);
+}
+
+static bool __dbc_image_load_attr_def(const dbc_t dbc,
+                                      const dbc_image_section_t* sections,
+                                      const char** strings,
+                                      const uint8_t* rec) {
+    const char* name;
+    const uint64_t first_label = __dbc_image_get(rec + 36, 4);
+    const uint64_t num_labels = __dbc_image_get(rec + 40, 4);
+    const uint64_t first_value = __dbc_image_get(rec + 44, 4);
+    const uint64_t num_values = __dbc_image_get(rec + 48, 4);
+    if (unlikely(!__dbc_image_string(sections, strings, rec, &name)
+                 || rec[4] >= DBC_NUM_OBJECT_KINDS || rec[5] > DBC_ATTR_ENUM
+                 || !__dbc_image_range(sections, IMAGE_SECTION_LABELS,
+                                       first_label, num_labels)
+                 || !__dbc_image_range(sections, IMAGE_SECTION_VALUES,
+                                       first_value, num_values))) {
+        return false;
+    }
+
+    const dbc_attr_def_t def =
+        __dbc_add_attr_def_len(dbc, name, strlen(name),
+                               (dbc_object_kind_t)rec[4],
+                               (dbc_attr_type_t)rec[5]);
+    if (unlikely(def == NULL)) {
+        return false;
+    }
+    __dbc_attr_def_set_range(def, __dbc_image_get_f64(rec + 8),
+                             __dbc_image_get_f64(rec + 16));
+
+    for (uint64_t i = first_label; i < first_label + num_labels; i++) {
+        const char* label;
+        if (unlikely(!__dbc_image_string(
+                         sections, strings,
+                         __dbc_image_record(sections, IMAGE_SECTION_LABELS, i),
+                         &label)
+                     || !__dbc_attr_def_add_label_len(def, label,
+                                                      strlen(label)))) {
+            return false;
+        }
+    }
+
+    // Strings are interned in the dbc's pool already, labels included.
+    dbc_attr_value_t value;
+    if (rec[6] != 0) {
+        if (unlikely(!__dbc_image_attr_value(sections, strings, rec + 24,
+                                             &value))) {
+            return false;
+        }
+        __dbc_attr_def_set_default(def, &value);
+    }
+
+    for (uint64_t i = first_value; i < first_value + num_values; i++) {
+        const uint8_t* const row =
+            __dbc_image_record(sections, IMAGE_SECTION_VALUES, i);
+        if (unlikely(!__dbc_image_attr_value(sections, strings, row + 8,
+                                             &value)
+                     || !__dbc_attr_def_set_value(
+                         def, (uint32_t)__dbc_image_get(row, 4),
+                         (uint32_t)__dbc_image_get(row + 4, 4), &value))) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Loads the attributes and comments, which refer to the objects
+ *        loaded before them by index.
+ */
+static bool __dbc_image_load_annotations(const dbc_t dbc,
+                                         const dbc_image_section_t* sections,
+                                         const char** strings) {
+    for (uint64_t i = 0; i < sections[IMAGE_SECTION_ATTR_DEFS].count; i++) {
+        if (unlikely(!__dbc_image_load_attr_def(
+                dbc, sections, strings,
+                __dbc_image_record(sections, IMAGE_SECTION_ATTR_DEFS, i)))) {
+            return false;
+        }
+    }
+
+    for (uint64_t i = 0; i < sections[IMAGE_SECTION_COMMENTS].count; i++) {
+        const uint8_t* const rec =
+            __dbc_image_record(sections, IMAGE_SECTION_COMMENTS, i);
+        const char* text;
+        if (unlikely(rec[0] >= DBC_NUM_OBJECT_KINDS
+                     || !__dbc_image_string(sections, strings, rec + 12,
+                                            &text)
+                     || !__dbc_add_comment_len(
+                         dbc, (dbc_object_kind_t)rec[0],
+                         (uint32_t)__dbc_image_get(rec + 4, 4),
+                         (uint32_t)__dbc_image_get(rec + 8, 4), text,
+                         strlen(text)))) {
+            return false;
+        }
+    }
+
+    // Images list rows in order, unless written by something else.
+    return __dbc_sort_annotations(dbc);
+}
+
+dbc_t dbc_load_compiled(const char* path) {
+    dbc_file_map_t map;
+    if (unlikely(!__dbc_file_map(path, &map))) {
+        return NULL;
+    }
+
+    dbc_image_section_t sections[IMAGE_NUM_SECTIONS];
+    const uint8_t* const data = (const uint8_t*)map.data;
+    if (unlikely(!__dbc_image_validate(data, map.len, sections))) {
+        __dbc_file_unmap(&map);
+        return NULL;
+    }
+
+    const dbc_t dbc = dbc_new();
+    if (unlikely(dbc == NULL)) {
+        __dbc_file_unmap(&map);
+        return NULL;
+    }
+    // From here on, the mapping lives and dies with the dbc.
+    __dbc_keep_file_map(dbc, &map);
+
+    const uint64_t num_strings = sections[IMAGE_SECTION_STRINGS].count;
+    const char** const strings = (const char**)malloc(
+        (size_t)(num_strings == 0 ? 1 : num_strings) * sizeof(const char*));
+    const char* version;
+    const bool success = strings != NULL
+        && __dbc_image_load_strings(dbc, sections, strings)
+        && __dbc_image_string(sections, strings, data + 28, &version)
+        && __dbc_image_load_objects(dbc, sections, strings)
+        && __dbc_image_load_annotations(dbc, sections, strings);
+    if (likely(success)) {
+        dbc_set_version(dbc, version);
+    }
+
+    free(strings);
+    if (unlikely(!success)) {
+        dbc_free(dbc);
+        return NULL;
+    }
+    return dbc;
+}
@@ -0,0 +1,168 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define LIBDBC_HAVE_CLOCK_GETTIME
+#endif
+
+#include "__libdbc_instr.h"
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include "__libdbc.h"
+
+#ifdef LIBDBC_PARSE_STATS
+
+#if defined(_MSC_VER)
+#define DBC_THREAD_LOCAL __declspec(thread)
+#else
+#define DBC_THREAD_LOCAL __thread
+#endif
+
+// Phases nest a few deep at most, those nested deeper count towards the
+// deepest one kept track of.
+#define INSTR_MAX_DEPTH (8U)
+
+typedef struct {
+    bool active;
+    dbc_parse_stats_t* stats;
+    dbc_parse_hook_t hook;
+    void* ctx;
+    dbc_parse_phase_t phases[INSTR_MAX_DEPTH];
+    size_t depth;
+    // When the clock of the innermost phase was last read.
+    uint64_t since;
+    uint64_t statement_start;
+} dbc_instr_t;
+
+// Every thread instruments its own parses.
+static DBC_THREAD_LOCAL dbc_instr_t instr;
+
+static uint64_t __dbc_instr_now(void) {
+#ifdef LIBDBC_HAVE_CLOCK_GETTIME
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
+#else
+    return (uint64_t)((double)clock() * 1e9 / CLOCKS_PER_SEC);
+#endif
+}
+
+/**
+ * @brief Counts the time since the clock was last read towards the innermost
+ *        phase.
+ */
+static void __dbc_instr_tick(void) {
+    const uint64_t now = __dbc_instr_now();
+    if (instr.depth > 0 && instr.stats != NULL) {
+        const size_t top = instr.depth < INSTR_MAX_DEPTH ? instr.depth
+                                                         : INSTR_MAX_DEPTH;
+        instr.stats->phase_ns[instr.phases[top - 1]] += now - instr.since;
+    }
+    instr.since = now;
+}
+
+void __dbc_instr_push(const dbc_parse_phase_t phase) {
+    if (likely(!instr.active)) {
+        return;
+    }
+
+    __dbc_instr_tick();
+    if (instr.depth < INSTR_MAX_DEPTH) {
+        instr.phases[instr.depth] = phase;
+    }
+    instr.depth++;
+}
+
+void __dbc_instr_pop(void) {
+    if (likely(!instr.active) || unlikely(instr.depth == 0)) {
+        return;
+    }
+
+    __dbc_instr_tick();
+    instr.depth--;
+}
+
+void __dbc_instr_scanned(const size_t kw, const char* keyword,
+                         const size_t len) {
+    dbc_parse_stats_t* const stats = instr.stats;
+    if (likely(stats == NULL)) {
+        return;
+    }
+
+    dbc_parse_keyword_stats_t* const entry = &stats->keywords[kw];
+    entry->keyword = keyword;
+    entry->count++;
+    entry->bytes += len;
+    stats->count++;
+    stats->bytes += len;
+    if (kw >= stats->num_keywords) {
+        stats->num_keywords = kw + 1;
+    }
+}
+
+void __dbc_instr_begin_statement(void) {
+    __dbc_instr_push(DBC_PARSE_PHASE_TOKENIZE);
+    instr.statement_start = instr.since;
+}
+
+void __dbc_instr_end_statement(const size_t kw, const char* str,
+                               const size_t len,
+                               const dbc_parse_status_t status) {
+    if (likely(!instr.active)) {
+        return;
+    }
+
+    __dbc_instr_pop();
+    const uint64_t ns = instr.since - instr.statement_start;
+    dbc_parse_stats_t* const stats = instr.stats;
+    if (stats != NULL) {
+        dbc_parse_keyword_stats_t* const entry = &stats->keywords[kw];
+        entry->ns += ns;
+        entry->malformed += status == DBC_PARSE_MALFORMED;
+        entry->critical += status == DBC_PARSE_CRITICAL;
+        stats->malformed += status == DBC_PARSE_MALFORMED;
+        stats->critical += status == DBC_PARSE_CRITICAL;
+    }
+    if (instr.hook != NULL) {
+        instr.hook(instr.ctx, str, len, status, ns);
+    }
+}
+
+#endif
+
+bool dbc_parse_instrument(dbc_parse_stats_t* stats, dbc_parse_hook_t hook,
+                          void* ctx) {
+#ifdef LIBDBC_PARSE_STATS
+    if (stats != NULL) {
+        memset(stats, 0, sizeof(*stats));
+    }
+    memset(&instr, 0, sizeof(instr));
+    instr.active = stats != NULL || hook != NULL;
+    instr.stats = stats;
+    instr.hook = hook;
+    instr.ctx = ctx;
+    return true;
+#else
+    (void)stats;
+    (void)hook;
+    (void)ctx;
+    return false;
+#endif
+}
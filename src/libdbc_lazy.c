@@ -0,0 +1,93 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define LIBDBC_HAVE_PTHREAD
+#endif
+
+#include "__libdbc_lazy.h"
+#include "__libdbc.h"
+
+#ifdef LIBDBC_HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+struct dbc_lazy {
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_mutex_t lock;
+#endif
+    dbc_lazy_parse_t parse;
+    dbc_parse_status_t worst;
+};
+
+dbc_lazy_t __dbc_lazy_new(dbc_lazy_parse_t parse) {
+    const dbc_lazy_t lazy = (dbc_lazy_t)malloc(sizeof(struct dbc_lazy));
+    if (unlikely(lazy == NULL)) {
+        return NULL;
+    }
+
+#ifdef LIBDBC_HAVE_PTHREAD
+    if (unlikely(pthread_mutex_init(&lazy->lock, NULL) != 0)) {
+        free(lazy);
+        return NULL;
+    }
+#endif
+    lazy->parse = parse;
+    lazy->worst = DBC_PARSE_SUCCESS;
+    return lazy;
+}
+
+void __dbc_lazy_free(dbc_lazy_t lazy) {
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_mutex_destroy(&lazy->lock);
+#endif
+    free(lazy);
+}
+
+void __dbc_lazy_lock(dbc_lazy_t lazy) {
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_mutex_lock(&lazy->lock);
+#else
+    (void)lazy;
+#endif
+}
+
+void __dbc_lazy_unlock(dbc_lazy_t lazy) {
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_mutex_unlock(&lazy->lock);
+#else
+    (void)lazy;
+#endif
+}
+
+void __dbc_lazy_parse(dbc_lazy_t lazy, dbc_message_t msg, const char* str,
+                      const size_t len) {
+    __dbc_lazy_report(lazy, lazy->parse(msg, str, len));
+}
+
+void __dbc_lazy_report(dbc_lazy_t lazy, const dbc_parse_status_t status) {
+    lazy->worst = status > lazy->worst ? status : lazy->worst;
+}
+
+dbc_parse_status_t __dbc_lazy_get_status(dbc_lazy_t lazy) {
+    __dbc_lazy_lock(lazy);
+    const dbc_parse_status_t worst = lazy->worst;
+    __dbc_lazy_unlock(lazy);
+    return worst;
+}
@@ -0,0 +1,977 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libdbc_log.h"
+#include "__libdbc.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#define LIBDBC_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Logs lex a lot faster than DBCs parse, so threads need bigger pieces to
+// pay for themselves.
+#define LOG_MIN_PIECE_SIZE (1024U * 1024U)
+// Frames are decoded this many at a time, so a batch's payloads and columns
+// stay in L2.
+#define LOG_DECODE_CHUNK (1024U)
+#define LOG_MAX_PAYLOAD (64U)
+#define LOG_INLINE_PAYLOAD (8U)
+// Most frames take up some 30 to 60 bytes of text.
+#define LOG_BYTES_PER_FRAME (32U)
+// candump sets this in the IDs of error frames.
+#define CANDUMP_ERR_FLAG (0x20000000U)
+#define CAN_EXTENDED_ID_MASK (0x1FFFFFFFU)
+// The header of an ASC file is only ever a handful of lines.
+#define ASC_MAX_HEADER_LINES (16U)
+
+struct dbc_log {
+    dbc_log_frame_t* frames;
+    size_t num_frames;
+    // The payloads over 8 bytes, back to back.
+    uint8_t* payloads;
+    size_t payloads_len;
+};
+
+typedef struct {
+    dbc_log_format_t format;
+    // ASC headers can ask for decimal IDs with "base dec"...
+    bool decimal_ids;
+    // ...and for timestamps counting from the line before with
+    // "timestamps relative".
+    bool relative;
+} dbc_log_opts_t;
+
+typedef struct {
+    const char* buf;
+    size_t len;
+    const dbc_log_opts_t* opts;
+    struct dbc_log log;
+    size_t frames_cap;
+    size_t payloads_cap;
+    dbc_parse_status_t status;
+} dbc_log_piece_t;
+
+typedef enum {
+    LOG_LINE_FRAME,
+    // Not a data frame, like headers, events, remote and error frames.
+    LOG_LINE_SKIPPED,
+    // Looks like a data frame, but could not be read.
+    LOG_LINE_BROKEN
+} dbc_log_line_t;
+
+// The value of every hex digit plus one, 0 for everything else.
+static const uint8_t HEX_DIGITS[256] = {
+    ['0'] = 1,  ['1'] = 2,  ['2'] = 3,  ['3'] = 4,  ['4'] = 5,
+    ['5'] = 6,  ['6'] = 7,  ['7'] = 8,  ['8'] = 9,  ['9'] = 10,
+    ['A'] = 11, ['B'] = 12, ['C'] = 13, ['D'] = 14, ['E'] = 15, ['F'] = 16,
+    ['a'] = 11, ['b'] = 12, ['c'] = 13, ['d'] = 14, ['e'] = 15, ['f'] = 16
+};
+
+static inline int __dbc_log_hex(const char c) {
+    return (int)HEX_DIGITS[(unsigned char)c] - 1;
+}
+
+static inline bool __dbc_log_is_digit(const char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+static inline bool __dbc_log_is_blank(const char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline const char* __dbc_log_skip_blanks(const char* cur,
+                                                const char* end) {
+    while (cur < end && __dbc_log_is_blank(*cur)) {
+        cur++;
+    }
+    return cur;
+}
+
+static inline const char* __dbc_log_skip_token(const char* cur,
+                                               const char* end) {
+    while (cur < end && !__dbc_log_is_blank(*cur)) {
+        cur++;
+    }
+    return cur;
+}
+
+static inline bool __dbc_log_token_is(const char* cur, const char* end,
+                                      const char* token) {
+    const size_t len = strlen(token);
+    return (size_t)(end - cur) >= len && memcmp(cur, token, len) == 0
+           && (cur + len == end || __dbc_log_is_blank(cur[len]));
+}
+
+/**
+ * @brief Reads a timestamp in seconds, like "1436509052.249713".
+ *
+ * Digits past nanoseconds are dropped.
+ *
+ * @return The end of the timestamp, NULL if there is none.
+ */
+static const char* __dbc_log_timestamp(const char* cur, const char* end,
+                                       uint64_t* ns) {
+    const char* const start = cur;
+    uint64_t secs = 0;
+    for (; cur < end && __dbc_log_is_digit(*cur); cur++) {
+        secs = secs * 10 + (uint64_t)(*cur - '0');
+    }
+    if (unlikely(cur == start)) {
+        return NULL;
+    }
+
+    uint64_t frac = 0;
+    unsigned digits = 0;
+    if (cur < end && *cur == '.') {
+        for (cur++; cur < end && __dbc_log_is_digit(*cur); cur++) {
+            if (digits < 9) {
+                frac = frac * 10 + (uint64_t)(*cur - '0');
+                digits++;
+            }
+        }
+    }
+    for (; digits < 9; digits++) {
+        frac *= 10;
+    }
+
+    *ns = secs * 1000000000ULL + frac;
+    return cur;
+}
+
+#ifdef LIBDBC_HAVE_SSE2
+/**
+ * @brief Converts 16 hex digits into 8 bytes.
+ * @return false, with out untouched, unless all 16 are hex digits.
+ */
+static inline bool __dbc_log_hex16_sse2(const char* cur, uint8_t* out) {
+    const __m128i c = _mm_loadu_si128((const __m128i*)cur);
+    const __m128i digit = _mm_sub_epi8(c, _mm_set1_epi8('0'));
+    const __m128i letter = _mm_sub_epi8(_mm_or_si128(c, _mm_set1_epi8(0x20)),
+                                        _mm_set1_epi8('a'));
+    // Unsigned compares, anything below the range wraps above it.
+    const __m128i is_digit =
+        _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+    const __m128i is_letter =
+        _mm_cmpeq_epi8(_mm_min_epu8(letter, _mm_set1_epi8(5)), letter);
+    if (_mm_movemask_epi8(_mm_or_si128(is_digit, is_letter)) != 0xFFFF) {
+        return false;
+    }
+
+    const __m128i nibbles = _mm_or_si128(
+        _mm_and_si128(is_digit, digit),
+        _mm_and_si128(is_letter, _mm_add_epi8(letter, _mm_set1_epi8(10))));
+    // The first digit of every pair is its high nibble.
+    const __m128i bytes = _mm_or_si128(
+        _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4),
+        _mm_srli_epi16(nibbles, 8));
+    _mm_storel_epi64((__m128i*)out, _mm_packus_epi16(bytes, bytes));
+    return true;
+}
+#endif
+
+/**
+ * @brief Reads back to back hex digit pairs, like "DEADBEEF".
+ *
+ * @param cur Points at the digits, receives their end.
+ * @return The number of bytes read, SIZE_MAX if there were more than max or
+ *         an odd number of digits.
+ */
+static size_t __dbc_log_hex_bytes(const char** cur, const char* end,
+                                  uint8_t* out, const size_t max) {
+    const char* p = *cur;
+    size_t n = 0;
+
+#ifdef LIBDBC_HAVE_SSE2
+    // A classic frame's payload is a single block.
+    while (n + 8 <= max && end - p >= 16 && __dbc_log_hex16_sse2(p, out + n)) {
+        p += 16;
+        n += 8;
+    }
+#endif
+
+    for (; p < end; p += 2) {
+        const int hi = __dbc_log_hex(p[0]);
+        if (hi < 0) {
+            break;
+        }
+        const int lo = p + 1 < end ? __dbc_log_hex(p[1]) : -1;
+        if (unlikely(lo < 0 || n == max)) {
+            return SIZE_MAX;
+        }
+        out[n++] = (uint8_t)(hi << 4 | lo);
+    }
+
+    *cur = p;
+    return n;
+}
+
+/**
+ * @brief Reads n blank separated hex digit pairs, like "DE AD BE EF".
+ * @return false if there are fewer.
+ */
+static bool __dbc_log_spaced_hex_bytes(const char* cur, const char* end,
+                                       uint8_t* out, const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        cur = __dbc_log_skip_blanks(cur, end);
+        if (unlikely(end - cur < 2)) {
+            return false;
+        }
+        const int hi = __dbc_log_hex(cur[0]);
+        const int lo = __dbc_log_hex(cur[1]);
+        if (unlikely(hi < 0 || lo < 0
+                     || (cur + 2 < end && !__dbc_log_is_blank(cur[2])))) {
+            return false;
+        }
+        out[i] = (uint8_t)(hi << 4 | lo);
+        cur += 2;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a candump -l line, "(1436509052.249713) can0 123#DEADBEEF".
+ *
+ * CAN FD frames read "123##1DEADBEEF", with a flags digit after the "##".
+ */
+static dbc_log_line_t __dbc_log_candump_line(const char* cur,
+                                             const char* end,
+                                             dbc_log_frame_t* frame,
+                                             uint8_t* payload) {
+    cur = __dbc_log_skip_blanks(cur, end);
+    if (cur == end || *cur != '(') {
+        return LOG_LINE_SKIPPED;
+    }
+    cur = __dbc_log_timestamp(cur + 1, end, &frame->timestamp_ns);
+    if (unlikely(cur == NULL || cur == end || *cur != ')')) {
+        return LOG_LINE_BROKEN;
+    }
+
+    // The interface.
+    cur = __dbc_log_skip_blanks(cur + 1, end);
+    cur = __dbc_log_skip_token(cur, end);
+    cur = __dbc_log_skip_blanks(cur, end);
+
+    // Standard IDs have three digits, extended ones eight.
+    const char* const id_start = cur;
+    uint32_t id = 0;
+    for (int digit; cur < end && (digit = __dbc_log_hex(*cur)) >= 0; cur++) {
+        id = id << 4 | (uint32_t)digit;
+    }
+    const size_t id_digits = (size_t)(cur - id_start);
+    if (unlikely((id_digits != 3 && id_digits != 8) || cur == end
+                 || *cur != '#')) {
+        return LOG_LINE_BROKEN;
+    }
+    if (id_digits == 8) {
+        if (id & CANDUMP_ERR_FLAG) {
+            return LOG_LINE_SKIPPED;
+        }
+        id = (id & CAN_EXTENDED_ID_MASK) | DBC_MESSAGE_ID_EXTENDED;
+    }
+    cur++;
+
+    size_t max = LOG_INLINE_PAYLOAD;
+    if (cur < end && (*cur == 'R' || *cur == 'r')) {
+        return LOG_LINE_SKIPPED;
+    }
+    if (cur < end && *cur == '#') {
+        if (unlikely(end - cur < 2 || __dbc_log_hex(cur[1]) < 0)) {
+            return LOG_LINE_BROKEN;
+        }
+        cur += 2;
+        max = LOG_MAX_PAYLOAD;
+    }
+
+    const size_t len = __dbc_log_hex_bytes(&cur, end, payload, max);
+    // Only a DLC, like "_F", may follow the payload.
+    if (unlikely(len == SIZE_MAX
+                 || (cur < end && *cur != '_' && !__dbc_log_is_blank(*cur)))) {
+        return LOG_LINE_BROKEN;
+    }
+
+    frame->can_id = id;
+    frame->channel = 0;
+    frame->len = (uint8_t)len;
+    return LOG_LINE_FRAME;
+}
+
+/**
+ * @brief Reads an ASC message ID, like "123" or "18FEF100x".
+ * @return false if the token is not an ID, like "ErrorFrame".
+ */
+static bool __dbc_log_asc_id(const char** cur, const char* end,
+                             const bool decimal, uint32_t* id) {
+    const char* p = *cur;
+    const char* const start = p;
+    uint64_t value = 0;
+    if (decimal) {
+        for (; p < end && __dbc_log_is_digit(*p); p++) {
+            value = value * 10 + (uint64_t)(*p - '0');
+        }
+    } else {
+        for (int digit; p < end && (digit = __dbc_log_hex(*p)) >= 0; p++) {
+            value = value << 4 | (uint64_t)digit;
+        }
+    }
+    const size_t digits = (size_t)(p - start);
+
+    const bool extended = p < end && (*p == 'x' || *p == 'X');
+    p += extended;
+    if (digits == 0 || digits > 10 || (p < end && !__dbc_log_is_blank(*p))
+        || value > CAN_EXTENDED_ID_MASK) {
+        return false;
+    }
+
+    *id = extended ? (uint32_t)value | DBC_MESSAGE_ID_EXTENDED
+                   : (uint32_t)value;
+    *cur = p;
+    return true;
+}
+
+/**
+ * @brief Reads an ASC line.
+ *
+ * Classic frames read "0.012345 1 123 Rx d 4 DE AD BE EF", CAN FD ones
+ * "0.012345 CANFD 1 Rx 123 Name 1 0 4 4 DE AD BE EF", the symbolic name
+ * being optional. Whatever follows the payload is ignored.
+ *
+ * @param clock_ns The time of the line before, for relative timestamps.
+ */
+static dbc_log_line_t __dbc_log_asc_line(const char* cur, const char* end,
+                                         const dbc_log_opts_t* opts,
+                                         uint64_t* clock_ns,
+                                         dbc_log_frame_t* frame,
+                                         uint8_t* payload) {
+    // Every event starts with its timestamp, the header lines do not.
+    cur = __dbc_log_skip_blanks(cur, end);
+    if (cur == end || !__dbc_log_is_digit(*cur)) {
+        return LOG_LINE_SKIPPED;
+    }
+    uint64_t timestamp_ns;
+    cur = __dbc_log_timestamp(cur, end, &timestamp_ns);
+    if (opts->relative) {
+        *clock_ns += timestamp_ns;
+        timestamp_ns = *clock_ns;
+    }
+    frame->timestamp_ns = timestamp_ns;
+
+    cur = __dbc_log_skip_blanks(cur, end);
+    const bool fd = __dbc_log_token_is(cur, end, "CANFD");
+    if (fd) {
+        cur = __dbc_log_skip_blanks(cur + 5, end);
+    }
+
+    // Other events, like "Start of measurement", have no channel.
+    unsigned channel = 0;
+    const char* const channel_start = cur;
+    for (; cur < end && __dbc_log_is_digit(*cur) && channel <= UINT8_MAX;
+         cur++) {
+        channel = channel * 10 + (unsigned)(*cur - '0');
+    }
+    if (cur == channel_start || channel > UINT8_MAX
+        || (cur < end && !__dbc_log_is_blank(*cur))) {
+        return LOG_LINE_SKIPPED;
+    }
+    frame->channel = (uint8_t)channel;
+    cur = __dbc_log_skip_blanks(cur, end);
+
+    // CAN FD frames have their direction before the ID.
+    if (fd) {
+        cur = __dbc_log_skip_blanks(__dbc_log_skip_token(cur, end), end);
+    }
+    // Nor do error frames and statistics have an ID.
+    if (!__dbc_log_asc_id(&cur, end, opts->decimal_ids, &frame->can_id)) {
+        return LOG_LINE_SKIPPED;
+    }
+    cur = __dbc_log_skip_blanks(cur, end);
+
+    size_t len;
+    if (fd) {
+        // The symbolic name is there if the bit rate switch is not next.
+        const char* field = __dbc_log_skip_token(cur, end);
+        if (field - cur != 1) {
+            cur = __dbc_log_skip_blanks(field, end);
+        }
+        // The bit rate switch, the error state indicator and the DLC.
+        for (int i = 0; i < 3; i++) {
+            cur = __dbc_log_skip_blanks(__dbc_log_skip_token(cur, end), end);
+        }
+        len = 0;
+        const char* const len_start = cur;
+        for (; cur < end && __dbc_log_is_digit(*cur) && len <= LOG_MAX_PAYLOAD;
+             cur++) {
+            len = len * 10 + (size_t)(*cur - '0');
+        }
+        if (unlikely(cur == len_start || len > LOG_MAX_PAYLOAD)) {
+            return LOG_LINE_BROKEN;
+        }
+    } else {
+        // The direction, then "d" for data and "r" for remote frames.
+        cur = __dbc_log_skip_blanks(__dbc_log_skip_token(cur, end), end);
+        if (cur < end && *cur == 'r') {
+            return LOG_LINE_SKIPPED;
+        }
+        if (unlikely(!__dbc_log_token_is(cur, end, "d"))) {
+            return LOG_LINE_BROKEN;
+        }
+        cur = __dbc_log_skip_blanks(cur + 1, end);
+
+        const int dlc = cur < end ? __dbc_log_hex(*cur) : -1;
+        if (unlikely(dlc < 0)) {
+            return LOG_LINE_BROKEN;
+        }
+        // Classic DLCs over 8 still mean 8 bytes.
+        len = dlc < (int)LOG_INLINE_PAYLOAD ? (size_t)dlc : LOG_INLINE_PAYLOAD;
+        cur++;
+    }
+
+    if (unlikely(!__dbc_log_spaced_hex_bytes(cur, end, payload, len))) {
+        return LOG_LINE_BROKEN;
+    }
+    frame->len = (uint8_t)len;
+    return LOG_LINE_FRAME;
+}
+
+static bool __dbc_log_append(dbc_log_piece_t* piece, dbc_log_frame_t* frame,
+                             const uint8_t* payload) {
+    struct dbc_log* const log = &piece->log;
+    if (unlikely(log->num_frames == piece->frames_cap)) {
+        const size_t cap = piece->frames_cap * 2;
+        dbc_log_frame_t* const frames = (dbc_log_frame_t*)realloc(
+            log->frames, cap * sizeof(dbc_log_frame_t));
+        if (unlikely(frames == NULL)) {
+            return false;
+        }
+        log->frames = frames;
+        piece->frames_cap = cap;
+    }
+
+    memset(frame->payload.bytes, 0, sizeof(frame->payload.bytes));
+    if (likely(frame->len <= LOG_INLINE_PAYLOAD)) {
+        memcpy(frame->payload.bytes, payload, frame->len);
+    } else {
+        if (unlikely(log->payloads_len + frame->len > piece->payloads_cap)) {
+            const size_t cap = piece->payloads_cap * 2 + LOG_MAX_PAYLOAD;
+            uint8_t* const payloads = (uint8_t*)realloc(log->payloads, cap);
+            if (unlikely(payloads == NULL)) {
+                return false;
+            }
+            log->payloads = payloads;
+            piece->payloads_cap = cap;
+        }
+        memcpy(log->payloads + log->payloads_len, payload, frame->len);
+        frame->payload.offset = log->payloads_len;
+        log->payloads_len += frame->len;
+    }
+
+    log->frames[log->num_frames++] = *frame;
+    return true;
+}
+
+static void* __dbc_log_read_piece(void* arg) {
+    dbc_log_piece_t* const piece = (dbc_log_piece_t*)arg;
+    piece->status = DBC_PARSE_SUCCESS;
+    piece->frames_cap = piece->len / LOG_BYTES_PER_FRAME + 1;
+    piece->log.frames =
+        (dbc_log_frame_t*)malloc(piece->frames_cap * sizeof(dbc_log_frame_t));
+    if (unlikely(piece->log.frames == NULL)) {
+        piece->status = DBC_PARSE_IO_ERROR;
+        return NULL;
+    }
+
+    const char* cur = piece->buf;
+    const char* const end = piece->buf + piece->len;
+    uint64_t clock_ns = 0;
+    uint8_t payload[LOG_MAX_PAYLOAD];
+    while (cur < end) {
+        const char* eol = (const char*)memchr(cur, '\n', (size_t)(end - cur));
+        eol = eol != NULL ? eol : end;
+
+        dbc_log_frame_t frame;
+        const dbc_log_line_t line =
+            piece->opts->format == DBC_LOG_CANDUMP
+                ? __dbc_log_candump_line(cur, eol, &frame, payload)
+                : __dbc_log_asc_line(cur, eol, piece->opts, &clock_ns, &frame,
+                                     payload);
+        if (likely(line == LOG_LINE_FRAME)) {
+            if (unlikely(!__dbc_log_append(piece, &frame, payload))) {
+                piece->status = DBC_PARSE_IO_ERROR;
+                return NULL;
+            }
+        } else if (line == LOG_LINE_BROKEN) {
+            piece->status = DBC_PARSE_CRITICAL;
+        }
+
+        cur = eol == end ? end : eol + 1;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Tells the format apart by the first line that is not blank.
+ */
+static dbc_log_format_t __dbc_log_detect(const char* buf, const size_t len) {
+    for (const char* p = buf; p < buf + len; p++) {
+        if (*p != '\n' && !__dbc_log_is_blank(*p)) {
+            return *p == '(' ? DBC_LOG_CANDUMP : DBC_LOG_ASC;
+        }
+    }
+    return DBC_LOG_CANDUMP;
+}
+
+/**
+ * @brief Reads the options of an ASC file off the header before its first
+ *        event, like "base hex  timestamps absolute".
+ */
+static void __dbc_log_asc_opts(const char* buf, const size_t len,
+                               dbc_log_opts_t* opts) {
+    const char* cur = buf;
+    const char* const end = buf + len;
+    for (unsigned i = 0; i < ASC_MAX_HEADER_LINES && cur < end; i++) {
+        const char* eol = (const char*)memchr(cur, '\n', (size_t)(end - cur));
+        eol = eol != NULL ? eol : end;
+
+        cur = __dbc_log_skip_blanks(cur, eol);
+        if (cur < eol && __dbc_log_is_digit(*cur)) {
+            return;
+        }
+        while (cur < eol) {
+            const char* const next =
+                __dbc_log_skip_blanks(__dbc_log_skip_token(cur, eol), eol);
+            if (__dbc_log_token_is(cur, eol, "base")) {
+                opts->decimal_ids = __dbc_log_token_is(next, eol, "dec");
+            } else if (__dbc_log_token_is(cur, eol, "timestamps")) {
+                opts->relative = __dbc_log_token_is(next, eol, "relative");
+            }
+            cur = next;
+        }
+
+        cur = eol == end ? end : eol + 1;
+    }
+}
+
+/**
+ * @brief Splits the buffer into at most n pieces starting at line
+ *        boundaries.
+ * @return The number of pieces.
+ */
+static size_t __dbc_log_split_lines(const char* buf, const size_t len,
+                                    const size_t n, dbc_log_piece_t* pieces) {
+    const char* const end = buf + len;
+    const char* starts[DBC_MAX_THREADS];
+    size_t num_pieces = 1;
+    starts[0] = buf;
+    while (num_pieces < n) {
+        const char* target = buf + len / n * num_pieces;
+        target = target > starts[num_pieces - 1] ? target
+                                                 : starts[num_pieces - 1];
+        const char* const eol =
+            (const char*)memchr(target, '\n', (size_t)(end - target));
+        if (eol == NULL || eol + 1 == end) {
+            break;
+        }
+        starts[num_pieces++] = eol + 1;
+    }
+
+    for (size_t i = 0; i < num_pieces; i++) {
+        pieces[i].buf = starts[i];
+        pieces[i].len =
+            (size_t)((i + 1 < num_pieces ? starts[i + 1] : end) - starts[i]);
+    }
+    return num_pieces;
+}
+
+/**
+ * @brief Merges two runs of frames in timestamp order, a's first on ties.
+ */
+static void __dbc_log_merge_runs(const dbc_log_frame_t* a, const size_t na,
+                                 const dbc_log_frame_t* b, const size_t nb,
+                                 dbc_log_frame_t* out) {
+    size_t i = 0;
+    size_t j = 0;
+    if (na != 0 && nb != 0 && b[0].timestamp_ns < a[na - 1].timestamp_ns) {
+        while (i < na && j < nb) {
+            *out++ = b[j].timestamp_ns < a[i].timestamp_ns ? b[j++] : a[i++];
+        }
+    }
+    memcpy(out, a + i, (na - i) * sizeof(dbc_log_frame_t));
+    memcpy(out + (na - i), b + j, (nb - j) * sizeof(dbc_log_frame_t));
+}
+
+/**
+ * @brief Stably sorts the frames by timestamp.
+ *
+ * Logs are in order but for the odd frame, and pieces lexed on different
+ * threads are each in order, so the runs already there are merged rather
+ * than the frames sorted from scratch.
+ *
+ * @return false if out of memory.
+ */
+static bool __dbc_log_sort(dbc_log_frame_t* frames, const size_t n) {
+    size_t num_runs = 1;
+    for (size_t i = 1; i < n; i++) {
+        num_runs += frames[i].timestamp_ns < frames[i - 1].timestamp_ns;
+    }
+    if (likely(num_runs == 1)) {
+        return true;
+    }
+
+    size_t* const bounds = (size_t*)malloc((num_runs + 1) * sizeof(size_t));
+    dbc_log_frame_t* const scratch =
+        (dbc_log_frame_t*)malloc(n * sizeof(dbc_log_frame_t));
+    if (unlikely(bounds == NULL || scratch == NULL)) {
+        free(bounds);
+        free(scratch);
+        return false;
+    }
+
+    size_t r = 0;
+    bounds[r++] = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (frames[i].timestamp_ns < frames[i - 1].timestamp_ns) {
+            bounds[r++] = i;
+        }
+    }
+    bounds[num_runs] = n;
+
+    // Every pass merges neighbouring runs, halving their number.
+    dbc_log_frame_t* src = frames;
+    dbc_log_frame_t* dst = scratch;
+    while (num_runs > 1) {
+        size_t merged = 0;
+        for (r = 0; r < num_runs; r += 2) {
+            const size_t lo = bounds[r];
+            const size_t mid = bounds[r + 1];
+            const size_t hi = r + 2 <= num_runs ? bounds[r + 2] : mid;
+            __dbc_log_merge_runs(src + lo, mid - lo, src + mid, hi - mid,
+                                 dst + lo);
+            bounds[merged++] = lo;
+        }
+        bounds[merged] = n;
+        num_runs = merged;
+
+        dbc_log_frame_t* const tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    if (src != frames) {
+        memcpy(frames, src, n * sizeof(dbc_log_frame_t));
+    }
+    free(bounds);
+    free(scratch);
+    return true;
+}
+
+/**
+ * @brief Concatenates the pieces' frames and payloads into the first piece's.
+ *
+ * The pieces are freed, but for the first one.
+ *
+ * @return false if out of memory.
+ */
+static bool __dbc_log_concat(dbc_log_piece_t* pieces,
+                             const size_t num_pieces) {
+    struct dbc_log* const log = &pieces[0].log;
+    size_t num_frames = 0;
+    size_t payloads_len = 0;
+    for (size_t i = 0; i < num_pieces; i++) {
+        num_frames += pieces[i].log.num_frames;
+        payloads_len += pieces[i].log.payloads_len;
+    }
+
+    bool ok = true;
+    if (num_frames > pieces[0].frames_cap) {
+        dbc_log_frame_t* const frames = (dbc_log_frame_t*)realloc(
+            log->frames, num_frames * sizeof(dbc_log_frame_t));
+        ok = frames != NULL;
+        log->frames = ok ? frames : log->frames;
+    }
+    if (ok && payloads_len > pieces[0].payloads_cap) {
+        uint8_t* const payloads =
+            (uint8_t*)realloc(log->payloads, payloads_len);
+        ok = payloads != NULL;
+        log->payloads = ok ? payloads : log->payloads;
+    }
+
+    for (size_t i = 1; i < num_pieces; i++) {
+        const struct dbc_log* const piece = &pieces[i].log;
+        if (ok) {
+            dbc_log_frame_t* const frames = log->frames + log->num_frames;
+            memcpy(frames, piece->frames,
+                   piece->num_frames * sizeof(dbc_log_frame_t));
+            for (size_t j = 0; j < piece->num_frames; j++) {
+                if (frames[j].len > LOG_INLINE_PAYLOAD) {
+                    frames[j].payload.offset += log->payloads_len;
+                }
+            }
+            if (piece->payloads_len != 0) {
+                memcpy(log->payloads + log->payloads_len, piece->payloads,
+                       piece->payloads_len);
+            }
+            log->num_frames += piece->num_frames;
+            log->payloads_len += piece->payloads_len;
+        }
+        free(piece->frames);
+        free(piece->payloads);
+    }
+    return ok;
+}
+
+dbc_log_t dbc_log_read_buffer(const char* buf, size_t len,
+                              dbc_log_format_t format, size_t num_threads,
+                              dbc_parse_status_t* status) {
+    dbc_log_opts_t opts = { format, false, false };
+    if (opts.format == DBC_LOG_AUTO) {
+        opts.format = __dbc_log_detect(buf, len);
+    }
+    if (opts.format == DBC_LOG_ASC) {
+        __dbc_log_asc_opts(buf, len, &opts);
+    }
+
+    // Relative timestamps can only be added up from the start.
+    num_threads = opts.relative
+                      ? 1
+                      : __dbc_num_threads(num_threads, len,
+                                          LOG_MIN_PIECE_SIZE);
+    dbc_log_piece_t pieces[DBC_MAX_THREADS];
+    memset(pieces, 0, sizeof(pieces));
+    const size_t num_pieces =
+        __dbc_log_split_lines(buf, len, num_threads, pieces);
+    for (size_t i = 0; i < num_pieces; i++) {
+        pieces[i].opts = &opts;
+    }
+
+    __dbc_run_pieces(__dbc_log_read_piece, pieces, sizeof(pieces[0]),
+                     num_pieces);
+
+    dbc_parse_status_t worst = DBC_PARSE_SUCCESS;
+    for (size_t i = 0; i < num_pieces; i++) {
+        worst = pieces[i].status > worst ? pieces[i].status : worst;
+    }
+
+    dbc_log_t log = NULL;
+    if (likely(worst != DBC_PARSE_IO_ERROR)) {
+        log = (dbc_log_t)malloc(sizeof(struct dbc_log));
+    }
+    if (unlikely(log == NULL)) {
+        for (size_t i = 0; i < num_pieces; i++) {
+            free(pieces[i].log.frames);
+            free(pieces[i].log.payloads);
+        }
+        worst = DBC_PARSE_IO_ERROR;
+    } else if (unlikely(!__dbc_log_concat(pieces, num_pieces)
+                        || !__dbc_log_sort(pieces[0].log.frames,
+                                           pieces[0].log.num_frames))) {
+        free(pieces[0].log.frames);
+        free(pieces[0].log.payloads);
+        free(log);
+        log = NULL;
+        worst = DBC_PARSE_IO_ERROR;
+    } else {
+        *log = pieces[0].log;
+    }
+
+    if (status != NULL) {
+        *status = worst;
+    }
+    return log;
+}
+
+dbc_log_t dbc_log_read_file(const char* path, dbc_log_format_t format,
+                            size_t num_threads, dbc_parse_status_t* status) {
+    dbc_file_map_t map;
+    if (unlikely(!__dbc_file_map(path, &map))) {
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+
+    const dbc_log_t log =
+        dbc_log_read_buffer(map.data, map.len, format, num_threads, status);
+    __dbc_file_unmap(&map);
+    return log;
+}
+
+void dbc_log_free(dbc_log_t log) {
+    if (log == NULL) {
+        return;
+    }
+    free(log->frames);
+    free(log->payloads);
+    free(log);
+}
+
+size_t dbc_log_get_num_frames(const dbc_log_t log) {
+    return log->num_frames;
+}
+
+const dbc_log_frame_t* dbc_log_get_frames(const dbc_log_t log) {
+    return log->frames;
+}
+
+const uint8_t* dbc_log_get_payload(const dbc_log_t log,
+                                   const dbc_log_frame_t* frame) {
+    return frame->len <= LOG_INLINE_PAYLOAD
+               ? frame->payload.bytes
+               : log->payloads + frame->payload.offset;
+}
+
+typedef struct {
+    uint32_t can_id;
+    size_t index;
+} dbc_log_key_t;
+
+/**
+ * @brief Orders the frames by ID, keeping them in timestamp order within
+ *        every ID.
+ *
+ * A radix sort, a byte of the ID at a time, which is stable and skips the
+ * bytes all IDs share, like the upper ones of standard IDs.
+ *
+ * @return The frames' keys, NULL if out of memory.
+ */
+static dbc_log_key_t* __dbc_log_group(const dbc_log_t log) {
+    const size_t n = log->num_frames;
+    dbc_log_key_t* keys = (dbc_log_key_t*)malloc(n * sizeof(dbc_log_key_t));
+    dbc_log_key_t* scratch =
+        (dbc_log_key_t*)malloc(n * sizeof(dbc_log_key_t));
+    if (unlikely(keys == NULL || scratch == NULL)) {
+        free(keys);
+        free(scratch);
+        return NULL;
+    }
+
+    for (size_t i = 0; i < n; i++) {
+        keys[i].can_id = log->frames[i].can_id;
+        keys[i].index = i;
+    }
+
+    for (unsigned shift = 0; shift < 32; shift += 8) {
+        size_t offsets[256] = { 0 };
+        for (size_t i = 0; i < n; i++) {
+            offsets[keys[i].can_id >> shift & 0xFF]++;
+        }
+        if (offsets[keys[0].can_id >> shift & 0xFF] == n) {
+            continue;
+        }
+
+        size_t offset = 0;
+        for (size_t b = 0; b < 256; b++) {
+            const size_t count = offsets[b];
+            offsets[b] = offset;
+            offset += count;
+        }
+        for (size_t i = 0; i < n; i++) {
+            scratch[offsets[keys[i].can_id >> shift & 0xFF]++] = keys[i];
+        }
+
+        dbc_log_key_t* const tmp = keys;
+        keys = scratch;
+        scratch = tmp;
+    }
+
+    free(scratch);
+    return keys;
+}
+
+bool dbc_log_decode(const dbc_log_t log, const dbc_t dbc,
+                    dbc_log_decode_cb_t callback, void* ctx) {
+    const size_t n = log->num_frames;
+    if (n == 0) {
+        return true;
+    }
+
+    dbc_log_key_t* const keys = __dbc_log_group(log);
+    uint64_t* const timestamps =
+        (uint64_t*)malloc(LOG_DECODE_CHUNK * sizeof(uint64_t));
+    uint8_t* payloads = NULL;
+    size_t payloads_cap = 0;
+    double* values = NULL;
+    double** columns = NULL;
+    size_t columns_cap = 0;
+
+    bool ok = keys != NULL && timestamps != NULL;
+    for (size_t start = 0, stop; ok && start < n; start = stop) {
+        const uint32_t can_id = keys[start].can_id;
+        for (stop = start + 1; stop < n && keys[stop].can_id == can_id;
+             stop++) {
+        }
+        const dbc_message_t msg = dbc_get_message_by_id(dbc, can_id);
+        if (msg == NULL) {
+            continue;
+        }
+
+        const size_t size = dbc_message_get_size(msg);
+        const size_t num_signals = dbc_message_get_num_signals(msg);
+        if (size > payloads_cap || payloads == NULL) {
+            const size_t cap = size != 0 ? size : 1;
+            uint8_t* const grown =
+                (uint8_t*)realloc(payloads, cap * LOG_DECODE_CHUNK);
+            ok = grown != NULL;
+            payloads = ok ? grown : payloads;
+            payloads_cap = ok ? cap : payloads_cap;
+        }
+        if (ok && (num_signals > columns_cap || columns == NULL)) {
+            const size_t cap = num_signals != 0 ? num_signals : 1;
+            double* const grown_values = (double*)realloc(
+                values, cap * LOG_DECODE_CHUNK * sizeof(double));
+            values = grown_values != NULL ? grown_values : values;
+            double** const grown_columns =
+                (double**)realloc(columns, cap * sizeof(double*));
+            columns = grown_columns != NULL ? grown_columns : columns;
+            ok = grown_values != NULL && grown_columns != NULL;
+            if (ok) {
+                columns_cap = cap;
+                for (size_t s = 0; s < cap; s++) {
+                    columns[s] = values + s * LOG_DECODE_CHUNK;
+                }
+            }
+        }
+
+        for (size_t i = start; ok && i < stop; i += LOG_DECODE_CHUNK) {
+            const size_t chunk =
+                stop - i < LOG_DECODE_CHUNK ? stop - i : LOG_DECODE_CHUNK;
+            for (size_t j = 0; j < chunk; j++) {
+                const dbc_log_frame_t* const frame =
+                    &log->frames[keys[i + j].index];
+                const size_t copy = frame->len < size ? frame->len : size;
+                uint8_t* const payload = payloads + j * size;
+                memcpy(payload, dbc_log_get_payload(log, frame), copy);
+                memset(payload + copy, 0, size - copy);
+                timestamps[j] = frame->timestamp_ns;
+            }
+
+            dbc_decode_batch(dbc, can_id, payloads, chunk, columns);
+            callback(ctx, msg, timestamps, chunk,
+                     (const double* const*)columns);
+        }
+    }
+
+    free(keys);
+    free(timestamps);
+    free(payloads);
+    free(values);
+    free(columns);
+    return ok;
+}
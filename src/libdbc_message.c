@@ -0,0 +1,869 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libdbc_message.h"
+#include <math.h>
+#include <string.h>
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_instr.h"
+#include "__libdbc_lazy.h"
+#include "__libdbc_name_index.h"
+#include "__libdbc_signal.h"
+#include "__libdbc_strpool.h"
+
+// Multiplexors selecting multiplexors are followed this deep, no further.
+#define MUX_MAX_DEPTH (8U)
+// The jump table covers switch values below this.
+#define MUX_MAX_CASES (1024U)
+// Signals present for more switch values than this are not worth repeating
+// in every case of the jump table.
+#define MUX_MAX_CASE_SPAN (16U)
+// The smallest table of signal names, enough for four signals.
+#define MESSAGE_SIGNAL_SLOTS_MIN (8U)
+
+/**
+ * @brief Which signals to look at for a frame of a multiplexed message,
+ *        worked out once all of its signals are known.
+ *
+ * Signals are referred to by index. The switch is the multiplexor selected
+ * by no other one, and the signals it selects for a value v below num_cases
+ * are case_signals[case_starts[v]] up to case_signals[case_starts[v + 1]].
+ * The rest of the multiplexed signals have their multiplexors looked at frame
+ * by frame. They, and the muxed list, are sorted such that a multiplexor
+ * comes before the signals it selects.
+ */
+typedef struct {
+    dbc_signal_t sw;
+    uint32_t* fixed;
+    size_t num_fixed;
+    uint32_t* case_starts;
+    uint32_t* case_signals;
+    size_t num_cases;
+    uint32_t* dynamic;
+    size_t num_dynamic;
+    uint32_t* muxed;
+    size_t num_muxed;
+} dbc_mux_plan_t;
+
+struct dbc_message {
+    uint32_t id;
+    uint32_t size;
+    const char* name;
+    const char* transmitter;
+    dbc_signal_t* signals;
+    size_t num_signals;
+    size_t cap_signals;
+    dbc_arena_t arena;
+    dbc_strpool_t strings;
+    // The SG_ statements of a lazily loaded message, until they are parsed.
+    // Only ever cleared, and read atomically, see __dbc_message_load_signals.
+    const char* lazy_signals;
+    size_t lazy_len;
+    dbc_lazy_t lazy;
+    // Files the signals under their names, NULL for messages outside a DBC.
+    dbc_name_index_t* signals_by_name;
+    // Signal indices plus one, hashed by name, 0 for empty slots. The
+    // message's own, so lookups never touch the DBC's shared pool.
+    uint32_t* signal_slots;
+    size_t cap_signal_slots;
+    // The message's index in its DBC.
+    uint32_t index;
+    // Whether any signal is a multiplexor or multiplexed.
+    bool multiplexed;
+    // NULL while out of date, see __dbc_message_build_mux.
+    dbc_mux_plan_t* mux_plan;
+};
+
+dbc_message_t __dbc_message_new_in(dbc_arena_t arena, dbc_strpool_t strings,
+                                   const uint32_t id, const char* name,
+                                   const size_t name_len, const uint32_t size,
+                                   const char* transmitter,
+                                   const size_t transmitter_len) {
+    const dbc_message_t msg = (dbc_message_t)__dbc_arena_calloc(
+        arena, sizeof(struct dbc_message));
+    if (unlikely(msg == NULL)) {
+        return NULL;
+    }
+
+    msg->id = id;
+    msg->size = size;
+    msg->name = __dbc_strpool_intern(strings, name, name_len);
+    msg->transmitter =
+        __dbc_strpool_intern(strings, transmitter, transmitter_len);
+    if (unlikely(msg->name == NULL || msg->transmitter == NULL)) {
+        return NULL;
+    }
+    msg->arena = arena;
+    msg->strings = strings;
+
+    return msg;
+}
+
+void __dbc_message_set_lazy(dbc_message_t msg, dbc_lazy_t lazy,
+                            const char* str, const size_t len) {
+    msg->lazy = lazy;
+    msg->lazy_len = len;
+    msg->lazy_signals = str;
+}
+
+void __dbc_message_set_name_index(dbc_message_t msg, dbc_name_index_t* index) {
+    msg->signals_by_name = index;
+}
+
+void __dbc_message_set_index(dbc_message_t msg, const uint32_t index) {
+    msg->index = index;
+}
+
+bool __dbc_message_adopt(dbc_message_t msg, dbc_arena_t arena,
+                         dbc_strpool_t strings, dbc_name_index_t* index) {
+    if (unlikely(!__dbc_strpool_adopt_in_place(strings, &msg->name)
+                 || !__dbc_strpool_adopt_in_place(strings,
+                                                  &msg->transmitter))) {
+        return false;
+    }
+    msg->arena = arena;
+    msg->strings = strings;
+    msg->signals_by_name = index;
+
+    // The table of signal names hashes and compares their contents, which
+    // stay the same.
+    for (size_t i = 0; i < msg->num_signals; i++) {
+        const dbc_signal_t sig = msg->signals[i];
+        if (unlikely(!__dbc_signal_adopt(sig, arena, strings)
+                     || !__dbc_name_index_insert(index, sig->name, sig, msg,
+                                                 i))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+uint32_t __dbc_message_get_index(const dbc_message_t msg) {
+    return msg->index;
+}
+
+static void __dbc_message_load_signals_slow(dbc_message_t msg) {
+    __dbc_lazy_lock(msg->lazy);
+    // Another thread may have beaten us to it.
+    const char* const str = msg->lazy_signals;
+    if (str != NULL) {
+        __dbc_lazy_parse(msg->lazy, msg, str, msg->lazy_len);
+        __dbc_message_build_mux(msg);
+        __atomic_store_n(&msg->lazy_signals, NULL, __ATOMIC_RELEASE);
+    }
+    __dbc_lazy_unlock(msg->lazy);
+}
+
+void __dbc_message_load_signals(dbc_message_t msg) {
+    if (unlikely(__atomic_load_n(&msg->lazy_signals, __ATOMIC_ACQUIRE)
+                 != NULL)) {
+        __dbc_message_load_signals_slow(msg);
+    }
+}
+
+uint32_t dbc_message_get_id(const dbc_message_t msg) {
+    return msg->id;
+}
+
+const char* dbc_message_get_name(const dbc_message_t msg) {
+    return msg->name;
+}
+
+uint32_t dbc_message_get_size(const dbc_message_t msg) {
+    return msg->size;
+}
+
+const char* dbc_message_get_transmitter(const dbc_message_t msg) {
+    return msg->transmitter;
+}
+
+static uint32_t* __dbc_message_probe_signal(const dbc_message_t msg,
+                                            uint32_t* slots, const size_t cap,
+                                            const char* name,
+                                            const size_t len) {
+    const size_t mask = cap - 1;
+    for (size_t i = __dbc_strpool_hash(name, len) & mask;;
+         i = (i + 1) & mask) {
+        if (slots[i] == 0) {
+            return &slots[i];
+        }
+        const char* const sig_name = msg->signals[slots[i] - 1]->name;
+        if (strncmp(sig_name, name, len) == 0 && sig_name[len] == '\0') {
+            return &slots[i];
+        }
+    }
+}
+
+/**
+ * @brief Files the signal about to be appended under its name, unless an
+ *        earlier signal has that name already.
+ */
+static bool __dbc_message_file_signal(dbc_message_t msg,
+                                      const dbc_signal_t sig,
+                                      const size_t name_len) {
+    // Keep the load factor under 1/2. Old tables are left behind in the
+    // arena, which costs at most as much as the current one.
+    if (unlikely((msg->num_signals + 1) * 2 > msg->cap_signal_slots)) {
+        const size_t new_cap = msg->cap_signal_slots == 0
+            ? MESSAGE_SIGNAL_SLOTS_MIN
+            : msg->cap_signal_slots * 2;
+        uint32_t* const slots = (uint32_t*)__dbc_arena_calloc(
+            msg->arena, new_cap * sizeof(uint32_t));
+        if (unlikely(slots == NULL)) {
+            return false;
+        }
+        for (size_t i = 0; i < msg->num_signals; i++) {
+            const char* const name = msg->signals[i]->name;
+            uint32_t* const slot = __dbc_message_probe_signal(
+                msg, slots, new_cap, name, strlen(name));
+            if (*slot == 0) {
+                *slot = (uint32_t)i + 1;
+            }
+        }
+        msg->signal_slots = slots;
+        msg->cap_signal_slots = new_cap;
+    }
+
+    uint32_t* const slot = __dbc_message_probe_signal(
+        msg, msg->signal_slots, msg->cap_signal_slots, sig->name, name_len);
+    if (*slot == 0) {
+        *slot = (uint32_t)msg->num_signals + 1;
+    }
+    return true;
+}
+
+dbc_signal_t __dbc_message_add_signal_len(dbc_message_t msg,
+                                          const dbc_signal_def_t* def,
+                                          const size_t name_len,
+                                          const size_t unit_len) {
+    if (unlikely(!__dbc_vector_reserve(msg->arena, (void***)&msg->signals,
+                                       &msg->cap_signals,
+                                       msg->num_signals))) {
+        return NULL;
+    }
+
+    const dbc_signal_t sig = __dbc_signal_new_in(msg->arena, msg->strings, def,
+                                                 name_len, unit_len);
+    if (unlikely(sig == NULL || !__dbc_message_file_signal(msg, sig, name_len)
+                 || (msg->signals_by_name != NULL
+                     && !__dbc_name_index_insert(msg->signals_by_name,
+                                                 dbc_signal_get_name(sig), sig,
+                                                 msg, msg->num_signals)))) {
+        return NULL;
+    }
+
+    sig->index = (uint32_t)msg->num_signals;
+    msg->signals[msg->num_signals++] = sig;
+    if (unlikely(def->is_multiplexor || def->is_multiplexed)) {
+        msg->multiplexed = true;
+        msg->mux_plan = NULL;
+    }
+    return sig;
+}
+
+dbc_signal_t dbc_message_add_signal(dbc_message_t msg,
+                                    const dbc_signal_def_t* def) {
+    __dbc_message_load_signals(msg);
+    const dbc_signal_t sig = __dbc_message_add_signal_len(
+        msg, def, strlen(def->name), def->unit == NULL ? 0 : strlen(def->unit));
+    if (likely(sig != NULL)) {
+        __dbc_message_build_mux(msg);
+    }
+    return sig;
+}
+
+size_t __dbc_message_find_signal_index_len(const dbc_message_t msg,
+                                           const char* name,
+                                           const size_t len) {
+    __dbc_message_load_signals(msg);
+    // Once loaded, the table only changes through dbc_message_add_signal, so
+    // readers need no lock.
+    if (unlikely(msg->cap_signal_slots == 0)) {
+        return SIZE_MAX;
+    }
+
+    const uint32_t slot = *__dbc_message_probe_signal(
+        msg, msg->signal_slots, msg->cap_signal_slots, name, len);
+    return slot == 0 ? SIZE_MAX : slot - 1;
+}
+
+dbc_signal_t __dbc_message_find_signal_len(const dbc_message_t msg,
+                                           const char* name,
+                                           const size_t len) {
+    const size_t idx = __dbc_message_find_signal_index_len(msg, name, len);
+    return idx == SIZE_MAX ? NULL : msg->signals[idx];
+}
+
+size_t __dbc_message_get_signal_index(const dbc_message_t msg,
+                                      const dbc_signal_t sig) {
+    __dbc_message_load_signals(msg);
+    const size_t idx = sig->index;
+    return idx < msg->num_signals && msg->signals[idx] == sig ? idx : SIZE_MAX;
+}
+
+dbc_signal_t dbc_message_get_signal_by_name(const dbc_message_t msg,
+                                            const char* name) {
+    return __dbc_message_find_signal_len(msg, name, strlen(name));
+}
+
+bool __dbc_message_set_mux_len(dbc_message_t msg, dbc_signal_t sig,
+                               dbc_signal_t multiplexor,
+                               const dbc_mux_range_t* ranges, const size_t n,
+                               const bool shared) {
+    if (unlikely(!__dbc_signal_set_mux_ranges(sig, multiplexor, ranges, n,
+                                              shared))) {
+        return false;
+    }
+    msg->multiplexed = true;
+    msg->mux_plan = NULL;
+    return true;
+}
+
+bool dbc_message_set_signal_mux(dbc_message_t msg, dbc_signal_t sig,
+                                dbc_signal_t multiplexor,
+                                const dbc_mux_range_t* ranges,
+                                const size_t n) {
+    __dbc_message_load_signals(msg);
+    if (unlikely(multiplexor == sig
+                 || (multiplexor != NULL && !multiplexor->is_multiplexor))) {
+        return false;
+    }
+    return __dbc_message_set_mux_len(msg, sig, multiplexor, ranges, n, false)
+        && __dbc_message_build_mux(msg);
+}
+
+/**
+ * @brief Finds the switch among the signals loaded so far.
+ */
+static dbc_signal_t __dbc_message_switch(const dbc_message_t msg) {
+    for (size_t i = 0; i < msg->num_signals; i++) {
+        const dbc_signal_t sig = msg->signals[i];
+        if (sig->is_multiplexor && !sig->is_multiplexed) {
+            return sig;
+        }
+    }
+    return NULL;
+}
+
+dbc_signal_t dbc_message_get_multiplexor(const dbc_message_t msg) {
+    __dbc_message_load_signals(msg);
+    return __dbc_message_switch(msg);
+}
+
+static inline bool __dbc_mux_in_ranges(const dbc_signal_t sig,
+                                       const uint64_t value) {
+    for (size_t i = 0; i < sig->num_mux_ranges; i++) {
+        if (value >= sig->mux_ranges[i].min
+            && value <= sig->mux_ranges[i].max) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Whether the signal is present in the payload, following its chain
+ *        of multiplexors up to the switch.
+ */
+static bool __dbc_mux_present(const dbc_signal_t sw, dbc_signal_t sig,
+                              const uint8_t* payload, const size_t len) {
+    for (unsigned depth = 0; sig->is_multiplexed; depth++) {
+        const dbc_signal_t mux = sig->multiplexor != NULL ? sig->multiplexor
+                                                          : sw;
+        // Chains that do not end, or end nowhere, select nothing.
+        if (unlikely(mux == NULL || depth == MUX_MAX_DEPTH)) {
+            return false;
+        }
+        if (!__dbc_mux_in_ranges(
+                sig, __dbc_codec_extract(&mux->codec, payload, len))) {
+            return false;
+        }
+        sig = mux;
+    }
+    return true;
+}
+
+/**
+ * @return How many multiplexors there are between the signal and the switch,
+ *         0 for signals that are not multiplexed.
+ */
+static unsigned __dbc_mux_depth(const dbc_signal_t sw, dbc_signal_t sig) {
+    unsigned depth = 0;
+    while (sig->is_multiplexed && depth < MUX_MAX_DEPTH) {
+        sig = sig->multiplexor != NULL ? sig->multiplexor : sw;
+        if (sig == NULL) {
+            break;
+        }
+        depth++;
+    }
+    return depth;
+}
+
+/**
+ * @brief Decides whether the switch's jump table can select the signal.
+ * @param span Receives the number of switch values it is present for.
+ */
+static bool __dbc_mux_is_case(const dbc_signal_t sw, const dbc_signal_t sig,
+                              size_t* span) {
+    if (sw == NULL || (sig->multiplexor != NULL && sig->multiplexor != sw)) {
+        return false;
+    }
+
+    *span = 0;
+    for (size_t i = 0; i < sig->num_mux_ranges; i++) {
+        const dbc_mux_range_t range = sig->mux_ranges[i];
+        if (range.min > range.max || range.max >= MUX_MAX_CASES) {
+            return false;
+        }
+        *span += (size_t)(range.max - range.min + 1);
+    }
+    return *span <= MUX_MAX_CASE_SPAN;
+}
+
+/**
+ * @brief Sorts signal indices by the depth of the signals.
+ */
+static void __dbc_mux_sort_by_depth(const dbc_message_t msg,
+                                    const dbc_signal_t sw, uint32_t* idx,
+                                    const size_t n) {
+    // Few signals are nested, insertion sort is fine.
+    for (size_t i = 1; i < n; i++) {
+        const uint32_t cur = idx[i];
+        const unsigned depth = __dbc_mux_depth(sw, msg->signals[cur]);
+        size_t j = i;
+        while (j > 0 && __dbc_mux_depth(sw, msg->signals[idx[j - 1]]) > depth) {
+            idx[j] = idx[j - 1];
+            j--;
+        }
+        idx[j] = cur;
+    }
+}
+
+bool __dbc_message_build_mux(dbc_message_t msg) {
+    if (!msg->multiplexed || msg->mux_plan != NULL) {
+        return true;
+    }
+
+    const dbc_signal_t sw = __dbc_message_switch(msg);
+    size_t num_fixed = 0;
+    size_t num_dynamic = 0;
+    size_t num_entries = 0;
+    size_t num_cases = 0;
+    for (size_t i = 0; i < msg->num_signals; i++) {
+        const dbc_signal_t sig = msg->signals[i];
+        size_t span;
+        if (!sig->is_multiplexed) {
+            num_fixed++;
+        } else if (__dbc_mux_is_case(sw, sig, &span)) {
+            num_entries += span;
+            for (size_t j = 0; j < sig->num_mux_ranges; j++) {
+                const size_t max = (size_t)sig->mux_ranges[j].max;
+                num_cases = max + 1 > num_cases ? max + 1 : num_cases;
+            }
+        } else {
+            num_dynamic++;
+        }
+    }
+    const size_t num_muxed = msg->num_signals - num_fixed;
+
+    // Everything goes to the arena, an outdated plan is simply left behind.
+    dbc_mux_plan_t* const plan = (dbc_mux_plan_t*)__dbc_arena_calloc(
+        msg->arena, sizeof(dbc_mux_plan_t));
+    uint32_t* const idx = (uint32_t*)__dbc_arena_alloc(
+        msg->arena, (num_fixed + num_entries + num_dynamic + num_muxed + 1)
+                        * sizeof(uint32_t));
+    uint32_t* const case_starts = (uint32_t*)__dbc_arena_calloc(
+        msg->arena, (num_cases + 1) * sizeof(uint32_t));
+    if (unlikely(plan == NULL || idx == NULL || case_starts == NULL)) {
+        return false;
+    }
+    plan->sw = sw;
+    plan->fixed = idx;
+    plan->case_signals = idx + num_fixed;
+    plan->dynamic = plan->case_signals + num_entries;
+    plan->muxed = plan->dynamic + num_dynamic;
+    plan->case_starts = case_starts;
+    plan->num_cases = num_cases;
+
+    // The jump table is filled as by a counting sort: count the signals of
+    // every case, turn the counts into starts, then use the starts as
+    // cursors, which leaves them one case ahead.
+    for (size_t i = 0; i < msg->num_signals; i++) {
+        const dbc_signal_t sig = msg->signals[i];
+        size_t span;
+        if (sig->is_multiplexed && __dbc_mux_is_case(sw, sig, &span)) {
+            for (size_t j = 0; j < sig->num_mux_ranges; j++) {
+                for (uint64_t v = sig->mux_ranges[j].min;
+                     v <= sig->mux_ranges[j].max; v++) {
+                    case_starts[v + 1]++;
+                }
+            }
+        }
+    }
+    for (size_t v = 0; v < num_cases; v++) {
+        case_starts[v + 1] += case_starts[v];
+    }
+    for (size_t i = 0; i < msg->num_signals; i++) {
+        const dbc_signal_t sig = msg->signals[i];
+        size_t span;
+        if (!sig->is_multiplexed) {
+            plan->fixed[plan->num_fixed++] = (uint32_t)i;
+            continue;
+        }
+
+        plan->muxed[plan->num_muxed++] = (uint32_t)i;
+        if (!__dbc_mux_is_case(sw, sig, &span)) {
+            plan->dynamic[plan->num_dynamic++] = (uint32_t)i;
+            continue;
+        }
+        for (size_t j = 0; j < sig->num_mux_ranges; j++) {
+            for (uint64_t v = sig->mux_ranges[j].min;
+                 v <= sig->mux_ranges[j].max; v++) {
+                plan->case_signals[case_starts[v]++] = (uint32_t)i;
+            }
+        }
+    }
+    for (size_t v = num_cases; v > 0; v--) {
+        case_starts[v] = case_starts[v - 1];
+    }
+    case_starts[0] = 0;
+
+    __dbc_mux_sort_by_depth(msg, sw, plan->dynamic, plan->num_dynamic);
+    __dbc_mux_sort_by_depth(msg, sw, plan->muxed, plan->num_muxed);
+    msg->mux_plan = plan;
+    return true;
+}
+
+size_t __dbc_message_get_memory(const dbc_message_t msg, size_t* num_signals,
+                                size_t* sig_bytes) {
+    *num_signals = msg->num_signals;
+    *sig_bytes = 0;
+    for (size_t i = 0; i < msg->num_signals; i++) {
+        const dbc_signal_t sig = msg->signals[i];
+        *sig_bytes += sizeof(struct dbc_signal)
+                      + sig->cap_receivers * sizeof(const char*)
+                      + sig->num_mux_ranges * sizeof(dbc_mux_range_t);
+    }
+
+    size_t bytes = sizeof(struct dbc_message)
+                   + msg->cap_signals * sizeof(dbc_signal_t)
+                   + msg->cap_signal_slots * sizeof(uint32_t);
+    const dbc_mux_plan_t* const plan = msg->mux_plan;
+    if (plan != NULL) {
+        const size_t num_entries = plan->case_starts[plan->num_cases];
+        bytes += sizeof(dbc_mux_plan_t)
+                 + (plan->num_fixed + num_entries + plan->num_dynamic
+                    + plan->num_muxed + 1 + plan->num_cases + 1)
+                       * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+void __dbc_build_mux(dbc_t dbc) {
+    // Messages whose signals are yet to be loaded get their plans when they
+    // are.
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INDEX);
+    for (size_t i = 0; i < dbc_get_num_messages(dbc); i++) {
+        const dbc_message_t msg = dbc_get_message(dbc, i);
+        if (msg->lazy_signals == NULL) {
+            __dbc_message_build_mux(msg);
+        }
+    }
+    DBC_INSTR_POP();
+}
+
+size_t dbc_message_get_num_signals(const dbc_message_t msg) {
+    __dbc_message_load_signals(msg);
+    return msg->num_signals;
+}
+
+dbc_signal_t dbc_message_get_signal(const dbc_message_t msg,
+                                    const size_t idx) {
+    __dbc_message_load_signals(msg);
+    if (unlikely(idx >= msg->num_signals)) {
+        return NULL;
+    }
+
+    return msg->signals[idx];
+}
+
+static inline double __dbc_message_decode_one(const dbc_message_t msg,
+                                              const size_t idx,
+                                              const uint8_t* payload,
+                                              const size_t len) {
+    const dbc_signal_codec_t* const codec = &msg->signals[idx]->codec;
+    return __dbc_codec_to_physical(codec,
+                                   __dbc_codec_extract(codec, payload, len));
+}
+
+static inline void __dbc_message_encode_one(const dbc_message_t msg,
+                                            const size_t idx,
+                                            const double value,
+                                            uint8_t* payload,
+                                            const size_t len) {
+    const dbc_signal_codec_t* const codec = &msg->signals[idx]->codec;
+    __dbc_codec_insert(codec, __dbc_codec_from_physical(codec, value), payload,
+                       len);
+}
+
+/**
+ * @brief Decodes the multiplexed signals a frame holds. The others are left
+ *        as they are.
+ * @param out_stride The distance between two signals' values in out.
+ */
+static void __dbc_message_decode_muxed(const dbc_message_t msg,
+                                       const dbc_mux_plan_t* plan,
+                                       const uint8_t* payload,
+                                       const size_t len, double* out,
+                                       const size_t out_stride) {
+    // The switch is read once, and selects the signals to decode right away.
+    if (plan->num_cases != 0) {
+        const uint64_t sw =
+            __dbc_codec_extract(&plan->sw->codec, payload, len);
+        if (sw < plan->num_cases) {
+            for (uint32_t k = plan->case_starts[sw];
+                 k < plan->case_starts[sw + 1]; k++) {
+                const uint32_t i = plan->case_signals[k];
+                out[i * out_stride] =
+                    __dbc_message_decode_one(msg, i, payload, len);
+            }
+        }
+    }
+
+    for (size_t k = 0; k < plan->num_dynamic; k++) {
+        const uint32_t i = plan->dynamic[k];
+        if (__dbc_mux_present(plan->sw, msg->signals[i], payload, len)) {
+            out[i * out_stride] =
+                __dbc_message_decode_one(msg, i, payload, len);
+        }
+    }
+}
+
+void dbc_message_decode(const dbc_message_t msg, const uint8_t* payload,
+                        const size_t len, double* out) {
+    __dbc_message_load_signals(msg);
+    if (likely(!msg->multiplexed)) {
+        for (size_t i = 0; i < msg->num_signals; i++) {
+            out[i] = __dbc_message_decode_one(msg, i, payload, len);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < msg->num_signals; i++) {
+        out[i] = NAN;
+    }
+    const dbc_mux_plan_t* const plan = msg->mux_plan;
+    if (unlikely(plan == NULL)) {
+        // The plan could not be built, so look at every signal.
+        const dbc_signal_t sw = __dbc_message_switch(msg);
+        for (size_t i = 0; i < msg->num_signals; i++) {
+            if (__dbc_mux_present(sw, msg->signals[i], payload, len)) {
+                out[i] = __dbc_message_decode_one(msg, i, payload, len);
+            }
+        }
+        return;
+    }
+
+    for (size_t k = 0; k < plan->num_fixed; k++) {
+        const uint32_t i = plan->fixed[k];
+        out[i] = __dbc_message_decode_one(msg, i, payload, len);
+    }
+    __dbc_message_decode_muxed(msg, plan, payload, len, out, 1);
+}
+
+void dbc_message_decode_batch(const dbc_message_t msg, const uint8_t* payloads,
+                              const size_t len, const size_t stride,
+                              const size_t n, double* const* out_columns) {
+    __dbc_message_load_signals(msg);
+    const dbc_mux_plan_t* const plan = msg->mux_plan;
+    if (likely(!msg->multiplexed) || unlikely(plan == NULL)) {
+        for (size_t i = 0; i < msg->num_signals; i++) {
+            __dbc_codec_decode_batch(&msg->signals[i]->codec, payloads, len,
+                                     stride, n, out_columns[i]);
+        }
+        if (unlikely(msg->multiplexed)) {
+            const dbc_signal_t sw = __dbc_message_switch(msg);
+            for (size_t i = 0; i < msg->num_signals; i++) {
+                for (size_t j = 0; j < n; j++) {
+                    if (!__dbc_mux_present(sw, msg->signals[i],
+                                           payloads + j * stride, len)) {
+                        out_columns[i][j] = NAN;
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // Signals present in every frame are decoded a column at a time, the
+    // multiplexed ones frame by frame.
+    for (size_t k = 0; k < plan->num_fixed; k++) {
+        const uint32_t i = plan->fixed[k];
+        __dbc_codec_decode_batch(&msg->signals[i]->codec, payloads, len,
+                                 stride, n, out_columns[i]);
+    }
+    for (size_t k = 0; k < plan->num_muxed; k++) {
+        double* const column = out_columns[plan->muxed[k]];
+        for (size_t j = 0; j < n; j++) {
+            column[j] = NAN;
+        }
+    }
+    for (size_t j = 0; j < n; j++) {
+        const uint8_t* const payload = payloads + j * stride;
+        if (plan->num_cases != 0) {
+            const uint64_t sw =
+                __dbc_codec_extract(&plan->sw->codec, payload, len);
+            if (sw < plan->num_cases) {
+                for (uint32_t k = plan->case_starts[sw];
+                     k < plan->case_starts[sw + 1]; k++) {
+                    const uint32_t i = plan->case_signals[k];
+                    out_columns[i][j] =
+                        __dbc_message_decode_one(msg, i, payload, len);
+                }
+            }
+        }
+        for (size_t k = 0; k < plan->num_dynamic; k++) {
+            const uint32_t i = plan->dynamic[k];
+            if (__dbc_mux_present(plan->sw, msg->signals[i], payload, len)) {
+                out_columns[i][j] =
+                    __dbc_message_decode_one(msg, i, payload, len);
+            }
+        }
+    }
+}
+
+void dbc_message_encode(const dbc_message_t msg, const double* values,
+                        uint8_t* payload, const size_t len) {
+    __dbc_message_load_signals(msg);
+    memset(payload, 0, len);
+    const dbc_mux_plan_t* const plan = msg->mux_plan;
+    if (likely(!msg->multiplexed)) {
+        for (size_t i = 0; i < msg->num_signals; i++) {
+            __dbc_message_encode_one(msg, i, values[i], payload, len);
+        }
+        return;
+    }
+
+    if (unlikely(plan == NULL)) {
+        // The plan could not be built. Multiplexors have to be in the
+        // payload before the signals they select, so go by depth.
+        const dbc_signal_t sw = __dbc_message_switch(msg);
+        for (unsigned depth = 0; depth <= MUX_MAX_DEPTH; depth++) {
+            for (size_t i = 0; i < msg->num_signals; i++) {
+                const dbc_signal_t sig = msg->signals[i];
+                if (__dbc_mux_depth(sw, sig) == depth
+                    && __dbc_mux_present(sw, sig, payload, len)) {
+                    __dbc_message_encode_one(msg, i, values[i], payload, len);
+                }
+            }
+        }
+        return;
+    }
+
+    // The switch is among the fixed signals, so it is in the payload before
+    // the jump table is consulted.
+    for (size_t k = 0; k < plan->num_fixed; k++) {
+        const uint32_t i = plan->fixed[k];
+        __dbc_message_encode_one(msg, i, values[i], payload, len);
+    }
+    if (plan->num_cases != 0) {
+        const uint64_t sw =
+            __dbc_codec_extract(&plan->sw->codec, payload, len);
+        if (sw < plan->num_cases) {
+            for (uint32_t k = plan->case_starts[sw];
+                 k < plan->case_starts[sw + 1]; k++) {
+                const uint32_t i = plan->case_signals[k];
+                __dbc_message_encode_one(msg, i, values[i], payload, len);
+            }
+        }
+    }
+    for (size_t k = 0; k < plan->num_dynamic; k++) {
+        const uint32_t i = plan->dynamic[k];
+        if (__dbc_mux_present(plan->sw, msg->signals[i], payload, len)) {
+            __dbc_message_encode_one(msg, i, values[i], payload, len);
+        }
+    }
+}
+
+void dbc_message_encode_batch(const dbc_message_t msg,
+                              const double* const* columns, const size_t n,
+                              uint8_t* payloads, const size_t len,
+                              const size_t stride) {
+    __dbc_message_load_signals(msg);
+    for (size_t j = 0; j < n; j++) {
+        memset(payloads + j * stride, 0, len);
+    }
+
+    // A signal at a time, as when decoding, so only one codec is in use.
+    const dbc_mux_plan_t* const plan = msg->mux_plan;
+    if (likely(!msg->multiplexed) || unlikely(plan == NULL)) {
+        if (unlikely(msg->multiplexed)) {
+            // The plan could not be built, go by depth as dbc_message_encode
+            // does.
+            const dbc_signal_t sw = __dbc_message_switch(msg);
+            for (unsigned depth = 0; depth <= MUX_MAX_DEPTH; depth++) {
+                for (size_t i = 0; i < msg->num_signals; i++) {
+                    const dbc_signal_t sig = msg->signals[i];
+                    if (__dbc_mux_depth(sw, sig) != depth) {
+                        continue;
+                    }
+                    for (size_t j = 0; j < n; j++) {
+                        uint8_t* const payload = payloads + j * stride;
+                        if (__dbc_mux_present(sw, sig, payload, len)) {
+                            __dbc_message_encode_one(msg, i, columns[i][j],
+                                                     payload, len);
+                        }
+                    }
+                }
+            }
+            return;
+        }
+
+        for (size_t i = 0; i < msg->num_signals; i++) {
+            const double* const column = columns[i];
+            for (size_t j = 0; j < n; j++) {
+                __dbc_message_encode_one(msg, i, column[j],
+                                         payloads + j * stride, len);
+            }
+        }
+        return;
+    }
+
+    for (size_t k = 0; k < plan->num_fixed; k++) {
+        const uint32_t i = plan->fixed[k];
+        const double* const column = columns[i];
+        for (size_t j = 0; j < n; j++) {
+            __dbc_message_encode_one(msg, i, column[j], payloads + j * stride,
+                                     len);
+        }
+    }
+    // Multiplexors come first, so they are in place for the signals they
+    // select.
+    for (size_t k = 0; k < plan->num_muxed; k++) {
+        const uint32_t i = plan->muxed[k];
+        const dbc_signal_t sig = msg->signals[i];
+        const double* const column = columns[i];
+        for (size_t j = 0; j < n; j++) {
+            uint8_t* const payload = payloads + j * stride;
+            if (__dbc_mux_present(plan->sw, sig, payload, len)) {
+                __dbc_message_encode_one(msg, i, column[j], payload, len);
+            }
+        }
+    }
+}
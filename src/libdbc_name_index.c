@@ -0,0 +1,244 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "__libdbc_name_index.h"
+#include <string.h>
+
+#define NAME_INDEX_INITIAL_CAPACITY (16U)
+
+static inline size_t __dbc_name_hash(const char* name) {
+    uint64_t x = (uint64_t)(uintptr_t)name;
+    x ^= x >> 33;
+    x *= UINT64_C(0xff51afd7ed558ccd);
+    x ^= x >> 33;
+    return (size_t)x;
+}
+
+static uint32_t* __dbc_name_index_probe(const dbc_name_index_t* index,
+                                        uint32_t* slots, const size_t cap,
+                                        const char* name) {
+    const size_t mask = cap - 1;
+    for (size_t i = __dbc_name_hash(name) & mask;; i = (i + 1) & mask) {
+        if (slots[i] == 0 || index->entries[slots[i] - 1].name == name) {
+            return &slots[i];
+        }
+    }
+}
+
+static bool __dbc_name_index_grow(dbc_name_index_t* index) {
+    const size_t new_cap =
+        index->cap == 0 ? NAME_INDEX_INITIAL_CAPACITY : index->cap * 2;
+    uint32_t* const new_slots = (uint32_t*)calloc(new_cap, sizeof(uint32_t));
+    if (unlikely(new_slots == NULL)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < index->cap; i++) {
+        if (index->slots[i] != 0) {
+            *__dbc_name_index_probe(
+                index, new_slots, new_cap,
+                index->entries[index->slots[i] - 1].name) = index->slots[i];
+        }
+    }
+
+    free(index->slots);
+    index->slots = new_slots;
+    index->cap = new_cap;
+    return true;
+}
+
+bool __dbc_name_index_insert(dbc_name_index_t* index, const char* name,
+                             void* obj, void* owner, const size_t pos) {
+    if (unlikely(index->num_entries == index->cap_entries)) {
+        const size_t new_cap = index->cap_entries == 0
+            ? NAME_INDEX_INITIAL_CAPACITY
+            : index->cap_entries * 2;
+        if (unlikely(new_cap > UINT32_MAX)) {
+            return false;
+        }
+        dbc_name_entry_t* const entries = (dbc_name_entry_t*)realloc(
+            index->entries, new_cap * sizeof(dbc_name_entry_t));
+        if (unlikely(entries == NULL)) {
+            return false;
+        }
+        index->entries = entries;
+        index->cap_entries = new_cap;
+    }
+    // Keep the load factor under 1/2, so probe sequences stay short.
+    if (unlikely((index->num_entries + 1) * 2 > index->cap)
+        && unlikely(!__dbc_name_index_grow(index))) {
+        return false;
+    }
+
+    dbc_name_entry_t* const entry = &index->entries[index->num_entries];
+    entry->name = name;
+    entry->obj = obj;
+    entry->owner = owner;
+    entry->pos = (uint32_t)pos;
+    entry->next = 0;
+    index->num_entries++;
+
+    uint32_t* const slot =
+        __dbc_name_index_probe(index, index->slots, index->cap, name);
+    if (*slot == 0) {
+        *slot = (uint32_t)index->num_entries;
+    } else {
+        // Chained right behind the first, which keeps insertion constant.
+        dbc_name_entry_t* const first = &index->entries[*slot - 1];
+        entry->next = first->next;
+        first->next = (uint32_t)index->num_entries;
+    }
+
+    free(index->sorted);
+    index->sorted = NULL;
+    return true;
+}
+
+void __dbc_name_index_release(dbc_name_index_t* index) {
+    free(index->slots);
+    free(index->entries);
+    free(index->sorted);
+    memset(index, 0, sizeof(*index));
+}
+
+size_t __dbc_name_index_get_memory(const dbc_name_index_t* index) {
+    size_t bytes = index->cap * sizeof(uint32_t)
+                   + index->cap_entries * sizeof(dbc_name_entry_t);
+    if (__atomic_load_n(&index->sorted, __ATOMIC_ACQUIRE) != NULL) {
+        bytes += (index->num_entries + 1) * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+const dbc_name_entry_t* __dbc_name_index_find(const dbc_name_index_t* index,
+                                              const char* name) {
+    if (unlikely(index->cap == 0 || name == NULL)) {
+        return NULL;
+    }
+
+    const uint32_t slot =
+        *__dbc_name_index_probe(index, index->slots, index->cap, name);
+    return slot == 0 ? NULL : &index->entries[slot - 1];
+}
+
+const dbc_name_entry_t* __dbc_name_index_next(const dbc_name_index_t* index,
+                                              const dbc_name_entry_t* entry) {
+    return entry->next == 0 ? NULL : &index->entries[entry->next - 1];
+}
+
+/**
+ * @brief Orders entry indices by name, then by index, which keeps equal
+ *        names in the order added.
+ */
+static void __dbc_name_index_sort(const dbc_name_entry_t* entries,
+                                  uint32_t* idx, uint32_t* tmp,
+                                  const size_t n) {
+    // A merge sort, as qsort can not be handed the entries.
+    if (n < 2) {
+        return;
+    }
+
+    const size_t half = n / 2;
+    __dbc_name_index_sort(entries, idx, tmp, half);
+    __dbc_name_index_sort(entries, idx + half, tmp, n - half);
+
+    size_t i = 0;
+    size_t j = half;
+    size_t k = 0;
+    while (i < half && j < n) {
+        tmp[k++] = strcmp(entries[idx[j]].name, entries[idx[i]].name) < 0
+            ? idx[j++]
+            : idx[i++];
+    }
+    while (i < half) {
+        tmp[k++] = idx[i++];
+    }
+    while (j < n) {
+        tmp[k++] = idx[j++];
+    }
+    memcpy(idx, tmp, n * sizeof(uint32_t));
+}
+
+/**
+ * @return The entry indices sorted by name, NULL if out of memory.
+ */
+static const uint32_t* __dbc_name_index_sorted(dbc_name_index_t* index) {
+    uint32_t* sorted = __atomic_load_n(&index->sorted, __ATOMIC_ACQUIRE);
+    if (likely(sorted != NULL)) {
+        return sorted;
+    }
+
+    const size_t n = index->num_entries;
+    sorted = (uint32_t*)malloc((n + 1) * sizeof(uint32_t));
+    uint32_t* const tmp = (uint32_t*)malloc((n + 1) * sizeof(uint32_t));
+    if (unlikely(sorted == NULL || tmp == NULL)) {
+        free(sorted);
+        free(tmp);
+        return NULL;
+    }
+    for (size_t i = 0; i < n; i++) {
+        sorted[i] = (uint32_t)i;
+    }
+    __dbc_name_index_sort(index->entries, sorted, tmp, n);
+    free(tmp);
+
+    // Readers may race to sort, the first one to finish wins.
+    uint32_t* expected = NULL;
+    if (!__atomic_compare_exchange_n(&index->sorted, &expected, sorted, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        free(sorted);
+        return expected;
+    }
+    return sorted;
+}
+
+size_t __dbc_name_index_prefix(dbc_name_index_t* index, const char* prefix,
+                               size_t* first) {
+    const uint32_t* const sorted = __dbc_name_index_sorted(index);
+    if (unlikely(sorted == NULL)) {
+        return SIZE_MAX;
+    }
+
+    // The matches are a run, starting at the first name not below the prefix.
+    const size_t len = strlen(prefix);
+    size_t lo = 0;
+    size_t hi = index->num_entries;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (strcmp(index->entries[sorted[mid]].name, prefix) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    size_t end = lo;
+    while (end < index->num_entries
+           && strncmp(index->entries[sorted[end]].name, prefix, len) == 0) {
+        end++;
+    }
+    *first = lo;
+    return end - lo;
+}
+
+const dbc_name_entry_t* __dbc_name_index_sorted_at(
+    const dbc_name_index_t* index, const size_t pos) {
+    const uint32_t* const sorted =
+        __atomic_load_n(&index->sorted, __ATOMIC_ACQUIRE);
+    return &index->entries[sorted[pos]];
+}
@@ -18,22 +18,66 @@
 
 #include "libdbc_node.h"
 #include <stdlib.h>
-#include "sds.h"
+#include <string.h>
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_strpool.h"
 
 struct dbc_node {
-    sds name;
+    const char* name;
+    // Nodes created by dbc_node_new are heap allocated, those created by a
+    // dbc live in (and die with) its arena.
+    bool on_heap;
 };
 
+dbc_node_t __dbc_node_new_in(dbc_arena_t arena, const char* name) {
+    const dbc_node_t dbc_node =
+        (dbc_node_t)__dbc_arena_alloc(arena, sizeof(struct dbc_node));
+    if (unlikely(dbc_node == NULL)) {
+        return NULL;
+    }
+
+    dbc_node->name = name;
+    dbc_node->on_heap = false;
+    return dbc_node;
+}
+
+size_t __dbc_node_get_memory(const dbc_node_t node) {
+    return node->on_heap ? sizeof(struct dbc_node) + strlen(node->name) + 1
+                         : sizeof(struct dbc_node);
+}
+
+const char* __dbc_node_adopt(dbc_node_t node, dbc_strpool_t strings) {
+    const size_t len = strlen(node->name);
+    // A heap node's name dies with it, so the pool takes a copy.
+    if (node->on_heap) {
+        return __dbc_strpool_intern(strings, node->name, len);
+    }
+
+    const char* const adopted = __dbc_strpool_adopt(strings, node->name, len);
+    if (likely(adopted != NULL)) {
+        node->name = adopted;
+    }
+    return adopted;
+}
+
 dbc_node_t dbc_node_new(const char* name) {
-    dbc_node_t dbc_node = (dbc_node_t)malloc(sizeof(struct dbc_node));
-    dbc_node->name = sdsnew(name);
+    // The name lives right behind the node, so this is a single allocation.
+    const size_t len = strlen(name);
+    dbc_node_t dbc_node =
+        (dbc_node_t)malloc(sizeof(struct dbc_node) + len + 1);
+    char* const name_copy = (char*)(dbc_node + 1);
+    memcpy(name_copy, name, len + 1);
 
+    dbc_node->name = name_copy;
+    dbc_node->on_heap = true;
     return dbc_node;
 }
 
 void dbc_node_free(const dbc_node_t dbc_node) {
-    sdsfree(dbc_node->name);
-    free(dbc_node);
+    if (dbc_node->on_heap) {
+        free(dbc_node);
+    }
 }
 
 const char* dbc_node_get_name(const dbc_node_t dbc_node) {
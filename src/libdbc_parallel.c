@@ -0,0 +1,175 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define LIBDBC_HAVE_PTHREAD
+#endif
+
+#include "libdbc_parser.h"
+#include "__libdbc.h"
+
+#ifdef LIBDBC_HAVE_PTHREAD
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+// Below this much text per thread, starting threads costs more than it saves.
+#define PARALLEL_MIN_PIECE_SIZE (256U * 1024U)
+
+typedef struct {
+    const char* buf;
+    size_t len;
+    dbc_t dbc;
+    dbc_parse_status_t status;
+} dbc_parse_piece_t;
+
+static void* __dbc_parse_piece(void* arg) {
+    dbc_parse_piece_t* const piece = (dbc_parse_piece_t*)arg;
+    piece->dbc = dbc_new();
+    if (unlikely(piece->dbc == NULL)) {
+        piece->status = DBC_PARSE_IO_ERROR;
+        return NULL;
+    }
+
+    // The messages a statement is about may be in another piece.
+    __dbc_set_deferring(piece->dbc, true);
+    piece->status = __dbc_parse_into(piece->dbc, piece->buf, piece->len);
+    return NULL;
+}
+
+size_t __dbc_num_threads(const size_t requested, const size_t len,
+                         const size_t min_piece_size) {
+    size_t num_threads = requested;
+#ifdef LIBDBC_HAVE_PTHREAD
+    if (num_threads == 0) {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        num_threads = online > 0 ? (size_t)online : 1;
+    }
+#else
+    num_threads = 1;
+#endif
+
+    const size_t max_threads = len / min_piece_size;
+    num_threads = num_threads < max_threads ? num_threads : max_threads;
+    num_threads =
+        num_threads < DBC_MAX_THREADS ? num_threads : DBC_MAX_THREADS;
+    return num_threads == 0 ? 1 : num_threads;
+}
+
+void __dbc_run_pieces(void* (*worker)(void*), void* pieces,
+                      const size_t piece_size, const size_t num_pieces) {
+    char* const base = (char*)pieces;
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_t threads[DBC_MAX_THREADS];
+    bool started[DBC_MAX_THREADS] = { false };
+    for (size_t i = 1; i < num_pieces; i++) {
+        started[i] = pthread_create(&threads[i], NULL, worker,
+                                    base + i * piece_size)
+                     == 0;
+    }
+    for (size_t i = 0; i < num_pieces; i++) {
+        if (!started[i]) {
+            worker(base + i * piece_size);
+        }
+    }
+    for (size_t i = 1; i < num_pieces; i++) {
+        if (started[i]) {
+            pthread_join(threads[i], NULL);
+        }
+    }
+#else
+    for (size_t i = 0; i < num_pieces; i++) {
+        worker(base + i * piece_size);
+    }
+#endif
+}
+
+dbc_t dbc_parse_buffer_parallel(const char* buf, size_t len,
+                                size_t num_threads,
+                                dbc_parse_status_t* status) {
+    num_threads = __dbc_num_threads(num_threads, len, PARALLEL_MIN_PIECE_SIZE);
+    if (num_threads == 1) {
+        return dbc_parse_buffer(buf, len, status);
+    }
+
+    const char* starts[DBC_MAX_THREADS];
+    dbc_parse_piece_t pieces[DBC_MAX_THREADS];
+    const size_t num_pieces =
+        __dbc_split_statements(buf, len, num_threads, starts);
+    for (size_t i = 0; i < num_pieces; i++) {
+        const char* const end = i + 1 < num_pieces ? starts[i + 1] : buf + len;
+        pieces[i].buf = starts[i];
+        pieces[i].len = (size_t)(end - starts[i]);
+    }
+
+    __dbc_run_pieces(__dbc_parse_piece, pieces, sizeof(pieces[0]),
+                     num_pieces);
+
+    // Merging in order makes the result independent of scheduling.
+    dbc_t dbc = pieces[0].dbc;
+    dbc_parse_status_t worst = pieces[0].status;
+    for (size_t i = 1; i < num_pieces; i++) {
+        worst = pieces[i].status > worst ? pieces[i].status : worst;
+        if (unlikely(pieces[i].dbc == NULL)) {
+            continue;
+        }
+        if (unlikely(dbc == NULL)) {
+            dbc_free(pieces[i].dbc);
+        } else if (unlikely(!__dbc_absorb(dbc, pieces[i].dbc))) {
+            worst = worst > DBC_PARSE_CRITICAL ? worst : DBC_PARSE_CRITICAL;
+        }
+    }
+
+    // Statements about messages of other pieces can be parsed now that all
+    // messages are known.
+    if (likely(dbc != NULL)) {
+        const dbc_parse_status_t deferred = __dbc_parse_deferred(dbc);
+        worst = deferred > worst ? deferred : worst;
+        __dbc_build_mux(dbc);
+        if (unlikely(!__dbc_sort_annotations(dbc))) {
+            worst = worst > DBC_PARSE_CRITICAL ? worst : DBC_PARSE_CRITICAL;
+        }
+    }
+
+    // A piece that never got a dbc of its own ran out of memory.
+    if (unlikely(worst == DBC_PARSE_IO_ERROR) && dbc != NULL) {
+        dbc_free(dbc);
+        dbc = NULL;
+    }
+    if (status != NULL) {
+        *status = worst;
+    }
+    return dbc;
+}
+
+dbc_t dbc_parse_file_parallel(const char* path, size_t num_threads,
+                              dbc_parse_status_t* status) {
+    dbc_file_map_t map;
+    if (unlikely(!__dbc_file_map(path, &map))) {
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+
+    const dbc_t dbc =
+        dbc_parse_buffer_parallel(map.data, map.len, num_threads, status);
+    __dbc_file_unmap(&map);
+    return dbc;
+}
@@ -0,0 +1,286 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "libdbc_signal.h"
+#include <math.h>
+#include <string.h>
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_signal.h"
+#include "__libdbc_strpool.h"
+
+#define SIGNAL_MAX_LENGTH (64U)
+// CAN FD frames carry up to 64 bytes.
+#define SIGNAL_MAX_PAYLOAD_BITS (64U * 8U)
+
+/**
+ * @brief Works out where the signal's bits are.
+ * @return false if the signal does not fit into any payload.
+ */
+static bool __dbc_signal_compile(dbc_signal_codec_t* codec,
+                                 const dbc_signal_def_t* def) {
+    const unsigned length = def->length;
+    if (unlikely(length == 0 || length > SIGNAL_MAX_LENGTH
+                 || def->start_bit >= SIGNAL_MAX_PAYLOAD_BITS)) {
+        return false;
+    }
+
+    codec->mask = length == 64 ? UINT64_MAX : (UINT64_C(1) << length) - 1;
+    codec->sign_bit = def->is_signed ? UINT64_C(1) << (length - 1) : 0;
+    codec->length = (uint8_t)length;
+    codec->factor = def->factor;
+    codec->offset = def->offset;
+    codec->big_endian = def->byte_order == DBC_BYTE_ORDER_BIG_ENDIAN;
+
+    if (codec->big_endian) {
+        // Count bits in the order they go out on the wire, where the start
+        // bit (the most significant one) of byte n, bit b is bit n*8 + 7 - b.
+        const unsigned msb = def->start_bit / 8 * 8 + 7 - def->start_bit % 8;
+        if (unlikely(msb + length > SIGNAL_MAX_PAYLOAD_BITS)) {
+            return false;
+        }
+
+        // Bits from the start of the first byte to the end of the signal.
+        const unsigned span = msb % 8 + length;
+        codec->byte_offset = (uint16_t)(msb / 8);
+        codec->spills = span > 64;
+        codec->shift = (uint8_t)(codec->spills ? span - 64 : 64 - span);
+        codec->spill_shift = (uint8_t)(codec->spills ? 72 - span : 0);
+        codec->word_mask = codec->spills ? codec->mask >> codec->shift
+                                         : codec->mask << codec->shift;
+        codec->spill_mask = (uint8_t)(codec->spills
+                                          ? codec->mask << codec->spill_shift
+                                          : 0);
+    } else {
+        if (unlikely(def->start_bit + length > SIGNAL_MAX_PAYLOAD_BITS)) {
+            return false;
+        }
+
+        const unsigned span = def->start_bit % 8 + length;
+        codec->byte_offset = (uint16_t)(def->start_bit / 8);
+        codec->spills = span > 64;
+        codec->shift = (uint8_t)(def->start_bit % 8);
+        codec->spill_shift = (uint8_t)(codec->spills ? 64 - codec->shift : 0);
+        codec->word_mask = codec->mask << codec->shift;
+        codec->spill_mask = (uint8_t)(codec->spills
+                                          ? codec->mask >> codec->spill_shift
+                                          : 0);
+    }
+
+    // A range of [0|0], or any other empty one, means the signal has none.
+    const bool ranged = def->min < def->max;
+    codec->min = ranged ? def->min : -INFINITY;
+    codec->max = ranged ? def->max : INFINITY;
+    codec->raw_limit = ldexp(1.0, (int)(def->is_signed ? length - 1 : length));
+
+    return true;
+}
+
+dbc_signal_t __dbc_signal_new_in(dbc_arena_t arena, dbc_strpool_t strings,
+                                 const dbc_signal_def_t* def,
+                                 const size_t name_len,
+                                 const size_t unit_len) {
+    dbc_signal_codec_t codec;
+    if (unlikely(!__dbc_signal_compile(&codec, def))) {
+        return NULL;
+    }
+
+    const dbc_signal_t sig =
+        (dbc_signal_t)__dbc_arena_calloc(arena, sizeof(struct dbc_signal));
+    if (unlikely(sig == NULL)) {
+        return NULL;
+    }
+
+    sig->codec = codec;
+    sig->name = __dbc_strpool_intern(strings, def->name, name_len);
+    sig->unit = __dbc_strpool_intern(strings,
+                                     def->unit == NULL ? "" : def->unit,
+                                     unit_len);
+    if (unlikely(sig->name == NULL || sig->unit == NULL)) {
+        return NULL;
+    }
+    sig->arena = arena;
+    sig->strings = strings;
+    sig->min = def->min;
+    sig->max = def->max;
+    sig->start_bit = def->start_bit;
+    sig->length = def->length;
+    sig->byte_order = def->byte_order;
+    sig->is_signed = def->is_signed;
+    sig->is_multiplexor = def->is_multiplexor;
+    sig->is_multiplexed = def->is_multiplexed;
+    if (def->is_multiplexed) {
+        const dbc_mux_range_t range = { def->mux_value, def->mux_value };
+        if (unlikely(!__dbc_signal_set_mux_ranges(sig, NULL, &range, 1,
+                                                  false))) {
+            return NULL;
+        }
+    }
+
+    return sig;
+}
+
+bool __dbc_signal_set_mux_ranges(dbc_signal_t sig, dbc_signal_t multiplexor,
+                                 const dbc_mux_range_t* ranges,
+                                 const size_t n, const bool shared) {
+    if (!shared) {
+        dbc_mux_range_t* const copy = (dbc_mux_range_t*)__dbc_arena_alloc(
+            sig->arena, (n == 0 ? 1 : n) * sizeof(dbc_mux_range_t));
+        if (unlikely(copy == NULL)) {
+            return false;
+        }
+        memcpy(copy, ranges, n * sizeof(dbc_mux_range_t));
+        ranges = copy;
+    }
+
+    sig->is_multiplexed = true;
+    sig->multiplexor = multiplexor;
+    sig->mux_ranges = ranges;
+    sig->num_mux_ranges = n;
+    return true;
+}
+
+bool __dbc_signal_adopt(dbc_signal_t sig, dbc_arena_t arena,
+                        dbc_strpool_t strings) {
+    bool success = __dbc_strpool_adopt_in_place(strings, &sig->name)
+        && __dbc_strpool_adopt_in_place(strings, &sig->unit);
+    for (size_t i = 0; success && i < sig->num_receivers; i++) {
+        success = __dbc_strpool_adopt_in_place(strings, &sig->receivers[i]);
+    }
+
+    sig->arena = arena;
+    sig->strings = strings;
+    return success;
+}
+
+bool __dbc_signal_add_receiver_len(dbc_signal_t sig, const char* name,
+                                   const size_t len) {
+    if (unlikely(!__dbc_vector_reserve(sig->arena, (void***)&sig->receivers,
+                                       &sig->cap_receivers,
+                                       sig->num_receivers))) {
+        return false;
+    }
+
+    const char* const interned = __dbc_strpool_intern(sig->strings, name, len);
+    if (unlikely(interned == NULL)) {
+        return false;
+    }
+    sig->receivers[sig->num_receivers++] = interned;
+    return true;
+}
+
+const char* dbc_signal_get_name(const dbc_signal_t sig) {
+    return sig->name;
+}
+
+uint16_t dbc_signal_get_start_bit(const dbc_signal_t sig) {
+    return sig->start_bit;
+}
+
+uint16_t dbc_signal_get_length(const dbc_signal_t sig) {
+    return sig->length;
+}
+
+dbc_byte_order_t dbc_signal_get_byte_order(const dbc_signal_t sig) {
+    return sig->byte_order;
+}
+
+bool dbc_signal_is_signed(const dbc_signal_t sig) {
+    return sig->is_signed;
+}
+
+double dbc_signal_get_factor(const dbc_signal_t sig) {
+    return sig->codec.factor;
+}
+
+double dbc_signal_get_offset(const dbc_signal_t sig) {
+    return sig->codec.offset;
+}
+
+double dbc_signal_get_min(const dbc_signal_t sig) {
+    return sig->min;
+}
+
+double dbc_signal_get_max(const dbc_signal_t sig) {
+    return sig->max;
+}
+
+const char* dbc_signal_get_unit(const dbc_signal_t sig) {
+    return sig->unit;
+}
+
+size_t dbc_signal_get_num_receivers(const dbc_signal_t sig) {
+    return sig->num_receivers;
+}
+
+const char* dbc_signal_get_receiver(const dbc_signal_t sig, const size_t idx) {
+    if (unlikely(idx >= sig->num_receivers)) {
+        return NULL;
+    }
+
+    return sig->receivers[idx];
+}
+
+bool dbc_signal_is_multiplexor(const dbc_signal_t sig) {
+    return sig->is_multiplexor;
+}
+
+bool dbc_signal_is_multiplexed(const dbc_signal_t sig) {
+    return sig->is_multiplexed;
+}
+
+dbc_signal_t dbc_signal_get_multiplexor(const dbc_signal_t sig) {
+    return sig->multiplexor;
+}
+
+size_t dbc_signal_get_num_mux_ranges(const dbc_signal_t sig) {
+    return sig->num_mux_ranges;
+}
+
+dbc_mux_range_t dbc_signal_get_mux_range(const dbc_signal_t sig,
+                                         const size_t idx) {
+    if (unlikely(idx >= sig->num_mux_ranges)) {
+        const dbc_mux_range_t empty = { 1, 0 };
+        return empty;
+    }
+
+    return sig->mux_ranges[idx];
+}
+
+uint64_t dbc_signal_decode_raw(const dbc_signal_t sig, const uint8_t* payload,
+                               const size_t len) {
+    return __dbc_codec_extract(&sig->codec, payload, len);
+}
+
+double dbc_signal_decode(const dbc_signal_t sig, const uint8_t* payload,
+                         const size_t len) {
+    return __dbc_codec_to_physical(
+        &sig->codec, __dbc_codec_extract(&sig->codec, payload, len));
+}
+
+void dbc_signal_encode_raw(const dbc_signal_t sig, const uint64_t raw,
+                           uint8_t* payload, const size_t len) {
+    __dbc_codec_insert(&sig->codec, raw, payload, len);
+}
+
+void dbc_signal_encode(const dbc_signal_t sig, const double value,
+                       uint8_t* payload, const size_t len) {
+    __dbc_codec_insert(&sig->codec,
+                       __dbc_codec_from_physical(&sig->codec, value), payload,
+                       len);
+}
@@ -0,0 +1,186 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#define _POSIX_C_SOURCE 200809L
+#define LIBDBC_HAVE_PTHREAD
+#endif
+
+#include "libdbc_snapshot.h"
+#include "__libdbc.h"
+
+#ifdef LIBDBC_HAVE_PTHREAD
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+struct dbc_snapshot {
+    dbc_t dbc;
+    size_t refs;
+};
+
+/*
+ * Readers find the current snapshot and take a reference to it in two steps,
+ * so a reload must not drop the replaced snapshot's last reference in
+ * between. Readers announce themselves in one of two counters, picked by the
+ * parity of the epoch, for the duration. After swapping the snapshot, a
+ * reload moves the epoch on and waits for the counter readers no longer pick
+ * to drain, twice, so that readers who read the epoch just before it moved
+ * are waited for as well. Whoever reads the epoch afterwards finds the new
+ * snapshot.
+ */
+struct dbc_handle {
+#ifdef LIBDBC_HAVE_PTHREAD
+    // Serializes reloads, readers never take it.
+    pthread_mutex_t lock;
+#endif
+    dbc_snapshot_t current;
+    size_t epoch;
+    size_t readers[2];
+};
+
+static dbc_snapshot_t __dbc_snapshot_new(dbc_t dbc) {
+    const dbc_snapshot_t snapshot =
+        (dbc_snapshot_t)malloc(sizeof(struct dbc_snapshot));
+    if (unlikely(snapshot == NULL)) {
+        dbc_free(dbc);
+        return NULL;
+    }
+
+    snapshot->dbc = dbc;
+    snapshot->refs = 1;
+    return snapshot;
+}
+
+dbc_handle_t dbc_handle_new(dbc_t dbc) {
+    const dbc_handle_t handle =
+        (dbc_handle_t)calloc(1, sizeof(struct dbc_handle));
+    if (unlikely(handle == NULL)) {
+        dbc_free(dbc);
+        return NULL;
+    }
+
+#ifdef LIBDBC_HAVE_PTHREAD
+    if (unlikely(pthread_mutex_init(&handle->lock, NULL) != 0)) {
+        free(handle);
+        dbc_free(dbc);
+        return NULL;
+    }
+#endif
+    handle->current = __dbc_snapshot_new(dbc);
+    if (unlikely(handle->current == NULL)) {
+        dbc_handle_free(handle);
+        return NULL;
+    }
+    return handle;
+}
+
+dbc_handle_t dbc_handle_open(const char* path, dbc_parse_status_t* status) {
+    const dbc_t dbc = dbc_parse_file(path, status);
+    return dbc == NULL ? NULL : dbc_handle_new(dbc);
+}
+
+void dbc_handle_free(dbc_handle_t handle) {
+    if (handle->current != NULL) {
+        dbc_snapshot_release(handle->current);
+    }
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_mutex_destroy(&handle->lock);
+#endif
+    free(handle);
+}
+
+dbc_snapshot_t dbc_handle_acquire(dbc_handle_t handle) {
+    const size_t epoch = __atomic_load_n(&handle->epoch, __ATOMIC_SEQ_CST);
+    size_t* const readers = &handle->readers[epoch & 1];
+    __atomic_add_fetch(readers, 1, __ATOMIC_SEQ_CST);
+
+    const dbc_snapshot_t snapshot =
+        __atomic_load_n(&handle->current, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&snapshot->refs, 1, __ATOMIC_RELAXED);
+
+    // Publishes the reference to the reload waiting on the counter.
+    __atomic_sub_fetch(readers, 1, __ATOMIC_RELEASE);
+    return snapshot;
+}
+
+dbc_t dbc_snapshot_get(const dbc_snapshot_t snapshot) {
+    return snapshot->dbc;
+}
+
+void dbc_snapshot_release(dbc_snapshot_t snapshot) {
+    if (__atomic_sub_fetch(&snapshot->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+        dbc_free(snapshot->dbc);
+        free(snapshot);
+    }
+}
+
+/**
+ * @brief Moves the epoch on and waits for the readers of the previous one.
+ */
+static void __dbc_handle_flip(dbc_handle_t handle) {
+    const size_t epoch = handle->epoch;
+    __atomic_store_n(&handle->epoch, epoch + 1, __ATOMIC_SEQ_CST);
+    while (__atomic_load_n(&handle->readers[epoch & 1], __ATOMIC_SEQ_CST)
+           != 0) {
+#ifdef LIBDBC_HAVE_PTHREAD
+        sched_yield();
+#endif
+    }
+}
+
+bool dbc_handle_publish(dbc_handle_t handle, dbc_t dbc) {
+    const dbc_snapshot_t snapshot = __dbc_snapshot_new(dbc);
+    if (unlikely(snapshot == NULL)) {
+        return false;
+    }
+
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_mutex_lock(&handle->lock);
+#endif
+    const dbc_snapshot_t old =
+        __atomic_exchange_n(&handle->current, snapshot, __ATOMIC_SEQ_CST);
+    __dbc_handle_flip(handle);
+    __dbc_handle_flip(handle);
+#ifdef LIBDBC_HAVE_PTHREAD
+    pthread_mutex_unlock(&handle->lock);
+#endif
+
+    // Every reader who found the old snapshot holds a reference by now.
+    dbc_snapshot_release(old);
+    return true;
+}
+
+bool dbc_reload(dbc_handle_t handle, const char* path,
+                dbc_parse_status_t* status) {
+    dbc_parse_status_t parsed;
+    const dbc_t dbc = dbc_parse_file(path, &parsed);
+    if (status != NULL) {
+        *status = parsed;
+    }
+    if (unlikely(dbc == NULL)) {
+        return false;
+    }
+    if (unlikely(parsed >= DBC_PARSE_CRITICAL)) {
+        // Half a database is worse than the previous one.
+        dbc_free(dbc);
+        return false;
+    }
+
+    return dbc_handle_publish(handle, dbc);
+}
@@ -0,0 +1,190 @@
+/**
+ * libdbc - The DBC File Library
+ * Copyright (C) 2023 Marko Vejnovic <contact@markovejnovic.clm
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "__libdbc_strpool.h"
+#include <stdint.h>
+#include <string.h>
+#include "__libdbc.h"
+
+#define STRPOOL_INITIAL_CAPACITY (64U)
+typedef struct {
+    // NULL marks an empty slot.
+    const char* str;
+    uint32_t len;
+    uint32_t hash;
+} dbc_strpool_slot_t;
+
+struct dbc_strpool {
+    dbc_arena_t arena;
+    // Open addressing with linear probing, the capacity is a power of two.
+    dbc_strpool_slot_t* slots;
+    size_t cap;
+    size_t size;
+};
+
+dbc_strpool_t __dbc_strpool_new(dbc_arena_t arena) {
+    const dbc_strpool_t pool =
+        (dbc_strpool_t)__dbc_arena_alloc(arena, sizeof(struct dbc_strpool));
+    if (unlikely(pool == NULL)) {
+        return NULL;
+    }
+
+    // The index is rebuilt every time it grows, so it lives on the heap
+    // rather than littering the arena with its old copies.
+    pool->slots = (dbc_strpool_slot_t*)calloc(STRPOOL_INITIAL_CAPACITY,
+                                              sizeof(dbc_strpool_slot_t));
+    if (unlikely(pool->slots == NULL)) {
+        return NULL;
+    }
+
+    pool->arena = arena;
+    pool->cap = STRPOOL_INITIAL_CAPACITY;
+    pool->size = 0;
+    return pool;
+}
+
+void __dbc_strpool_release(dbc_strpool_t pool) {
+    free(pool->slots);
+    pool->slots = NULL;
+    pool->cap = 0;
+    pool->size = 0;
+}
+
+/**
+ * @brief Finds the slot holding the string, or the empty slot it would go to.
+ */
+static dbc_strpool_slot_t* __dbc_strpool_probe(const dbc_strpool_t pool,
+                                               const char* str,
+                                               const size_t len,
+                                               const uint32_t hash) {
+    const size_t mask = pool->cap - 1;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        dbc_strpool_slot_t* const slot = &pool->slots[i];
+        if (slot->str == NULL
+            || (slot->hash == hash && slot->len == len
+                && memcmp(slot->str, str, len) == 0)) {
+            return slot;
+        }
+    }
+}
+
+static bool __dbc_strpool_grow(dbc_strpool_t pool) {
+    const size_t new_cap = pool->cap * 2;
+    dbc_strpool_slot_t* const new_slots =
+        (dbc_strpool_slot_t*)calloc(new_cap, sizeof(dbc_strpool_slot_t));
+    if (unlikely(new_slots == NULL)) {
+        return false;
+    }
+
+    const size_t mask = new_cap - 1;
+    for (size_t i = 0; i < pool->cap; i++) {
+        const dbc_strpool_slot_t* const slot = &pool->slots[i];
+        if (slot->str == NULL) {
+            continue;
+        }
+
+        size_t j = slot->hash & mask;
+        while (new_slots[j].str != NULL) {
+            j = (j + 1) & mask;
+        }
+        new_slots[j] = *slot;
+    }
+
+    free(pool->slots);
+    pool->slots = new_slots;
+    pool->cap = new_cap;
+    return true;
+}
+
+static const char* __dbc_strpool_insert(dbc_strpool_t pool, const char* str,
+                                        const size_t len, const bool copy) {
+    if (unlikely(len > UINT32_MAX)) {
+        return NULL;
+    }
+
+    const uint32_t hash = __dbc_strpool_hash(str, len);
+    dbc_strpool_slot_t* slot = __dbc_strpool_probe(pool, str, len, hash);
+    if (slot->str != NULL) {
+        return slot->str;
+    }
+
+    // Keep the load factor under 3/4, so probe sequences stay short.
+    if (unlikely((pool->size + 1) * 4 > pool->cap * 3)) {
+        if (unlikely(!__dbc_strpool_grow(pool))) {
+            return NULL;
+        }
+        slot = __dbc_strpool_probe(pool, str, len, hash);
+    }
+
+    const char* const stored =
+        copy ? __dbc_arena_strndup(pool->arena, str, len) : str;
+    if (unlikely(stored == NULL)) {
+        return NULL;
+    }
+
+    slot->str = stored;
+    slot->len = (uint32_t)len;
+    slot->hash = hash;
+    pool->size++;
+    return stored;
+}
+
+const char* __dbc_strpool_intern(dbc_strpool_t pool, const char* str,
+                                 const size_t len) {
+    return __dbc_strpool_insert(pool, str, len, true);
+}
+
+const char* __dbc_strpool_adopt(dbc_strpool_t pool, const char* str,
+                                const size_t len) {
+    return __dbc_strpool_insert(pool, str, len, false);
+}
+
+bool __dbc_strpool_adopt_in_place(dbc_strpool_t pool, const char** str) {
+    const char* const adopted = __dbc_strpool_adopt(pool, *str, strlen(*str));
+    if (unlikely(adopted == NULL)) {
+        return false;
+    }
+    *str = adopted;
+    return true;
+}
+
+const char* __dbc_strpool_find(const dbc_strpool_t pool, const char* str,
+                               const size_t len) {
+    if (unlikely(len > UINT32_MAX)) {
+        return NULL;
+    }
+
+    return __dbc_strpool_probe(pool, str, len, __dbc_strpool_hash(str, len))
+        ->str;
+}
+
+size_t __dbc_strpool_get_size(const dbc_strpool_t pool) {
+    return pool->size;
+}
+
+size_t __dbc_strpool_get_memory(const dbc_strpool_t pool,
+                                size_t* table_bytes) {
+    *table_bytes = pool->cap * sizeof(dbc_strpool_slot_t);
+    size_t bytes = sizeof(struct dbc_strpool) + *table_bytes;
+    for (size_t i = 0; i < pool->cap; i++) {
+        if (pool->slots[i].str != NULL) {
+            bytes += pool->slots[i].len + 1;
+        }
+    }
+    return bytes;
+}
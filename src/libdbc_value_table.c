@@ -17,70 +17,633 @@
  */
 
 #include "libdbc_value_table.h"
-#include "hashtable.h"
-#include "hashtable_itr.h"
-#include "sds.h"
+#include <stdint.h>
+#include <string.h>
+#include "__libdbc.h"
+#include "__libdbc_arena.h"
+#include "__libdbc_strpool.h"
 
-typedef struct hashtable* hashtable_t;
-typedef struct hashtable_itr* hashtable_itr_t;
+#define VT_INITIAL_CAPACITY (8U)
+// A dense table may have at most this many slots per stored entry. At 4, a
+// dense slot array is no larger than the hashed one would be.
+#define VT_DENSE_MAX_SPARSITY (4U)
+// Tiny dense tables are always fine, whatever their sparsity.
+#define VT_DENSE_MIN_CAPACITY (64U)
 
-static unsigned int key_hash(void* key) {
-    return (unsigned int)(*(double*)key);
-}
+typedef struct {
+    double key;
+    // NULL marks an empty slot.
+    const char* desc;
+} dbc_value_table_slot_t;
 
-static int keys_eq(void* k1, void* k2) { return *(double*)k1 == *(double*)k2; }
+typedef struct {
+    // NULL marks an empty slot.
+    const char* desc;
+    uint64_t hash;
+    double key;
+} dbc_value_table_rslot_t;
 
 struct dbc_value_table {
-    sds name;
-    hashtable_t val_to_desc;
+    const char* name;
+    // Tables created by dbc_value_table_new own their arena and string pool,
+    // those created by a dbc share the dbc's.
+    dbc_arena_t arena;
+    dbc_strpool_t strings;
+    bool owns_arena;
+    bool frozen;
+    size_t size;
+    // While every key is a small non-negative integer, descriptions are
+    // indexed by key directly. Once a key does not fit, the table turns into
+    // an open-addressing hash table (slots != NULL) for good.
+    const char** dense;
+    size_t dense_cap;
+    // Linear probing, the capacity is a power of two.
+    dbc_value_table_slot_t* slots;
+    size_t cap;
+    // Freezing a hashed table replaces the slots with these, both of length
+    // size. See __dbc_vt_key_order for how keys are sorted.
+    uint64_t* sorted_keys;
+    const char** sorted_descs;
+    // The reverse index, descriptions to keys, kept up to date by every
+    // insert. Linear probing, the capacity is a power of two.
+    dbc_value_table_rslot_t* rslots;
+    size_t rcap;
+    size_t rsize;
 };
 
+/**
+ * @brief Folds -0.0 into 0.0, so that both find the same entry.
+ */
+static inline double __dbc_vt_normalize(const double key) {
+    return key == 0 ? 0.0 : key;
+}
+
+static inline uint64_t __dbc_vt_key_bits(const double key) {
+    uint64_t bits;
+    memcpy(&bits, &key, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Hashes a (normalized) key.
+ *
+ * Enum values mostly differ in their low mantissa or exponent bits only, so
+ * every bit of the double is mixed in (the splitmix64 finalizer).
+ */
+static inline size_t __dbc_vt_hash(const double key) {
+    uint64_t x = __dbc_vt_key_bits(key);
+    x ^= x >> 30;
+    x *= UINT64_C(0xbf58476d1ce4e5b9);
+    x ^= x >> 27;
+    x *= UINT64_C(0x94d049bb133111eb);
+    x ^= x >> 31;
+    return (size_t)x;
+}
+
+/**
+ * @brief Maps a (normalized) key to an integer with the same ordering.
+ *
+ * Negative doubles sort backwards when their bits are read as an integer, so
+ * those get all of their bits flipped, while positive ones only get the sign
+ * bit set. NaNs land at either end, which is fine, as they only ever need to
+ * compare equal to themselves.
+ */
+static inline uint64_t __dbc_vt_key_order(const double key) {
+    const uint64_t bits = __dbc_vt_key_bits(key);
+    return (bits >> 63) != 0 ? ~bits : bits | (UINT64_C(1) << 63);
+}
+
+/**
+ * @brief Undoes __dbc_vt_key_order.
+ */
+static inline double __dbc_vt_key_from_order(const uint64_t order) {
+    const uint64_t bits =
+        (order >> 63) != 0 ? order & ~(UINT64_C(1) << 63) : ~order;
+    double key;
+    memcpy(&key, &bits, sizeof(key));
+    return key;
+}
+
+/**
+ * @brief Returns whether key can index the dense array, storing the index.
+ */
+static inline bool __dbc_vt_dense_index(const double key, const size_t limit,
+                                        size_t* idx) {
+    // The range check comes first, converting an out of range double is
+    // undefined.
+    if (!(key >= 0 && key < (double)limit)) {
+        return false;
+    }
+
+    *idx = (size_t)key;
+    return (double)*idx == key;
+}
+
+/**
+ * @brief Finds the slot holding key, or the empty slot it would go to.
+ */
+static inline dbc_value_table_slot_t* __dbc_vt_probe(
+    const dbc_value_table_slot_t* slots, const size_t cap, const double key) {
+    const size_t mask = cap - 1;
+    const uint64_t bits = __dbc_vt_key_bits(key);
+    for (size_t i = __dbc_vt_hash(key) & mask;; i = (i + 1) & mask) {
+        const dbc_value_table_slot_t* const slot = &slots[i];
+        // Comparing the bits lets NaN keys be found, too.
+        if (slot->desc == NULL || __dbc_vt_key_bits(slot->key) == bits) {
+            return (dbc_value_table_slot_t*)slot;
+        }
+    }
+}
+
+/**
+ * @brief Moves every entry into a fresh slot array of the given capacity.
+ */
+static bool __dbc_vt_rehash(dbc_value_table_t vt, const size_t new_cap) {
+    dbc_value_table_slot_t* const new_slots =
+        (dbc_value_table_slot_t*)__dbc_arena_calloc(
+            vt->arena, new_cap * sizeof(dbc_value_table_slot_t));
+    if (unlikely(new_slots == NULL)) {
+        return false;
+    }
+
+    if (vt->slots == NULL) {
+        for (size_t i = 0; i < vt->dense_cap; i++) {
+            if (vt->dense[i] != NULL) {
+                dbc_value_table_slot_t* const slot =
+                    __dbc_vt_probe(new_slots, new_cap, (double)i);
+                slot->key = (double)i;
+                slot->desc = vt->dense[i];
+            }
+        }
+        vt->dense = NULL;
+        vt->dense_cap = 0;
+    } else {
+        for (size_t i = 0; i < vt->cap; i++) {
+            if (vt->slots[i].desc != NULL) {
+                *__dbc_vt_probe(new_slots, new_cap, vt->slots[i].key) =
+                    vt->slots[i];
+            }
+        }
+    }
+
+    // The old array is left behind in the arena.
+    vt->slots = new_slots;
+    vt->cap = new_cap;
+    return true;
+}
+
+/**
+ * @brief Tries to make the dense array large enough to hold key.
+ * @return false if the key does not belong in a dense array.
+ */
+static bool __dbc_vt_dense_reserve(dbc_value_table_t vt, const double key,
+                                   size_t* idx) {
+    size_t max_cap = VT_DENSE_MAX_SPARSITY * (vt->size + 1);
+    max_cap = max_cap < VT_DENSE_MIN_CAPACITY ? VT_DENSE_MIN_CAPACITY
+                                              : max_cap;
+    if (!__dbc_vt_dense_index(key, max_cap, idx)) {
+        return false;
+    }
+    if (likely(*idx < vt->dense_cap)) {
+        return true;
+    }
+
+    size_t new_cap = vt->dense_cap == 0 ? VT_INITIAL_CAPACITY : vt->dense_cap;
+    while (new_cap <= *idx) {
+        new_cap *= 2;
+    }
+    if (new_cap > max_cap) {
+        return false;
+    }
+
+    const char** const new_dense = (const char**)__dbc_arena_realloc(
+        vt->arena, (void*)vt->dense, vt->dense_cap * sizeof(const char*),
+        new_cap * sizeof(const char*));
+    if (unlikely(new_dense == NULL)) {
+        return false;
+    }
+    memset((void*)(new_dense + vt->dense_cap), 0,
+           (new_cap - vt->dense_cap) * sizeof(const char*));
+
+    vt->dense = new_dense;
+    vt->dense_cap = new_cap;
+    return true;
+}
+
+/**
+ * @brief Hashes a description (64-bit FNV-1a).
+ */
+static inline uint64_t __dbc_vt_desc_hash(const char* desc) {
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    for (; *desc != '\0'; desc++) {
+        hash ^= (uint8_t)*desc;
+        hash *= UINT64_C(0x100000001b3);
+    }
+    return hash;
+}
+
+/**
+ * @brief Finds the reverse slot holding desc, or the empty slot it would go
+ *        to.
+ */
+static inline dbc_value_table_rslot_t* __dbc_vt_rprobe(
+    const dbc_value_table_rslot_t* rslots, const size_t rcap,
+    const char* desc, const uint64_t hash) {
+    const size_t mask = rcap - 1;
+    for (size_t i = (size_t)hash & mask;; i = (i + 1) & mask) {
+        const dbc_value_table_rslot_t* const slot = &rslots[i];
+        if (slot->desc == NULL
+            || (slot->hash == hash
+                && (slot->desc == desc || strcmp(slot->desc, desc) == 0))) {
+            return (dbc_value_table_rslot_t*)slot;
+        }
+    }
+}
+
+/**
+ * @brief Maps desc to key in the reverse index, which must have room.
+ *
+ * If several keys share a description, the smallest one wins, whatever the
+ * order they were inserted in.
+ */
+static void __dbc_vt_reverse_add(dbc_value_table_t vt, const double key,
+                                 const char* desc) {
+    const uint64_t hash = __dbc_vt_desc_hash(desc);
+    dbc_value_table_rslot_t* const slot =
+        __dbc_vt_rprobe(vt->rslots, vt->rcap, desc, hash);
+    if (slot->desc == NULL) {
+        slot->desc = desc;
+        slot->hash = hash;
+        slot->key = key;
+        vt->rsize++;
+    } else if (__dbc_vt_key_order(key) < __dbc_vt_key_order(slot->key)) {
+        slot->key = key;
+    }
+}
+
+static void __dbc_vt_reverse_visit(void* ctx, const double num,
+                                   const char* desc) {
+    __dbc_vt_reverse_add((dbc_value_table_t)ctx, num, desc);
+}
+
+/**
+ * @brief Makes sure the reverse index has room for one more description.
+ */
+static bool __dbc_vt_reverse_reserve(dbc_value_table_t vt) {
+    // Keep the load factor under 1/2, as for the keys.
+    if (likely(vt->rcap != 0 && (vt->rsize + 1) * 2 <= vt->rcap)) {
+        return true;
+    }
+
+    const size_t new_cap = vt->rcap == 0 ? VT_INITIAL_CAPACITY : vt->rcap * 2;
+    dbc_value_table_rslot_t* const new_rslots =
+        (dbc_value_table_rslot_t*)__dbc_arena_calloc(
+            vt->arena, new_cap * sizeof(dbc_value_table_rslot_t));
+    if (unlikely(new_rslots == NULL)) {
+        return false;
+    }
+
+    // The old array is left behind in the arena.
+    for (size_t i = 0; i < vt->rcap; i++) {
+        if (vt->rslots[i].desc != NULL) {
+            *__dbc_vt_rprobe(new_rslots, new_cap, vt->rslots[i].desc,
+                             vt->rslots[i].hash) = vt->rslots[i];
+        }
+    }
+    vt->rslots = new_rslots;
+    vt->rcap = new_cap;
+    return true;
+}
+
+/**
+ * @brief Brings the reverse index up to date with key having been mapped to
+ *        desc, in place of old (NULL if key is new).
+ */
+static void __dbc_vt_reverse_update(dbc_value_table_t vt, const double key,
+                                    const char* old, const char* desc) {
+    if (likely(old == NULL || old == desc)) {
+        __dbc_vt_reverse_add(vt, key, desc);
+        return;
+    }
+
+    // The old description may or may not live on under another key. This is
+    // rare enough for the index to simply be rebuilt, which needs no more
+    // room than it already has.
+    memset(vt->rslots, 0, vt->rcap * sizeof(dbc_value_table_rslot_t));
+    vt->rsize = 0;
+    __dbc_value_table_visit(vt, __dbc_vt_reverse_visit, vt);
+}
+
+static int __dbc_vt_slot_order_cmp(const void* lhs, const void* rhs) {
+    const dbc_value_table_slot_t* const l = (const dbc_value_table_slot_t*)lhs;
+    const dbc_value_table_slot_t* const r = (const dbc_value_table_slot_t*)rhs;
+    const uint64_t l_order = __dbc_vt_key_order(l->key);
+    const uint64_t r_order = __dbc_vt_key_order(r->key);
+    return (l_order > r_order) - (l_order < r_order);
+}
+
+dbc_value_table_t __dbc_value_table_new_in(dbc_arena_t arena,
+                                           dbc_strpool_t strings,
+                                           const char* name,
+                                           const size_t len) {
+    dbc_value_table_t vt = (dbc_value_table_t)__dbc_arena_calloc(
+        arena, sizeof(struct dbc_value_table));
+    if (unlikely(vt == NULL)) {
+        return NULL;
+    }
+
+    vt->name = __dbc_strpool_intern(strings, name, len);
+    vt->arena = arena;
+    vt->strings = strings;
+    vt->owns_arena = false;
+
+    return vt;
+}
+
+static inline bool __dbc_vt_adopt_desc(dbc_strpool_t strings,
+                                       const char** desc) {
+    return *desc == NULL || __dbc_strpool_adopt_in_place(strings, desc);
+}
+
+bool __dbc_value_table_adopt(dbc_value_table_t vt, dbc_arena_t arena,
+                             dbc_strpool_t strings) {
+    bool success = __dbc_strpool_adopt_in_place(strings, &vt->name);
+    for (size_t i = 0; success && i < vt->dense_cap; i++) {
+        success = __dbc_vt_adopt_desc(strings, &vt->dense[i]);
+    }
+    for (size_t i = 0; success && i < vt->cap; i++) {
+        success = __dbc_vt_adopt_desc(strings, &vt->slots[i].desc);
+    }
+    for (size_t i = 0; success && vt->sorted_descs != NULL && i < vt->size;
+         i++) {
+        success = __dbc_vt_adopt_desc(strings, &vt->sorted_descs[i]);
+    }
+    // Descriptions are hashed by their contents, so they stay where they are.
+    for (size_t i = 0; success && i < vt->rcap; i++) {
+        success = __dbc_vt_adopt_desc(strings, &vt->rslots[i].desc);
+    }
+
+    vt->arena = arena;
+    vt->strings = strings;
+    return success;
+}
+
 dbc_value_table_t dbc_value_table_new(const char* name) {
-    dbc_value_table_t vt =
-        (dbc_value_table_t)malloc(sizeof(dbc_value_table_t));
-    vt->name = sdsnew(name);
+    const dbc_arena_t arena = __dbc_arena_new();
+    if (unlikely(arena == NULL)) {
+        return NULL;
+    }
 
-    vt->val_to_desc = create_hashtable(4, key_hash, keys_eq);
+    const dbc_strpool_t strings = __dbc_strpool_new(arena);
+    const dbc_value_table_t vt = strings == NULL
+        ? NULL
+        : __dbc_value_table_new_in(arena, strings, name, strlen(name));
+    if (unlikely(vt == NULL)) {
+        if (strings != NULL) {
+            __dbc_strpool_release(strings);
+        }
+        __dbc_arena_free(arena);
+        return NULL;
+    }
 
+    vt->owns_arena = true;
     return vt;
 }
 
 void dbc_value_table_free(const dbc_value_table_t vt) {
-    sdsfree(vt->name);
-
-    if (hashtable_count(vt->val_to_desc) != 0) {
-        // Need to go and clear all those values manually. Let's use the
-        // iterator, for this.
-        hashtable_itr_t iter = hashtable_iterator(vt->val_to_desc);
-        sds val;
-        while ((val = hashtable_iterator_value(iter)) != NULL) {
-            sdsfree(val);
-            if (hashtable_iterator_advance(iter) == 0) {
-                break;
-            }
-        }
+    if (!vt->owns_arena) {
+        return;
     }
 
-    hashtable_destroy(vt->val_to_desc, false);
-    free(vt);
+    __dbc_strpool_release(vt->strings);
+    __dbc_arena_free(vt->arena);
 }
 
 const char* dbc_value_table_get_name(const dbc_value_table_t vt) {
     return vt->name;
 }
 
+bool __dbc_value_table_insert_len(dbc_value_table_t vt, double num,
+                                  const char* desc, const size_t len) {
+    if (unlikely(vt->frozen)) {
+        return false;
+    }
+
+    // Descriptions repeat a lot across tables, so they are interned rather
+    // than copied.
+    const char* const m_desc = __dbc_strpool_intern(vt->strings, desc, len);
+    if (unlikely(m_desc == NULL)) {
+        return false;
+    }
+    num = __dbc_vt_normalize(num);
+    if (unlikely(!__dbc_vt_reverse_reserve(vt))) {
+        return false;
+    }
+
+    size_t idx;
+    if (vt->slots == NULL && __dbc_vt_dense_reserve(vt, num, &idx)) {
+        const char* const old = vt->dense[idx];
+        vt->size += old == NULL;
+        vt->dense[idx] = m_desc;
+        __dbc_vt_reverse_update(vt, num, old, m_desc);
+        return true;
+    }
+
+    // Keep the load factor under 1/2, so probe sequences stay short.
+    if (vt->slots == NULL || (vt->size + 1) * 2 > vt->cap) {
+        size_t new_cap = vt->cap == 0 ? VT_INITIAL_CAPACITY : vt->cap * 2;
+        while ((vt->size + 1) * 2 > new_cap) {
+            new_cap *= 2;
+        }
+        if (unlikely(!__dbc_vt_rehash(vt, new_cap))) {
+            return false;
+        }
+    }
+
+    dbc_value_table_slot_t* const slot = __dbc_vt_probe(vt->slots, vt->cap,
+                                                        num);
+    const char* const old = slot->desc;
+    vt->size += old == NULL;
+    slot->key = num;
+    slot->desc = m_desc;
+    __dbc_vt_reverse_update(vt, num, old, m_desc);
+    return true;
+}
+
 bool dbc_value_table_insert(dbc_value_table_t vt, double num,
                             const char* desc) {
-    double* m_num = (double*)malloc(sizeof(num));
-    *m_num = num;
-    sds m_desc = sdsnew(desc);
-    return hashtable_insert(vt->val_to_desc, m_num, m_desc);
+    return __dbc_value_table_insert_len(vt, num, desc, strlen(desc));
 }
 
 size_t dbc_value_table_get_size(dbc_value_table_t vt) {
-    return hashtable_count(vt->val_to_desc);
+    return vt->size;
+}
+
+/**
+ * @brief Binary searches the sorted keys of a frozen table.
+ *
+ * The loop has a fixed trip count for a given size and its only decision is
+ * a conditional move, so there is nothing for the branch predictor to miss.
+ */
+static inline const char* __dbc_vt_sorted_find(const dbc_value_table_t vt,
+                                               const double val) {
+    if (unlikely(vt->size == 0)) {
+        return NULL;
+    }
+
+    const uint64_t key = __dbc_vt_key_order(__dbc_vt_normalize(val));
+    const uint64_t* base = vt->sorted_keys;
+    size_t n = vt->size;
+    while (n > 1) {
+        const size_t half = n / 2;
+        base = base[half] <= key ? base + half : base;
+        n -= half;
+    }
+
+    return *base == key ? vt->sorted_descs[base - vt->sorted_keys] : NULL;
 }
 
 const char* dbc_value_table_get_desc(dbc_value_table_t vt, const double val) {
-    return hashtable_search(vt->val_to_desc, (void*)&val);
+    if (vt->sorted_keys != NULL) {
+        return __dbc_vt_sorted_find(vt, val);
+    }
+
+    if (vt->slots == NULL) {
+        size_t idx;
+        return __dbc_vt_dense_index(val, vt->dense_cap, &idx)
+            ? vt->dense[idx]
+            : NULL;
+    }
+
+    return __dbc_vt_probe(vt->slots, vt->cap, __dbc_vt_normalize(val))->desc;
+}
+
+bool dbc_value_table_get_value(dbc_value_table_t vt, const char* desc,
+                               double* out) {
+    if (vt->rsize == 0) {
+        return false;
+    }
+
+    const dbc_value_table_rslot_t* const slot = __dbc_vt_rprobe(
+        vt->rslots, vt->rcap, desc, __dbc_vt_desc_hash(desc));
+    if (slot->desc == NULL) {
+        return false;
+    }
+    *out = slot->key;
+    return true;
+}
+
+bool dbc_value_table_next(dbc_value_table_t vt, size_t* cursor, double* num,
+                          const char** desc) {
+    size_t i = *cursor;
+    if (vt->sorted_keys != NULL) {
+        if (i >= vt->size) {
+            return false;
+        }
+        *num = __dbc_vt_key_from_order(vt->sorted_keys[i]);
+        *desc = vt->sorted_descs[i];
+    } else if (vt->slots != NULL) {
+        while (i < vt->cap && vt->slots[i].desc == NULL) {
+            i++;
+        }
+        if (i >= vt->cap) {
+            return false;
+        }
+        *num = vt->slots[i].key;
+        *desc = vt->slots[i].desc;
+    } else {
+        while (i < vt->dense_cap && vt->dense[i] == NULL) {
+            i++;
+        }
+        if (i >= vt->dense_cap) {
+            return false;
+        }
+        *num = (double)i;
+        *desc = vt->dense[i];
+    }
+
+    *cursor = i + 1;
+    return true;
+}
+
+bool dbc_value_table_freeze(dbc_value_table_t vt) {
+    if (vt->frozen) {
+        return true;
+    }
+
+    // Dense tables are as good as it gets already.
+    if (vt->slots == NULL) {
+        vt->frozen = true;
+        return true;
+    }
+
+    uint64_t* const keys =
+        (uint64_t*)__dbc_arena_alloc(vt->arena, vt->size * sizeof(uint64_t));
+    const char** const descs = (const char**)__dbc_arena_alloc(
+        vt->arena, vt->size * sizeof(const char*));
+    dbc_value_table_slot_t* const entries = (dbc_value_table_slot_t*)malloc(
+        (vt->size == 0 ? 1 : vt->size) * sizeof(dbc_value_table_slot_t));
+    if (unlikely(keys == NULL || descs == NULL || entries == NULL)) {
+        free(entries);
+        return false;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < vt->cap; i++) {
+        if (vt->slots[i].desc != NULL) {
+            entries[n++] = vt->slots[i];
+        }
+    }
+    qsort(entries, n, sizeof(dbc_value_table_slot_t), __dbc_vt_slot_order_cmp);
+    for (size_t i = 0; i < n; i++) {
+        keys[i] = __dbc_vt_key_order(entries[i].key);
+        descs[i] = entries[i].desc;
+    }
+    free(entries);
+
+    // The slots are left behind in the arena.
+    vt->sorted_keys = keys;
+    vt->sorted_descs = descs;
+    vt->slots = NULL;
+    vt->cap = 0;
+    vt->frozen = true;
+    return true;
+}
+
+void __dbc_value_table_visit(const dbc_value_table_t vt,
+                             const dbc_value_table_visitor_t visit,
+                             void* ctx) {
+    for (size_t i = 0; i < vt->dense_cap; i++) {
+        if (vt->dense[i] != NULL) {
+            visit(ctx, (double)i, vt->dense[i]);
+        }
+    }
+    for (size_t i = 0; i < vt->cap; i++) {
+        if (vt->slots[i].desc != NULL) {
+            visit(ctx, vt->slots[i].key, vt->slots[i].desc);
+        }
+    }
+    if (vt->sorted_keys != NULL) {
+        for (size_t i = 0; i < vt->size; i++) {
+            visit(ctx, __dbc_vt_key_from_order(vt->sorted_keys[i]),
+                  vt->sorted_descs[i]);
+        }
+    }
+}
+
+void __dbc_value_table_get_memory(const dbc_value_table_t vt, size_t* keys,
+                                  size_t* descs, size_t* overhead) {
+    *keys = vt->dense != NULL ? 0 : vt->size * sizeof(double);
+    *descs = vt->size * sizeof(const char*);
+    *overhead = sizeof(struct dbc_value_table)
+                + vt->rcap * sizeof(dbc_value_table_rslot_t);
+    if (vt->dense != NULL) {
+        *overhead += (vt->dense_cap - vt->size) * sizeof(const char*);
+    } else if (vt->slots != NULL) {
+        *overhead += (vt->cap - vt->size) * sizeof(dbc_value_table_slot_t);
+    }
+}
+
+bool __dbc_value_table_is_frozen(const dbc_value_table_t vt) {
+    return vt->frozen;
 }
@@ -1,25 +1,185 @@
 #include "libdbc.h"
+#include "libdbc_parser.h"
 #include "__libdbc.h"
+#include "__libdbc_attribute.h"
+#include "__libdbc_instr.h"
+#include "__libdbc_lazy.h"
+#include "__libdbc_signal.h"
 #include <string.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <float.h>
+#include <locale.h>
+
+#if defined(__SSE2__)
+#define LIBDBC_HAVE_SSE2
+#include <emmintrin.h>
+#endif
 
 #define PARSE_VERSION_DEFAULT ("")
+#define PARSE_NUMBER_MAX_LEN (64U)
 
 typedef enum
 {
-    PARSE_ERR_SUCCESS,
-    PARSE_ERR_MALFORMED,
-    PARSE_ERR_CRITICAL
+    PARSE_ERR_SUCCESS = DBC_PARSE_SUCCESS,
+    PARSE_ERR_MALFORMED = DBC_PARSE_MALFORMED,
+    PARSE_ERR_CRITICAL = DBC_PARSE_CRITICAL
 } parse_err_t;
 
+/**
+ * @brief A token, viewed in place in the input.
+ *
+ * Tokens are never NUL-terminated and never copied. Quoted strings keep their
+ * quotes, see __dbc_tok_unquote.
+ */
+typedef struct {
+    const char* ptr;
+    size_t len;
+} dbc_tok_t;
+
+typedef struct {
+    const char* cur;
+    const char* end;
+} dbc_lexer_t;
+
+static inline dbc_lexer_t __dbc_lexer(const char* str, const size_t len) {
+    const dbc_lexer_t lx = { str, str + len };
+    return lx;
+}
+
+static inline bool __dbc_is_space(const char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v'
+        || c == '\f';
+}
+
+static inline bool __dbc_is_punct(const char c) {
+    switch (c) {
+        case ':': case ';': case '|': case '@': case '(': case ')': case '[':
+        case ']': case ',':
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Finds the first occurrence of either character.
+ * @return The occurrence, end if there is none.
+ */
+static inline const char* __dbc_find_either(const char* cur,
+                                            const char* const end,
+                                            const char a, const char b) {
+#ifdef LIBDBC_HAVE_SSE2
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    for (; end - cur >= 16; cur += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*)cur);
+        const int mask = _mm_movemask_epi8(_mm_or_si128(
+            _mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask != 0) {
+            return cur + __builtin_ctz((unsigned)mask);
+        }
+    }
+#endif
+
+    for (; cur < end; cur++) {
+        if (*cur == a || *cur == b) {
+            return cur;
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief Finds the closing quote of a string whose opening quote is at str.
+ * @return The closing quote, or NULL if the string is never closed.
+ */
+static const char* __dbc_find_closing_quote(const char* str,
+                                            const char* const end) {
+    for (str++; (str = __dbc_find_either(str, end, '"', '\\')) < end;
+         str++) {
+        if (*str == '"') {
+            return str;
+        }
+        // Skip whatever is escaped.
+        if (++str == end) {
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Lexes the next token.
+ *
+ * Tokens are either single punctuation characters, quoted strings (an
+ * unterminated string extends to the end of the input), or runs of anything
+ * else up to the next whitespace, punctuation or quote.
+ *
+ * @return false once the input is exhausted.
+ */
+static bool __dbc_lex(dbc_lexer_t* lx, dbc_tok_t* tok) {
+    const char* cur = lx->cur;
+    while (cur < lx->end && __dbc_is_space(*cur)) {
+        cur++;
+    }
+
+    if (unlikely(cur == lx->end)) {
+        lx->cur = cur;
+        return false;
+    }
+
+    tok->ptr = cur;
+    if (*cur == '"') {
+        const char* const closing = __dbc_find_closing_quote(cur, lx->end);
+        cur = closing == NULL ? lx->end : closing + 1;
+    } else if (__dbc_is_punct(*cur)) {
+        cur++;
+    } else {
+        while (cur < lx->end && !__dbc_is_space(*cur)
+               && !__dbc_is_punct(*cur) && *cur != '"') {
+            cur++;
+        }
+    }
+
+    tok->len = (size_t)(cur - tok->ptr);
+    lx->cur = cur;
+    return true;
+}
+
+static inline bool __dbc_tok_is(const dbc_tok_t tok, const char c) {
+    return tok.len == 1 && tok.ptr[0] == c;
+}
+
+/**
+ * @brief Strips the quotes off a string token.
+ * @return false if the token is not a properly terminated string.
+ */
+static bool __dbc_tok_unquote(const dbc_tok_t tok, dbc_tok_t* content) {
+    if (unlikely(tok.len < 2 || tok.ptr[0] != '"'
+                 || tok.ptr[tok.len - 1] != '"')) {
+        return false;
+    }
+
+    content->ptr = tok.ptr + 1;
+    content->len = tok.len - 2;
+    return true;
+}
+
 static bool __dbc_valid_cexpr(const char* str, const size_t len) {
-    if (!(str[0] == '_' || isalpha(str[0]))) {
+    if (len == 0) {
+        return false;
+    }
+
+    if (!(str[0] == '_' || isalpha((unsigned char)str[0]))) {
         return false;
     }
 
     for (size_t i = 1; i < len; i++) {
-        if (!isalnum(str[i])) {
+        if (!(str[i] == '_' || isalnum((unsigned char)str[i]))) {
             return false;
         }
     }
@@ -37,43 +197,265 @@ static bool __dbc_valid_char_str(const char* str, const size_t len) {
     return true;
 }
 
-static parse_err_t __dbc_parse_version(dbc_t dbc, char* str) {
+static parse_err_t __dbc_parse_version(dbc_t dbc, const char* str,
+                                       const size_t len) {
     // ['VERSION' '"' { CANdb_version_string } '"' ]
-    const char* const first_quote = strchr(str, '"');
-
-    const char* const content_begin = first_quote + 1;
-    // Empty version string if <VERSION "">
-    if (unlikely(*content_begin == '"'))
-    {
-        dbc_set_version(dbc, PARSE_VERSION_DEFAULT);
-        return PARSE_ERR_SUCCESS;
-    }
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // VERSION, ignore.
 
-    // Malformed if <VERSION ">
-    // TODO: Maybe too expensive to call strlen all the time
-    const size_t len_remaining = strlen(str) - (content_begin - str);
-    char* content_end = strchr(content_begin, '"');
-    if (unlikely(content_end == NULL))
+    // Malformed if <VERSION> or <VERSION ">
+    dbc_tok_t content;
+    if (unlikely(!__dbc_lex(&lx, &tok) || !__dbc_tok_unquote(tok, &content)))
     {
         dbc_set_version(dbc, PARSE_VERSION_DEFAULT);
         return PARSE_ERR_MALFORMED;
     }
 
-    *content_end = 0;
-    dbc_set_version(dbc, content_begin);
+    __dbc_set_version_len(dbc, content.ptr, content.len);
     return PARSE_ERR_SUCCESS;
 }
 
-static bool maybe_str_to_double(double* out, const char* str) {
+// Every power of ten up to here is exactly representable as a double.
+static const double EXACT_POWERS_OF_TEN[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+#define EXACT_POWER_OF_TEN_MAX (22)
+#define EXACT_MANTISSA_MAX (UINT64_C(1) << 53)
+#define DECIMAL_MAX_DIGITS (19)
+#define DECIMAL_MAX_EXPONENT (100000)
+
+static inline bool __dbc_is_digit(const char c) {
+    return (unsigned)(c - '0') < 10;
+}
+
+/**
+ * @brief Accumulates a run of digits into a decimal mantissa.
+ * @return false if the mantissa grows past DECIMAL_MAX_DIGITS significant
+ *         digits.
+ */
+static inline bool __dbc_lex_digits(const char** cur, const char* end,
+                                    uint64_t* mantissa, int* digits,
+                                    int* exponent, const bool fraction,
+                                    bool* any) {
+    const char* p = *cur;
+    for (; p < end && __dbc_is_digit(*p); p++) {
+        *any = true;
+        if (fraction) {
+            (*exponent)--;
+        }
+        // Leading zeros are not significant.
+        if (*mantissa != 0 || *p != '0') {
+            if (unlikely(++*digits > DECIMAL_MAX_DIGITS)) {
+                return false;
+            }
+            *mantissa = *mantissa * 10 + (uint64_t)(*p - '0');
+        }
+    }
+
+    *cur = p;
+    return true;
+}
+
+/**
+ * @brief Converts a decimal number without strtod.
+ *
+ * The mantissa and the power of ten are both exact doubles, so their product
+ * or quotient is correctly rounded (Clinger's fast path). Numbers with too
+ * many digits or too large an exponent, and anything else strtod might
+ * accept, are left to maybe_str_to_double's slow path.
+ *
+ * @return false if the token is not such a simple decimal number.
+ */
+static bool __dbc_fast_str_to_double(double* out, const char* str,
+                                     const size_t len) {
+#if FLT_EVAL_METHOD == 0
+    const char* p = str;
+    const char* const end = str + len;
+    const bool negative = p < end && *p == '-';
+    if (p < end && (*p == '-' || *p == '+')) {
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool any = false;
+    if (!__dbc_lex_digits(&p, end, &mantissa, &digits, &exponent, false,
+                          &any)) {
+        return false;
+    }
+    if (p < end && *p == '.') {
+        p++;
+        if (!__dbc_lex_digits(&p, end, &mantissa, &digits, &exponent, true,
+                              &any)) {
+            return false;
+        }
+    }
+    if (unlikely(!any)) {
+        return false;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        const bool exp_negative = p < end && *p == '-';
+        if (p < end && (*p == '-' || *p == '+')) {
+            p++;
+        }
+        if (unlikely(p == end || !__dbc_is_digit(*p))) {
+            return false;
+        }
+        int exp = 0;
+        for (; p < end && __dbc_is_digit(*p); p++) {
+            if (exp < DECIMAL_MAX_EXPONENT) {
+                exp = exp * 10 + (*p - '0');
+            }
+        }
+        exponent += exp_negative ? -exp : exp;
+    }
+    if (unlikely(p != end)) {
+        return false;
+    }
+
+    if (mantissa == 0) {
+        *out = negative ? -0.0 : 0.0;
+        return true;
+    }
+
+    // 1e25 is 1000 * 1e22, and 1000 is still exact.
+    while (exponent > EXACT_POWER_OF_TEN_MAX
+           && mantissa <= EXACT_MANTISSA_MAX / 10) {
+        mantissa *= 10;
+        exponent--;
+    }
+    if (mantissa > EXACT_MANTISSA_MAX || exponent > EXACT_POWER_OF_TEN_MAX
+        || exponent < -EXACT_POWER_OF_TEN_MAX) {
+        return false;
+    }
+
+    double value = (double)mantissa;
+    if (exponent < 0) {
+        value /= EXACT_POWERS_OF_TEN[-exponent];
+    } else {
+        value *= EXACT_POWERS_OF_TEN[exponent];
+    }
+    *out = negative ? -value : value;
+    return true;
+#else
+    // Excess precision would round twice, there is no fast path then.
+    (void)out;
+    (void)str;
+    (void)len;
+    return false;
+#endif
+}
+
+static bool __dbc_str_to_double(double* out, const char* str,
+                                const size_t len) {
+    if (likely(__dbc_fast_str_to_double(out, str, len))) {
+        return true;
+    }
+
+    // strtod needs a terminated string, and numbers are short, so borrow a
+    // stack buffer rather than touching the input.
+    char buf[PARSE_NUMBER_MAX_LEN];
+    if (unlikely(len == 0 || len >= sizeof(buf))) {
+        return false;
+    }
+    memcpy(buf, str, len);
+    buf[len] = 0;
+
+    // DBC numbers always use a '.', whatever the locale's decimal point is.
+    const char* const point = localeconv()->decimal_point;
+    if (unlikely(point[0] != '.' && point[0] != 0 && point[1] == 0)) {
+        char* const dot = (char*)memchr(buf, '.', len);
+        if (dot != NULL) {
+            *dot = point[0];
+        }
+    }
+
     char* tail;
-    const double conv = strtod(str, &tail);
-    if (conv == 0.0 && tail == str) {
+    const double conv = strtod(buf, &tail);
+    if (tail != buf + len) {
         return false;
     }
     *out = conv;
     return true;
 }
 
+static bool __dbc_str_to_uint(uint32_t* out, const char* str,
+                              const size_t len) {
+    // IDs, bit positions and sizes are nearly always plain digits.
+    if (likely(len > 0 && len <= 10)) {
+        uint64_t value = 0;
+        size_t i = 0;
+        for (; i < len && __dbc_is_digit(str[i]); i++) {
+            value = value * 10 + (uint64_t)(str[i] - '0');
+        }
+        if (likely(i == len)) {
+            if (unlikely(value > UINT32_MAX)) {
+                return false;
+            }
+            *out = (uint32_t)value;
+            return true;
+        }
+    }
+
+    double conv;
+    if (unlikely(!__dbc_str_to_double(&conv, str, len) || conv < 0
+                 || conv > UINT32_MAX || conv != (double)(uint32_t)conv)) {
+        return false;
+    }
+    *out = (uint32_t)conv;
+    return true;
+}
+
+/*
+ * The parser converts numbers through these, which instrumented builds time
+ * as the numbers phase.
+ */
+
+static bool maybe_str_to_double(double* out, const char* str,
+                                const size_t len) {
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_NUMBERS);
+    const bool converted = __dbc_str_to_double(out, str, len);
+    DBC_INSTR_POP();
+    return converted;
+}
+
+static bool maybe_str_to_uint(uint32_t* out, const char* str,
+                              const size_t len) {
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_NUMBERS);
+    const bool converted = __dbc_str_to_uint(out, str, len);
+    DBC_INSTR_POP();
+    return converted;
+}
+
+/**
+ * @brief Lexes the next token, expecting it to be the given punctuation.
+ */
+static inline bool __dbc_lex_expect(dbc_lexer_t* lx, const char c) {
+    dbc_tok_t tok;
+    return __dbc_lex(lx, &tok) && __dbc_tok_is(tok, c);
+}
+
+/**
+ * @brief Lexes the next token, expecting it to be a number.
+ */
+static inline bool __dbc_lex_double(dbc_lexer_t* lx, double* out) {
+    dbc_tok_t tok;
+    return __dbc_lex(lx, &tok) && maybe_str_to_double(out, tok.ptr, tok.len);
+}
+
+/**
+ * @brief Lexes the next token, expecting it to be an unsigned integer.
+ */
+static inline bool __dbc_lex_uint(dbc_lexer_t* lx, uint32_t* out) {
+    dbc_tok_t tok;
+    return __dbc_lex(lx, &tok) && maybe_str_to_uint(out, tok.ptr, tok.len);
+}
+
 /**
  * @brief Parses the nodes out of a node line.
  *
@@ -85,35 +467,48 @@ static bool maybe_str_to_double(double* out, const char* str) {
  *                     adhere to the spec, ie. if it is not a "c-expr",
  *                     PARSE_ERR_SUCCESS otherwise.
  */
-static parse_err_t __dbc_parse_nodes(dbc_t dbc, char* str) {
+static parse_err_t __dbc_parse_nodes(dbc_t dbc, const char* str,
+                                     const size_t len) {
     // 'BU_:' {node_name}
     parse_err_t success = PARSE_ERR_SUCCESS;
 
-    char* strtok_r_ptr;
-    char* tok = strtok_r(str, " ", &strtok_r_ptr); // BU_, ignore.
-    while ((tok = strtok_r(NULL, " ", &strtok_r_ptr)) != NULL) {
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // BU_, ignore.
+    bool first = true;
+    while (__dbc_lex(&lx, &tok)) {
+        // The colon is mandated by the spec, but commonly left out.
+        if (first && __dbc_tok_is(tok, ':')) {
+            first = false;
+            continue;
+        }
+        first = false;
+
         // tok is a node name.
-        const dbc_node_t node = dbc_node_new(tok);
-        if (unlikely(!__dbc_valid_cexpr(tok, strlen(tok)))) {
+        if (unlikely(!__dbc_valid_cexpr(tok.ptr, tok.len))) {
             success = PARSE_ERR_MALFORMED;
         }
-        dbc_push_node(dbc, node);
+        DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+        __dbc_add_node_len(dbc, tok.ptr, tok.len);
+        DBC_INSTR_POP();
     }
 
     return success;
 }
 
-static parse_err_t __dbc_parse_value_table(dbc_t dbc, char* str) {
+static parse_err_t __dbc_parse_value_table(dbc_t dbc, const char* str,
+                                           const size_t len) {
     // 'VAL_TABLE_' value_table_name {value_description} ';' ;
     // value_table_name = C_identifier ;
     // value_description = double char_string ;
     parse_err_t success = PARSE_ERR_SUCCESS;
 
-    char* strtok_r_ptr;
-    char* tok = strtok_r(str, " ", &strtok_r_ptr); // VAL_TABLE_, ignore.
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // VAL_TABLE_, ignore.
     // The name comes first
-    const char* const vt_name = strtok_r(NULL, " ", &strtok_r_ptr);
-    if (strcmp(vt_name, ";") == 0) {
+    dbc_tok_t vt_name;
+    if (unlikely(!__dbc_lex(&lx, &vt_name) || __dbc_tok_is(vt_name, ';'))) {
         // If we find a ';' character, then we did not find any value tables.
         // This should be ignored and we should not inject anything into the
         // dbc.
@@ -122,60 +517,1666 @@ static parse_err_t __dbc_parse_value_table(dbc_t dbc, char* str) {
 
     // We should ensure the name is a C_identifier, but if it is not, let's
     // continue.
-    success = __dbc_valid_char_str(vt_name, strlen(vt_name))
+    success = __dbc_valid_cexpr(vt_name.ptr, vt_name.len)
             ? PARSE_ERR_SUCCESS
             : PARSE_ERR_MALFORMED;
 
     // Otherwise, we may now safely create a vtable.
-    dbc_value_table_t tbl = dbc_add_value_table(dbc, vt_name);
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+    dbc_value_table_t tbl =
+        __dbc_add_value_table_len(dbc, vt_name.ptr, vt_name.len);
+    DBC_INSTR_POP();
     do {
-        tok = strtok_r(NULL, " ", &strtok_r_ptr);
-        // If we find a null, character, we failed, because we're, eventually
+        // If we run out of tokens, we failed, because we're, eventually
         // supposed to exit when we find ';'
-        if (unlikely(tok == NULL)) {
+        if (unlikely(!__dbc_lex(&lx, &tok))) {
             return PARSE_ERR_CRITICAL;
         }
 
-        if (tok[0] == ';') {
+        if (__dbc_tok_is(tok, ';')) {
             return success;
         }
 
         // Alright, this should be the value, let's see if we can cast to
         // double.
         double value;
-        if (unlikely(!maybe_str_to_double(&value, tok))) {
+        if (unlikely(!maybe_str_to_double(&value, tok.ptr, tok.len))) {
             // If we can't cast it to double, something is really bad, let's
             // fail.
             return PARSE_ERR_CRITICAL;
         }
 
         // If this passes, we got our value, time to look for the key.
-        tok = strtok_r(NULL, " ", &strtok_r_ptr);
-        // If the token is null, but we have a value, there's nothing we can
-        // do. If it's a semicolon, then we found a value, but no semicolon.
+        // If there is no token, but we have a value, there's nothing we can
+        // do. If it's a semicolon, then we found a value, but no key.
         // There's no recovery from that, chief. Let's just give up.
-        if (unlikely(tok == NULL || tok[0] == ';')) {
+        if (unlikely(!__dbc_lex(&lx, &tok) || __dbc_tok_is(tok, ';'))) {
             return PARSE_ERR_CRITICAL;
         }
 
-        // If these pass, this is a key.
-        const char* key = tok;
-        const size_t key_len = strlen(tok);
-        if (unlikely(key[0] != '"' || key[key_len - 1] != '"')) {
-            // The key must be contained within two "", if failing, mark error,
-            // but we'll try our best to continue.
+        // If these pass, this is a key. The key must be contained within two
+        // "", if failing, mark error, but we'll try our best to continue.
+        dbc_tok_t key;
+        if (unlikely(!__dbc_tok_unquote(tok, &key))) {
             success = PARSE_ERR_MALFORMED;
+            key = tok;
         }
         // If the key is not a valid char string, then this is a failure, but
         // let's continue pretending like it is all fine.
-        success = __dbc_valid_char_str(key, key_len - 1)
+        success = __dbc_valid_char_str(key.ptr, key.len)
                 ? success
                 : PARSE_ERR_MALFORMED;
 
         // Alright, key looks pretty good, let's now put both of these into our
         // value table!
-        dbc_value_table_insert(tbl, value, key);
+        DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+        __dbc_value_table_insert_len(tbl, value, key.ptr, key.len);
+        DBC_INSTR_POP();
     } while (true);
 
     return success;
 }
+
+static parse_err_t __dbc_parse_message(dbc_t dbc, const char* str,
+                                       const size_t len) {
+    // 'BO_' message_id message_name ':' message_size transmitter
+    parse_err_t success = PARSE_ERR_SUCCESS;
+
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // BO_, ignore.
+
+    uint32_t id;
+    dbc_tok_t name;
+    uint32_t size;
+    if (unlikely(!__dbc_lex_uint(&lx, &id) || !__dbc_lex(&lx, &name)
+                 || __dbc_tok_is(name, ':') || !__dbc_lex_expect(&lx, ':')
+                 || !__dbc_lex_uint(&lx, &size))) {
+        // Without these, there is nothing the message's signals could be
+        // decoded with. Its SG_ lines will complain on their own.
+        return PARSE_ERR_CRITICAL;
+    }
+    if (unlikely(!__dbc_valid_cexpr(name.ptr, name.len))) {
+        success = PARSE_ERR_MALFORMED;
+    }
+
+    // The transmitter is mandated by the spec, but some tools leave it out.
+    dbc_tok_t transmitter;
+    if (unlikely(!__dbc_lex(&lx, &transmitter))) {
+        transmitter.ptr = "";
+        transmitter.len = 0;
+        success = PARSE_ERR_MALFORMED;
+    }
+
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+    const dbc_message_t msg = __dbc_add_message_len(
+        dbc, id, name.ptr, name.len, size, transmitter.ptr, transmitter.len);
+    DBC_INSTR_POP();
+    if (unlikely(msg == NULL)) {
+        return PARSE_ERR_CRITICAL;
+    }
+    return success;
+}
+
+/**
+ * @brief Parses a run of decimal digits into a 64-bit value.
+ * @return false if there are no digits, or too many.
+ */
+static bool __dbc_parse_u64(const char* str, const size_t len,
+                            uint64_t* out) {
+    if (unlikely(len == 0)) {
+        return false;
+    }
+
+    uint64_t value = 0;
+    for (size_t i = 0; i < len; i++) {
+        const uint64_t digit = (uint64_t)(str[i] - '0');
+        if (unlikely(!__dbc_is_digit(str[i])
+                     || value > (UINT64_MAX - digit) / 10)) {
+            return false;
+        }
+        value = value * 10 + digit;
+    }
+    *out = value;
+    return true;
+}
+
+/**
+ * @brief Parses the multiplexer indicator of a signal: "M" for a multiplexor,
+ *        "m" and its value for a multiplexed signal, both for a multiplexed
+ *        multiplexor.
+ * @return false if the indicator is none of these.
+ */
+static bool __dbc_parse_mux_indicator(const dbc_tok_t tok,
+                                      dbc_signal_def_t* def) {
+    if (__dbc_tok_is(tok, 'M')) {
+        def->is_multiplexor = true;
+        return true;
+    }
+    if (unlikely(tok.len < 2 || tok.ptr[0] != 'm')) {
+        return false;
+    }
+
+    const bool is_multiplexor = tok.ptr[tok.len - 1] == 'M';
+    if (unlikely(!__dbc_parse_u64(tok.ptr + 1, tok.len - 1 - is_multiplexor,
+                                  &def->mux_value))) {
+        return false;
+    }
+    def->is_multiplexor = is_multiplexor;
+    def->is_multiplexed = true;
+    return true;
+}
+
+static parse_err_t __dbc_parse_signal_in(dbc_message_t msg, const char* str,
+                                         const size_t len) {
+    // 'SG_' signal_name [multiplexer_indicator] ':' start_bit '|'
+    //     signal_size '@' byte_order value_type '(' factor ',' offset ')'
+    //     '[' minimum '|' maximum ']' unit receiver {',' receiver}
+    parse_err_t success = PARSE_ERR_SUCCESS;
+
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // SG_, ignore.
+
+    dbc_tok_t name;
+    if (unlikely(!__dbc_lex(&lx, &name) || __dbc_tok_is(name, ':'))) {
+        return PARSE_ERR_CRITICAL;
+    }
+    if (unlikely(!__dbc_valid_cexpr(name.ptr, name.len))) {
+        success = PARSE_ERR_MALFORMED;
+    }
+
+    dbc_signal_def_t def;
+    def.is_multiplexor = false;
+    def.is_multiplexed = false;
+    def.mux_value = 0;
+    if (unlikely(!__dbc_lex(&lx, &tok))) {
+        return PARSE_ERR_CRITICAL;
+    }
+    if (!__dbc_tok_is(tok, ':')) {
+        if (unlikely(!__dbc_parse_mux_indicator(tok, &def))) {
+            // Decode it as a plain signal rather than not at all.
+            success = PARSE_ERR_MALFORMED;
+        }
+        if (unlikely(!__dbc_lex_expect(&lx, ':'))) {
+            return PARSE_ERR_CRITICAL;
+        }
+    }
+
+    uint32_t start_bit;
+    uint32_t length;
+    dbc_tok_t order_sign;
+    if (unlikely(!__dbc_lex_uint(&lx, &start_bit)
+                 || !__dbc_lex_expect(&lx, '|')
+                 || !__dbc_lex_uint(&lx, &length)
+                 || !__dbc_lex_expect(&lx, '@')
+                 || !__dbc_lex(&lx, &order_sign))) {
+        return PARSE_ERR_CRITICAL;
+    }
+
+    // The byte order and value type form a single token, like "1+".
+    if (unlikely(order_sign.len != 2
+                 || (order_sign.ptr[0] != '0' && order_sign.ptr[0] != '1')
+                 || (order_sign.ptr[1] != '+' && order_sign.ptr[1] != '-'))) {
+        return PARSE_ERR_CRITICAL;
+    }
+
+    if (unlikely(!__dbc_lex_expect(&lx, '(')
+                 || !__dbc_lex_double(&lx, &def.factor)
+                 || !__dbc_lex_expect(&lx, ',')
+                 || !__dbc_lex_double(&lx, &def.offset)
+                 || !__dbc_lex_expect(&lx, ')')
+                 || !__dbc_lex_expect(&lx, '[')
+                 || !__dbc_lex_double(&lx, &def.min)
+                 || !__dbc_lex_expect(&lx, '|')
+                 || !__dbc_lex_double(&lx, &def.max)
+                 || !__dbc_lex_expect(&lx, ']'))) {
+        return PARSE_ERR_CRITICAL;
+    }
+
+    // The unit and the receivers are mandated by the spec, but are of no
+    // use for decoding, so do without them if need be.
+    dbc_tok_t unit = { "", 0 };
+    if (likely(__dbc_lex(&lx, &tok))
+        && unlikely(!__dbc_tok_unquote(tok, &unit))) {
+        return PARSE_ERR_CRITICAL;
+    }
+
+    def.name = name.ptr;
+    def.start_bit = (uint16_t)(start_bit > UINT16_MAX ? UINT16_MAX
+                                                      : start_bit);
+    def.length = (uint16_t)(length > UINT16_MAX ? UINT16_MAX : length);
+    def.byte_order = order_sign.ptr[0] == '1'
+        ? DBC_BYTE_ORDER_LITTLE_ENDIAN
+        : DBC_BYTE_ORDER_BIG_ENDIAN;
+    def.is_signed = order_sign.ptr[1] == '-';
+    def.unit = unit.ptr;
+
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+    const dbc_signal_t sig =
+        __dbc_message_add_signal_len(msg, &def, name.len, unit.len);
+    DBC_INSTR_POP();
+    if (unlikely(sig == NULL)) {
+        // The signal does not fit into a frame.
+        return PARSE_ERR_CRITICAL;
+    }
+
+    while (__dbc_lex(&lx, &tok)) {
+        if (__dbc_tok_is(tok, ',')) {
+            continue;
+        }
+
+        if (unlikely(!__dbc_valid_cexpr(tok.ptr, tok.len))) {
+            success = PARSE_ERR_MALFORMED;
+        }
+        DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+        __dbc_signal_add_receiver_len(sig, tok.ptr, tok.len);
+        DBC_INSTR_POP();
+    }
+    if (unlikely(dbc_signal_get_num_receivers(sig) == 0)) {
+        success = PARSE_ERR_MALFORMED;
+    }
+
+    return success;
+}
+
+static parse_err_t __dbc_parse_signal(dbc_t dbc, const char* str,
+                                      const size_t len) {
+    // Signals belong to the message defined last.
+    const size_t num_messages = dbc_get_num_messages(dbc);
+    if (unlikely(num_messages == 0)) {
+        return PARSE_ERR_CRITICAL;
+    }
+    const dbc_message_t msg = dbc_get_message(dbc, num_messages - 1);
+
+    // Whatever was deferred comes first.
+    __dbc_message_load_signals(msg);
+    return __dbc_parse_signal_in(msg, str, len);
+}
+
+/**
+ * @brief Parses a range of multiplexor values, like "3-5".
+ */
+static bool __dbc_parse_mux_range(const dbc_tok_t tok,
+                                  dbc_mux_range_t* range) {
+    const char* const dash = (const char*)memchr(tok.ptr, '-', tok.len);
+    return dash != NULL
+        && __dbc_parse_u64(tok.ptr, (size_t)(dash - tok.ptr), &range->min)
+        && __dbc_parse_u64(dash + 1, (size_t)(tok.ptr + tok.len - dash - 1),
+                           &range->max)
+        && range->min <= range->max;
+}
+
+// More ranges than this for a single signal are not taken into account.
+#define MUX_MAX_RANGES (64U)
+
+static parse_err_t __dbc_parse_signal_mux_values(dbc_t dbc, const char* str,
+                                                 const size_t len) {
+    // 'SG_MUL_VAL_' message_id multiplexed_signal_name
+    //     multiplexor_switch_name multiplexor_value_ranges ';'
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // SG_MUL_VAL_, ignore.
+
+    uint32_t id;
+    dbc_tok_t sig_name;
+    dbc_tok_t mux_name;
+    if (unlikely(!__dbc_lex_uint(&lx, &id) || !__dbc_lex(&lx, &sig_name)
+                 || !__dbc_lex(&lx, &mux_name))) {
+        return PARSE_ERR_MALFORMED;
+    }
+
+    const dbc_message_t msg = dbc_get_message_by_id(dbc, id);
+    if (unlikely(msg == NULL)) {
+        // The message may yet be absorbed from another piece.
+        return __dbc_defer_statement(dbc, str, len) ? PARSE_ERR_SUCCESS
+                                                    : PARSE_ERR_MALFORMED;
+    }
+    const dbc_signal_t sig =
+        __dbc_message_find_signal_len(msg, sig_name.ptr, sig_name.len);
+    const dbc_signal_t mux =
+        __dbc_message_find_signal_len(msg, mux_name.ptr, mux_name.len);
+    if (unlikely(sig == NULL || mux == NULL || sig == mux
+                 || !dbc_signal_is_multiplexor(mux))) {
+        return PARSE_ERR_MALFORMED;
+    }
+
+    dbc_mux_range_t ranges[MUX_MAX_RANGES];
+    size_t num_ranges = 0;
+    parse_err_t success = PARSE_ERR_SUCCESS;
+    while (__dbc_lex(&lx, &tok) && !__dbc_tok_is(tok, ';')) {
+        if (__dbc_tok_is(tok, ',')) {
+            continue;
+        }
+        if (unlikely(num_ranges == MUX_MAX_RANGES
+                     || !__dbc_parse_mux_range(tok, &ranges[num_ranges]))) {
+            success = PARSE_ERR_MALFORMED;
+            continue;
+        }
+        num_ranges++;
+    }
+    if (unlikely(num_ranges == 0)) {
+        return PARSE_ERR_MALFORMED;
+    }
+
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+    const bool set = __dbc_message_set_mux_len(msg, sig, mux, ranges,
+                                               num_ranges, false);
+    DBC_INSTR_POP();
+    if (unlikely(!set)) {
+        return PARSE_ERR_CRITICAL;
+    }
+    return success;
+}
+
+static inline bool __dbc_tok_eq(const dbc_tok_t tok, const char* str) {
+    const size_t len = strlen(str);
+    return tok.len == len && memcmp(tok.ptr, str, len) == 0;
+}
+
+/**
+ * @brief The outcome of __dbc_parse_object_ref.
+ */
+typedef enum {
+    OBJECT_REF_FOUND,
+    /** The object is of a kind not kept, an environment variable. */
+    OBJECT_REF_IGNORED,
+    /** There is no such object, or the reference is malformed. */
+    OBJECT_REF_UNKNOWN
+} object_ref_t;
+
+/**
+ * @brief Parses the object a comment or attribute is about: "BU_" and a node
+ *        name, "BO_" and a message ID, "SG_", a message ID and a signal name,
+ *        "EV_" and a variable name, or nothing for the network.
+ *
+ * @param tok Receives the token following the reference.
+ * @param obj Receives the index of the node or message.
+ * @param sub Receives the index of the signal within the message.
+ */
+static object_ref_t __dbc_parse_object_ref(dbc_t dbc, dbc_lexer_t* lx,
+                                           dbc_tok_t* tok,
+                                           dbc_object_kind_t* kind,
+                                           uint32_t* obj, uint32_t* sub) {
+    *kind = DBC_OBJECT_NETWORK;
+    *obj = 0;
+    *sub = 0;
+    if (unlikely(!__dbc_lex(lx, tok))) {
+        return OBJECT_REF_UNKNOWN;
+    }
+
+    object_ref_t ref = OBJECT_REF_FOUND;
+    dbc_tok_t name;
+    uint32_t id;
+    if (__dbc_tok_eq(*tok, "BU_")) {
+        *kind = DBC_OBJECT_NODE;
+        if (unlikely(!__dbc_lex(lx, &name))) {
+            return OBJECT_REF_UNKNOWN;
+        }
+        const size_t idx = __dbc_find_node_index_len(dbc, name.ptr, name.len);
+        if (unlikely(idx == SIZE_MAX)) {
+            return OBJECT_REF_UNKNOWN;
+        }
+        *obj = (uint32_t)idx;
+    } else if (__dbc_tok_eq(*tok, "BO_") || __dbc_tok_eq(*tok, "SG_")) {
+        const bool is_signal = tok->ptr[0] == 'S';
+        *kind = is_signal ? DBC_OBJECT_SIGNAL : DBC_OBJECT_MESSAGE;
+        if (unlikely(!__dbc_lex_uint(lx, &id)
+                     || (is_signal && !__dbc_lex(lx, &name)))) {
+            return OBJECT_REF_UNKNOWN;
+        }
+        const dbc_message_t msg = dbc_get_message_by_id(dbc, id);
+        if (unlikely(msg == NULL)) {
+            return OBJECT_REF_UNKNOWN;
+        }
+        *obj = __dbc_message_get_index(msg);
+        if (is_signal) {
+            const size_t idx =
+                __dbc_message_find_signal_index_len(msg, name.ptr, name.len);
+            if (unlikely(idx == SIZE_MAX)) {
+                return OBJECT_REF_UNKNOWN;
+            }
+            *sub = (uint32_t)idx;
+        }
+    } else if (__dbc_tok_eq(*tok, "EV_")) {
+        if (unlikely(!__dbc_lex(lx, &name))) {
+            return OBJECT_REF_UNKNOWN;
+        }
+        ref = OBJECT_REF_IGNORED;
+    } else {
+        return OBJECT_REF_FOUND;
+    }
+
+    return __dbc_lex(lx, tok) ? ref : OBJECT_REF_UNKNOWN;
+}
+
+static parse_err_t __dbc_parse_comment(dbc_t dbc, const char* str,
+                                       const size_t len) {
+    // 'CM_' [ 'BU_' node_name | 'BO_' message_id
+    //     | 'SG_' message_id signal_name | 'EV_' env_var_name ]
+    //     char_string ';'
+    // Objects are referred to by index, which only settles once every piece
+    // has been absorbed.
+    if (__dbc_defer_statement(dbc, str, len)) {
+        return PARSE_ERR_SUCCESS;
+    }
+
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // CM_, ignore.
+
+    dbc_object_kind_t kind;
+    uint32_t obj;
+    uint32_t sub;
+    const object_ref_t ref =
+        __dbc_parse_object_ref(dbc, &lx, &tok, &kind, &obj, &sub);
+    if (ref != OBJECT_REF_FOUND) {
+        return ref == OBJECT_REF_IGNORED ? PARSE_ERR_SUCCESS
+                                         : PARSE_ERR_MALFORMED;
+    }
+
+    dbc_tok_t text;
+    if (unlikely(!__dbc_tok_unquote(tok, &text))) {
+        return PARSE_ERR_MALFORMED;
+    }
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+    const bool added =
+        __dbc_add_comment_len(dbc, kind, obj, sub, text.ptr, text.len);
+    DBC_INSTR_POP();
+    if (unlikely(!added)) {
+        return PARSE_ERR_CRITICAL;
+    }
+    return __dbc_lex_expect(&lx, ';') ? PARSE_ERR_SUCCESS
+                                      : PARSE_ERR_MALFORMED;
+}
+
+static parse_err_t __dbc_parse_attr_def(dbc_t dbc, const char* str,
+                                        const size_t len) {
+    // 'BA_DEF_' [ 'BU_' | 'BO_' | 'SG_' | 'EV_' ] attribute_name
+    //     attribute_value_type ';'
+    // attribute_value_type = 'INT' signed_integer signed_integer
+    //     | 'HEX' signed_integer signed_integer | 'FLOAT' double double
+    //     | 'STRING' | 'ENUM' [ char_string { ',' char_string } ]
+    if (__dbc_defer_statement(dbc, str, len)) {
+        return PARSE_ERR_SUCCESS;
+    }
+
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // BA_DEF_, ignore.
+
+    if (unlikely(!__dbc_lex(&lx, &tok))) {
+        return PARSE_ERR_MALFORMED;
+    }
+    dbc_object_kind_t kind = DBC_OBJECT_NETWORK;
+    if (__dbc_tok_eq(tok, "EV_")) {
+        // Environment variables are not kept, nor are their attributes.
+        return PARSE_ERR_SUCCESS;
+    }
+    if (__dbc_tok_eq(tok, "BU_") || __dbc_tok_eq(tok, "BO_")
+        || __dbc_tok_eq(tok, "SG_")) {
+        kind = tok.ptr[0] == 'S' ? DBC_OBJECT_SIGNAL
+            : tok.ptr[1] == 'O'  ? DBC_OBJECT_MESSAGE
+                                 : DBC_OBJECT_NODE;
+        if (unlikely(!__dbc_lex(&lx, &tok))) {
+            return PARSE_ERR_MALFORMED;
+        }
+    }
+
+    dbc_tok_t name;
+    dbc_tok_t type_tok;
+    if (unlikely(!__dbc_tok_unquote(tok, &name)
+                 || !__dbc_lex(&lx, &type_tok))) {
+        return PARSE_ERR_MALFORMED;
+    }
+    if (unlikely(__dbc_find_attr_def_len(dbc, name.ptr, name.len) != NULL)) {
+        // The first definition stands.
+        return PARSE_ERR_MALFORMED;
+    }
+
+    dbc_attr_type_t type;
+    if (__dbc_tok_eq(type_tok, "INT")) {
+        type = DBC_ATTR_INT;
+    } else if (__dbc_tok_eq(type_tok, "HEX")) {
+        type = DBC_ATTR_HEX;
+    } else if (__dbc_tok_eq(type_tok, "FLOAT")) {
+        type = DBC_ATTR_FLOAT;
+    } else if (__dbc_tok_eq(type_tok, "STRING")) {
+        type = DBC_ATTR_STRING;
+    } else if (__dbc_tok_eq(type_tok, "ENUM")) {
+        type = DBC_ATTR_ENUM;
+    } else {
+        return PARSE_ERR_MALFORMED;
+    }
+
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+    const dbc_attr_def_t def =
+        __dbc_add_attr_def_len(dbc, name.ptr, name.len, kind, type);
+    DBC_INSTR_POP();
+    if (unlikely(def == NULL)) {
+        return PARSE_ERR_CRITICAL;
+    }
+
+    parse_err_t success = PARSE_ERR_SUCCESS;
+    if (type == DBC_ATTR_INT || type == DBC_ATTR_HEX
+        || type == DBC_ATTR_FLOAT) {
+        double min;
+        double max;
+        if (unlikely(!__dbc_lex_double(&lx, &min)
+                     || !__dbc_lex_double(&lx, &max))) {
+            return PARSE_ERR_MALFORMED;
+        }
+        __dbc_attr_def_set_range(def, min, max);
+    } else if (type == DBC_ATTR_ENUM) {
+        while (__dbc_lex(&lx, &tok) && !__dbc_tok_is(tok, ';')) {
+            dbc_tok_t label;
+            if (__dbc_tok_is(tok, ',')) {
+                continue;
+            }
+            if (unlikely(!__dbc_tok_unquote(tok, &label))) {
+                success = PARSE_ERR_MALFORMED;
+                label = tok;
+            }
+            DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+            const bool added =
+                __dbc_attr_def_add_label_len(def, label.ptr, label.len);
+            DBC_INSTR_POP();
+            if (unlikely(!added)) {
+                return PARSE_ERR_CRITICAL;
+            }
+        }
+        return success;
+    }
+
+    return __dbc_lex_expect(&lx, ';') ? success : PARSE_ERR_MALFORMED;
+}
+
+/**
+ * @brief Parses a value of the attribute: a string, a number, or, for enums,
+ *        the index or the quoted label.
+ * @return PARSE_ERR_MALFORMED if the value does not fit the attribute.
+ */
+static parse_err_t __dbc_parse_attr_value(dbc_attr_def_t def,
+                                          const dbc_tok_t tok,
+                                          dbc_attr_value_t* value) {
+    dbc_tok_t content;
+    const bool quoted = __dbc_tok_unquote(tok, &content);
+    value->num = 0;
+    value->str = NULL;
+
+    switch (dbc_attr_def_get_type(def)) {
+        case DBC_ATTR_STRING:
+            if (unlikely(!quoted)) {
+                return PARSE_ERR_MALFORMED;
+            }
+            value->str =
+                __dbc_attr_def_intern_len(def, content.ptr, content.len);
+            return value->str != NULL ? PARSE_ERR_SUCCESS
+                                      : PARSE_ERR_CRITICAL;
+        case DBC_ATTR_ENUM: {
+            size_t idx;
+            if (quoted) {
+                idx = __dbc_attr_def_find_label_len(def, content.ptr,
+                                                    content.len);
+            } else {
+                uint32_t num;
+                idx = maybe_str_to_uint(&num, tok.ptr, tok.len) ? num
+                                                                 : SIZE_MAX;
+            }
+            value->str = dbc_attr_def_get_label(def, idx);
+            if (unlikely(value->str == NULL)) {
+                return PARSE_ERR_MALFORMED;
+            }
+            value->num = (double)idx;
+            return PARSE_ERR_SUCCESS;
+        }
+        default:
+            // Some tools quote numbers, too.
+            if (quoted) {
+                return maybe_str_to_double(&value->num, content.ptr,
+                                           content.len)
+                    ? PARSE_ERR_SUCCESS
+                    : PARSE_ERR_MALFORMED;
+            }
+            return maybe_str_to_double(&value->num, tok.ptr, tok.len)
+                ? PARSE_ERR_SUCCESS
+                : PARSE_ERR_MALFORMED;
+    }
+}
+
+/**
+ * @brief Looks up the attribute named by the next token.
+ * @return The attribute, NULL if there is none.
+ */
+static dbc_attr_def_t __dbc_lex_attr_def(dbc_t dbc, dbc_lexer_t* lx) {
+    dbc_tok_t tok;
+    dbc_tok_t name;
+    if (unlikely(!__dbc_lex(lx, &tok) || !__dbc_tok_unquote(tok, &name))) {
+        return NULL;
+    }
+    return __dbc_find_attr_def_len(dbc, name.ptr, name.len);
+}
+
+static parse_err_t __dbc_parse_attr_default(dbc_t dbc, const char* str,
+                                            const size_t len) {
+    // 'BA_DEF_DEF_' attribute_name attribute_value ';'
+    if (__dbc_defer_statement(dbc, str, len)) {
+        return PARSE_ERR_SUCCESS;
+    }
+
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // BA_DEF_DEF_, ignore.
+
+    const dbc_attr_def_t def = __dbc_lex_attr_def(dbc, &lx);
+    if (def == NULL) {
+        // Possibly the default of an environment variable attribute.
+        return PARSE_ERR_SUCCESS;
+    }
+
+    dbc_attr_value_t value;
+    if (unlikely(!__dbc_lex(&lx, &tok))) {
+        return PARSE_ERR_MALFORMED;
+    }
+    const parse_err_t err = __dbc_parse_attr_value(def, tok, &value);
+    if (unlikely(err != PARSE_ERR_SUCCESS)) {
+        return err;
+    }
+    __dbc_attr_def_set_default(def, &value);
+    return __dbc_lex_expect(&lx, ';') ? PARSE_ERR_SUCCESS
+                                      : PARSE_ERR_MALFORMED;
+}
+
+static parse_err_t __dbc_parse_attribute(dbc_t dbc, const char* str,
+                                         const size_t len) {
+    // 'BA_' attribute_name [ 'BU_' node_name | 'BO_' message_id
+    //     | 'SG_' message_id signal_name | 'EV_' env_var_name ]
+    //     attribute_value ';'
+    if (__dbc_defer_statement(dbc, str, len)) {
+        return PARSE_ERR_SUCCESS;
+    }
+
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // BA_, ignore.
+
+    const dbc_attr_def_t def = __dbc_lex_attr_def(dbc, &lx);
+    dbc_object_kind_t kind;
+    uint32_t obj;
+    uint32_t sub;
+    const object_ref_t ref =
+        __dbc_parse_object_ref(dbc, &lx, &tok, &kind, &obj, &sub);
+    if (ref == OBJECT_REF_IGNORED) {
+        return PARSE_ERR_SUCCESS;
+    }
+    if (unlikely(def == NULL || ref == OBJECT_REF_UNKNOWN
+                 || dbc_attr_def_get_object_kind(def) != kind)) {
+        return PARSE_ERR_MALFORMED;
+    }
+
+    dbc_attr_value_t value;
+    const parse_err_t err = __dbc_parse_attr_value(def, tok, &value);
+    if (unlikely(err != PARSE_ERR_SUCCESS)) {
+        return err;
+    }
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_INSERT);
+    const bool set = __dbc_attr_def_set_value(def, obj, sub, &value);
+    DBC_INSTR_POP();
+    if (unlikely(!set)) {
+        return PARSE_ERR_CRITICAL;
+    }
+    return __dbc_lex_expect(&lx, ';') ? PARSE_ERR_SUCCESS
+                                      : PARSE_ERR_MALFORMED;
+}
+
+/**
+ * @brief How far a statement extends past its keyword.
+ */
+typedef enum {
+    /** The statement ends with the line. */
+    STMT_TERM_LINE,
+    /** The statement ends with a ';' outside of any string. */
+    STMT_TERM_SEMICOLON,
+    /** The statement ends before the next line beginning in column 0. */
+    STMT_TERM_SECTION
+} stmt_term_t;
+
+/**
+ * @brief Where a statement names the message it is about, if it does.
+ */
+typedef enum {
+    /** The statement is not about any one message. */
+    STMT_SUBJECT_NONE,
+    /** The message ID follows the keyword. */
+    STMT_SUBJECT_ID,
+    /** A BO_ or SG_ object, then the message ID, follow the keyword. */
+    STMT_SUBJECT_OBJECT,
+    /** As STMT_SUBJECT_OBJECT, but after the attribute name. */
+    STMT_SUBJECT_ATTRIBUTE
+} stmt_subject_t;
+
+typedef parse_err_t (*stmt_parser_t)(dbc_t, const char*, const size_t);
+
+typedef struct {
+    const char* keyword;
+    size_t keyword_len;
+    stmt_term_t term;
+    stmt_parser_t parse;
+    stmt_subject_t subject;
+} stmt_def_t;
+
+#define STMT_ABOUT(keyword, term, parse, subject) \
+    { keyword, sizeof(keyword) - 1, term, parse, subject }
+#define STMT(keyword, term, parse) \
+    STMT_ABOUT(keyword, term, parse, STMT_SUBJECT_NONE)
+
+static const stmt_def_t STMT_DEFS[] = {
+    STMT("VERSION", STMT_TERM_LINE, __dbc_parse_version),
+    STMT("NS_", STMT_TERM_SECTION, NULL),
+    STMT("BS_", STMT_TERM_LINE, NULL),
+    STMT("BU_", STMT_TERM_LINE, __dbc_parse_nodes),
+    STMT("VAL_TABLE_", STMT_TERM_SEMICOLON, __dbc_parse_value_table),
+    STMT("BO_", STMT_TERM_LINE, __dbc_parse_message),
+    STMT("SG_", STMT_TERM_LINE, __dbc_parse_signal),
+    STMT_ABOUT("BO_TX_BU_", STMT_TERM_SEMICOLON, NULL, STMT_SUBJECT_ID),
+    STMT("EV_", STMT_TERM_SEMICOLON, NULL),
+    STMT("ENVVAR_DATA_", STMT_TERM_SEMICOLON, NULL),
+    STMT("SGTYPE_", STMT_TERM_SEMICOLON, NULL),
+    STMT("SGTYPE_VAL_", STMT_TERM_SEMICOLON, NULL),
+    STMT("SIG_TYPE_REF_", STMT_TERM_SEMICOLON, NULL),
+    STMT_ABOUT("SIG_GROUP_", STMT_TERM_SEMICOLON, NULL, STMT_SUBJECT_ID),
+    STMT_ABOUT("SIG_VALTYPE_", STMT_TERM_SEMICOLON, NULL, STMT_SUBJECT_ID),
+    STMT("SIGTYPE_VALTYPE_", STMT_TERM_SEMICOLON, NULL),
+    STMT_ABOUT("SG_MUL_VAL_", STMT_TERM_SEMICOLON,
+               __dbc_parse_signal_mux_values, STMT_SUBJECT_ID),
+    STMT_ABOUT("CM_", STMT_TERM_SEMICOLON, __dbc_parse_comment,
+               STMT_SUBJECT_OBJECT),
+    STMT("BA_DEF_", STMT_TERM_SEMICOLON, __dbc_parse_attr_def),
+    STMT("BA_DEF_SGTYPE_", STMT_TERM_SEMICOLON, NULL),
+    STMT("BA_DEF_REL_", STMT_TERM_SEMICOLON, NULL),
+    STMT("BA_DEF_DEF_", STMT_TERM_SEMICOLON, __dbc_parse_attr_default),
+    STMT("BA_DEF_DEF_REL_", STMT_TERM_SEMICOLON, NULL),
+    STMT_ABOUT("BA_", STMT_TERM_SEMICOLON, __dbc_parse_attribute,
+               STMT_SUBJECT_ATTRIBUTE),
+    STMT("BA_SGTYPE_", STMT_TERM_SEMICOLON, NULL),
+    STMT("BA_REL_", STMT_TERM_SEMICOLON, NULL),
+    STMT_ABOUT("VAL_", STMT_TERM_SEMICOLON, NULL, STMT_SUBJECT_ID),
+    STMT("CAT_DEF_", STMT_TERM_SEMICOLON, NULL),
+    STMT("CAT_", STMT_TERM_SEMICOLON, NULL),
+    STMT("FILTER", STMT_TERM_SEMICOLON, NULL),
+    STMT("EV_DATA_", STMT_TERM_SEMICOLON, NULL),
+    STMT("BU_SG_REL_", STMT_TERM_SEMICOLON, NULL),
+    STMT("BU_EV_REL_", STMT_TERM_SEMICOLON, NULL),
+    STMT("BU_BO_REL_", STMT_TERM_SEMICOLON, NULL),
+};
+
+// Anything we do not recognize is skipped a line at a time.
+static const stmt_def_t STMT_DEF_UNKNOWN = STMT("", STMT_TERM_LINE, NULL);
+
+#define STMT_NUM_DEFS (sizeof(STMT_DEFS) / sizeof(STMT_DEFS[0]))
+
+// Parse statistics have a row for every keyword, and one for the unknown.
+typedef char stmt_defs_fit_stats[STMT_NUM_DEFS < DBC_PARSE_STATS_MAX_KEYWORDS
+                                     ? 1
+                                     : -1];
+
+/**
+ * @return The statement's row in dbc_parse_stats_t's keywords.
+ */
+static inline size_t __dbc_stmt_index(const stmt_def_t* def) {
+    return def == &STMT_DEF_UNKNOWN ? STMT_NUM_DEFS
+                                    : (size_t)(def - STMT_DEFS);
+}
+
+/**
+ * @brief Parses a statement of the kind def describes, timing it when
+ *        instrumented.
+ */
+static inline parse_err_t __dbc_parse_statement(dbc_t dbc,
+                                                const stmt_def_t* def,
+                                                const char* str,
+                                                const size_t len) {
+    DBC_INSTR_BEGIN_STATEMENT();
+    const parse_err_t err = def->parse(dbc, str, len);
+    DBC_INSTR_END_STATEMENT(__dbc_stmt_index(def), str, len,
+                            (dbc_parse_status_t)err);
+    return err;
+}
+
+/*
+ * Keywords are classified with a perfect hash of their length and first eight
+ * bytes. The multiplier was searched for such that no two keywords share a
+ * bucket, so adding a keyword means searching for a new one. The keyword
+ * tests catch any collision.
+ */
+#define STMT_HASH_BITS (6U)
+#define STMT_HASH_MULTIPLIER UINT64_C(0xd533fe8e71353be7)
+#define STMT_MAX_KEYWORD_LEN (16U)
+
+// One past the keyword's index in STMT_DEFS, 0 for empty buckets.
+static const uint8_t STMT_BUCKETS[1U << STMT_HASH_BITS] = {
+    [1] = 25, // BA_SGTYPE_
+    [2] = 31, // EV_DATA_
+    [3] = 10, // ENVVAR_DATA_
+    [8] = 24, // BA_
+    [9] = 1, // VERSION
+    [12] = 4, // BU_
+    [15] = 17, // SG_MUL_VAL_
+    [17] = 5, // VAL_TABLE_
+    [18] = 22, // BA_DEF_DEF_
+    [19] = 12, // SGTYPE_VAL_
+    [20] = 20, // BA_DEF_SGTYPE_
+    [23] = 14, // SIG_GROUP_
+    [24] = 11, // SGTYPE_
+    [25] = 18, // CM_
+    [30] = 16, // SIGTYPE_VALTYPE_
+    [32] = 7, // SG_
+    [33] = 8, // BO_TX_BU_
+    [34] = 15, // SIG_VALTYPE_
+    [36] = 28, // CAT_DEF_
+    [37] = 27, // VAL_
+    [38] = 19, // BA_DEF_
+    [39] = 23, // BA_DEF_DEF_REL_
+    [40] = 26, // BA_REL_
+    [41] = 33, // BU_EV_REL_
+    [45] = 29, // CAT_
+    [49] = 2, // NS_
+    [50] = 3, // BS_
+    [51] = 32, // BU_SG_REL_
+    [55] = 13, // SIG_TYPE_REF_
+    [56] = 34, // BU_BO_REL_
+    [57] = 9, // EV_
+    [58] = 21, // BA_DEF_REL_
+    [62] = 6, // BO_
+    [63] = 30, // FILTER
+};
+
+static inline size_t __dbc_stmt_hash(const uint64_t word, const size_t len) {
+    return (size_t)(((word + len) * STMT_HASH_MULTIPLIER)
+                    >> (64 - STMT_HASH_BITS));
+}
+
+/**
+ * @brief Packs up to the first eight bytes of the keyword, little endian,
+ *        zero-padded.
+ */
+static inline uint64_t __dbc_keyword_word(const dbc_tok_t keyword,
+                                          const char* const end) {
+    const size_t len = keyword.len < 8 ? keyword.len : 8;
+    const uint8_t* const bytes = (const uint8_t*)keyword.ptr;
+    if (likely(end - keyword.ptr >= 8)) {
+        const uint64_t word = __dbc_bytes_le64(bytes);
+        return len == 8 ? word : word & ((UINT64_C(1) << (8 * len)) - 1);
+    }
+
+    uint64_t word = 0;
+    for (size_t i = 0; i < len; i++) {
+        word |= (uint64_t)bytes[i] << (8 * i);
+    }
+    return word;
+}
+
+/**
+ * @param end The end of the input the keyword was lexed from. The keyword is
+ *            read in words, never past it.
+ */
+static const stmt_def_t* __dbc_classify_statement(const dbc_tok_t keyword,
+                                                  const char* const end) {
+    if (unlikely(keyword.len > STMT_MAX_KEYWORD_LEN)) {
+        return &STMT_DEF_UNKNOWN;
+    }
+
+    const size_t bucket = STMT_BUCKETS[__dbc_stmt_hash(
+        __dbc_keyword_word(keyword, end), keyword.len)];
+    if (bucket != 0) {
+        const stmt_def_t* const def = &STMT_DEFS[bucket - 1];
+        if (likely(def->keyword_len == keyword.len
+                   && memcmp(def->keyword, keyword.ptr, keyword.len) == 0)) {
+            return def;
+        }
+    }
+
+    return &STMT_DEF_UNKNOWN;
+}
+
+/**
+ * @brief Finds the end of the statement starting at begin.
+ * @param terminated Set if the statement's terminator was found, rather than
+ *                   the statement running into the end of the input.
+ * @return One past the last character of the statement.
+ */
+static const char* __dbc_statement_end(const stmt_term_t term,
+                                       const char* const begin,
+                                       const char* const end,
+                                       bool* terminated) {
+    const char* cur = begin;
+    *terminated = true;
+    switch (term) {
+        case STMT_TERM_LINE: {
+            const char* const nl =
+                (const char*)memchr(cur, '\n', (size_t)(end - cur));
+            if (nl != NULL) {
+                return nl + 1;
+            }
+            break;
+        }
+        case STMT_TERM_SEMICOLON:
+            while ((cur = __dbc_find_either(cur, end, '"', ';')) < end) {
+                if (*cur == ';') {
+                    return cur + 1;
+                }
+                cur = __dbc_find_closing_quote(cur, end);
+                if (unlikely(cur == NULL)) {
+                    break;
+                }
+                cur++;
+            }
+            break;
+        case STMT_TERM_SECTION:
+            while ((cur = (const char*)memchr(cur, '\n', (size_t)(end - cur)))
+                   != NULL) {
+                cur++;
+                if (cur < end && !__dbc_is_space(*cur)) {
+                    return cur;
+                }
+            }
+            break;
+    }
+
+    *terminated = false;
+    return end;
+}
+
+/**
+ * @brief Skips the UTF-8 byte order mark some editors like to leave behind.
+ */
+static inline const char* __dbc_skip_bom(const char* buf, const size_t len) {
+    return len >= 3 && memcmp(buf, "\xEF\xBB\xBF", 3) == 0 ? buf + 3 : buf;
+}
+
+/**
+ * @brief Parses the statements in the buffer into the dbc.
+ *
+ * @param final If not set, more input follows the buffer, and a statement
+ *              running into the end of the buffer is left for later.
+ * @param worst Raised to the most severe error encountered.
+ * @return The length of the parsed prefix of the buffer.
+ */
+static size_t __dbc_parse_statements_some(dbc_t dbc, const char* buf,
+                                          const size_t len, const bool final,
+                                          parse_err_t* worst) {
+    const char* const end = buf + len;
+    const char* parsed = buf;
+    bool unfinished = false;
+
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_SCAN);
+    dbc_lexer_t lx = __dbc_lexer(buf, len);
+    dbc_tok_t keyword;
+    while (__dbc_lex(&lx, &keyword)) {
+        const stmt_def_t* const def = __dbc_classify_statement(keyword, end);
+        bool terminated;
+        const char* const stmt_end =
+            __dbc_statement_end(def->term, keyword.ptr, end, &terminated);
+        if (!terminated && !final) {
+            unfinished = true;
+            break;
+        }
+
+        const size_t stmt_len = (size_t)(stmt_end - keyword.ptr);
+        DBC_INSTR_SCANNED(__dbc_stmt_index(def), def->keyword, stmt_len);
+        if (def->parse != NULL) {
+            const parse_err_t err =
+                __dbc_parse_statement(dbc, def, keyword.ptr, stmt_len);
+            *worst = err > *worst ? err : *worst;
+        }
+
+        lx.cur = stmt_end;
+        parsed = stmt_end;
+    }
+    DBC_INSTR_POP();
+
+    // Trailing whitespace belongs to no statement, it can go.
+    return unfinished ? (size_t)(parsed - buf) : len;
+}
+
+/**
+ * @brief Parses every statement in the buffer into the dbc.
+ * @return The most severe error encountered.
+ */
+static parse_err_t __dbc_parse_statements(dbc_t dbc, const char* buf,
+                                          const size_t len) {
+    parse_err_t worst = PARSE_ERR_SUCCESS;
+    const char* const cur = __dbc_skip_bom(buf, len);
+    __dbc_parse_statements_some(dbc, cur, (size_t)(buf + len - cur), true,
+                                &worst);
+    return worst;
+}
+
+dbc_parse_status_t __dbc_parse_into(dbc_t dbc, const char* buf,
+                                    const size_t len) {
+    return (dbc_parse_status_t)__dbc_parse_statements(dbc, buf, len);
+}
+
+dbc_parse_status_t __dbc_parse_deferred(dbc_t dbc) {
+    size_t n;
+    const dbc_stmt_ref_t* const stmts = __dbc_take_deferred(dbc, &n);
+    return __dbc_parse_refs(dbc, stmts, n);
+}
+
+dbc_parse_status_t __dbc_parse_refs(dbc_t dbc, const dbc_stmt_ref_t* stmts,
+                                    const size_t n) {
+    parse_err_t worst = PARSE_ERR_SUCCESS;
+    for (size_t i = 0; i < n; i++) {
+        dbc_lexer_t lx = __dbc_lexer(stmts[i].str, stmts[i].len);
+        dbc_tok_t keyword;
+        __dbc_lex(&lx, &keyword);
+        const stmt_def_t* const def = __dbc_classify_statement(
+            keyword, stmts[i].str + stmts[i].len);
+        const parse_err_t err =
+            __dbc_parse_statement(dbc, def, stmts[i].str, stmts[i].len);
+        worst = err > worst ? err : worst;
+    }
+    return (dbc_parse_status_t)worst;
+}
+
+size_t __dbc_split_statements(const char* buf, const size_t len,
+                              const size_t n, const char** starts) {
+    const char* const end = buf + len;
+    const char* const cur = __dbc_skip_bom(buf, len);
+    size_t num_starts = 1;
+    starts[0] = buf;
+
+    // Only the keywords are lexed here, the statements themselves are
+    // skipped over. Signals belong to the message before them, so a piece
+    // never starts on one.
+    dbc_lexer_t lx = __dbc_lexer(cur, (size_t)(end - cur));
+    dbc_tok_t keyword;
+    while (num_starts < n && __dbc_lex(&lx, &keyword)) {
+        const stmt_def_t* const def = __dbc_classify_statement(keyword, end);
+        const size_t target = len / n * num_starts;
+        if ((size_t)(keyword.ptr - buf) >= target
+            && def->parse != __dbc_parse_signal) {
+            starts[num_starts++] = keyword.ptr;
+        }
+
+        bool terminated;
+        lx.cur = __dbc_statement_end(def->term, keyword.ptr, end, &terminated);
+    }
+
+    return num_starts;
+}
+
+dbc_t dbc_parse_buffer(const char* buf, size_t len,
+                       dbc_parse_status_t* status) {
+    const dbc_t dbc = dbc_new();
+    if (unlikely(dbc == NULL)) {
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+    parse_err_t err = __dbc_parse_statements(dbc, buf, len);
+    __dbc_build_mux(dbc);
+    if (unlikely(!__dbc_sort_annotations(dbc))) {
+        err = PARSE_ERR_CRITICAL;
+    }
+
+    if (status != NULL) {
+        *status = (dbc_parse_status_t)err;
+    }
+    return dbc;
+}
+
+dbc_t dbc_parse_file(const char* path, dbc_parse_status_t* status) {
+    dbc_file_map_t map;
+    if (unlikely(!__dbc_file_map(path, &map))) {
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+
+    const dbc_t dbc = dbc_parse_buffer(map.data, map.len, status);
+    __dbc_file_unmap(&map);
+    return dbc;
+}
+
+/**
+ * @brief Matches the string against a pattern of '*' for any run of
+ *        characters and '?' for any one character.
+ */
+static bool __dbc_glob_match(const char* pattern, const char* str,
+                             const size_t len) {
+    const char* const end = str + len;
+    // Where to resume when a mismatch follows the last '*'.
+    const char* star = NULL;
+    const char* star_str = NULL;
+
+    while (str < end) {
+        if (*pattern == '*') {
+            star = ++pattern;
+            star_str = str;
+        } else if (*pattern != '\0' && (*pattern == '?' || *pattern == *str)) {
+            pattern++;
+            str++;
+        } else if (star != NULL) {
+            // Let the '*' swallow one more character and try again.
+            pattern = star;
+            str = ++star_str;
+        } else {
+            return false;
+        }
+    }
+
+    while (*pattern == '*') {
+        pattern++;
+    }
+    return *pattern == '\0';
+}
+
+static bool __dbc_is_included_node(const dbc_load_opts_t* opts,
+                                   const dbc_tok_t tok) {
+    for (size_t i = 0; i < opts->num_include_nodes; i++) {
+        const char* const node = opts->include_nodes[i];
+        if (strlen(node) == tok.len && memcmp(node, tok.ptr, tok.len) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Whether one of the included nodes receives a signal of the SG_
+ *        statements starting at cur.
+ */
+static bool __dbc_signals_received(const dbc_load_opts_t* opts,
+                                   const char* cur, const char* const end) {
+    dbc_lexer_t lx = __dbc_lexer(cur, (size_t)(end - cur));
+    dbc_tok_t keyword;
+    while (__dbc_lex(&lx, &keyword)
+           && __dbc_classify_statement(keyword, end)->parse
+                  == __dbc_parse_signal) {
+        bool terminated;
+        const char* const stmt_end = __dbc_statement_end(
+            STMT_TERM_LINE, keyword.ptr, end, &terminated);
+
+        // The receivers follow the range and the unit.
+        dbc_lexer_t sg = __dbc_lexer(keyword.ptr,
+                                     (size_t)(stmt_end - keyword.ptr));
+        dbc_tok_t tok;
+        while (__dbc_lex(&sg, &tok) && !__dbc_tok_is(tok, ']')) {
+        }
+        __dbc_lex(&sg, &tok);
+        while (__dbc_lex(&sg, &tok)) {
+            if (__dbc_is_included_node(opts, tok)) {
+                return true;
+            }
+        }
+
+        lx.cur = stmt_end;
+    }
+    return false;
+}
+
+/**
+ * @brief Decides whether the message of the BO_ statement in str is loaded.
+ * @param signals Where the message's SG_ statements start.
+ * @return false if the statement is beyond understanding, and should be left
+ *         to the message parser to complain about.
+ */
+static bool __dbc_message_included(const dbc_load_opts_t* opts,
+                                   const char* str, const size_t len,
+                                   const char* signals, const char* end,
+                                   bool* included) {
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // BO_, ignore.
+
+    uint32_t id;
+    dbc_tok_t name;
+    uint32_t size;
+    dbc_tok_t transmitter = { "", 0 };
+    if (unlikely(!__dbc_lex_uint(&lx, &id) || !__dbc_lex(&lx, &name)
+                 || __dbc_tok_is(name, ':') || !__dbc_lex_expect(&lx, ':')
+                 || !__dbc_lex_uint(&lx, &size))) {
+        return false;
+    }
+    __dbc_lex(&lx, &transmitter);
+
+    if (opts->exclude_name_glob != NULL
+        && __dbc_glob_match(opts->exclude_name_glob, name.ptr, name.len)) {
+        *included = false;
+        return true;
+    }
+    if (opts->num_include_ids == 0 && opts->num_include_nodes == 0) {
+        *included = true;
+        return true;
+    }
+
+    for (size_t i = 0; i < opts->num_include_ids; i++) {
+        if (opts->include_ids[i] == id) {
+            *included = true;
+            return true;
+        }
+    }
+    *included = opts->num_include_nodes != 0
+        && (__dbc_is_included_node(opts, transmitter)
+            || __dbc_signals_received(opts, signals, end));
+    return true;
+}
+
+/**
+ * @brief Finds the ID of the message the statement is about.
+ * @return false if the statement is not about a message.
+ */
+static bool __dbc_statement_subject(const stmt_def_t* def, const char* str,
+                                    const size_t len, uint32_t* id) {
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t tok;
+    __dbc_lex(&lx, &tok); // The keyword, ignore.
+
+    switch (def->subject) {
+        case STMT_SUBJECT_NONE:
+            return false;
+        case STMT_SUBJECT_ATTRIBUTE:
+            __dbc_lex(&lx, &tok); // The attribute name, ignore.
+            /* fallthrough */
+        case STMT_SUBJECT_OBJECT:
+            if (!__dbc_lex(&lx, &tok) || tok.len != 3
+                || (memcmp(tok.ptr, "BO_", 3) != 0
+                    && memcmp(tok.ptr, "SG_", 3) != 0)) {
+                return false;
+            }
+            /* fallthrough */
+        case STMT_SUBJECT_ID:
+            break;
+    }
+    return __dbc_lex_uint(&lx, id);
+}
+
+/**
+ * @brief Parses the statements in the buffer into the dbc, skipping those
+ *        about messages the options leave out.
+ * @return The most severe error encountered.
+ */
+static parse_err_t __dbc_parse_statements_filtered(dbc_t dbc,
+                                                   const dbc_load_opts_t* opts,
+                                                   const char* buf,
+                                                   const size_t len) {
+    parse_err_t worst = PARSE_ERR_SUCCESS;
+    const char* const end = buf + len;
+    const char* const cur = __dbc_skip_bom(buf, len);
+
+    // Whether the message defined last was left out, signals belong to it.
+    bool skipping = false;
+
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_SCAN);
+    dbc_lexer_t lx = __dbc_lexer(cur, (size_t)(end - cur));
+    dbc_tok_t keyword;
+    while (__dbc_lex(&lx, &keyword)) {
+        const stmt_def_t* const def = __dbc_classify_statement(keyword, end);
+        bool terminated;
+        const char* const stmt_end =
+            __dbc_statement_end(def->term, keyword.ptr, end, &terminated);
+        const size_t stmt_len = (size_t)(stmt_end - keyword.ptr);
+        DBC_INSTR_SCANNED(__dbc_stmt_index(def), def->keyword, stmt_len);
+        lx.cur = stmt_end;
+        if (def->parse == NULL) {
+            continue;
+        }
+
+        uint32_t id;
+        if (def->parse == __dbc_parse_message) {
+            bool included;
+            if (__dbc_message_included(opts, keyword.ptr, stmt_len, stmt_end,
+                                       end, &included)) {
+                skipping = !included;
+            }
+            if (skipping) {
+                continue;
+            }
+        } else if (def->parse == __dbc_parse_signal) {
+            if (skipping) {
+                continue;
+            }
+        } else if (__dbc_statement_subject(def, keyword.ptr, stmt_len, &id)
+                   && dbc_get_message_by_id(dbc, id) == NULL) {
+            // Left out, or never defined in the first place.
+            continue;
+        }
+
+        const parse_err_t err =
+            __dbc_parse_statement(dbc, def, keyword.ptr, stmt_len);
+        worst = err > worst ? err : worst;
+    }
+    DBC_INSTR_POP();
+
+    return worst;
+}
+
+dbc_t dbc_parse_buffer_opts(const char* buf, size_t len,
+                            const dbc_load_opts_t* opts,
+                            dbc_parse_status_t* status) {
+    if (opts == NULL) {
+        return dbc_parse_buffer(buf, len, status);
+    }
+
+    const dbc_t dbc = dbc_new();
+    if (unlikely(dbc == NULL)) {
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+    parse_err_t err = __dbc_parse_statements_filtered(dbc, opts, buf, len);
+    __dbc_build_mux(dbc);
+    if (unlikely(!__dbc_sort_annotations(dbc))) {
+        err = PARSE_ERR_CRITICAL;
+    }
+
+    if (status != NULL) {
+        *status = (dbc_parse_status_t)err;
+    }
+    return dbc;
+}
+
+dbc_t dbc_parse_file_opts(const char* path, const dbc_load_opts_t* opts,
+                          dbc_parse_status_t* status) {
+    dbc_file_map_t map;
+    if (unlikely(!__dbc_file_map(path, &map))) {
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+
+    const dbc_t dbc = dbc_parse_buffer_opts(map.data, map.len, opts, status);
+    __dbc_file_unmap(&map);
+    return dbc;
+}
+
+/**
+ * @brief Parses the SG_ statements deferred by a lazy load.
+ */
+static dbc_parse_status_t __dbc_parse_signal_block(dbc_message_t msg,
+                                                   const char* str,
+                                                   const size_t len) {
+    parse_err_t worst = PARSE_ERR_SUCCESS;
+    const char* const end = str + len;
+
+    dbc_lexer_t lx = __dbc_lexer(str, len);
+    dbc_tok_t keyword;
+    while (__dbc_lex(&lx, &keyword)) {
+        bool terminated;
+        const char* const stmt_end = __dbc_statement_end(
+            STMT_TERM_LINE, keyword.ptr, end, &terminated);
+        const size_t stmt_len = (size_t)(stmt_end - keyword.ptr);
+        DBC_INSTR_BEGIN_STATEMENT();
+        const parse_err_t err =
+            __dbc_parse_signal_in(msg, keyword.ptr, stmt_len);
+        DBC_INSTR_END_STATEMENT(
+            __dbc_stmt_index(__dbc_classify_statement(keyword, end)),
+            keyword.ptr, stmt_len, (dbc_parse_status_t)err);
+        worst = err > worst ? err : worst;
+        lx.cur = stmt_end;
+    }
+
+    return (dbc_parse_status_t)worst;
+}
+
+/**
+ * @return Whether the statement is a comment or about attributes, which a
+ *         lazy load leaves for later.
+ */
+static inline bool __dbc_is_annotation(const stmt_def_t* def) {
+    return def->parse == __dbc_parse_comment
+        || def->parse == __dbc_parse_attr_def
+        || def->parse == __dbc_parse_attr_default
+        || def->parse == __dbc_parse_attribute;
+}
+
+/**
+ * @brief Parses every statement in the buffer into the dbc, but for the SG_
+ *        statements following a message, which are only marked on it, and
+ *        comments and attributes, which are kept aside.
+ * @return The most severe error encountered.
+ */
+static parse_err_t __dbc_parse_statements_lazy(dbc_t dbc, dbc_lazy_t lazy,
+                                               const char* buf,
+                                               const size_t len) {
+    parse_err_t worst = PARSE_ERR_SUCCESS;
+    const char* const end = buf + len;
+    const char* const cur = __dbc_skip_bom(buf, len);
+
+    // The message whose signals are being skipped, and where they start.
+    dbc_message_t msg = NULL;
+    const char* block = NULL;
+    const char* block_end = NULL;
+
+    DBC_INSTR_PUSH(DBC_PARSE_PHASE_SCAN);
+    dbc_lexer_t lx = __dbc_lexer(cur, (size_t)(end - cur));
+    dbc_tok_t keyword;
+    while (__dbc_lex(&lx, &keyword)) {
+        const stmt_def_t* const def = __dbc_classify_statement(keyword, end);
+        bool terminated;
+        const char* const stmt_end =
+            __dbc_statement_end(def->term, keyword.ptr, end, &terminated);
+        const size_t stmt_len = (size_t)(stmt_end - keyword.ptr);
+        DBC_INSTR_SCANNED(__dbc_stmt_index(def), def->keyword, stmt_len);
+        lx.cur = stmt_end;
+
+        if (def->parse == __dbc_parse_signal && msg != NULL) {
+            block = block == NULL ? keyword.ptr : block;
+            block_end = stmt_end;
+            continue;
+        }
+
+        if (block != NULL) {
+            __dbc_message_set_lazy(msg, lazy, block,
+                                   (size_t)(block_end - block));
+            block = NULL;
+        }
+        msg = NULL;
+
+        if (__dbc_is_annotation(def)) {
+            if (unlikely(!__dbc_defer_annotation(dbc, keyword.ptr,
+                                                 stmt_len))) {
+                worst = PARSE_ERR_CRITICAL;
+            }
+        } else if (def->parse != NULL) {
+            const size_t num_messages = dbc_get_num_messages(dbc);
+            const parse_err_t err =
+                __dbc_parse_statement(dbc, def, keyword.ptr, stmt_len);
+            worst = err > worst ? err : worst;
+
+            // Signals of a message that could not be added go to the one
+            // before it, as they do when parsed eagerly.
+            if (def->parse == __dbc_parse_message
+                && dbc_get_num_messages(dbc) > num_messages) {
+                msg = dbc_get_message(dbc, num_messages);
+            }
+        }
+    }
+
+    if (block != NULL) {
+        __dbc_message_set_lazy(msg, lazy, block, (size_t)(block_end - block));
+    }
+    DBC_INSTR_POP();
+    return worst;
+}
+
+dbc_t dbc_parse_buffer_lazy(const char* buf, size_t len,
+                            dbc_parse_status_t* status) {
+    const dbc_t dbc = dbc_new();
+    const dbc_lazy_t lazy = dbc == NULL
+        ? NULL
+        : __dbc_lazy_new(__dbc_parse_signal_block);
+    if (unlikely(lazy == NULL)) {
+        if (dbc != NULL) {
+            dbc_free(dbc);
+        }
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+    __dbc_set_lazy(dbc, lazy);
+
+    const parse_err_t err = __dbc_parse_statements_lazy(dbc, lazy, buf, len);
+    __dbc_build_mux(dbc);
+    if (status != NULL) {
+        *status = (dbc_parse_status_t)err;
+    }
+    return dbc;
+}
+
+dbc_t dbc_parse_file_lazy(const char* path, dbc_parse_status_t* status) {
+    dbc_file_map_t map;
+    if (unlikely(!__dbc_file_map(path, &map))) {
+        if (status != NULL) {
+            *status = DBC_PARSE_IO_ERROR;
+        }
+        return NULL;
+    }
+
+    const dbc_t dbc = dbc_parse_buffer_lazy(map.data, map.len, status);
+    if (unlikely(dbc == NULL)) {
+        __dbc_file_unmap(&map);
+        return NULL;
+    }
+    // The deferred statements are parsed straight out of the mapping.
+    __dbc_keep_file_map(dbc, &map);
+    return dbc;
+}
+
+#define PARSER_INITIAL_CAPACITY (4096U)
+
+struct dbc_parser {
+    dbc_t dbc;
+    // The unfinished statement, carried over to the next call.
+    char* pending;
+    size_t pending_len;
+    size_t pending_cap;
+    // Whether the byte order mark may still be ahead.
+    bool at_start;
+    parse_err_t worst;
+};
+
+dbc_parser_t dbc_parser_new(void) {
+    const dbc_parser_t parser =
+        (dbc_parser_t)calloc(1, sizeof(struct dbc_parser));
+    if (unlikely(parser == NULL)) {
+        return NULL;
+    }
+
+    parser->dbc = dbc_new();
+    if (unlikely(parser->dbc == NULL)) {
+        free(parser);
+        return NULL;
+    }
+    parser->at_start = true;
+    parser->worst = PARSE_ERR_SUCCESS;
+    return parser;
+}
+
+/**
+ * @brief Parses what it can out of buf, bumping the parser's severity.
+ * @return The length of the parsed prefix of buf.
+ */
+static size_t __dbc_parser_parse(dbc_parser_t parser, const char* buf,
+                                 const size_t len, const bool final) {
+    const char* cur = buf;
+    if (parser->at_start) {
+        // Not enough input yet to tell whether there is a byte order mark.
+        if (len < 3 && !final) {
+            return 0;
+        }
+        cur = __dbc_skip_bom(buf, len);
+        parser->at_start = false;
+    }
+
+    const size_t skipped = (size_t)(cur - buf);
+    return skipped
+        + __dbc_parse_statements_some(parser->dbc, cur, len - skipped, final,
+                                      &parser->worst);
+}
+
+static bool __dbc_parser_append(dbc_parser_t parser, const char* buf,
+                                const size_t len) {
+    if (len == 0) {
+        return true;
+    }
+    if (parser->pending_len + len > parser->pending_cap) {
+        size_t new_cap = parser->pending_cap == 0 ? PARSER_INITIAL_CAPACITY
+                                                  : parser->pending_cap;
+        while (new_cap < parser->pending_len + len) {
+            new_cap *= 2;
+        }
+        char* const pending = (char*)realloc(parser->pending, new_cap);
+        if (unlikely(pending == NULL)) {
+            return false;
+        }
+        parser->pending = pending;
+        parser->pending_cap = new_cap;
+    }
+
+    memcpy(parser->pending + parser->pending_len, buf, len);
+    parser->pending_len += len;
+    return true;
+}
+
+bool dbc_parser_feed(dbc_parser_t parser, const char* buf, size_t len) {
+    while (len > 0) {
+        if (parser->pending_len == 0) {
+            // Nothing is carried over, so statements are parsed straight out
+            // of the caller's buffer and only the unfinished tail is kept.
+            const size_t parsed = __dbc_parser_parse(parser, buf, len, false);
+            return __dbc_parser_append(parser, buf + parsed, len - parsed);
+        }
+
+        // Finish the carried over statement first. Statements end with a
+        // line, or somewhere within one, so lines are moved over. Taking at
+        // least as much as is already pending keeps long statements from
+        // being rescanned over and over.
+        const size_t min_take =
+            parser->pending_len < len ? parser->pending_len : len;
+        const char* const nl =
+            (const char*)memchr(buf + min_take, '\n', len - min_take);
+        const size_t take = nl == NULL ? len : (size_t)(nl - buf) + 1;
+        if (unlikely(!__dbc_parser_append(parser, buf, take))) {
+            return false;
+        }
+        buf += take;
+        len -= take;
+
+        const size_t parsed = __dbc_parser_parse(parser, parser->pending,
+                                                 parser->pending_len, false);
+        parser->pending_len -= parsed;
+        memmove(parser->pending, parser->pending + parsed,
+                parser->pending_len);
+    }
+
+    return true;
+}
+
+dbc_t dbc_parser_finish(dbc_parser_t parser, dbc_parse_status_t* status) {
+    __dbc_parser_parse(parser, parser->pending, parser->pending_len, true);
+
+    const dbc_t dbc = parser->dbc;
+    __dbc_build_mux(dbc);
+    if (unlikely(!__dbc_sort_annotations(dbc))) {
+        parser->worst = PARSE_ERR_CRITICAL;
+    }
+    if (status != NULL) {
+        *status = (dbc_parse_status_t)parser->worst;
+    }
+    free(parser->pending);
+    free(parser);
+    return dbc;
+}
+
+void dbc_parser_free(dbc_parser_t parser) {
+    dbc_free(parser->dbc);
+    free(parser->pending);
+    free(parser);
+}
@@ -0,0 +1,136 @@
+#include <check.h>
+#include <stdint.h>
+#include "__libdbc_arena.h"
+
+START_TEST(tc_alloc_aligned)
+{
+    const dbc_arena_t arena = __dbc_arena_new();
+    for (size_t i = 1; i < 100; i++) {
+        void* const ptr = __dbc_arena_alloc(arena, i);
+        ck_assert_ptr_ne(ptr, NULL);
+        ck_assert_uint_eq((uintptr_t)ptr % sizeof(double), 0);
+    }
+    __dbc_arena_free(arena);
+}
+END_TEST
+
+START_TEST(tc_alloc_large)
+{
+    const dbc_arena_t arena = __dbc_arena_new();
+    char* const small = (char*)__dbc_arena_alloc(arena, 16);
+    char* const large = (char*)__dbc_arena_calloc(arena, 4 * 1024 * 1024);
+    ck_assert_ptr_ne(large, NULL);
+    ck_assert_int_eq(large[4 * 1024 * 1024 - 1], 0);
+
+    // The chunk serving small allocations keeps on serving them.
+    char* const next = (char*)__dbc_arena_alloc(arena, 16);
+    ck_assert_ptr_eq(next, small + 16);
+    __dbc_arena_free(arena);
+}
+END_TEST
+
+START_TEST(tc_realloc_in_place)
+{
+    const dbc_arena_t arena = __dbc_arena_new();
+    int* const vec = (int*)__dbc_arena_alloc(arena, 4 * sizeof(int));
+    vec[3] = 42;
+    int* const grown = (int*)__dbc_arena_realloc(arena, vec, 4 * sizeof(int),
+                                                 64 * sizeof(int));
+    ck_assert_ptr_eq(grown, vec);
+    ck_assert_int_eq(grown[3], 42);
+    __dbc_arena_free(arena);
+}
+END_TEST
+
+START_TEST(tc_realloc_moves)
+{
+    const dbc_arena_t arena = __dbc_arena_new();
+    int* const vec = (int*)__dbc_arena_alloc(arena, 4 * sizeof(int));
+    vec[3] = 42;
+    __dbc_arena_alloc(arena, 1);
+    int* const grown = (int*)__dbc_arena_realloc(arena, vec, 4 * sizeof(int),
+                                                 64 * sizeof(int));
+    ck_assert_ptr_ne(grown, vec);
+    ck_assert_int_eq(grown[3], 42);
+    __dbc_arena_free(arena);
+}
+END_TEST
+
+START_TEST(tc_stats)
+{
+    const dbc_arena_t arena = __dbc_arena_new();
+    dbc_arena_stats_t stats;
+    __dbc_arena_get_stats(arena, &stats);
+    ck_assert_uint_eq(stats.num_chunks, 0);
+    ck_assert_uint_eq(stats.reserved, 0);
+
+    void* const vec = __dbc_arena_alloc(arena, 10);
+    __dbc_arena_realloc(arena, vec, 10, 20);
+    __dbc_arena_get_stats(arena, &stats);
+    ck_assert_uint_eq(stats.num_allocs, 1);
+    ck_assert_uint_eq(stats.num_chunks, 1);
+    ck_assert_uint_eq(stats.live, 20);
+
+    // Moving abandons the old space, which is no longer live.
+    __dbc_arena_alloc(arena, 1);
+    __dbc_arena_realloc(arena, vec, 20, 40);
+    __dbc_arena_get_stats(arena, &stats);
+    ck_assert_uint_eq(stats.num_allocs, 3);
+    ck_assert_uint_eq(stats.live, 41);
+    ck_assert_uint_gt(stats.reserved, stats.live);
+
+    const dbc_arena_t other = __dbc_arena_new();
+    __dbc_arena_alloc(other, 8);
+    __dbc_arena_absorb(arena, other);
+    __dbc_arena_get_stats(arena, &stats);
+    ck_assert_uint_eq(stats.num_allocs, 4);
+    ck_assert_uint_eq(stats.num_chunks, 2);
+    ck_assert_uint_eq(stats.live, 49);
+    __dbc_arena_free(arena);
+}
+END_TEST
+
+START_TEST(tc_strndup)
+{
+    const dbc_arena_t arena = __dbc_arena_new();
+    const char str[] = "MYNODE和平 trailing";
+    ck_assert_str_eq(__dbc_arena_strndup(arena, str, 12), "MYNODE和平");
+    __dbc_arena_free(arena);
+}
+END_TEST
+
+int main(void)
+{
+    Suite* const s = suite_create("Arena");
+
+    {
+        TCase* const tc = tcase_create("Alloc");
+        tcase_add_test(tc, tc_alloc_aligned);
+        tcase_add_test(tc, tc_alloc_large);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Realloc");
+        tcase_add_test(tc, tc_realloc_in_place);
+        tcase_add_test(tc, tc_realloc_moves);
+        tcase_add_test(tc, tc_stats);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Strings");
+        tcase_add_test(tc, tc_strndup);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        SRunner* const sr = srunner_create(s);
+        srunner_run_all(sr, CK_NORMAL);
+        const size_t number_failed = srunner_ntests_failed(sr);
+        srunner_free(sr);
+
+        return number_failed;
+    }
+
+}
@@ -0,0 +1,243 @@
+#include <check.h>
+#include "libdbc.h"
+#include "libdbc_compiled.h"
+#include "libdbc_parser.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define IMAGE_PATH "test_compiled.dbcc"
+
+static dbc_t build_dbc(void)
+{
+    const char str[] =
+        "VERSION \"1.2.3\"\n"
+        "BU_: ECU1 ECU2\n"
+        "VAL_TABLE_ Gears 1 \"Reverse\" 0 \"Park\" ;\n"
+        "BO_ 100 ENGINE: 8 ECU1\n"
+        " SG_ RPM : 0|16@1+ (0.25,0) [0|16000] \"rpm\" ECU2\n"
+        " SG_ Temp : 23|8@0- (1,-40) [-40|215] \"degC\" Vector__XXX\n"
+        "BO_ 2566844672 CCVS: 8 ECU2\n"
+        "CM_ SG_ 100 RPM \"Engine \\\"speed\\\"\";\n"
+        "CM_ BU_ ECU2 \"Gateway\";\n"
+        "BA_DEF_ BO_ \"GenMsgCycleTime\" INT 0 10000;\n"
+        "BA_DEF_ BU_ \"NodeLayer\" ENUM \"App\",\"Boot\";\n"
+        "BA_DEF_ \"BusType\" STRING ;\n"
+        "BA_DEF_DEF_ \"GenMsgCycleTime\" 100;\n"
+        "BA_ \"GenMsgCycleTime\" BO_ 100 20;\n"
+        "BA_ \"NodeLayer\" BU_ ECU2 1;\n"
+        "BA_ \"BusType\" \"CAN\";\n";
+    const dbc_t dbc = dbc_parse_buffer(str, sizeof(str) - 1, NULL);
+
+    dbc_value_table_insert(dbc_get_value_table(dbc, "Gears"), -2.5, "Odd");
+    const dbc_value_table_t onoff = dbc_add_value_table(dbc, "OnOff");
+    dbc_value_table_insert(onoff, 0, "Off");
+    dbc_value_table_insert(onoff, 1, "On");
+    dbc_value_table_freeze(onoff);
+
+    return dbc;
+}
+
+START_TEST(tc_roundtrip)
+{
+    const dbc_t orig = build_dbc();
+    ck_assert(dbc_save_compiled(orig, IMAGE_PATH));
+    const dbc_t dbc = dbc_load_compiled(IMAGE_PATH);
+    remove(IMAGE_PATH);
+    ck_assert_ptr_ne(dbc, NULL);
+
+    ck_assert_str_eq(dbc_get_version(dbc), "1.2.3");
+    ck_assert_uint_eq(dbc_get_num_nodes(dbc), 2);
+    ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 1)), "ECU2");
+
+    const dbc_value_table_t gears = dbc_get_value_table(dbc, "Gears");
+    ck_assert_uint_eq(dbc_value_table_get_size(gears), 3);
+    ck_assert_str_eq(dbc_value_table_get_desc(gears, 1), "Reverse");
+    ck_assert_str_eq(dbc_value_table_get_desc(gears, -2.5), "Odd");
+    const dbc_value_table_t onoff = dbc_get_value_table(dbc, "OnOff");
+    ck_assert_str_eq(dbc_value_table_get_desc(onoff, 1), "On");
+    ck_assert(!dbc_value_table_insert(onoff, 2, "Error"));
+
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 2);
+    const dbc_message_t msg = dbc_get_message_by_id(dbc, 100);
+    ck_assert_str_eq(dbc_message_get_name(msg), "ENGINE");
+    ck_assert_str_eq(dbc_message_get_transmitter(msg), "ECU1");
+    ck_assert_uint_eq(dbc_message_get_num_signals(msg), 2);
+    const dbc_signal_t rpm = dbc_message_get_signal(msg, 0);
+    ck_assert_str_eq(dbc_signal_get_unit(rpm), "rpm");
+    ck_assert_uint_eq(dbc_signal_get_num_receivers(rpm), 1);
+    ck_assert_str_eq(dbc_signal_get_receiver(rpm, 0), "ECU2");
+    ck_assert_ptr_eq(dbc_signal_get_receiver(rpm, 0),
+                     dbc_node_get_name(dbc_get_node(dbc, 1)));
+    ck_assert_ptr_ne(dbc_get_message_by_pgn(dbc, 0x18FEF100U
+                                                     | DBC_MESSAGE_ID_EXTENDED),
+                     NULL);
+
+    const uint8_t payload[8] = { 0x10, 0x27, 0x50, 0, 0, 0, 0, 0 };
+    double expected[2];
+    double actual[2];
+    char comment[32];
+    ck_assert_uint_eq(dbc_get_signal_comment(dbc, msg, rpm, comment,
+                                             sizeof(comment)),
+                      14);
+    ck_assert_str_eq(comment, "Engine \"speed\"");
+    dbc_get_node_comment(dbc, dbc_get_node(dbc, 1), comment, sizeof(comment));
+    ck_assert_str_eq(comment, "Gateway");
+
+    ck_assert_uint_eq(dbc_get_num_attr_defs(dbc), 3);
+    dbc_attr_value_t value;
+    ck_assert(dbc_get_message_attribute(dbc, msg, "GenMsgCycleTime", &value));
+    ck_assert_double_eq(value.num, 20);
+    ck_assert(dbc_get_message_attribute(dbc, dbc_get_message(dbc, 1),
+                                        "GenMsgCycleTime", &value));
+    ck_assert_double_eq(value.num, 100);
+    const dbc_attr_def_t cycle = dbc_get_attr_def_by_name(dbc,
+                                                          "GenMsgCycleTime");
+    ck_assert_double_eq(dbc_attr_def_get_max(cycle), 10000);
+    ck_assert(dbc_get_node_attribute(dbc, dbc_get_node(dbc, 1), "NodeLayer",
+                                     &value));
+    ck_assert_str_eq(value.str, "Boot");
+    ck_assert_uint_eq(dbc_attr_def_get_num_labels(
+                          dbc_get_attr_def_by_name(dbc, "NodeLayer")),
+                      2);
+    ck_assert(dbc_get_network_attribute(dbc, "BusType", &value));
+    ck_assert_str_eq(value.str, "CAN");
+
+    ck_assert(dbc_decode(orig, 100, payload, sizeof(payload), expected));
+    ck_assert(dbc_decode(dbc, 100, payload, sizeof(payload), actual));
+    ck_assert_double_eq(actual[0], expected[0]);
+    ck_assert_double_eq(actual[1], expected[1]);
+
+    dbc_free(orig);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_roundtrip_mux)
+{
+    const char str[] =
+        "BO_ 300 MUX: 8 ECU1\n"
+        " SG_ Level m0 : 16|8@1+ (1,0) [0|0] \"\" ECU2\n"
+        " SG_ Switch M : 0|8@1+ (1,0) [0|0] \"\" ECU2\n"
+        " SG_ Page m2M : 8|8@1+ (1,0) [0|0] \"\" ECU2\n"
+        "SG_MUL_VAL_ 300 Level Page 3-4, 7-7;\n";
+    const dbc_t orig = dbc_parse_buffer(str, sizeof(str) - 1, NULL);
+    ck_assert(dbc_save_compiled(orig, IMAGE_PATH));
+    const dbc_t dbc = dbc_load_compiled(IMAGE_PATH);
+    remove(IMAGE_PATH);
+    ck_assert_ptr_ne(dbc, NULL);
+
+    // The multiplexor is loaded after the signal it selects.
+    const dbc_message_t msg = dbc_get_message_by_id(dbc, 300);
+    const dbc_signal_t level = dbc_message_get_signal(msg, 0);
+    ck_assert_ptr_eq(dbc_message_get_multiplexor(msg),
+                     dbc_message_get_signal(msg, 1));
+    ck_assert_ptr_eq(dbc_signal_get_multiplexor(level),
+                     dbc_message_get_signal(msg, 2));
+    ck_assert_uint_eq(dbc_signal_get_num_mux_ranges(level), 2);
+    ck_assert_uint_eq(dbc_signal_get_mux_range(level, 1).max, 7);
+
+    const uint8_t payloads[3][8] = { { 2, 7, 9 }, { 2, 5, 9 }, { 1, 7, 9 } };
+    for (size_t i = 0; i < 3; i++) {
+        double expected[3];
+        double actual[3];
+        ck_assert(dbc_decode(orig, 300, payloads[i], 8, expected));
+        ck_assert(dbc_decode(dbc, 300, payloads[i], 8, actual));
+        for (size_t j = 0; j < 3; j++) {
+            ck_assert(isnan(expected[j]) ? isnan(actual[j])
+                                         : actual[j] == expected[j]);
+        }
+    }
+
+    dbc_free(orig);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_empty)
+{
+    const dbc_t orig = dbc_new();
+    ck_assert(dbc_save_compiled(orig, IMAGE_PATH));
+    const dbc_t dbc = dbc_load_compiled(IMAGE_PATH);
+    remove(IMAGE_PATH);
+
+    ck_assert_ptr_ne(dbc, NULL);
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 0);
+    ck_assert_str_eq(dbc_get_version(dbc), dbc_get_version(orig));
+
+    dbc_free(orig);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_missing)
+{
+    ck_assert_ptr_eq(dbc_load_compiled("does/not/exist.dbcc"), NULL);
+}
+END_TEST
+
+START_TEST(tc_corrupt)
+{
+    const dbc_t orig = build_dbc();
+    ck_assert(dbc_save_compiled(orig, IMAGE_PATH));
+    dbc_free(orig);
+
+    FILE* f = fopen(IMAGE_PATH, "rb");
+    ck_assert_ptr_ne(f, NULL);
+    fseek(f, 0, SEEK_END);
+    const long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    unsigned char* const image = malloc((size_t)len);
+    ck_assert_uint_eq(fread(image, 1, (size_t)len, f), (size_t)len);
+    fclose(f);
+
+    // Flipping any single byte, or cutting the image short, must be caught.
+    for (long i = 0; i < len; i += 7) {
+        image[i] ^= 0x40;
+        f = fopen(IMAGE_PATH, "wb");
+        fwrite(image, 1, (size_t)len, f);
+        fclose(f);
+        ck_assert_ptr_eq(dbc_load_compiled(IMAGE_PATH), NULL);
+        image[i] ^= 0x40;
+    }
+
+    f = fopen(IMAGE_PATH, "wb");
+    fwrite(image, 1, (size_t)len / 2, f);
+    fclose(f);
+    ck_assert_ptr_eq(dbc_load_compiled(IMAGE_PATH), NULL);
+
+    remove(IMAGE_PATH);
+    free(image);
+}
+END_TEST
+
+int main(void)
+{
+    Suite* const s = suite_create("Compiled");
+
+    {
+        TCase* const tc = tcase_create("Round trip");
+        tcase_add_test(tc, tc_roundtrip);
+        tcase_add_test(tc, tc_roundtrip_mux);
+        tcase_add_test(tc, tc_empty);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Rejection");
+        tcase_add_test(tc, tc_missing);
+        tcase_add_test(tc, tc_corrupt);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        SRunner* const sr = srunner_create(s);
+        srunner_run_all(sr, CK_NORMAL);
+        const size_t number_failed = srunner_ntests_failed(sr);
+        srunner_free(sr);
+
+        return number_failed;
+    }
+}
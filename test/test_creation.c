@@ -1,5 +1,6 @@
 #include <check.h>
 #include "libdbc.h"
+#include <stdio.h>
 
 START_TEST(tc_newfree_1)
 {
@@ -32,6 +33,158 @@ START_TEST(tc_version_copied)
     dbc_free(dbc);
 }
 
+START_TEST(tc_owns_children)
+{
+    const dbc_t dbc = dbc_new();
+    dbc_push_node(dbc, dbc_node_new("PUSHED"));
+    for (size_t i = 0; i < 1000; i++) {
+        char name[20];
+        snprintf(name, sizeof(name), "table_%zu", i);
+        dbc_value_table_insert(dbc_add_value_table(dbc, name), 1, "On");
+    }
+
+    ck_assert_uint_eq(dbc_get_num_value_tables(dbc), 1000);
+    ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 0)), "PUSHED");
+    const dbc_value_table_t vt = dbc_get_value_table(dbc, "table_999");
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 1), "On");
+
+    ck_assert(dbc_freeze(dbc));
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 1), "On");
+    ck_assert(!dbc_value_table_insert(vt, 0, "Off"));
+
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_strings_interned)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_value_table_t a = dbc_add_value_table(dbc, "A");
+    const dbc_value_table_t b = dbc_add_value_table(dbc, "B");
+    dbc_value_table_insert(a, 0, "Off");
+    dbc_value_table_insert(b, 3, "Off");
+
+    const char* const off = dbc_find_string(dbc, "Off");
+    ck_assert_str_eq(off, "Off");
+    ck_assert_ptr_eq(dbc_value_table_get_desc(a, 0), off);
+    ck_assert_ptr_eq(dbc_value_table_get_desc(b, 3), off);
+    ck_assert_ptr_eq(dbc_find_string(dbc, "A"), dbc_value_table_get_name(a));
+    ck_assert_ptr_eq(dbc_find_string(dbc, "On"), NULL);
+
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_names_indexed)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_node_t pushed = dbc_node_new("PUSHED");
+    dbc_push_node(dbc, pushed);
+    const dbc_value_table_t vt = dbc_add_value_table(dbc, "States");
+
+    dbc_message_t msgs[3];
+    for (size_t i = 0; i < 3; i++) {
+        char name[20];
+        snprintf(name, sizeof(name), "BMS_%zu", i);
+        msgs[i] = dbc_add_message(dbc, (uint32_t)i, name, 8, "PUSHED");
+    }
+    dbc_signal_def_t def = { "BMS_Cell2", 0, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN,
+                             false, 1, 0, 0, 0, "V", false, false, 0 };
+    const dbc_signal_t cell2 = dbc_message_add_signal(msgs[0], &def);
+    def.name = "BMS_Cell1";
+    const dbc_signal_t cell1 = dbc_message_add_signal(msgs[1], &def);
+    def.name = "BMS_Cell2";
+    dbc_message_add_signal(msgs[2], &def);
+    def.name = "BMS_Current";
+    dbc_message_add_signal(msgs[2], &def);
+
+    ck_assert_ptr_eq(dbc_get_node_by_name(dbc, "PUSHED"), pushed);
+    ck_assert_ptr_eq(dbc_get_node_by_name(dbc, "GW"), NULL);
+    ck_assert_ptr_eq(dbc_get_value_table(dbc, "States"), vt);
+    ck_assert_ptr_eq(dbc_get_message_by_name(dbc, "BMS_1"), msgs[1]);
+    ck_assert_ptr_eq(dbc_get_message_by_name(dbc, "BMS_3"), NULL);
+
+    // The first of equal names wins.
+    dbc_message_t owner = NULL;
+    ck_assert_ptr_eq(dbc_get_signal_by_name(dbc, "BMS_Cell2", &owner), cell2);
+    ck_assert_ptr_eq(owner, msgs[0]);
+    ck_assert_ptr_eq(dbc_get_signal_by_name(dbc, "BMS_Cell", NULL), NULL);
+    ck_assert_ptr_eq(dbc_message_get_signal_by_name(msgs[1], "BMS_Cell1"),
+                     cell1);
+
+    dbc_signal_t sigs[4];
+    dbc_message_t owners[4];
+    ck_assert_uint_eq(
+        dbc_find_signals_by_prefix(dbc, "BMS_Cell", sigs, owners, 2), 3);
+    ck_assert_ptr_eq(sigs[0], cell1);
+    ck_assert_ptr_eq(owners[0], msgs[1]);
+    ck_assert_ptr_eq(sigs[1], cell2);
+    ck_assert_ptr_eq(owners[1], msgs[0]);
+    ck_assert_uint_eq(dbc_find_signals_by_prefix(dbc, "BMS_D", sigs, NULL, 4),
+                      0);
+    ck_assert_uint_eq(dbc_find_messages_by_prefix(dbc, "BMS_", msgs, 3), 3);
+
+    // Adding a signal brings the sorted names up to date.
+    def.name = "BMS_Cell0";
+    dbc_message_add_signal(msgs[1], &def);
+    ck_assert_uint_eq(
+        dbc_find_signals_by_prefix(dbc, "BMS_Cell", sigs, NULL, 4), 4);
+    ck_assert_str_eq(dbc_signal_get_name(sigs[0]), "BMS_Cell0");
+
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_memory_stats)
+{
+    const dbc_t dbc = dbc_new();
+    dbc_memory_stats_t stats;
+    dbc_memory_stats(dbc, &stats);
+    ck_assert_uint_eq(stats.messages.count, 0);
+    ck_assert_uint_eq(stats.value_tables.bytes, 0);
+    const size_t num_allocs = stats.num_allocs;
+
+    dbc_push_node(dbc, dbc_node_new("ECU"));
+    const dbc_value_table_t vt = dbc_add_value_table(dbc, "States");
+    dbc_value_table_insert(vt, 0, "Off");
+    dbc_value_table_insert(vt, 1, "On");
+    const dbc_message_t msg = dbc_add_message(dbc, 0x123, "Status", 8, "ECU");
+    const dbc_signal_def_t def = { "Mode", 0, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN,
+                                   false, 1, 0, 0, 0, "", false, false, 0 };
+    dbc_message_add_signal(msg, &def);
+
+    dbc_memory_stats(dbc, &stats);
+    ck_assert_uint_eq(stats.nodes.count, 1);
+    ck_assert_uint_eq(stats.value_tables.count, 1);
+    ck_assert_uint_eq(stats.messages.count, 1);
+    ck_assert_uint_eq(stats.signals.count, 1);
+    ck_assert_uint_gt(stats.signals.bytes, 0);
+    ck_assert_uint_eq(stats.annotations.count, 0);
+    ck_assert_uint_ge(stats.strings.count, 5);
+    ck_assert_uint_gt(stats.num_allocs, num_allocs);
+
+    // Small integer keys index the table, and take no bytes of their own.
+    ck_assert_uint_eq(stats.value_table_keys, 0);
+    ck_assert_uint_eq(stats.value_table_descs, 2 * sizeof(const char*));
+    ck_assert_uint_eq(stats.value_tables.bytes,
+                      stats.value_table_keys + stats.value_table_descs
+                          + stats.value_table_overhead);
+    dbc_value_table_insert(vt, 0.5, "Half");
+    dbc_memory_stats(dbc, &stats);
+    ck_assert_uint_eq(stats.value_table_keys, 3 * sizeof(double));
+    ck_assert_uint_eq(stats.value_table_descs, 3 * sizeof(const char*));
+
+    // The node, table, message and signal names, and the message ID.
+    ck_assert_uint_eq(stats.indices.count, 5);
+    ck_assert_uint_gt(stats.arena_chunks, 0);
+    ck_assert_uint_lt(stats.arena_slack, stats.arena_bytes);
+    ck_assert_uint_gt(stats.total_bytes, stats.arena_bytes);
+    ck_assert_uint_eq(stats.file_bytes, 0);
+
+    dbc_free(dbc);
+}
+END_TEST
+
 int main(void)
 {
     Suite* const s = suite_create("CRUD");
@@ -51,6 +204,16 @@ int main(void)
         suite_add_tcase(s, tc);
     }
 
+    {
+        TCase* const tc = tcase_create("Ownership");
+        tcase_add_test(tc, tc_owns_children);
+        tcase_add_test(tc, tc_strings_interned);
+        tcase_add_test(tc, tc_names_indexed);
+        tcase_add_test(tc, tc_memory_stats);
+
+        suite_add_tcase(s, tc);
+    }
+
     {
         SRunner* const sr = srunner_create(s);
         srunner_run_all(sr, CK_NORMAL);
@@ -0,0 +1,291 @@
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libdbc.h"
+#include "libdbc_log.h"
+#include "libdbc_parser.h"
+
+#define LOG_PATH "test_log.log"
+
+START_TEST(tc_candump)
+{
+    const char str[] =
+        "(1436509052.249713) vcan0 044#2A366C2BBA\n"
+        "(1436509052.250000) vcan0 18FEF100#0102030405060708\n"
+        "(1436509052.250001) vcan0 123#R\n"
+        "(1436509052.250002) vcan0 20000080#0000000000000000\n"
+        "(1436509052.250003) can1 7FF##1"
+        "000102030405060708090A0B0C0D0E0F\n"
+        "(1436509052.250004) can1 100#\n"
+        "(1436509052.250005) can1 101#0102_C\r\n";
+    dbc_parse_status_t status;
+    const dbc_log_t log = dbc_log_read_buffer(str, sizeof(str) - 1,
+                                              DBC_LOG_AUTO, 1, &status);
+    ck_assert_ptr_ne(log, NULL);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+
+    // Remote and error frames are left out.
+    ck_assert_uint_eq(dbc_log_get_num_frames(log), 5);
+    const dbc_log_frame_t* const frames = dbc_log_get_frames(log);
+    ck_assert_uint_eq(frames[0].timestamp_ns, 1436509052249713000ULL);
+    ck_assert_uint_eq(frames[0].can_id, 0x44);
+    ck_assert_uint_eq(frames[0].len, 5);
+    const uint8_t first[] = { 0x2A, 0x36, 0x6C, 0x2B, 0xBA };
+    ck_assert_mem_eq(dbc_log_get_payload(log, &frames[0]), first, 5);
+
+    ck_assert_uint_eq(frames[1].can_id, 0x18FEF100U | DBC_MESSAGE_ID_EXTENDED);
+    ck_assert_uint_eq(frames[1].len, 8);
+    const uint8_t second[] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    ck_assert_mem_eq(dbc_log_get_payload(log, &frames[1]), second, 8);
+
+    ck_assert_uint_eq(frames[2].can_id, 0x7FF);
+    ck_assert_uint_eq(frames[2].len, 16);
+    const uint8_t* const fd = dbc_log_get_payload(log, &frames[2]);
+    for (int i = 0; i < 16; i++) {
+        ck_assert_uint_eq(fd[i], i);
+    }
+
+    ck_assert_uint_eq(frames[3].len, 0);
+    ck_assert_uint_eq(frames[4].len, 2);
+    dbc_log_free(log);
+}
+END_TEST
+
+START_TEST(tc_candump_broken)
+{
+    const char str[] =
+        "(1.000000) can0 12#00\n"
+        "(1.000001) can0 123#001\n"
+        "(1.000002) can0 123#000102030405060708\n"
+        "(1.000003 can0 123#00\n"
+        "(1.000004) can0 123#00\n";
+    dbc_parse_status_t status;
+    const dbc_log_t log = dbc_log_read_buffer(str, sizeof(str) - 1,
+                                              DBC_LOG_CANDUMP, 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_CRITICAL);
+    ck_assert_uint_eq(dbc_log_get_num_frames(log), 1);
+    ck_assert_uint_eq(dbc_log_get_frames(log)[0].timestamp_ns, 1000004000ULL);
+    dbc_log_free(log);
+}
+END_TEST
+
+START_TEST(tc_asc)
+{
+    const char str[] =
+        "date Wed Jun 12 10:00:00.000 am 2024\n"
+        "base hex  timestamps absolute\n"
+        "internal events logged\n"
+        "// version 9.0.0\n"
+        "Begin Triggerblock Wed Jun 12 10:00:00.000 am 2024\n"
+        "   0.000000 Start of measurement\n"
+        "   0.001234 1  123             Rx   d 8 01 02 03 04 05 06 07 08"
+        "  Length = 240000 BitCount = 124 ID = 291\n"
+        "   0.002000 2  18FEF100x       Tx   d 2 AA BB\n"
+        "   0.002500 1  ErrorFrame\n"
+        "   0.003000 1  200             Rx   r\n"
+        "   0.004000 CANFD   3 Rx        7FF  Engine  1 0 9 12"
+        " 00 01 02 03 04 05 06 07 08 09 0A 0B  0 0 1000 0 0 0 0 0\n"
+        "   0.005000 CANFD   3 Rx        100  1 0 2 2 CA FE\n"
+        "End TriggerBlock\n";
+    dbc_parse_status_t status;
+    const dbc_log_t log = dbc_log_read_buffer(str, sizeof(str) - 1,
+                                              DBC_LOG_AUTO, 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    ck_assert_uint_eq(dbc_log_get_num_frames(log), 4);
+
+    const dbc_log_frame_t* const frames = dbc_log_get_frames(log);
+    ck_assert_uint_eq(frames[0].timestamp_ns, 1234000);
+    ck_assert_uint_eq(frames[0].channel, 1);
+    ck_assert_uint_eq(frames[0].can_id, 0x123);
+    ck_assert_uint_eq(frames[0].len, 8);
+    ck_assert_uint_eq(dbc_log_get_payload(log, &frames[0])[7], 8);
+
+    ck_assert_uint_eq(frames[1].channel, 2);
+    ck_assert_uint_eq(frames[1].can_id, 0x18FEF100U | DBC_MESSAGE_ID_EXTENDED);
+    ck_assert_uint_eq(dbc_log_get_payload(log, &frames[1])[1], 0xBB);
+
+    ck_assert_uint_eq(frames[2].channel, 3);
+    ck_assert_uint_eq(frames[2].can_id, 0x7FF);
+    ck_assert_uint_eq(frames[2].len, 12);
+    ck_assert_uint_eq(dbc_log_get_payload(log, &frames[2])[11], 0x0B);
+
+    ck_assert_uint_eq(frames[3].can_id, 0x100);
+    ck_assert_uint_eq(dbc_log_get_payload(log, &frames[3])[0], 0xCA);
+    dbc_log_free(log);
+}
+END_TEST
+
+START_TEST(tc_asc_header)
+{
+    // Relative timestamps count from the event before, frames or not.
+    const char str[] =
+        "date Wed Jun 12 10:00:00.000 am 2024\n"
+        "base dec  timestamps relative\n"
+        "   1.000000 Start of measurement\n"
+        "   0.500000 1  291             Rx   d 1 01\n"
+        "   0.250000 1  291x            Rx   d 1 02\n";
+    const dbc_log_t log = dbc_log_read_buffer(str, sizeof(str) - 1,
+                                              DBC_LOG_ASC, 0, NULL);
+    ck_assert_uint_eq(dbc_log_get_num_frames(log), 2);
+    const dbc_log_frame_t* const frames = dbc_log_get_frames(log);
+    ck_assert_uint_eq(frames[0].timestamp_ns, 1500000000ULL);
+    ck_assert_uint_eq(frames[0].can_id, 0x123);
+    ck_assert_uint_eq(frames[1].timestamp_ns, 1750000000ULL);
+    ck_assert_uint_eq(frames[1].can_id, 0x123U | DBC_MESSAGE_ID_EXTENDED);
+    dbc_log_free(log);
+}
+END_TEST
+
+/**
+ * @brief Writes a candump log, big enough to be split across threads, into
+ *        buf, which needs 64 bytes per frame.
+ *
+ * Every frame's payload holds its line number. Every 1000th frame is logged
+ * late, and every 7th shares its timestamp with the frame before.
+ */
+static size_t write_candump(char* buf, const size_t num_frames)
+{
+    size_t off = 0;
+    for (size_t i = 0; i < num_frames; i++) {
+        size_t tick = i - (i % 7 == 0 && i != 0);
+        tick = i % 1000 == 999 ? tick - 500 : tick;
+        off += (size_t)sprintf(buf + off,
+                               "(%zu.%06zu) can0 %03zX#%016zX\n",
+                               tick / 1000000, tick % 1000000, i % 3 + 0x100,
+                               i);
+    }
+    return off;
+}
+
+START_TEST(tc_parallel_order)
+{
+    const size_t num_frames = 100000;
+    char* const buf = (char*)malloc(num_frames * 64);
+    ck_assert_ptr_ne(buf, NULL);
+    const size_t len = write_candump(buf, num_frames);
+
+    dbc_parse_status_t status;
+    const dbc_log_t serial =
+        dbc_log_read_buffer(buf, len, DBC_LOG_CANDUMP, 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    const dbc_log_t parallel =
+        dbc_log_read_buffer(buf, len, DBC_LOG_CANDUMP, 4, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    free(buf);
+
+    ck_assert_uint_eq(dbc_log_get_num_frames(serial), num_frames);
+    ck_assert_uint_eq(dbc_log_get_num_frames(parallel), num_frames);
+    const dbc_log_frame_t* const a = dbc_log_get_frames(serial);
+    const dbc_log_frame_t* const b = dbc_log_get_frames(parallel);
+    for (size_t i = 0; i < num_frames; i++) {
+        ck_assert_uint_eq(a[i].timestamp_ns, b[i].timestamp_ns);
+        ck_assert_mem_eq(a[i].payload.bytes, b[i].payload.bytes, 8);
+        if (i > 0) {
+            ck_assert_uint_le(a[i - 1].timestamp_ns, a[i].timestamp_ns);
+        }
+    }
+
+    // Ties keep the order they were logged in.
+    ck_assert_uint_eq(a[6].timestamp_ns, a[7].timestamp_ns);
+    ck_assert_uint_eq(a[6].payload.bytes[7], 6);
+    ck_assert_uint_eq(a[7].payload.bytes[7], 7);
+
+    dbc_log_free(serial);
+    dbc_log_free(parallel);
+}
+END_TEST
+
+typedef struct {
+    size_t num_frames;
+    size_t num_batches;
+    uint64_t last_timestamp;
+    double sum;
+} decode_totals_t;
+
+static void count_decoded(void* ctx, const dbc_message_t msg,
+                          const uint64_t* timestamps_ns, const size_t n,
+                          const double* const* columns)
+{
+    decode_totals_t* const totals = (decode_totals_t*)ctx;
+    ck_assert_uint_eq(dbc_message_get_id(msg), 0x101);
+    for (size_t i = 0; i < n; i++) {
+        ck_assert_uint_ge(timestamps_ns[i], totals->last_timestamp);
+        totals->last_timestamp = timestamps_ns[i];
+        totals->sum += columns[0][i];
+    }
+    totals->num_frames += n;
+    totals->num_batches++;
+}
+
+START_TEST(tc_decode)
+{
+    const char str[] = "BO_ 257 ENGINE: 8 ECU1\n"
+                       " SG_ Line : 55|16@0+ (1,0) [0|0] \"\" ECU2\n";
+    const dbc_t dbc = dbc_parse_buffer(str, sizeof(str) - 1, NULL);
+
+    const size_t num_frames = 30000;
+    char* const buf = (char*)malloc(num_frames * 64);
+    ck_assert_ptr_ne(buf, NULL);
+    const size_t len = write_candump(buf, num_frames);
+    FILE* const f = fopen(LOG_PATH, "wb");
+    ck_assert_ptr_ne(f, NULL);
+    ck_assert_uint_eq(fwrite(buf, 1, len, f), len);
+    fclose(f);
+    free(buf);
+
+    dbc_parse_status_t status;
+    const dbc_log_t log =
+        dbc_log_read_file(LOG_PATH, DBC_LOG_AUTO, 0, &status);
+    remove(LOG_PATH);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+
+    // Only every third frame has a message in the DBC.
+    decode_totals_t totals = { 0, 0, 0, 0 };
+    ck_assert(dbc_log_decode(log, dbc, count_decoded, &totals));
+    ck_assert_uint_eq(totals.num_frames, num_frames / 3);
+    ck_assert_uint_eq(totals.num_batches, (num_frames / 3 + 1023) / 1024);
+    double expected = 0;
+    for (size_t i = 1; i < num_frames; i += 3) {
+        expected += (double)(i & 0xFFFF);
+    }
+    ck_assert_double_eq(totals.sum, expected);
+
+    dbc_log_free(log);
+    dbc_free(dbc);
+
+    ck_assert_ptr_eq(dbc_log_read_file("does_not_exist.log", DBC_LOG_AUTO, 0,
+                                       &status),
+                     NULL);
+    ck_assert_uint_eq(status, DBC_PARSE_IO_ERROR);
+}
+END_TEST
+
+int main(void)
+{
+    Suite* const s = suite_create("Log");
+
+    {
+        TCase* const tc = tcase_create("Formats");
+        tcase_add_test(tc, tc_candump);
+        tcase_add_test(tc, tc_candump_broken);
+        tcase_add_test(tc, tc_asc);
+        tcase_add_test(tc, tc_asc_header);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Replay");
+        tcase_add_test(tc, tc_parallel_order);
+        tcase_add_test(tc, tc_decode);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        SRunner* const sr = srunner_create(s);
+        srunner_run_all(sr, CK_NORMAL);
+        const size_t number_failed = srunner_ntests_failed(sr);
+        srunner_free(sr);
+        return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,642 @@
+#include <check.h>
+#include <math.h>
+#include <string.h>
+#include "libdbc.h"
+
+static dbc_signal_def_t signal_def(const uint16_t start_bit,
+                                   const uint16_t length,
+                                   const dbc_byte_order_t byte_order,
+                                   const bool is_signed) {
+    const dbc_signal_def_t def = {
+        "SIG", start_bit, length, byte_order, is_signed, 1, 0, 0, 0, "",
+        false, false, 0
+    };
+    return def;
+}
+
+START_TEST(tc_message_simple)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 500, "IO_DEBUG", 4, "IO");
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 1);
+    ck_assert_ptr_eq(dbc_get_message(dbc, 0), msg);
+    ck_assert_ptr_eq(dbc_get_message_by_id(dbc, 500), msg);
+    ck_assert_ptr_eq(dbc_get_message_by_id(dbc, 501), NULL);
+    ck_assert_uint_eq(dbc_message_get_id(msg), 500);
+    ck_assert_str_eq(dbc_message_get_name(msg), "IO_DEBUG");
+    ck_assert_uint_eq(dbc_message_get_size(msg), 4);
+    ck_assert_str_eq(dbc_message_get_transmitter(msg), "IO");
+    ck_assert_uint_eq(dbc_message_get_num_signals(msg), 0);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_message_by_id_many)
+{
+    const dbc_t dbc = dbc_new();
+    for (uint32_t i = 0; i < 2048; i += 3) {
+        dbc_add_message(dbc, i, "STD", 8, "ECU");
+        dbc_add_message(dbc, DBC_MESSAGE_ID_EXTENDED | (i << 8), "EXT", 8,
+                        "ECU");
+    }
+    // Duplicates do not shadow the first definition.
+    const dbc_message_t first = dbc_get_message_by_id(dbc, 3);
+    dbc_add_message(dbc, 3, "DUPLICATE", 8, "ECU");
+
+    for (uint32_t i = 0; i < 2048; i++) {
+        const dbc_message_t std = dbc_get_message_by_id(dbc, i);
+        const dbc_message_t ext =
+            dbc_get_message_by_id(dbc, DBC_MESSAGE_ID_EXTENDED | (i << 8));
+        if (i % 3 == 0) {
+            ck_assert_uint_eq(dbc_message_get_id(std), i);
+            ck_assert_uint_eq(dbc_message_get_id(ext),
+                              DBC_MESSAGE_ID_EXTENDED | (i << 8));
+        } else {
+            ck_assert_ptr_eq(std, NULL);
+            ck_assert_ptr_eq(ext, NULL);
+        }
+    }
+    ck_assert_ptr_eq(dbc_get_message_by_id(dbc, 3), first);
+    ck_assert_ptr_eq(dbc_get_message_by_id(dbc, 2048), NULL);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_message_by_pgn)
+{
+    const dbc_t dbc = dbc_new();
+    // EEC1, PGN 61444 (PDU2), priority 3, source 0.
+    const dbc_message_t eec1 =
+        dbc_add_message(dbc, DBC_MESSAGE_ID_EXTENDED | 0x0CF00400U, "EEC1",
+                        8, "ECU");
+    // TSC1, PGN 0 (PDU1), destination 0, source 0x0B.
+    const dbc_message_t tsc1 =
+        dbc_add_message(dbc, DBC_MESSAGE_ID_EXTENDED | 0x0C00000BU, "TSC1",
+                        8, "ECU");
+
+    // Other priorities, sources and destinations.
+    ck_assert_ptr_eq(dbc_get_message_by_pgn(dbc, 0x18F00417U), eec1);
+    ck_assert_ptr_eq(dbc_get_message_by_pgn(dbc, 0x0C0017F1U), tsc1);
+    ck_assert_ptr_eq(dbc_get_message_by_pgn(dbc, 0x18F00517U), NULL);
+    // Exact lookups still want the exact ID.
+    ck_assert_ptr_eq(
+        dbc_get_message_by_id(dbc, DBC_MESSAGE_ID_EXTENDED | 0x18F00417U),
+        NULL);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_signal_invalid)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 8, "ECU");
+    dbc_signal_def_t def =
+        signal_def(0, 0, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    ck_assert_ptr_eq(dbc_message_add_signal(msg, &def), NULL);
+    def.length = 65;
+    ck_assert_ptr_eq(dbc_message_add_signal(msg, &def), NULL);
+    def.start_bit = 511;
+    def.length = 2;
+    ck_assert_ptr_eq(dbc_message_add_signal(msg, &def), NULL);
+    ck_assert_uint_eq(dbc_message_get_num_signals(msg), 0);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_decode_little_endian)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 8, "ECU");
+    dbc_signal_def_t def =
+        signal_def(0, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    const dbc_signal_t byte0 = dbc_message_add_signal(msg, &def);
+    def.start_bit = 4;
+    def.length = 12;
+    const dbc_signal_t unaligned = dbc_message_add_signal(msg, &def);
+
+    const uint8_t payload[8] = { 0xAB, 0xCD };
+    ck_assert_uint_eq(dbc_signal_decode_raw(byte0, payload, 8), 0xAB);
+    ck_assert_uint_eq(dbc_signal_decode_raw(unaligned, payload, 8), 0xCDA);
+
+    double out[2];
+    ck_assert(dbc_decode(dbc, 1, payload, 8, out));
+    ck_assert_double_eq(out[0], 0xAB);
+    ck_assert_double_eq(out[1], 0xCDA);
+    ck_assert(!dbc_decode(dbc, 2, payload, 8, out));
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_decode_big_endian)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 8, "ECU");
+    dbc_signal_def_t def = signal_def(7, 16, DBC_BYTE_ORDER_BIG_ENDIAN, false);
+    const dbc_signal_t word = dbc_message_add_signal(msg, &def);
+    def.start_bit = 3;
+    def.length = 12;
+    const dbc_signal_t unaligned = dbc_message_add_signal(msg, &def);
+
+    const uint8_t payload[8] = { 0x12, 0x34 };
+    ck_assert_uint_eq(dbc_signal_decode_raw(word, payload, 8), 0x1234);
+    ck_assert_uint_eq(dbc_signal_decode_raw(unaligned, payload, 8), 0x234);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_decode_signed_scaled)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 8, "ECU");
+    dbc_signal_def_t def = signal_def(0, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, true);
+    def.factor = 0.5;
+    def.offset = 10;
+    const dbc_signal_t sig = dbc_message_add_signal(msg, &def);
+
+    const uint8_t payload[1] = { 0xFF };
+    ck_assert_int_eq((int64_t)dbc_signal_decode_raw(sig, payload, 1), -1);
+    ck_assert_double_eq(dbc_signal_decode(sig, payload, 1), 9.5);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_decode_spills)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 16, "ECU");
+    dbc_signal_def_t def =
+        signal_def(4, 64, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    const dbc_signal_t intel = dbc_message_add_signal(msg, &def);
+    def = signal_def(3, 64, DBC_BYTE_ORDER_BIG_ENDIAN, false);
+    const dbc_signal_t motorola = dbc_message_add_signal(msg, &def);
+
+    const uint8_t intel_payload[16] = { 0xF0, [8] = 0x0F };
+    ck_assert_uint_eq(dbc_signal_decode_raw(intel, intel_payload, 16),
+                      UINT64_C(0xF00000000000000F));
+    // The ninth byte is past the end of the payload.
+    ck_assert_uint_eq(dbc_signal_decode_raw(intel, intel_payload, 8),
+                      UINT64_C(0x000000000000000F));
+
+    const uint8_t motorola_payload[16] = { 0x0F, [8] = 0xF0 };
+    ck_assert_uint_eq(dbc_signal_decode_raw(motorola, motorola_payload, 16),
+                      UINT64_C(0xF00000000000000F));
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_decode_short_payload)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 8, "ECU");
+    dbc_signal_def_t def =
+        signal_def(8, 16, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    const dbc_signal_t sig = dbc_message_add_signal(msg, &def);
+
+    const uint8_t payload[2] = { 0x11, 0x22 };
+    ck_assert_uint_eq(dbc_signal_decode_raw(sig, payload, 2), 0x22);
+    ck_assert_uint_eq(dbc_signal_decode_raw(sig, payload, 1), 0);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_decode_batch_matches_single)
+{
+    enum { NUM_FRAMES = 1001, NUM_SIGNALS = 6 };
+    static uint8_t payloads[NUM_FRAMES][8];
+    static double columns[NUM_SIGNALS][NUM_FRAMES];
+
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 7, "MSG", 8, "ECU");
+    dbc_signal_def_t def =
+        signal_def(3, 13, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.factor = 0.25;
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(12, 20, DBC_BYTE_ORDER_LITTLE_ENDIAN, true);
+    def.offset = -40;
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(23, 16, DBC_BYTE_ORDER_BIG_ENDIAN, true);
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(0, 64, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(5, 60, DBC_BYTE_ORDER_BIG_ENDIAN, true);
+    dbc_message_add_signal(msg, &def);
+    // Sticks out of the 8 byte payload.
+    def = signal_def(60, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    dbc_message_add_signal(msg, &def);
+    ck_assert_uint_eq(dbc_message_get_num_signals(msg), NUM_SIGNALS);
+
+    uint32_t state = 12345;
+    for (size_t i = 0; i < NUM_FRAMES; i++) {
+        for (size_t j = 0; j < 8; j++) {
+            state = state * 1103515245U + 12345U;
+            payloads[i][j] = (uint8_t)(state >> 16);
+        }
+    }
+
+    double* out_columns[NUM_SIGNALS];
+    for (size_t i = 0; i < NUM_SIGNALS; i++) {
+        out_columns[i] = columns[i];
+    }
+    ck_assert(dbc_decode_batch(dbc, 7, &payloads[0][0], NUM_FRAMES,
+                               out_columns));
+    ck_assert(!dbc_decode_batch(dbc, 8, &payloads[0][0], NUM_FRAMES,
+                                out_columns));
+
+    for (size_t i = 0; i < NUM_FRAMES; i++) {
+        double out[NUM_SIGNALS];
+        dbc_message_decode(msg, payloads[i], 8, out);
+        for (size_t j = 0; j < NUM_SIGNALS; j++) {
+            ck_assert_double_eq(columns[j][i], out[j]);
+        }
+    }
+    dbc_free(dbc);
+}
+END_TEST
+
+static dbc_message_t add_packed_message(const dbc_t dbc, const uint32_t id)
+{
+    // Every byte but the gaps at bits 0-2 and 36-39 is covered, once.
+    const dbc_message_t msg = dbc_add_message(dbc, id, "MSG", 8, "ECU");
+    dbc_signal_def_t def =
+        signal_def(3, 13, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.factor = 0.25;
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(16, 20, DBC_BYTE_ORDER_LITTLE_ENDIAN, true);
+    def.offset = -40;
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(47, 16, DBC_BYTE_ORDER_BIG_ENDIAN, true);
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(56, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    dbc_message_add_signal(msg, &def);
+    return msg;
+}
+
+START_TEST(tc_encode_round_trip)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = add_packed_message(dbc, 7);
+
+    uint32_t state = 54321;
+    for (size_t i = 0; i < 1000; i++) {
+        uint8_t payload[8];
+        for (size_t j = 0; j < 8; j++) {
+            state = state * 1103515245U + 12345U;
+            payload[j] = (uint8_t)(state >> 16);
+        }
+        payload[0] &= 0xF8;
+        payload[4] &= 0x0F;
+
+        double values[4];
+        dbc_message_decode(msg, payload, 8, values);
+        uint8_t encoded[8];
+        memset(encoded, 0xAA, sizeof(encoded));
+        ck_assert(dbc_encode(dbc, 7, values, encoded, 8));
+        ck_assert_mem_eq(encoded, payload, 8);
+    }
+
+    const double values[4] = { 0 };
+    uint8_t untouched[8] = { 0xAA };
+    ck_assert(!dbc_encode(dbc, 8, values, untouched, 8));
+    ck_assert_uint_eq(untouched[0], 0xAA);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_encode_clamps)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 8, "ECU");
+    dbc_signal_def_t def =
+        signal_def(0, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.factor = 0.5;
+    def.max = 100;
+    const dbc_signal_t ranged = dbc_message_add_signal(msg, &def);
+    def = signal_def(8, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, true);
+    const dbc_signal_t unranged = dbc_message_add_signal(msg, &def);
+
+    uint8_t payload[2] = { 0 };
+    dbc_signal_encode(ranged, 1000, payload, 2);
+    ck_assert_uint_eq(payload[0], 200);
+    dbc_signal_encode(ranged, -5, payload, 2);
+    ck_assert_uint_eq(payload[0], 0);
+    dbc_signal_encode(ranged, 10.3, payload, 2);
+    ck_assert_uint_eq(payload[0], 21);
+    dbc_signal_encode(ranged, NAN, payload, 2);
+    ck_assert_uint_eq(payload[0], 0);
+
+    // Without a range, only the bits limit the value.
+    dbc_signal_encode(unranged, 1000, payload, 2);
+    ck_assert_uint_eq(payload[1], 0x7F);
+    dbc_signal_encode(unranged, -1000, payload, 2);
+    ck_assert_uint_eq(payload[1], 0x80);
+    dbc_signal_encode(unranged, -2, payload, 2);
+    ck_assert_uint_eq(payload[1], 0xFE);
+    ck_assert_uint_eq(payload[0], 0);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_encode_spills)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = dbc_add_message(dbc, 1, "MSG", 16, "ECU");
+    dbc_signal_def_t def =
+        signal_def(4, 64, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    const dbc_signal_t intel = dbc_message_add_signal(msg, &def);
+    def = signal_def(3, 64, DBC_BYTE_ORDER_BIG_ENDIAN, false);
+    const dbc_signal_t motorola = dbc_message_add_signal(msg, &def);
+
+    uint8_t payload[16];
+    memset(payload, 0x55, sizeof(payload));
+    dbc_signal_encode_raw(intel, UINT64_C(0xF00000000000000F), payload, 16);
+    const uint8_t intel_payload[16] = {
+        0xF5, 0, 0, 0, 0, 0, 0, 0, 0x5F, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55
+    };
+    ck_assert_mem_eq(payload, intel_payload, 16);
+
+    memset(payload, 0x55, sizeof(payload));
+    dbc_signal_encode_raw(motorola, UINT64_C(0xF00000000000000F), payload, 16);
+    const uint8_t motorola_payload[16] = {
+        0x5F, 0, 0, 0, 0, 0, 0, 0, 0xF5, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55,
+        0x55
+    };
+    ck_assert_mem_eq(payload, motorola_payload, 16);
+
+    // Nothing is written past the end of the payload.
+    memset(payload, 0x55, sizeof(payload));
+    dbc_signal_encode_raw(intel, UINT64_MAX, payload, 3);
+    ck_assert_uint_eq(payload[0], 0xF5);
+    ck_assert_uint_eq(payload[2], 0xFF);
+    ck_assert_uint_eq(payload[3], 0x55);
+    ck_assert_uint_eq(payload[8], 0x55);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_encode_batch_matches_single)
+{
+    enum { NUM_FRAMES = 257, NUM_SIGNALS = 4 };
+    static uint8_t payloads[NUM_FRAMES][8];
+    static double columns[NUM_SIGNALS][NUM_FRAMES];
+
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = add_packed_message(dbc, 7);
+
+    const double* in_columns[NUM_SIGNALS];
+    for (size_t i = 0; i < NUM_SIGNALS; i++) {
+        for (size_t j = 0; j < NUM_FRAMES; j++) {
+            columns[i][j] = (double)j * 37.75 - 1000 * (double)i;
+        }
+        in_columns[i] = columns[i];
+    }
+    ck_assert(dbc_encode_batch(dbc, 7, in_columns, NUM_FRAMES,
+                               &payloads[0][0]));
+    ck_assert(!dbc_encode_batch(dbc, 8, in_columns, NUM_FRAMES,
+                                &payloads[0][0]));
+
+    for (size_t j = 0; j < NUM_FRAMES; j++) {
+        double values[NUM_SIGNALS];
+        for (size_t i = 0; i < NUM_SIGNALS; i++) {
+            values[i] = columns[i][j];
+        }
+        uint8_t payload[8];
+        dbc_message_encode(msg, values, payload, 8);
+        ck_assert_mem_eq(payloads[j], payload, 8);
+    }
+    dbc_free(dbc);
+}
+END_TEST
+
+/**
+ * @brief Adds a message with a 16-bit switch, a plain signal, signals for
+ *        switch values 1 and 2 sharing a byte, a signal selected by the
+ *        latter, and two signals present for many switch values.
+ */
+static dbc_message_t add_mux_message(const dbc_t dbc, const uint32_t id) {
+    const dbc_message_t msg = dbc_add_message(dbc, id, "MUX", 8, "ECU");
+    dbc_signal_def_t def =
+        signal_def(0, 16, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.is_multiplexor = true;
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(16, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(24, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, true);
+    def.is_multiplexed = true;
+    def.mux_value = 1;
+    dbc_message_add_signal(msg, &def);
+    def = signal_def(24, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.is_multiplexor = true;
+    def.is_multiplexed = true;
+    def.mux_value = 2;
+    const dbc_signal_t sub = dbc_message_add_signal(msg, &def);
+
+    def = signal_def(32, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.is_multiplexed = true;
+    const dbc_mux_range_t sub_ranges[2] = { { 5, 5 }, { 7, 9 } };
+    dbc_message_set_signal_mux(msg, dbc_message_add_signal(msg, &def), sub,
+                               sub_ranges, 2);
+
+    // Past the jump table, and too wide for it.
+    def = signal_def(40, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.is_multiplexed = true;
+    const dbc_mux_range_t far_ranges[2] = { { 1, 1 }, { 2000, 2000 } };
+    dbc_message_set_signal_mux(msg, dbc_message_add_signal(msg, &def), NULL,
+                               far_ranges, 2);
+    def = signal_def(48, 8, DBC_BYTE_ORDER_LITTLE_ENDIAN, false);
+    def.is_multiplexed = true;
+    const dbc_mux_range_t wide_range = { 0, 100 };
+    dbc_message_set_signal_mux(msg, dbc_message_add_signal(msg, &def), NULL,
+                               &wide_range, 1);
+    return msg;
+}
+
+static void assert_values_eq(const double* a, const double* b,
+                             const size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        ck_assert(isnan(a[i]) ? isnan(b[i]) : a[i] == b[i]);
+    }
+}
+
+START_TEST(tc_mux_decode)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = add_mux_message(dbc, 9);
+    ck_assert_ptr_eq(dbc_message_get_multiplexor(msg),
+                     dbc_message_get_signal(msg, 0));
+    ck_assert(dbc_signal_is_multiplexed(dbc_message_get_signal(msg, 3)));
+    ck_assert_ptr_eq(dbc_signal_get_multiplexor(dbc_message_get_signal(msg, 4)),
+                     dbc_message_get_signal(msg, 3));
+    ck_assert_uint_eq(
+        dbc_signal_get_mux_range(dbc_message_get_signal(msg, 4), 1).max, 9);
+    ck_assert_uint_eq(dbc_signal_get_num_mux_ranges(
+                          dbc_message_get_signal(msg, 6)), 1);
+
+    double values[7];
+    const uint8_t one[8] = { 1, 0, 0x11, 0xFE, 0x33, 0x44, 0x55, 0 };
+    dbc_message_decode(msg, one, 8, values);
+    const double one_values[7] = { 1, 0x11, -2, NAN, NAN, 0x44, 0x55 };
+    assert_values_eq(values, one_values, 7);
+
+    const uint8_t two[8] = { 2, 0, 0x11, 8, 0x33, 0x44, 0x55, 0 };
+    dbc_message_decode(msg, two, 8, values);
+    const double two_values[7] = { 2, 0x11, NAN, 8, 0x33, NAN, 0x55 };
+    assert_values_eq(values, two_values, 7);
+
+    // The sub-multiplexor selects nothing.
+    const uint8_t six[8] = { 2, 0, 0x11, 6, 0x33, 0x44, 0x55, 0 };
+    dbc_message_decode(msg, six, 8, values);
+    const double six_values[7] = { 2, 0x11, NAN, 6, NAN, NAN, 0x55 };
+    assert_values_eq(values, six_values, 7);
+
+    const uint8_t far[8] = { 0xD0, 0x07, 0x11, 8, 0x33, 0x44, 0x55, 0 };
+    dbc_message_decode(msg, far, 8, values);
+    const double far_values[7] = { 2000, 0x11, NAN, NAN, NAN, 0x44, NAN };
+    assert_values_eq(values, far_values, 7);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_mux_encode)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = add_mux_message(dbc, 9);
+
+    // Signals the switch does not select are left out, even where they
+    // share bits with the ones it does.
+    const double values[7] = { 2, 0x11, -1, 7, 0x33, 0x44, 0x55 };
+    uint8_t payload[8];
+    dbc_message_encode(msg, values, payload, 8);
+    const uint8_t expected[8] = { 2, 0, 0x11, 7, 0x33, 0, 0x55, 0 };
+    ck_assert_mem_eq(payload, expected, 8);
+
+    double decoded[7];
+    dbc_message_decode(msg, payload, 8, decoded);
+    const double present[7] = { 2, 0x11, NAN, 7, 0x33, NAN, 0x55 };
+    assert_values_eq(decoded, present, 7);
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_mux_batch_matches_single)
+{
+    enum { NUM_FRAMES = 300, NUM_SIGNALS = 7 };
+    static uint8_t payloads[NUM_FRAMES][8];
+    static uint8_t encoded[NUM_FRAMES][8];
+    static double columns[NUM_SIGNALS][NUM_FRAMES];
+
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = add_mux_message(dbc, 9);
+
+    uint32_t state = 7;
+    for (size_t j = 0; j < NUM_FRAMES; j++) {
+        for (size_t k = 0; k < 8; k++) {
+            state = state * 1103515245U + 12345U;
+            payloads[j][k] = (uint8_t)(state >> 16);
+        }
+        // Make every case show up.
+        payloads[j][0] = (uint8_t)(j % 4 == 3 ? 0xD0 : j % 4);
+        payloads[j][1] = (uint8_t)(j % 4 == 3 ? 0x07 : 0);
+        payloads[j][3] = (uint8_t)(j % 11);
+    }
+
+    double* out_columns[NUM_SIGNALS];
+    const double* in_columns[NUM_SIGNALS];
+    for (size_t i = 0; i < NUM_SIGNALS; i++) {
+        out_columns[i] = columns[i];
+        in_columns[i] = columns[i];
+    }
+    dbc_message_decode_batch(msg, &payloads[0][0], 8, 8, NUM_FRAMES,
+                             out_columns);
+    dbc_message_encode_batch(msg, in_columns, NUM_FRAMES, &encoded[0][0], 8,
+                             8);
+
+    for (size_t j = 0; j < NUM_FRAMES; j++) {
+        double values[NUM_SIGNALS];
+        double column_values[NUM_SIGNALS];
+        dbc_message_decode(msg, payloads[j], 8, values);
+        for (size_t i = 0; i < NUM_SIGNALS; i++) {
+            column_values[i] = columns[i][j];
+        }
+        assert_values_eq(column_values, values, NUM_SIGNALS);
+
+        uint8_t payload[8];
+        dbc_message_encode(msg, values, payload, 8);
+        ck_assert_mem_eq(encoded[j], payload, 8);
+    }
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(tc_mux_invalid)
+{
+    const dbc_t dbc = dbc_new();
+    const dbc_message_t msg = add_mux_message(dbc, 9);
+    const dbc_mux_range_t range = { 1, 1 };
+    const dbc_signal_t plain = dbc_message_get_signal(msg, 1);
+    ck_assert(!dbc_message_set_signal_mux(msg, plain, plain, &range, 1));
+    ck_assert(!dbc_message_set_signal_mux(
+        msg, dbc_message_get_signal(msg, 2), plain, &range, 1));
+    ck_assert(!dbc_signal_is_multiplexed(plain));
+    ck_assert_uint_eq(dbc_signal_get_num_mux_ranges(plain), 0);
+    ck_assert_uint_gt(dbc_signal_get_mux_range(plain, 0).min,
+                      dbc_signal_get_mux_range(plain, 0).max);
+
+    const dbc_message_t flat = add_packed_message(dbc, 7);
+    ck_assert_ptr_eq(dbc_message_get_multiplexor(flat), NULL);
+    dbc_free(dbc);
+}
+END_TEST
+
+int main(void)
+{
+    Suite* const s = suite_create("Message");
+
+    {
+        TCase* const tc = tcase_create("Definition");
+        tcase_add_test(tc, tc_message_simple);
+        tcase_add_test(tc, tc_message_by_id_many);
+        tcase_add_test(tc, tc_message_by_pgn);
+        tcase_add_test(tc, tc_signal_invalid);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Decode");
+        tcase_add_test(tc, tc_decode_little_endian);
+        tcase_add_test(tc, tc_decode_big_endian);
+        tcase_add_test(tc, tc_decode_signed_scaled);
+        tcase_add_test(tc, tc_decode_spills);
+        tcase_add_test(tc, tc_decode_short_payload);
+        tcase_add_test(tc, tc_decode_batch_matches_single);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Encode");
+        tcase_add_test(tc, tc_encode_round_trip);
+        tcase_add_test(tc, tc_encode_clamps);
+        tcase_add_test(tc, tc_encode_spills);
+        tcase_add_test(tc, tc_encode_batch_matches_single);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Multiplexing");
+        tcase_add_test(tc, tc_mux_decode);
+        tcase_add_test(tc, tc_mux_encode);
+        tcase_add_test(tc, tc_mux_batch_matches_single);
+        tcase_add_test(tc, tc_mux_invalid);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        SRunner* const sr = srunner_create(s);
+        srunner_run_all(sr, CK_NORMAL);
+        const size_t number_failed = srunner_ntests_failed(sr);
+        srunner_free(sr);
+
+        return number_failed;
+    }
+
+}
@@ -1,12 +1,17 @@
 #include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <pthread.h>
 #include "libdbc.h"
+#include "libdbc_parser.h"
 #include "parser.c"
 
 START_TEST(version_simple)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"v0.1.0\"";
-    __dbc_parse_version(dbc, str);
+    __dbc_parse_version(dbc, str, sizeof(str) - 1);
     dbc_free(dbc);
 }
 END_TEST
@@ -15,7 +20,7 @@ START_TEST(version_no_space)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version\"v0.1.0\"";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_str_eq(dbc_get_version(dbc), "v0.1.0");
     dbc_free(dbc);
 }
@@ -25,7 +30,7 @@ START_TEST(version_trailing_space)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"v0.1.0\"    ";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_str_eq(dbc_get_version(dbc), "v0.1.0");
     dbc_free(dbc);
 }
@@ -35,7 +40,7 @@ START_TEST(version_double_quote)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"v0.1.0\"    \"";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_str_eq(dbc_get_version(dbc), "v0.1.0");
     dbc_free(dbc);
 }
@@ -44,7 +49,7 @@ START_TEST(version_utf8)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"v0.1.0和平\"";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_str_eq(dbc_get_version(dbc), "v0.1.0和平");
     dbc_free(dbc);
 }
@@ -53,7 +58,7 @@ START_TEST(version_long)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"v0.1.0和平3030,corporateinstitutionalbankoftime\"";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_str_eq(dbc_get_version(dbc),
                      "v0.1.0和平3030,corporateinstitutionalbankoftime");
     dbc_free(dbc);
@@ -63,7 +68,7 @@ START_TEST(version_empty)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"\"";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_str_eq(dbc_get_version(dbc), "");
     dbc_free(dbc);
 }
@@ -72,7 +77,7 @@ START_TEST(version_malformed_simple)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_MALFORMED);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_MALFORMED);
     ck_assert_str_eq(dbc_get_version(dbc), "");
     dbc_free(dbc);
 }
@@ -81,7 +86,7 @@ START_TEST(version_malformed_whitespace)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "Version \"                 ";
-    ck_assert_uint_eq(__dbc_parse_version(dbc, str), PARSE_ERR_MALFORMED);
+    ck_assert_uint_eq(__dbc_parse_version(dbc, str, sizeof(str) - 1), PARSE_ERR_MALFORMED);
     ck_assert_str_eq(dbc_get_version(dbc), "");
     dbc_free(dbc);
 }
@@ -90,7 +95,7 @@ START_TEST(nodes_simple)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "BU_ NODE1";
-    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_uint_eq(dbc_get_num_nodes(dbc), 1);
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 0)), "NODE1");
     dbc_free(dbc);
@@ -100,7 +105,7 @@ START_TEST(nodes_multiple)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "BU_ NODE1 NODE2";
-    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_uint_eq(dbc_get_num_nodes(dbc), 2);
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 0)), "NODE1");
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 1)), "NODE2");
@@ -111,7 +116,7 @@ START_TEST(nodes_utf8)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "BU_ NODE1 NODE2和平";
-    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str), PARSE_ERR_MALFORMED);
+    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str, sizeof(str) - 1), PARSE_ERR_MALFORMED);
     ck_assert_uint_eq(dbc_get_num_nodes(dbc), 2);
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 0)), "NODE1");
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 1)), "NODE2和平");
@@ -122,7 +127,7 @@ START_TEST(nodes_many)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "BU_ a b c d e f g h";
-    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_uint_eq(dbc_get_num_nodes(dbc), 8);
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 0)), "a");
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 1)), "b");
@@ -139,7 +144,7 @@ START_TEST(nodes_whitespace_head)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "BU_       a";
-    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_uint_eq(dbc_get_num_nodes(dbc), 1);
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 0)), "a");
     dbc_free(dbc);
@@ -149,7 +154,7 @@ START_TEST(nodes_whitespace_tail)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "BU_ a        ";
-    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_uint_eq(dbc_get_num_nodes(dbc), 1);
     ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 0)), "a");
     dbc_free(dbc);
@@ -159,39 +164,1260 @@ START_TEST(nodes_none)
 {
     const dbc_t dbc = dbc_new();
     char str[] = "BU_         ";
-    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str), PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_nodes(dbc, str, sizeof(str) - 1), PARSE_ERR_SUCCESS);
     ck_assert_uint_eq(dbc_get_num_nodes(dbc), 0);
     dbc_free(dbc);
 }
 
-//START_TEST(vtables_empty)
-//{
-//    const dbc_t dbc = dbc_new();
-//    char str[] = "VAL_TABLE_ m_table ;";
-//    ck_assert_uint_eq(__dbc_parse_value_table(dbc, str), PARSE_ERR_SUCCESS);
-//    ck_assert_uint_eq(dbc_get_num_value_tables(dbc), 1);
-//
-//    const dbc_value_table_t val_tbl = dbc_get_value_table(dbc, "m_table");
-//    ck_assert_str_eq(dbc_value_table_get_name(val_tbl), "m_table");
-//
-//
-//    dbc_free(dbc);
-//}
-//
-//START_TEST(vtables_simple)
-//{
-//    const dbc_t dbc = dbc_new();
-//    char str[] = "VAL_TABLE_ m_table 0 \"Zero\" ;";
-//    ck_assert_uint_eq(__dbc_parse_value_table(dbc, str), PARSE_ERR_SUCCESS);
-//    ck_assert_uint_eq(dbc_get_num_value_tables(dbc), 1);
-//
-//    const dbc_value_table_t val_tbl = dbc_get_value_table(dbc, "m_table");
-//    ck_assert_str_eq(dbc_value_table_get_name(val_tbl), "m_table");
-//    ck_assert_uint_eq(dbc_value_table_get_num_values(val_tbl), 1);
-//    ck_assert_str_eq(dbc_value_table_get_value(val_tbl, 0), "Zero");
-//
-//    dbc_free(dbc);
-//}
+START_TEST(vtables_empty)
+{
+    const dbc_t dbc = dbc_new();
+    char str[] = "VAL_TABLE_ m_table ;";
+    ck_assert_uint_eq(__dbc_parse_value_table(dbc, str, sizeof(str) - 1),
+                      PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(dbc_get_num_value_tables(dbc), 1);
+
+    const dbc_value_table_t val_tbl = dbc_get_value_table(dbc, "m_table");
+    ck_assert_str_eq(dbc_value_table_get_name(val_tbl), "m_table");
+
+    dbc_free(dbc);
+}
+
+START_TEST(vtables_simple)
+{
+    const dbc_t dbc = dbc_new();
+    char str[] = "VAL_TABLE_ m_table 0 \"Zero\" ;";
+    ck_assert_uint_eq(__dbc_parse_value_table(dbc, str, sizeof(str) - 1),
+                      PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(dbc_get_num_value_tables(dbc), 1);
+
+    const dbc_value_table_t val_tbl = dbc_get_value_table(dbc, "m_table");
+    ck_assert_str_eq(dbc_value_table_get_name(val_tbl), "m_table");
+    ck_assert_uint_eq(dbc_value_table_get_size(val_tbl), 1);
+    ck_assert_str_eq(dbc_value_table_get_desc(val_tbl, 0), "Zero");
+
+    dbc_free(dbc);
+}
+
+START_TEST(vtables_spaces_in_desc)
+{
+    const dbc_t dbc = dbc_new();
+    char str[] = "VAL_TABLE_ m_table 3 \"Not Available\" -1 \"Error\";";
+    ck_assert_uint_eq(__dbc_parse_value_table(dbc, str, sizeof(str) - 1),
+                      PARSE_ERR_SUCCESS);
+
+    const dbc_value_table_t val_tbl = dbc_get_value_table(dbc, "m_table");
+    ck_assert_uint_eq(dbc_value_table_get_size(val_tbl), 2);
+    ck_assert_str_eq(dbc_value_table_get_desc(val_tbl, 3), "Not Available");
+    ck_assert_str_eq(dbc_value_table_get_desc(val_tbl, -1), "Error");
+
+    dbc_free(dbc);
+}
+
+START_TEST(vtables_unterminated)
+{
+    const dbc_t dbc = dbc_new();
+    char str[] = "VAL_TABLE_ m_table 0 \"Zero\"";
+    ck_assert_uint_eq(__dbc_parse_value_table(dbc, str, sizeof(str) - 1),
+                      PARSE_ERR_CRITICAL);
+    dbc_free(dbc);
+}
+
+START_TEST(messages_simple)
+{
+    const dbc_t dbc = dbc_new();
+    char msg[] = "BO_ 500 IO_DEBUG: 4 IO";
+    char sig[] = "SG_ IO_DEBUG_test_signed : 8|8@1- (0.5,-1) [-65|62.5] "
+                 "\"degC\" DBG,IO";
+    ck_assert_uint_eq(__dbc_parse_message(dbc, msg, sizeof(msg) - 1),
+                      PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_signal(dbc, sig, sizeof(sig) - 1),
+                      PARSE_ERR_SUCCESS);
+
+    const dbc_message_t m = dbc_get_message_by_id(dbc, 500);
+    ck_assert_str_eq(dbc_message_get_name(m), "IO_DEBUG");
+    ck_assert_uint_eq(dbc_message_get_size(m), 4);
+    ck_assert_str_eq(dbc_message_get_transmitter(m), "IO");
+    ck_assert_uint_eq(dbc_message_get_num_signals(m), 1);
+
+    const dbc_signal_t s = dbc_message_get_signal(m, 0);
+    ck_assert_str_eq(dbc_signal_get_name(s), "IO_DEBUG_test_signed");
+    ck_assert_uint_eq(dbc_signal_get_start_bit(s), 8);
+    ck_assert_uint_eq(dbc_signal_get_length(s), 8);
+    ck_assert_int_eq(dbc_signal_get_byte_order(s),
+                     DBC_BYTE_ORDER_LITTLE_ENDIAN);
+    ck_assert(dbc_signal_is_signed(s));
+    ck_assert_double_eq(dbc_signal_get_factor(s), 0.5);
+    ck_assert_double_eq(dbc_signal_get_offset(s), -1);
+    ck_assert_double_eq(dbc_signal_get_min(s), -65);
+    ck_assert_double_eq(dbc_signal_get_max(s), 62.5);
+    ck_assert_str_eq(dbc_signal_get_unit(s), "degC");
+    ck_assert_uint_eq(dbc_signal_get_num_receivers(s), 2);
+    ck_assert_str_eq(dbc_signal_get_receiver(s, 1), "IO");
+
+    dbc_free(dbc);
+}
+
+START_TEST(messages_multiplexed_motorola)
+{
+    const dbc_t dbc = dbc_new();
+    char msg[] = "BO_ 2147484672 MUX: 8 Vector__XXX";
+    char mux[] = "SG_ Mux M : 7|8@0+ (1,0) [0|0] \"\" Vector__XXX";
+    char sig[] = "SG_ Muxed m1 : 15|16@0+ (1,0) [0|0] \"\" Vector__XXX";
+    __dbc_parse_message(dbc, msg, sizeof(msg) - 1);
+    ck_assert_uint_eq(__dbc_parse_signal(dbc, mux, sizeof(mux) - 1),
+                      PARSE_ERR_SUCCESS);
+    ck_assert_uint_eq(__dbc_parse_signal(dbc, sig, sizeof(sig) - 1),
+                      PARSE_ERR_SUCCESS);
+
+    const dbc_message_t m =
+        dbc_get_message_by_id(dbc, DBC_MESSAGE_ID_EXTENDED | 1024);
+    ck_assert_uint_eq(dbc_message_get_num_signals(m), 2);
+    ck_assert_int_eq(dbc_signal_get_byte_order(dbc_message_get_signal(m, 1)),
+                     DBC_BYTE_ORDER_BIG_ENDIAN);
+
+    const uint8_t payload[8] = { 1, 0x12, 0x34 };
+    double out[2];
+    dbc_message_decode(m, payload, sizeof(payload), out);
+    ck_assert_double_eq(out[0], 1);
+    ck_assert_double_eq(out[1], 0x1234);
+
+    dbc_free(dbc);
+}
+
+START_TEST(messages_signal_orphaned)
+{
+    const dbc_t dbc = dbc_new();
+    char sig[] = "SG_ S : 0|8@1+ (1,0) [0|0] \"\" Vector__XXX";
+    ck_assert_uint_eq(__dbc_parse_signal(dbc, sig, sizeof(sig) - 1),
+                      PARSE_ERR_CRITICAL);
+    dbc_free(dbc);
+}
+
+START_TEST(messages_signal_truncated)
+{
+    const dbc_t dbc = dbc_new();
+    char msg[] = "BO_ 1 M: 8 ECU";
+    char sig[] = "SG_ S : 0|8@1+ (1,0)";
+    __dbc_parse_message(dbc, msg, sizeof(msg) - 1);
+    ck_assert_uint_eq(__dbc_parse_signal(dbc, sig, sizeof(sig) - 1),
+                      PARSE_ERR_CRITICAL);
+    ck_assert_uint_eq(
+        dbc_message_get_num_signals(dbc_get_message(dbc, 0)), 0);
+    dbc_free(dbc);
+}
+
+START_TEST(buffer_simple)
+{
+    const char str[] =
+        "VERSION \"1.0\"\n"
+        "\n"
+        "NS_ :\n"
+        "\tCM_\n"
+        "\tVAL_TABLE_\n"
+        "\n"
+        "BS_:\n"
+        "\n"
+        "BU_: ECU1 ECU2\n"
+        "VAL_TABLE_ OnOff 1 \"On\"\n"
+        "    0 \"Off\" ;\n"
+        "CM_ \"A comment; with a semicolon\";\n"
+        "\n"
+        "BO_ 100 ENGINE: 8 ECU1\n"
+        " SG_ RPM : 0|16@1+ (0.25,0) [0|16383.75] \"rpm\" ECU2\n"
+        " SG_ Temp : 16|8@1+ (1,-40) [-40|215] \"degC\" ECU2\n";
+    dbc_parse_status_t status;
+    // The buffer is not NUL-terminated as far as the parser is concerned.
+    const dbc_t dbc = dbc_parse_buffer(str, sizeof(str) - 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    ck_assert_str_eq(dbc_get_version(dbc), "1.0");
+    ck_assert_uint_eq(dbc_get_num_nodes(dbc), 2);
+    ck_assert_str_eq(dbc_node_get_name(dbc_get_node(dbc, 1)), "ECU2");
+    ck_assert_uint_eq(dbc_get_num_value_tables(dbc), 1);
+
+    const dbc_value_table_t val_tbl = dbc_get_value_table(dbc, "OnOff");
+    ck_assert_str_eq(dbc_value_table_get_desc(val_tbl, 0), "Off");
+    ck_assert_str_eq(dbc_value_table_get_desc(val_tbl, 1), "On");
+
+    const uint8_t payload[8] = { 0x40, 0x1F, 130 };
+    double out[2];
+    ck_assert(dbc_decode(dbc, 100, payload, sizeof(payload), out));
+    ck_assert_double_eq(out[0], 2000);
+    ck_assert_double_eq(out[1], 90);
+
+    dbc_free(dbc);
+}
+
+START_TEST(buffer_malformed)
+{
+    const char str[] = "VERSION \"\nBU_: ECU1\n";
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer(str, sizeof(str) - 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_MALFORMED);
+    ck_assert_uint_eq(dbc_get_num_nodes(dbc), 1);
+    dbc_free(dbc);
+}
+
+START_TEST(file_missing)
+{
+    dbc_parse_status_t status;
+    ck_assert_ptr_eq(dbc_parse_file("/nonexistent/libdbc.dbc", &status), NULL);
+    ck_assert_uint_eq(status, DBC_PARSE_IO_ERROR);
+}
+
+/**
+ * @brief Writes a DBC big enough to be split across a few threads.
+ */
+static char* make_big_dbc(size_t* len)
+{
+    const size_t cap = 4 * 1024 * 1024;
+    char* const buf = malloc(cap);
+    size_t n = (size_t)snprintf(buf, cap, "VERSION \"big\"\nBU_: ECU1 ECU2\n");
+    for (size_t i = 0; i < 12000; i++) {
+        if (i % 1000 == 0) {
+            n += (size_t)snprintf(buf + n, cap - n,
+                                  "VAL_TABLE_ T%zu 1 \"On\" 0 \"Off\" ;\n"
+                                  "BU_: N%zu\n", i, i);
+        }
+        n += (size_t)snprintf(buf + n, cap - n,
+                              "BO_ %zu M%zu: 8 ECU1\n"
+                              " SG_ A%zu : 0|16@1+ (0.5,%zu) [0|100] \"u\" ECU2\n"
+                              " SG_ B : 23|8@0- (1,0) [0|0] \"\" ECU1,ECU2\n",
+                              i, i, i, i);
+    }
+    *len = n;
+    return buf;
+}
+
+START_TEST(buffer_parallel)
+{
+    size_t len;
+    char* const buf = make_big_dbc(&len);
+
+    const char* starts[4];
+    const size_t num_starts = __dbc_split_statements(buf, len, 4, starts);
+    ck_assert_uint_eq(num_starts, 4);
+    for (size_t i = 1; i < num_starts; i++) {
+        ck_assert(starts[i] > starts[i - 1]);
+        ck_assert(strncmp(starts[i], "SG_", 3) != 0);
+    }
+
+    dbc_parse_status_t seq_status;
+    dbc_parse_status_t par_status;
+    const dbc_t seq = dbc_parse_buffer(buf, len, &seq_status);
+    const dbc_t par = dbc_parse_buffer_parallel(buf, len, 4, &par_status);
+    ck_assert_uint_eq(par_status, seq_status);
+    ck_assert_str_eq(dbc_get_version(par), "big");
+
+    ck_assert_uint_eq(dbc_get_num_nodes(par), dbc_get_num_nodes(seq));
+    for (size_t i = 0; i < dbc_get_num_nodes(seq); i++) {
+        ck_assert_str_eq(dbc_node_get_name(dbc_get_node(par, i)),
+                         dbc_node_get_name(dbc_get_node(seq, i)));
+    }
+
+    ck_assert_uint_eq(dbc_get_num_value_tables(par),
+                      dbc_get_num_value_tables(seq));
+    const dbc_value_table_t vt = dbc_get_value_table(par, "T11000");
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 1), "On");
+
+    ck_assert_uint_eq(dbc_get_num_messages(par), 12000);
+    for (size_t i = 0; i < dbc_get_num_messages(seq); i++) {
+        const dbc_message_t a = dbc_get_message(seq, i);
+        const dbc_message_t b = dbc_get_message(par, i);
+        ck_assert_str_eq(dbc_message_get_name(b), dbc_message_get_name(a));
+        ck_assert_ptr_eq(dbc_get_message_by_id(par, dbc_message_get_id(a)), b);
+        ck_assert_uint_eq(dbc_message_get_num_signals(b), 2);
+
+        const dbc_signal_t sa = dbc_message_get_signal(a, 0);
+        const dbc_signal_t sb = dbc_message_get_signal(b, 0);
+        ck_assert_str_eq(dbc_signal_get_name(sb), dbc_signal_get_name(sa));
+        ck_assert_double_eq(dbc_signal_get_offset(sb),
+                            dbc_signal_get_offset(sa));
+        ck_assert_uint_eq(dbc_signal_get_num_receivers(
+                              dbc_message_get_signal(b, 1)), 2);
+    }
+
+    // Equal strings from different pieces still end up as one.
+    const char* const ecu2 = dbc_find_string(par, "ECU2");
+    const dbc_message_t last = dbc_get_message(par, 11999);
+    ck_assert_ptr_eq(dbc_signal_get_receiver(dbc_message_get_signal(last, 0), 0),
+                     ecu2);
+
+    dbc_free(seq);
+    dbc_free(par);
+    free(buf);
+}
+
+START_TEST(buffer_parallel_memory)
+{
+    size_t len;
+    char* const buf = make_big_dbc(&len);
+
+    dbc_parse_status_t status;
+    const dbc_t seq = dbc_parse_buffer(buf, len, &status);
+    const dbc_t par = dbc_parse_buffer_parallel(buf, len, 4, &status);
+    dbc_memory_stats_t seq_stats;
+    dbc_memory_stats_t par_stats;
+    dbc_memory_stats(seq, &seq_stats);
+    dbc_memory_stats(par, &par_stats);
+
+    // The pieces' objects are moved over rather than copied, so only the
+    // chunk tails each piece leaves behind cost extra.
+    const size_t seq_live = seq_stats.arena_bytes - seq_stats.arena_slack;
+    const size_t par_live = par_stats.arena_bytes - par_stats.arena_slack;
+    ck_assert_uint_le(par_live, seq_live + seq_live / 8);
+    ck_assert_uint_le(par_stats.total_bytes,
+                      seq_stats.total_bytes + seq_stats.total_bytes / 3);
+    ck_assert_uint_eq(dbc_get_num_messages(par), 12000);
+
+    dbc_free(seq);
+    dbc_free(par);
+    free(buf);
+}
+
+START_TEST(buffer_parallel_small)
+{
+    const char str[] = "BU_: ECU1\nBO_ 1 M: 8 ECU1\n";
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer_parallel(str, sizeof(str) - 1, 0,
+                                                &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 1);
+    dbc_free(dbc);
+}
+
+START_TEST(stream_any_split)
+{
+    const char str[] =
+        "\xEF\xBB\xBFVERSION \"v1\"\n"
+        "NS_ :\n\tCM_\n\tBA_\n\n"
+        "BU_: ECU1 ECU2\n"
+        "VAL_TABLE_ Gears 0 \"Park\"\n  1 \"Reverse\"\n  2 \"Neutral\" ;\n"
+        "CM_ \"A comment\nover two lines; with a semicolon\";\n"
+        "BO_ 100 ENGINE: 8 ECU1\n"
+        " SG_ RPM : 0|16@1+ (0.25,0) [0|16000] \"rpm\" ECU2\n"
+        " SG_ Temp : 23|8@0- (1,-40) [-40|215] \"degC\" ECU2\n"
+        "BO_ 200 BRAKES: 2 ECU2";
+
+    for (size_t piece = 1; piece < sizeof(str); piece++) {
+        const dbc_parser_t parser = dbc_parser_new();
+        for (size_t i = 0; i < sizeof(str) - 1; i += piece) {
+            const size_t left = sizeof(str) - 1 - i;
+            ck_assert(dbc_parser_feed(parser, str + i,
+                                      left < piece ? left : piece));
+        }
+
+        dbc_parse_status_t status;
+        const dbc_t dbc = dbc_parser_finish(parser, &status);
+        ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+        ck_assert_str_eq(dbc_get_version(dbc), "v1");
+        ck_assert_uint_eq(dbc_get_num_nodes(dbc), 2);
+        const dbc_value_table_t vt = dbc_get_value_table(dbc, "Gears");
+        ck_assert_uint_eq(dbc_value_table_get_size(vt), 3);
+        ck_assert_str_eq(dbc_value_table_get_desc(vt, 2), "Neutral");
+        ck_assert_uint_eq(dbc_get_num_messages(dbc), 2);
+        const dbc_message_t msg = dbc_get_message(dbc, 0);
+        ck_assert_uint_eq(dbc_message_get_num_signals(msg), 2);
+        ck_assert_str_eq(dbc_signal_get_unit(dbc_message_get_signal(msg, 1)),
+                         "degC");
+        ck_assert_str_eq(dbc_message_get_transmitter(dbc_get_message(dbc, 1)),
+                         "ECU2");
+        dbc_free(dbc);
+    }
+}
+
+START_TEST(stream_bounded)
+{
+    size_t len;
+    char* const buf = make_big_dbc(&len);
+
+    const dbc_parser_t parser = dbc_parser_new();
+    for (size_t i = 0; i < len; i += 1000) {
+        ck_assert(dbc_parser_feed(parser, buf + i,
+                                  len - i < 1000 ? len - i : 1000));
+        // Never more than the statement cut off by the piece is kept.
+        ck_assert_uint_lt(parser->pending_len, 1000);
+    }
+    const dbc_t dbc = dbc_parser_finish(parser, NULL);
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 12000);
+    ck_assert_uint_eq(dbc_get_num_value_tables(dbc), 12);
+
+    dbc_free(dbc);
+    free(buf);
+}
+
+START_TEST(stream_abandoned)
+{
+    const char str[] = "BU_: ECU1\nBO_ 1 M: 8";
+    const dbc_parser_t parser = dbc_parser_new();
+    ck_assert(dbc_parser_feed(parser, str, sizeof(str) - 1));
+    dbc_parser_free(parser);
+}
+
+START_TEST(keywords_classified)
+{
+    for (size_t i = 0; i < sizeof(STMT_DEFS) / sizeof(STMT_DEFS[0]); i++) {
+        char str[STMT_MAX_KEYWORD_LEN + 17];
+        const size_t len = strlen(STMT_DEFS[i].keyword);
+        memcpy(str, STMT_DEFS[i].keyword, len);
+        memcpy(str + len, " 1 2 3 4 5 6 7 8", 17);
+
+        // Both with plenty of input left, and right at its end.
+        const dbc_tok_t kw = { str, len };
+        ck_assert_ptr_eq(__dbc_classify_statement(kw, str + sizeof(str)),
+                         &STMT_DEFS[i]);
+        ck_assert_ptr_eq(__dbc_classify_statement(kw, str + len),
+                         &STMT_DEFS[i]);
+    }
+}
+
+START_TEST(keywords_unknown)
+{
+    const char* const words[] = {
+        "BO", "BO__", "bo_", "VERSIONS", "SIGTYPE_VALTYPE_X", "VAL_TABLE",
+        "BA_DEF_DEF", "X", "SIGTYPE_VALTYPE_SIGTYPE_VALTYPE_"
+    };
+    for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); i++) {
+        const dbc_tok_t kw = { words[i], strlen(words[i]) };
+        ck_assert_ptr_eq(__dbc_classify_statement(kw, kw.ptr + kw.len),
+                         &STMT_DEF_UNKNOWN);
+    }
+}
+
+START_TEST(keywords_long_strings)
+{
+    // Long enough for the vectorized scans, with escaped quotes and
+    // semicolons within the strings.
+    const char str[] =
+        "CM_ \"A long comment; it has \\\"quotes\\\" and; semicolons;"
+        " spread over more than sixteen bytes\";\n"
+        "VAL_TABLE_ T 1 \"A long description with ; in it\" 0 \"\\\"\" ;\n"
+        "BO_ 1 M: 8 ECU1\n";
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer(str, sizeof(str) - 1, &status);
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 1);
+    const dbc_value_table_t vt = dbc_get_value_table(dbc, "T");
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 1),
+                     "A long description with ; in it");
+    dbc_free(dbc);
+}
+
+START_TEST(numbers_match_strtod)
+{
+    const char* const fixed[] = {
+        "0", "-0", "1", "-1", "+2", "0.5", ".5", "5.", "0.1", "-0.25", "1e3",
+        "1E-3", "2.5e+2", "123456789012345678", "9007199254740993",
+        "0.000001", "1e22", "1e23", "1e25", "3.0e-22", "4.9e-324", "1e308",
+        "1.7976931348623157e308", "12345678901234567890123", "0.1e-30",
+        "1234.5678", "-0.000000001", "00012.5000"
+    };
+    for (size_t i = 0; i < sizeof(fixed) / sizeof(fixed[0]); i++) {
+        double value;
+        ck_assert(maybe_str_to_double(&value, fixed[i], strlen(fixed[i])));
+        ck_assert(memcmp(&value, &(double){ strtod(fixed[i], NULL) },
+                         sizeof(value)) == 0);
+    }
+
+    // Random doubles, written the ways DBC tools write them.
+    const char* const formats[] = { "%.17g", "%g", "%.3f", "%.6e", "%.1f" };
+    uint64_t state = 1;
+    for (size_t i = 0; i < 100000; i++) {
+        state = state * UINT64_C(6364136223846793005) + 1;
+        const double orig = ((double)(state >> 11) / 9007199254740992.0 - 0.5)
+            * pow(10, (int)(state % 24) - 12);
+        char str[64];
+        snprintf(str, sizeof(str), formats[i % 5], orig);
+
+        double value;
+        ck_assert(maybe_str_to_double(&value, str, strlen(str)));
+        ck_assert_msg(value == strtod(str, NULL), "%s", str);
+    }
+}
+
+START_TEST(numbers_malformed)
+{
+    const char* const bad[] = {
+        "", "-", "+", ".", "e5", "1e", "1e+", "1.2.3", "12a", "--1", "1 "
+    };
+    for (size_t i = 0; i < sizeof(bad) / sizeof(bad[0]); i++) {
+        double value;
+        ck_assert_msg(!maybe_str_to_double(&value, bad[i], strlen(bad[i])),
+                      "%s", bad[i]);
+    }
+}
+
+START_TEST(numbers_uint)
+{
+    uint32_t value;
+    ck_assert(maybe_str_to_uint(&value, "2147484672", 10));
+    ck_assert_uint_eq(value, 2147484672U);
+    ck_assert(maybe_str_to_uint(&value, "4294967295", 10));
+    ck_assert_uint_eq(value, 4294967295U);
+    ck_assert(!maybe_str_to_uint(&value, "4294967296", 10));
+    ck_assert(maybe_str_to_uint(&value, "8.0", 3));
+    ck_assert_uint_eq(value, 8);
+    ck_assert(!maybe_str_to_uint(&value, "-1", 2));
+    ck_assert(!maybe_str_to_uint(&value, "1.5", 3));
+    ck_assert(!maybe_str_to_uint(&value, "", 0));
+}
+
+START_TEST(numbers_any_locale)
+{
+    // Only meaningful where such a locale is installed.
+    if (setlocale(LC_NUMERIC, "de_DE.UTF-8") == NULL
+        && setlocale(LC_NUMERIC, "de_DE") == NULL) {
+        return;
+    }
+
+    double value;
+    ck_assert(maybe_str_to_double(&value, "1.5", 3));
+    ck_assert_double_eq(value, 1.5);
+    // Too many digits for the fast path.
+    ck_assert(maybe_str_to_double(&value, "1.50000000000000000000001", 25));
+    ck_assert_double_eq(value, 1.5);
+    setlocale(LC_NUMERIC, "C");
+}
+
+START_TEST(lazy_matches_eager)
+{
+    size_t len;
+    char* const buf = make_big_dbc(&len);
+
+    dbc_parse_status_t status;
+    const dbc_t eager = dbc_parse_buffer(buf, len, NULL);
+    const dbc_t lazy = dbc_parse_buffer_lazy(buf, len, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    ck_assert_uint_eq(dbc_get_num_messages(lazy), 12000);
+
+    // Decoding a message parses its signals, and nobody else's.
+    const uint8_t payload[8] = { 0x34, 0x12, 0, 0x80 };
+    double expected[2];
+    double actual[2];
+    ck_assert(dbc_decode(eager, 4321, payload, sizeof(payload), expected));
+    ck_assert(dbc_decode(lazy, 4321, payload, sizeof(payload), actual));
+    ck_assert_double_eq(actual[0], expected[0]);
+    ck_assert_double_eq(actual[1], expected[1]);
+
+    for (size_t i = 0; i < dbc_get_num_messages(eager); i++) {
+        const dbc_message_t a = dbc_get_message(eager, i);
+        const dbc_message_t b = dbc_get_message(lazy, i);
+        ck_assert_uint_eq(dbc_message_get_num_signals(b),
+                          dbc_message_get_num_signals(a));
+        ck_assert_str_eq(dbc_signal_get_name(dbc_message_get_signal(b, 0)),
+                         dbc_signal_get_name(dbc_message_get_signal(a, 0)));
+    }
+    ck_assert_uint_eq(dbc_get_lazy_status(lazy), DBC_PARSE_SUCCESS);
+
+    dbc_free(eager);
+    dbc_free(lazy);
+    free(buf);
+}
+
+START_TEST(lazy_orphans)
+{
+    // The second message is broken, its signals go to the first.
+    const char str[] =
+        "BO_ 1 A: 8 ECU1\n"
+        " SG_ S1 : 0|8@1+ (1,0) [0|0] \"\" ECU2\n"
+        "BO_ x\n"
+        " SG_ S2 : 8|8@1+ (1,0) [0|0] \"\" ECU2\n"
+        " SG_ S3 : 8|8@1+ (1,0) [0|0] \"\"\n";
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer_lazy(str, sizeof(str) - 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_CRITICAL);
+
+    const dbc_message_t msg = dbc_get_message_by_id(dbc, 1);
+    ck_assert_uint_eq(dbc_message_get_num_signals(msg), 3);
+    ck_assert_str_eq(dbc_signal_get_name(dbc_message_get_signal(msg, 0)),
+                     "S1");
+    ck_assert_str_eq(dbc_signal_get_name(dbc_message_get_signal(msg, 2)),
+                     "S3");
+    dbc_free(dbc);
+}
+
+START_TEST(lazy_deferred_status)
+{
+    const char str[] =
+        "BO_ 1 A: 8 ECU1\n"
+        " SG_ S1 : 0|8@1+ (1,0) [0|0] \"\"\n";
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer_lazy(str, sizeof(str) - 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    ck_assert_uint_eq(dbc_get_lazy_status(dbc), DBC_PARSE_SUCCESS);
+
+    // Parsing the signal finds it has no receivers.
+    ck_assert_uint_eq(dbc_message_get_num_signals(dbc_get_message(dbc, 0)), 1);
+    ck_assert_uint_eq(dbc_get_lazy_status(dbc), DBC_PARSE_MALFORMED);
+    dbc_free(dbc);
+}
+
+typedef struct {
+    dbc_t dbc;
+    double sum;
+    size_t found;
+} lazy_worker_t;
+
+static void* lazy_worker(void* arg)
+{
+    lazy_worker_t* const worker = (lazy_worker_t*)arg;
+    const uint8_t payload[8] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    double out[2];
+    for (uint32_t id = 0; id < 12000; id += 7) {
+        if (dbc_decode(worker->dbc, id, payload, sizeof(payload), out)) {
+            worker->sum += out[0] + out[1];
+        }
+    }
+    // Every message has a B, looked up while other threads load signals.
+    for (uint32_t id = 0; id < 12000; id += 5) {
+        const dbc_message_t msg = dbc_get_message_by_id(worker->dbc, id);
+        if (dbc_message_get_signal_by_name(msg, "B")
+            == dbc_message_get_signal(msg, 1)) {
+            worker->found++;
+        }
+    }
+    return NULL;
+}
+
+START_TEST(lazy_threads)
+{
+    size_t len;
+    char* const buf = make_big_dbc(&len);
+    const dbc_t dbc = dbc_parse_buffer_lazy(buf, len, NULL);
+
+    pthread_t threads[4];
+    lazy_worker_t workers[4];
+    for (size_t i = 0; i < 4; i++) {
+        workers[i].dbc = dbc;
+        workers[i].sum = 0;
+        workers[i].found = 0;
+        ck_assert_int_eq(pthread_create(&threads[i], NULL, lazy_worker,
+                                        &workers[i]), 0);
+    }
+    for (size_t i = 0; i < 4; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // Every thread saw the same, completely parsed, signals.
+    for (size_t i = 1; i < 4; i++) {
+        ck_assert_double_eq(workers[i].sum, workers[0].sum);
+    }
+    for (size_t i = 0; i < 4; i++) {
+        ck_assert_uint_eq(workers[i].found, 2400);
+    }
+    ck_assert_uint_eq(dbc_message_get_num_signals(dbc_get_message(dbc, 7)), 2);
+
+    dbc_free(dbc);
+    free(buf);
+}
+
+START_TEST(lazy_file)
+{
+    const char str[] =
+        "BO_ 100 ENGINE: 8 ECU1\n"
+        " SG_ RPM : 0|16@1+ (0.25,0) [0|16000] \"rpm\" ECU2\n";
+    const char* const path = "test_lazy.dbc";
+    FILE* const f = fopen(path, "wb");
+    ck_assert_ptr_ne(f, NULL);
+    fwrite(str, 1, sizeof(str) - 1, f);
+    fclose(f);
+
+    const dbc_t dbc = dbc_parse_file_lazy(path, NULL);
+    remove(path);
+    ck_assert_ptr_ne(dbc, NULL);
+
+    const uint8_t payload[8] = { 0x40, 0x1F };
+    double out[1];
+    ck_assert(dbc_decode(dbc, 100, payload, sizeof(payload), out));
+    ck_assert_double_eq(out[0], 2000);
+    dbc_free(dbc);
+}
+
+static const char MUX_DBC[] =
+    "BO_ 300 MUX: 8 ECU1\n"
+    " SG_ Switch M : 0|8@1+ (1,0) [0|0] \"\" ECU2\n"
+    " SG_ Temp m1 : 8|8@1+ (1,-40) [0|0] \"\" ECU2\n"
+    " SG_ Page m2M : 8|8@1+ (1,0) [0|0] \"\" ECU2\n"
+    " SG_ Level m0 : 16|8@1+ (1,0) [0|0] \"\" ECU2\n"
+    " SG_ Speed : 24|8@1+ (1,0) [0|0] \"\" ECU2\n"
+    "SG_MUL_VAL_ 300 Level Page 3-4, 7-7;\n";
+
+START_TEST(mux_indicators)
+{
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer(MUX_DBC, sizeof(MUX_DBC) - 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    const dbc_message_t msg = dbc_get_message_by_id(dbc, 300);
+    const dbc_signal_t sw = dbc_message_get_signal(msg, 0);
+    const dbc_signal_t page = dbc_message_get_signal(msg, 2);
+    const dbc_signal_t level = dbc_message_get_signal(msg, 3);
+    ck_assert_ptr_eq(dbc_message_get_multiplexor(msg), sw);
+    ck_assert(dbc_signal_is_multiplexor(sw));
+    ck_assert(!dbc_signal_is_multiplexed(sw));
+    ck_assert(dbc_signal_is_multiplexor(page));
+    ck_assert(dbc_signal_is_multiplexed(page));
+    ck_assert_uint_eq(dbc_signal_get_mux_range(page, 0).min, 2);
+    ck_assert(!dbc_signal_is_multiplexor(dbc_message_get_signal(msg, 4)));
+    ck_assert(!dbc_signal_is_multiplexed(dbc_message_get_signal(msg, 4)));
+
+    // The extended ranges replace the value of the indicator.
+    ck_assert_ptr_eq(dbc_signal_get_multiplexor(level), page);
+    ck_assert_uint_eq(dbc_signal_get_num_mux_ranges(level), 2);
+    ck_assert_uint_eq(dbc_signal_get_mux_range(level, 0).max, 4);
+    ck_assert_uint_eq(dbc_signal_get_mux_range(level, 1).min, 7);
+
+    double out[5];
+    const uint8_t temp[8] = { 1, 60, 9, 10 };
+    ck_assert(dbc_decode(dbc, 300, temp, sizeof(temp), out));
+    ck_assert_double_eq(out[1], 20);
+    ck_assert(isnan(out[2]) && isnan(out[3]));
+    ck_assert_double_eq(out[4], 10);
+
+    const uint8_t level_page[8] = { 2, 7, 9, 10 };
+    ck_assert(dbc_decode(dbc, 300, level_page, sizeof(level_page), out));
+    ck_assert(isnan(out[1]));
+    ck_assert_double_eq(out[2], 7);
+    ck_assert_double_eq(out[3], 9);
+
+    dbc_free(dbc);
+}
+
+START_TEST(mux_malformed)
+{
+    const char str[] =
+        "BO_ 1 M: 8 ECU1\n"
+        " SG_ Bad x3 : 0|8@1+ (1,0) [0|0] \"\" ECU2\n"
+        " SG_ S M : 8|8@1+ (1,0) [0|0] \"\" ECU2\n";
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer(str, sizeof(str) - 1, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_MALFORMED);
+    const dbc_message_t msg = dbc_get_message_by_id(dbc, 1);
+    ck_assert_uint_eq(dbc_message_get_num_signals(msg), 2);
+    ck_assert(!dbc_signal_is_multiplexed(dbc_message_get_signal(msg, 0)));
+
+    char unknown[] = "SG_MUL_VAL_ 2 Bad S 1-1;";
+    ck_assert_uint_eq(__dbc_parse_signal_mux_values(dbc, unknown,
+                                                    sizeof(unknown) - 1),
+                      PARSE_ERR_MALFORMED);
+    char not_mux[] = "SG_MUL_VAL_ 1 S Bad 1-1;";
+    ck_assert_uint_eq(__dbc_parse_signal_mux_values(dbc, not_mux,
+                                                    sizeof(not_mux) - 1),
+                      PARSE_ERR_MALFORMED);
+    char backwards[] = "SG_MUL_VAL_ 1 Bad S 4-2, 5-6;";
+    ck_assert_uint_eq(__dbc_parse_signal_mux_values(dbc, backwards,
+                                                    sizeof(backwards) - 1),
+                      PARSE_ERR_MALFORMED);
+    const dbc_signal_t bad = dbc_message_get_signal(msg, 0);
+    ck_assert(dbc_signal_is_multiplexed(bad));
+    ck_assert_uint_eq(dbc_signal_get_num_mux_ranges(bad), 1);
+    ck_assert_uint_eq(dbc_signal_get_mux_range(bad, 0).min, 5);
+
+    dbc_free(dbc);
+}
+
+START_TEST(mux_parallel_and_lazy)
+{
+    // The extended ranges come long after their message, in another piece.
+    size_t big_len;
+    char* const big = make_big_dbc(&big_len);
+    const char tail[] = "SG_MUL_VAL_ 300 Level Page 3-4, 7-7;\n";
+    const size_t len = sizeof(MUX_DBC) - 1 + big_len + sizeof(tail) - 1;
+    char* const buf = malloc(len);
+    memcpy(buf, MUX_DBC, sizeof(MUX_DBC) - 1);
+    memcpy(buf + sizeof(MUX_DBC) - 1, big, big_len);
+    memcpy(buf + sizeof(MUX_DBC) - 1 + big_len, tail, sizeof(tail) - 1);
+
+    dbc_parse_status_t status;
+    const dbc_t seq = dbc_parse_buffer(buf, len, NULL);
+    const dbc_t par = dbc_parse_buffer_parallel(buf, len, 4, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    const dbc_t lazy = dbc_parse_buffer_lazy(buf, len, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+
+    const uint8_t payloads[3][8] = { { 1, 60, 9 }, { 2, 7, 9 }, { 2, 5, 9 } };
+    for (size_t i = 0; i < 3; i++) {
+        double expected[5];
+        double actual[5];
+        ck_assert(dbc_decode(seq, 300, payloads[i], 8, expected));
+        for (size_t k = 0; k < 2; k++) {
+            ck_assert(dbc_decode(k == 0 ? par : lazy, 300, payloads[i], 8,
+                                 actual));
+            for (size_t j = 0; j < 5; j++) {
+                ck_assert(isnan(expected[j]) ? isnan(actual[j])
+                                             : actual[j] == expected[j]);
+            }
+        }
+    }
+
+    dbc_free(seq);
+    dbc_free(par);
+    dbc_free(lazy);
+    free(buf);
+    free(big);
+}
+
+START_TEST(names_parallel_and_lazy)
+{
+    size_t len;
+    char* const buf = make_big_dbc(&len);
+
+    dbc_parse_status_t status;
+    const dbc_t dbcs[3] = { dbc_parse_buffer(buf, len, NULL),
+                            dbc_parse_buffer_parallel(buf, len, 4, &status),
+                            dbc_parse_buffer_lazy(buf, len, &status) };
+    for (size_t i = 0; i < 3; i++) {
+        const dbc_t dbc = dbcs[i];
+        ck_assert_str_eq(dbc_node_get_name(dbc_get_node_by_name(dbc, "N7000")),
+                         "N7000");
+        ck_assert_ptr_nonnull(dbc_get_value_table(dbc, "T11000"));
+        const dbc_message_t msg = dbc_get_message_by_name(dbc, "M11999");
+        ck_assert_uint_eq(dbc_message_get_id(msg), 11999);
+
+        dbc_message_t owner;
+        const dbc_signal_t sig = dbc_get_signal_by_name(dbc, "A11999", &owner);
+        ck_assert_ptr_eq(owner, msg);
+        ck_assert_ptr_eq(sig, dbc_message_get_signal(msg, 0));
+        dbc_get_signal_by_name(dbc, "B", &owner);
+        ck_assert_ptr_eq(owner, dbc_get_message(dbc, 0));
+
+        // A1, A10 to A19, A100 to A199, A1000 to A1999 and A10000 to A11999.
+        dbc_signal_t sigs[4];
+        ck_assert_uint_eq(dbc_find_signals_by_prefix(dbc, "A1", sigs, NULL, 4),
+                          3111);
+        ck_assert_str_eq(dbc_signal_get_name(sigs[3]), "A1000");
+    }
+
+    for (size_t i = 0; i < 3; i++) {
+        dbc_free(dbcs[i]);
+    }
+    free(buf);
+}
+END_TEST
+
+static const char ANNOTATED_OBJECTS[] =
+    "BU_: GW ECU1\n"
+    "BO_ 70000 Engine: 8 ECU1\n"
+    " SG_ Rpm : 0|16@1+ (1,0) [0|0] \"rpm\" GW\n"
+    " SG_ Temp : 16|8@1+ (1,0) [0|0] \"C\" GW\n"
+    "BO_ 70001 Brakes: 8 GW\n"
+    " SG_ Pressure : 0|8@1+ (1,0) [0|0] \"bar\" ECU1\n"
+    " SG_ Temp : 8|8@1+ (1,0) [0|0] \"C\" ECU1\n";
+
+static const char ANNOTATIONS[] =
+    "CM_ \"The network\";\n"
+    "CM_ BU_ ECU1 \"Engine controller\";\n"
+    "CM_ BO_ 70000 \"Sent \\\"fast\\\"; or not\";\n"
+    "CM_ SG_ 70000 Temp \"Coolant\ntemperature\";\n"
+    "CM_ SG_ 70001 Temp \"Brake fluid\";\n"
+    "CM_ EV_ Ignition \"Not kept\";\n"
+    "BA_DEF_ BO_ \"GenMsgCycleTime\" INT 0 65535;\n"
+    "BA_DEF_ SG_ \"GenSigStartValue\" FLOAT -1e9 1e9;\n"
+    "BA_DEF_ BO_ \"GenMsgSendType\" ENUM \"Cyclic\",\"OnEvent\";\n"
+    "BA_DEF_ \"BusType\" STRING ;\n"
+    "BA_DEF_ BU_ \"NodeLayer\" HEX 0 255;\n"
+    "BA_DEF_ EV_ \"EvAttr\" INT 0 1;\n"
+    "BA_DEF_DEF_ \"GenMsgCycleTime\" 100;\n"
+    "BA_DEF_DEF_ \"GenMsgSendType\" \"OnEvent\";\n"
+    "BA_DEF_DEF_ \"EvAttr\" 0;\n"
+    "BA_ \"BusType\" \"CAN FD\";\n"
+    "BA_ \"NodeLayer\" BU_ GW 3;\n"
+    "BA_ \"GenMsgCycleTime\" BO_ 70001 20;\n"
+    "BA_ \"GenMsgSendType\" BO_ 70001 0;\n"
+    "BA_ \"GenSigStartValue\" SG_ 70000 Temp 40;\n"
+    "BA_ \"GenSigStartValue\" SG_ 70001 Temp -5;\n"
+    "BA_ \"EvAttr\" EV_ Ignition 1;\n";
+
+static void check_annotations(const dbc_t dbc)
+{
+    const dbc_message_t engine = dbc_get_message_by_id(dbc, 70000);
+    const dbc_message_t brakes = dbc_get_message_by_id(dbc, 70001);
+    const dbc_signal_t rpm = dbc_message_get_signal(engine, 0);
+    const dbc_signal_t temp = dbc_message_get_signal(engine, 1);
+    dbc_attr_value_t value;
+
+    ck_assert_uint_eq(dbc_get_num_attr_defs(dbc), 5);
+    ck_assert(dbc_get_message_attribute(dbc, brakes, "GenMsgCycleTime",
+                                        &value));
+    ck_assert(value.num == 20 && value.str == NULL);
+    ck_assert(dbc_get_message_attribute(dbc, engine, "GenMsgCycleTime",
+                                        &value));
+    ck_assert(value.num == 100);
+    ck_assert(dbc_get_message_attribute(dbc, engine, "GenMsgSendType",
+                                        &value));
+    ck_assert(value.num == 1);
+    ck_assert_str_eq(value.str, "OnEvent");
+    ck_assert(dbc_get_message_attribute(dbc, brakes, "GenMsgSendType",
+                                        &value));
+    ck_assert_str_eq(value.str, "Cyclic");
+    ck_assert(dbc_get_signal_attribute(dbc, engine, temp,
+                                       "GenSigStartValue", &value));
+    ck_assert(value.num == 40);
+    // Both messages have a Temp signal, each with its own value.
+    ck_assert(dbc_get_signal_attribute(
+        dbc, brakes, dbc_message_get_signal_by_name(brakes, "Temp"),
+        "GenSigStartValue", &value));
+    ck_assert(value.num == -5);
+    ck_assert(!dbc_get_signal_attribute(dbc, engine, rpm,
+                                        "GenSigStartValue", &value));
+    ck_assert(!dbc_get_signal_attribute(dbc, engine, temp,
+                                        "GenMsgCycleTime", &value));
+    ck_assert(dbc_get_network_attribute(dbc, "BusType", &value));
+    ck_assert_str_eq(value.str, "CAN FD");
+    ck_assert(dbc_get_node_attribute(
+        dbc, dbc_get_node_by_name(dbc, "GW"), "NodeLayer", &value));
+    ck_assert(value.num == 3);
+    ck_assert(!dbc_get_network_attribute(dbc, "EvAttr", &value));
+
+    // Values are columns of object indices.
+    const dbc_attr_def_t def = dbc_get_attr_def_by_name(dbc, "GenMsgSendType");
+    ck_assert_uint_eq(dbc_attr_def_get_type(def), DBC_ATTR_ENUM);
+    ck_assert_uint_eq(dbc_attr_def_get_object_kind(def), DBC_OBJECT_MESSAGE);
+    ck_assert_uint_eq(dbc_attr_def_get_num_labels(def), 2);
+    ck_assert_uint_eq(dbc_attr_def_get_num_values(def), 1);
+    size_t obj;
+    size_t sub;
+    ck_assert(dbc_attr_def_get_value(def, 0, &obj, &sub, &value));
+    ck_assert_ptr_eq(dbc_get_message(dbc, obj), brakes);
+    ck_assert_uint_eq(sub, 0);
+
+    char buf[64];
+    ck_assert_uint_eq(dbc_get_network_comment(dbc, buf, sizeof(buf)), 11);
+    ck_assert_str_eq(buf, "The network");
+    dbc_get_node_comment(dbc, dbc_get_node_by_name(dbc, "ECU1"), buf,
+                         sizeof(buf));
+    ck_assert_str_eq(buf, "Engine controller");
+    ck_assert_uint_eq(dbc_get_node_comment(dbc, dbc_get_node_by_name(dbc, "GW"),
+                                           buf, sizeof(buf)),
+                      0);
+    ck_assert_str_eq(buf, "");
+    dbc_get_message_comment(dbc, engine, buf, sizeof(buf));
+    ck_assert_str_eq(buf, "Sent \"fast\"; or not");
+    ck_assert_uint_eq(dbc_get_message_comment(dbc, engine, buf, 5), 19);
+    ck_assert_str_eq(buf, "Sent");
+    dbc_get_signal_comment(dbc, engine, temp, buf, sizeof(buf));
+    ck_assert_str_eq(buf, "Coolant\ntemperature");
+    dbc_get_signal_comment(dbc, brakes, dbc_message_get_signal(brakes, 1), buf,
+                           sizeof(buf));
+    ck_assert_str_eq(buf, "Brake fluid");
+}
+
+START_TEST(annotations_parsed)
+{
+    char buf[sizeof(ANNOTATED_OBJECTS) + sizeof(ANNOTATIONS) - 2];
+    const size_t len = sizeof(buf);
+    memcpy(buf, ANNOTATED_OBJECTS, sizeof(ANNOTATED_OBJECTS) - 1);
+    memcpy(buf + sizeof(ANNOTATED_OBJECTS) - 1, ANNOTATIONS,
+           sizeof(ANNOTATIONS) - 1);
+
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer(buf, len, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    // Comments are copied out of the buffer.
+    memset(buf, ' ', len);
+    check_annotations(dbc);
+
+    dbc_free(dbc);
+}
+END_TEST
+
+START_TEST(annotations_malformed)
+{
+    static const char* const cases[] = {
+        "CM_ BO_ 99 \"No such message\";\n",
+        "CM_ SG_ 70000 Nope \"No such signal\";\n",
+        "CM_ BO_ 70000 Unquoted;\n",
+        "BA_ \"Undefined\" BO_ 70000 1;\n",
+        "BA_DEF_ BO_ \"X\" INT 0 1;\nBA_ \"X\" SG_ 70000 Rpm 1;\n",
+        "BA_DEF_ BO_ \"X\" ENUM \"A\";\nBA_ \"X\" BO_ 70000 1;\n",
+        "BA_DEF_ BO_ \"X\" REAL 0 1;\n",
+        "BA_DEF_ \"X\" STRING;\nBA_DEF_ \"X\" STRING;\n",
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        const size_t len = sizeof(ANNOTATED_OBJECTS) - 1 + strlen(cases[i]);
+        char* const buf = malloc(len);
+        memcpy(buf, ANNOTATED_OBJECTS, sizeof(ANNOTATED_OBJECTS) - 1);
+        memcpy(buf + sizeof(ANNOTATED_OBJECTS) - 1, cases[i],
+               strlen(cases[i]));
+
+        dbc_parse_status_t status;
+        const dbc_t dbc = dbc_parse_buffer(buf, len, &status);
+        ck_assert_msg(status == DBC_PARSE_MALFORMED, "case %zu", i);
+        dbc_free(dbc);
+
+        const dbc_t lazy = dbc_parse_buffer_lazy(buf, len, &status);
+        ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+        ck_assert_uint_eq(dbc_get_lazy_status(lazy), DBC_PARSE_SUCCESS);
+        dbc_get_num_attr_defs(lazy);
+        ck_assert_uint_eq(dbc_get_lazy_status(lazy), DBC_PARSE_MALFORMED);
+        dbc_free(lazy);
+        free(buf);
+    }
+}
+END_TEST
+
+START_TEST(annotations_parallel_and_lazy)
+{
+    // The annotations come long after their objects, in another piece.
+    size_t big_len;
+    char* const big = make_big_dbc(&big_len);
+    const size_t len =
+        sizeof(ANNOTATED_OBJECTS) - 1 + big_len + sizeof(ANNOTATIONS) - 1;
+    char* const buf = malloc(len);
+    memcpy(buf, ANNOTATED_OBJECTS, sizeof(ANNOTATED_OBJECTS) - 1);
+    memcpy(buf + sizeof(ANNOTATED_OBJECTS) - 1, big, big_len);
+    memcpy(buf + sizeof(ANNOTATED_OBJECTS) - 1 + big_len, ANNOTATIONS,
+           sizeof(ANNOTATIONS) - 1);
+
+    dbc_parse_status_t status;
+    const dbc_t par = dbc_parse_buffer_parallel(buf, len, 4, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    check_annotations(par);
+    dbc_free(par);
+
+    const dbc_t lazy = dbc_parse_buffer_lazy(buf, len, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    check_annotations(lazy);
+    ck_assert_uint_eq(dbc_get_lazy_status(lazy), DBC_PARSE_SUCCESS);
+    dbc_free(lazy);
+
+    // Annotations about messages left out go with them.
+    const uint32_t ids[] = { 70000 };
+    dbc_load_opts_t opts = { 0 };
+    opts.include_ids = ids;
+    opts.num_include_ids = 1;
+    const dbc_t filtered = dbc_parse_buffer_opts(buf, len, &opts, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    ck_assert_uint_eq(dbc_get_num_messages(filtered), 1);
+    dbc_attr_value_t value;
+    ck_assert(dbc_get_message_attribute(
+        filtered, dbc_get_message(filtered, 0), "GenMsgCycleTime", &value));
+    ck_assert(value.num == 100);
+    ck_assert_uint_eq(dbc_attr_def_get_num_values(dbc_get_attr_def_by_name(
+                          filtered, "GenMsgCycleTime")),
+                      0);
+    dbc_free(filtered);
+
+    free(buf);
+    free(big);
+}
+END_TEST
+
+/**
+ * Annotates the signals of 200 messages in reverse order, then sets the
+ * fifth one's value again.
+ */
+static char* make_reversed_annotations(size_t* len)
+{
+    const size_t cap = 64 * 1024;
+    char* const buf = malloc(cap);
+    size_t n = (size_t)snprintf(buf, cap,
+                                "BA_DEF_ SG_ \"Start\" INT 0 100000;\n");
+    for (size_t i = 0; i < 200; i++) {
+        n += (size_t)snprintf(buf + n, cap - n,
+                              "BO_ %zu M%zu: 8 ECU1\n"
+                              " SG_ S : 0|8@1+ (1,0) [0|0] \"\" ECU1\n",
+                              i, i);
+    }
+    for (size_t i = 200; i-- > 0;) {
+        n += (size_t)snprintf(buf + n, cap - n,
+                              "BA_ \"Start\" SG_ %zu S %zu;\n"
+                              "CM_ BO_ %zu \"Message %zu\";\n",
+                              i, i, i, i);
+    }
+    n += (size_t)snprintf(buf + n, cap - n, "BA_ \"Start\" SG_ 5 S 999;\n");
+    *len = n;
+    return buf;
+}
+
+static void check_reversed_annotations(const dbc_t dbc)
+{
+    const dbc_attr_def_t def = dbc_get_attr_def_by_name(dbc, "Start");
+    ck_assert_uint_eq(dbc_attr_def_get_num_values(def), 200);
+    for (size_t i = 0; i < 200; i++) {
+        const dbc_message_t msg = dbc_get_message(dbc, i);
+        dbc_attr_value_t value;
+        ck_assert(dbc_get_signal_attribute(
+            dbc, msg, dbc_message_get_signal(msg, 0), "Start", &value));
+        ck_assert(value.num == (i == 5 ? 999 : (double)i));
+
+        char buf[32];
+        char want[32];
+        snprintf(want, sizeof(want), "Message %zu", i);
+        dbc_get_message_comment(dbc, msg, buf, sizeof(buf));
+        ck_assert_str_eq(buf, want);
+    }
+}
+
+START_TEST(annotations_out_of_order)
+{
+    size_t len;
+    char* const buf = make_reversed_annotations(&len);
+
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer(buf, len, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    check_reversed_annotations(dbc);
+    dbc_free(dbc);
+
+    const dbc_t lazy = dbc_parse_buffer_lazy(buf, len, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    check_reversed_annotations(lazy);
+    dbc_free(lazy);
+    free(buf);
+}
+END_TEST
+
+static const char FILTER_DBC[] =
+    "BU_: GW ECU1 ECU2 ECU3\n"
+    "BO_ 1 Engine: 8 ECU1\n"
+    " SG_ Rpm : 0|16@1+ (1,0) [0|0] \"rpm\" GW\n"
+    "BO_ 2 Brakes: 8 ECU2\n"
+    " SG_ Pressure : 0|8@1+ (1,0) [0|0] \"bar\" ECU3\n"
+    "CM_ BO_ 2 \"Skipped along with its message\";\n"
+    " SG_ Late : 8|8@1+ (1,0) [0|0] \"\" ECU3\n"
+    "BO_ 3 Debug_Dump: 8 ECU3\n"
+    " SG_ Blob : 0|8@1+ (1,0) [0|0] \"\" ECU1,GW\n"
+    "BO_ 2147483652 Gateway: 8 GW\n"
+    " SG_ Mode : 0|8@1+ (1,0) [0|0] \"\" ECU1\n";
+
+START_TEST(filter_nodes)
+{
+    const char* const nodes[] = { "GW" };
+    dbc_load_opts_t opts = { 0 };
+    opts.include_nodes = nodes;
+    opts.num_include_nodes = 1;
+
+    dbc_parse_status_t status;
+    const dbc_t dbc = dbc_parse_buffer_opts(FILTER_DBC, sizeof(FILTER_DBC) - 1,
+                                            &opts, &status);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    ck_assert_uint_eq(dbc_get_num_nodes(dbc), 4);
+
+    // Received by the gateway, received by it among others, and sent by it.
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 3);
+    ck_assert_ptr_ne(dbc_get_message_by_id(dbc, 1), NULL);
+    ck_assert_ptr_eq(dbc_get_message_by_id(dbc, 2), NULL);
+    ck_assert_ptr_ne(dbc_get_message_by_id(dbc, 3), NULL);
+    ck_assert_ptr_ne(dbc_get_message_by_id(dbc, 0x80000004U), NULL);
+
+    // The skipped message's signals went with it.
+    ck_assert_uint_eq(dbc_message_get_num_signals(dbc_get_message(dbc, 0)), 1);
+    dbc_free(dbc);
+}
+
+START_TEST(filter_ids_and_glob)
+{
+    const uint32_t ids[] = { 2, 3, 0x80000004U };
+    dbc_load_opts_t opts = { 0 };
+    opts.include_ids = ids;
+    opts.num_include_ids = 3;
+    opts.exclude_name_glob = "Debug_*";
+
+    const dbc_t dbc = dbc_parse_buffer_opts(FILTER_DBC, sizeof(FILTER_DBC) - 1,
+                                            &opts, NULL);
+    ck_assert_uint_eq(dbc_get_num_messages(dbc), 2);
+    const dbc_message_t brakes = dbc_get_message_by_id(dbc, 2);
+    ck_assert_str_eq(dbc_message_get_name(brakes), "Brakes");
+    ck_assert_uint_eq(dbc_message_get_num_signals(brakes), 2);
+    ck_assert_ptr_eq(dbc_get_message_by_id(dbc, 3), NULL);
+    dbc_free(dbc);
+
+    // Without options, everything is loaded.
+    const dbc_t all = dbc_parse_buffer_opts(FILTER_DBC, sizeof(FILTER_DBC) - 1,
+                                            NULL, NULL);
+    ck_assert_uint_eq(dbc_get_num_messages(all), 4);
+    dbc_free(all);
+}
+
+START_TEST(filter_glob)
+{
+    ck_assert(__dbc_glob_match("*", "", 0));
+    ck_assert(__dbc_glob_match("Debug_*", "Debug_Dump", 10));
+    ck_assert(!__dbc_glob_match("Debug_*", "Debug", 5));
+    ck_assert(__dbc_glob_match("*_Dump", "Debug_Dump", 10));
+    ck_assert(__dbc_glob_match("D?b*g*p", "Debug_Dump", 10));
+    ck_assert(__dbc_glob_match("*a*a*", "banana", 6));
+    ck_assert(!__dbc_glob_match("*a*a*b", "banana", 6));
+    // Only the given length is looked at.
+    ck_assert(__dbc_glob_match("Eng", "Engine", 3));
+}
+
+#ifdef LIBDBC_PARSE_STATS
+typedef struct {
+    size_t num_calls;
+    dbc_parse_status_t worst;
+} instr_hook_ctx_t;
+
+static void instr_hook(void* ctx, const char* stmt, size_t len,
+                       dbc_parse_status_t status, uint64_t ns) {
+    instr_hook_ctx_t* const hook_ctx = (instr_hook_ctx_t*)ctx;
+    (void)stmt;
+    (void)len;
+    (void)ns;
+    hook_ctx->num_calls++;
+    hook_ctx->worst = status > hook_ctx->worst ? status : hook_ctx->worst;
+}
+
+static const dbc_parse_keyword_stats_t* instr_keyword(
+    const dbc_parse_stats_t* stats, const char* keyword) {
+    for (size_t i = 0; i < stats->num_keywords; i++) {
+        if (stats->keywords[i].count > 0
+            && strcmp(stats->keywords[i].keyword, keyword) == 0) {
+            return &stats->keywords[i];
+        }
+    }
+    return NULL;
+}
+#endif
+
+START_TEST(instrumented_parse)
+{
+    dbc_parse_stats_t stats;
+#ifdef LIBDBC_PARSE_STATS
+    const char str[] = "VERSION \"1\"\n"
+                       "BU_: ECU1 ECU2\n"
+                       "BO_ 1 Status: 8 ECU1\n"
+                       " SG_ Mode : 0|8@1+ (1,0) [0|255] \"\" ECU2\n"
+                       "BO_ 2 Broken: x ECU1\n"
+                       "CM_ BO_ 1 \"Status\";\n"
+                       "FOO_ bar\n";
+    instr_hook_ctx_t ctx = { 0, DBC_PARSE_SUCCESS };
+    ck_assert(dbc_parse_instrument(&stats, instr_hook, &ctx));
+    dbc_free(dbc_parse_buffer(str, sizeof(str) - 1, NULL));
+    ck_assert(dbc_parse_instrument(NULL, NULL, NULL));
+
+    // All but the indentation of SG_, and the line break after CM_'s ';'.
+    ck_assert_uint_eq(stats.count, 7);
+    ck_assert_uint_eq(stats.bytes, sizeof(str) - 3);
+    ck_assert_uint_eq(stats.critical, 1);
+    const dbc_parse_keyword_stats_t* const messages =
+        instr_keyword(&stats, "BO_");
+    ck_assert_ptr_ne(messages, NULL);
+    ck_assert_uint_eq(messages->count, 2);
+    ck_assert_uint_eq(messages->critical, 1);
+    const dbc_parse_keyword_stats_t* const unknown =
+        instr_keyword(&stats, "");
+    ck_assert_ptr_ne(unknown, NULL);
+    ck_assert_uint_eq(unknown->count, 1);
+    ck_assert_uint_eq(unknown->ns, 0);
+    uint64_t total_ns = 0;
+    for (size_t i = 0; i < DBC_PARSE_NUM_PHASES; i++) {
+        total_ns += stats.phase_ns[i];
+    }
+    ck_assert_uint_gt(total_ns, 0);
+
+    // The hook sees the statements that are parsed, unknown ones are not.
+    ck_assert_uint_eq(ctx.num_calls, 6);
+    ck_assert_int_eq(ctx.worst, DBC_PARSE_CRITICAL);
+
+    // Once stopped, parses are left alone.
+    dbc_free(dbc_parse_buffer(str, sizeof(str) - 1, NULL));
+    ck_assert_uint_eq(stats.count, 7);
+    ck_assert_uint_eq(ctx.num_calls, 6);
+#else
+    ck_assert(!dbc_parse_instrument(&stats, NULL, NULL));
+#endif
+}
 
 int main(void)
 {
@@ -223,12 +1449,110 @@ int main(void)
         suite_add_tcase(s, tc);
     }
 
-    //{
-    //    TCase* const tc = tcase_create("Value Tables");
-    //    tcase_add_test(tc, vtables_empty);
-    //    tcase_add_test(tc, vtables_simple);
-    //    suite_add_tcase(s, tc);
-    //}
+    {
+        TCase* const tc = tcase_create("Value Tables");
+        tcase_add_test(tc, vtables_empty);
+        tcase_add_test(tc, vtables_simple);
+        tcase_add_test(tc, vtables_spaces_in_desc);
+        tcase_add_test(tc, vtables_unterminated);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Messages");
+        tcase_add_test(tc, messages_simple);
+        tcase_add_test(tc, messages_multiplexed_motorola);
+        tcase_add_test(tc, messages_signal_orphaned);
+        tcase_add_test(tc, messages_signal_truncated);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Multiplexing");
+        tcase_add_test(tc, mux_indicators);
+        tcase_add_test(tc, mux_malformed);
+        tcase_add_test(tc, mux_parallel_and_lazy);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Annotations");
+        tcase_add_test(tc, annotations_parsed);
+        tcase_add_test(tc, annotations_malformed);
+        tcase_add_test(tc, annotations_parallel_and_lazy);
+        tcase_add_test(tc, annotations_out_of_order);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Numbers");
+        tcase_add_test(tc, numbers_match_strtod);
+        tcase_add_test(tc, numbers_malformed);
+        tcase_add_test(tc, numbers_uint);
+        tcase_add_test(tc, numbers_any_locale);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Filter");
+        tcase_add_test(tc, filter_nodes);
+        tcase_add_test(tc, filter_ids_and_glob);
+        tcase_add_test(tc, filter_glob);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Lazy");
+        tcase_add_test(tc, lazy_matches_eager);
+        tcase_add_test(tc, lazy_orphans);
+        tcase_add_test(tc, lazy_deferred_status);
+        tcase_add_test(tc, lazy_threads);
+        tcase_add_test(tc, lazy_file);
+        tcase_add_test(tc, names_parallel_and_lazy);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Keywords");
+        tcase_add_test(tc, keywords_classified);
+        tcase_add_test(tc, keywords_unknown);
+        tcase_add_test(tc, keywords_long_strings);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Whole File");
+        tcase_add_test(tc, buffer_simple);
+        tcase_add_test(tc, buffer_malformed);
+        tcase_add_test(tc, file_missing);
+        tcase_add_test(tc, buffer_parallel);
+        tcase_add_test(tc, buffer_parallel_memory);
+        tcase_add_test(tc, buffer_parallel_small);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Streaming");
+        tcase_add_test(tc, stream_any_split);
+        tcase_add_test(tc, stream_bounded);
+        tcase_add_test(tc, stream_abandoned);
+
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Instrumentation");
+        tcase_add_test(tc, instrumented_parse);
+
+        suite_add_tcase(s, tc);
+    }
 
     {
         SRunner* const sr = srunner_create(s);
@@ -0,0 +1,166 @@
+#include <check.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "libdbc.h"
+#include "libdbc_parser.h"
+#include "libdbc_snapshot.h"
+
+#define DBC_PATH "test_snapshot.dbc"
+
+/**
+ * @brief Writes a DBC whose single signal decodes with the given offset.
+ */
+static void write_dbc(const char* path, const int offset)
+{
+    FILE* const f = fopen(path, "w");
+    ck_assert_ptr_ne(f, NULL);
+    fprintf(f, "BO_ 100 ENGINE: 8 ECU1\n"
+               " SG_ Temp : 0|8@1+ (1,%d) [0|0] \"\" ECU2\n", offset);
+    fclose(f);
+}
+
+static double decode_temp(const dbc_snapshot_t snapshot)
+{
+    const uint8_t payload[8] = { 10 };
+    double out = -1;
+    dbc_decode(dbc_snapshot_get(snapshot), 100, payload, sizeof(payload),
+               &out);
+    return out;
+}
+
+START_TEST(tc_reload)
+{
+    write_dbc(DBC_PATH, 0);
+    dbc_parse_status_t status;
+    const dbc_handle_t handle = dbc_handle_open(DBC_PATH, &status);
+    ck_assert_ptr_ne(handle, NULL);
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+
+    const dbc_snapshot_t before = dbc_handle_acquire(handle);
+    ck_assert_double_eq(decode_temp(before), 10);
+
+    // The old snapshot stays as it was for as long as it is held.
+    write_dbc(DBC_PATH, 100);
+    ck_assert(dbc_reload(handle, DBC_PATH, &status));
+    ck_assert_uint_eq(status, DBC_PARSE_SUCCESS);
+    const dbc_snapshot_t after = dbc_handle_acquire(handle);
+    ck_assert_double_eq(decode_temp(after), 110);
+    ck_assert_double_eq(decode_temp(before), 10);
+    dbc_snapshot_release(before);
+
+    // The handle can go before the snapshots it handed out.
+    remove(DBC_PATH);
+    dbc_handle_free(handle);
+    ck_assert_double_eq(decode_temp(after), 110);
+    dbc_snapshot_release(after);
+}
+END_TEST
+
+START_TEST(tc_reload_failed)
+{
+    write_dbc(DBC_PATH, 5);
+    const dbc_handle_t handle = dbc_handle_open(DBC_PATH, NULL);
+
+    dbc_parse_status_t status;
+    ck_assert(!dbc_reload(handle, "does_not_exist.dbc", &status));
+    ck_assert_uint_eq(status, DBC_PARSE_IO_ERROR);
+
+    FILE* const f = fopen(DBC_PATH, "w");
+    fprintf(f, "BO_ 100 ENGINE: 8 ECU1\n SG_ Temp : 0|8@9+\n");
+    fclose(f);
+    ck_assert(!dbc_reload(handle, DBC_PATH, &status));
+    ck_assert_uint_eq(status, DBC_PARSE_CRITICAL);
+    remove(DBC_PATH);
+
+    const dbc_snapshot_t snapshot = dbc_handle_acquire(handle);
+    ck_assert_double_eq(decode_temp(snapshot), 15);
+    dbc_snapshot_release(snapshot);
+    dbc_handle_free(handle);
+
+    ck_assert_ptr_eq(dbc_handle_open("does_not_exist.dbc", &status), NULL);
+    ck_assert_uint_eq(status, DBC_PARSE_IO_ERROR);
+}
+END_TEST
+
+enum { NUM_READERS = 4, NUM_RELOADS = 200 };
+
+typedef struct {
+    dbc_handle_t handle;
+    int done;
+    int failed;
+} reader_ctx_t;
+
+static void* reader(void* arg)
+{
+    reader_ctx_t* const ctx = (reader_ctx_t*)arg;
+    double last = 0;
+    while (!__atomic_load_n(&ctx->done, __ATOMIC_ACQUIRE)) {
+        const dbc_snapshot_t snapshot = dbc_handle_acquire(ctx->handle);
+        const double temp = decode_temp(snapshot);
+        dbc_snapshot_release(snapshot);
+
+        // Versions only ever move forward.
+        if (temp < last || temp > 10 + NUM_RELOADS) {
+            __atomic_store_n(&ctx->failed, 1, __ATOMIC_RELAXED);
+        }
+        last = temp;
+    }
+    return NULL;
+}
+
+START_TEST(tc_readers_during_reloads)
+{
+    char str[128];
+    int len = snprintf(str, sizeof(str),
+                       "BO_ 100 ENGINE: 8 ECU1\n"
+                       " SG_ Temp : 0|8@1+ (1,%d) [0|0] \"\" ECU2\n", 0);
+    reader_ctx_t ctx = {
+        dbc_handle_new(dbc_parse_buffer(str, (size_t)len, NULL)), 0, 0
+    };
+
+    pthread_t threads[NUM_READERS];
+    for (size_t i = 0; i < NUM_READERS; i++) {
+        ck_assert_int_eq(pthread_create(&threads[i], NULL, reader, &ctx), 0);
+    }
+    for (int i = 1; i <= NUM_RELOADS; i++) {
+        len = snprintf(str, sizeof(str),
+                       "BO_ 100 ENGINE: 8 ECU1\n"
+                       " SG_ Temp : 0|8@1+ (1,%d) [0|0] \"\" ECU2\n", i);
+        ck_assert(dbc_handle_publish(
+            ctx.handle, dbc_parse_buffer(str, (size_t)len, NULL)));
+    }
+    __atomic_store_n(&ctx.done, 1, __ATOMIC_RELEASE);
+    for (size_t i = 0; i < NUM_READERS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    ck_assert_int_eq(ctx.failed, 0);
+
+    const dbc_snapshot_t snapshot = dbc_handle_acquire(ctx.handle);
+    ck_assert_double_eq(decode_temp(snapshot), 10 + NUM_RELOADS);
+    dbc_snapshot_release(snapshot);
+    dbc_handle_free(ctx.handle);
+}
+END_TEST
+
+int main(void)
+{
+    Suite* const s = suite_create("Snapshot");
+
+    {
+        TCase* const tc = tcase_create("Reload");
+        tcase_add_test(tc, tc_reload);
+        tcase_add_test(tc, tc_reload_failed);
+        tcase_add_test(tc, tc_readers_during_reloads);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        SRunner* const sr = srunner_create(s);
+        srunner_run_all(sr, CK_NORMAL);
+        const size_t number_failed = srunner_ntests_failed(sr);
+        srunner_free(sr);
+
+        return number_failed;
+    }
+}
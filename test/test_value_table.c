@@ -45,6 +45,224 @@ START_TEST(tc_insert_many)
 }
 END_TEST
 
+START_TEST(tc_insert_fractional_negative)
+{
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    dbc_value_table_insert(vt, 0.5, "HALF");
+    dbc_value_table_insert(vt, -1.0, "MINUS_ONE");
+    dbc_value_table_insert(vt, 1.5, "ONE_AND_A_HALF");
+    ck_assert_uint_eq(dbc_value_table_get_size(vt), 3);
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 0.5), "HALF");
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, -1.0), "MINUS_ONE");
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 1.5), "ONE_AND_A_HALF");
+    ck_assert_ptr_eq(dbc_value_table_get_desc(vt, 1.0), NULL);
+    ck_assert_ptr_eq(dbc_value_table_get_desc(vt, 0.0), NULL);
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_insert_many_fractional)
+{
+    const size_t num_values = 100000;
+
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    for (size_t i = 0; i < num_values; i++) {
+        char str_buf[20];
+        snprintf(str_buf, 20, "%f", (double)i / 4);
+        dbc_value_table_insert(vt, -(double)i / 4, str_buf);
+    }
+    ck_assert_uint_eq(dbc_value_table_get_size(vt), num_values);
+    for (size_t i = 0; i < num_values; i++) {
+        char str_buf[20];
+        snprintf(str_buf, 20, "%f", (double)i / 4);
+        ck_assert_str_eq(dbc_value_table_get_desc(vt, -(double)i / 4),
+                         str_buf);
+    }
+
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_insert_dense_then_sparse)
+{
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    for (size_t i = 0; i < 10; i++) {
+        char str_buf[20];
+        snprintf(str_buf, 20, "%zu", i);
+        dbc_value_table_insert(vt, (double)i, str_buf);
+    }
+    // Neither fits a dense table, so everything has to move over.
+    dbc_value_table_insert(vt, 1e9, "HUGE");
+    dbc_value_table_insert(vt, -3, "NEGATIVE");
+
+    ck_assert_uint_eq(dbc_value_table_get_size(vt), 12);
+    for (size_t i = 0; i < 10; i++) {
+        char str_buf[20];
+        snprintf(str_buf, 20, "%zu", i);
+        ck_assert_str_eq(dbc_value_table_get_desc(vt, (double)i), str_buf);
+    }
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 1e9), "HUGE");
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, -3), "NEGATIVE");
+    ck_assert_ptr_eq(dbc_value_table_get_desc(vt, 10), NULL);
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_insert_overwrites)
+{
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    dbc_value_table_insert(vt, 0.0, "ZERO");
+    dbc_value_table_insert(vt, -0.0, "NEGATIVE_ZERO");
+    ck_assert_uint_eq(dbc_value_table_get_size(vt), 1);
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 0.0), "NEGATIVE_ZERO");
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_freeze_sparse)
+{
+    const double keys[] = { -1e9, -3, -0.5, 0, 0.25, 7, 1e9 };
+    const size_t num_keys = sizeof(keys) / sizeof(keys[0]);
+
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    // Insert out of order, the freeze has to sort.
+    for (size_t i = num_keys; i-- > 0;) {
+        char str_buf[20];
+        snprintf(str_buf, 20, "%f", keys[i]);
+        dbc_value_table_insert(vt, keys[i], str_buf);
+    }
+    ck_assert(dbc_value_table_freeze(vt));
+    ck_assert(dbc_value_table_freeze(vt));
+    ck_assert(!dbc_value_table_insert(vt, 1, "LATE"));
+
+    ck_assert_uint_eq(dbc_value_table_get_size(vt), num_keys);
+    for (size_t i = 0; i < num_keys; i++) {
+        char str_buf[20];
+        snprintf(str_buf, 20, "%f", keys[i]);
+        ck_assert_str_eq(dbc_value_table_get_desc(vt, keys[i]), str_buf);
+    }
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, -0.0), "0.000000");
+    ck_assert_ptr_eq(dbc_value_table_get_desc(vt, 1), NULL);
+    ck_assert_ptr_eq(dbc_value_table_get_desc(vt, -1e10), NULL);
+    ck_assert_ptr_eq(dbc_value_table_get_desc(vt, 1e10), NULL);
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_freeze_dense)
+{
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    dbc_value_table_insert(vt, 0, "Off");
+    dbc_value_table_insert(vt, 1, "On");
+    ck_assert(dbc_value_table_freeze(vt));
+    ck_assert(!dbc_value_table_insert(vt, 2, "Error"));
+    ck_assert_uint_eq(dbc_value_table_get_size(vt), 2);
+    ck_assert_str_eq(dbc_value_table_get_desc(vt, 1), "On");
+    ck_assert_ptr_eq(dbc_value_table_get_desc(vt, 2), NULL);
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_reverse_lookup)
+{
+    const size_t num_values = 10000;
+
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    for (size_t i = 0; i < num_values; i++) {
+        char str_buf[20];
+        snprintf(str_buf, 20, "V%zu", i * 3);
+        dbc_value_table_insert(vt, (double)(i * 3), str_buf);
+    }
+
+    for (int frozen = 0; frozen < 2; frozen++) {
+        for (size_t i = 0; i < num_values; i++) {
+            char str_buf[20];
+            snprintf(str_buf, 20, "V%zu", i * 3);
+            double value = -1;
+            ck_assert(dbc_value_table_get_value(vt, str_buf, &value));
+            ck_assert_double_eq(value, (double)(i * 3));
+        }
+
+        double value = -1;
+        ck_assert(!dbc_value_table_get_value(vt, "V1", &value));
+        ck_assert(!dbc_value_table_get_value(vt, "", &value));
+        ck_assert_double_eq(value, -1);
+        ck_assert(dbc_value_table_freeze(vt));
+    }
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_reverse_shared_and_overwritten)
+{
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    double value;
+    ck_assert(!dbc_value_table_get_value(vt, "GEAR_DRIVE", &value));
+
+    dbc_value_table_insert(vt, 7.5, "GEAR_DRIVE");
+    dbc_value_table_insert(vt, 3, "GEAR_DRIVE");
+    dbc_value_table_insert(vt, 0, "GEAR_PARK");
+    ck_assert(dbc_value_table_get_value(vt, "GEAR_DRIVE", &value));
+    ck_assert_double_eq(value, 3);
+
+    // The description moves on to the value left holding it.
+    dbc_value_table_insert(vt, 3, "GEAR_REVERSE");
+    ck_assert(dbc_value_table_get_value(vt, "GEAR_DRIVE", &value));
+    ck_assert_double_eq(value, 7.5);
+    ck_assert(dbc_value_table_get_value(vt, "GEAR_REVERSE", &value));
+    ck_assert_double_eq(value, 3);
+
+    dbc_value_table_insert(vt, 0, "GEAR_NEUTRAL");
+    ck_assert(!dbc_value_table_get_value(vt, "GEAR_PARK", &value));
+    ck_assert(dbc_value_table_get_value(vt, "GEAR_NEUTRAL", &value));
+    ck_assert_double_eq(value, 0);
+    dbc_value_table_free(vt);
+}
+END_TEST
+
+START_TEST(tc_iterate)
+{
+    const double keys[] = { 0, 1, 5, 2 };
+    const double sparse_keys[] = { 1e9, -0.5, 0.25, -3, 7 };
+
+    const dbc_value_table_t vt = dbc_value_table_new("m_table");
+    size_t cursor = 0;
+    double num;
+    const char* desc;
+    ck_assert(!dbc_value_table_next(vt, &cursor, &num, &desc));
+
+    // Dense, hashed, then sorted.
+    for (int phase = 0; phase < 3; phase++) {
+        if (phase == 0) {
+            for (size_t i = 0; i < 4; i++) {
+                dbc_value_table_insert(vt, keys[i], "DENSE");
+            }
+        } else if (phase == 1) {
+            for (size_t i = 0; i < 5; i++) {
+                dbc_value_table_insert(vt, sparse_keys[i], "SPARSE");
+            }
+        } else {
+            ck_assert(dbc_value_table_freeze(vt));
+        }
+
+        size_t count = 0;
+        double last = -1e10;
+        cursor = 0;
+        while (dbc_value_table_next(vt, &cursor, &num, &desc)) {
+            ck_assert_str_eq(dbc_value_table_get_desc(vt, num), desc);
+            if (phase != 1) {
+                ck_assert(num > last);
+            }
+            last = num;
+            count++;
+        }
+        ck_assert_uint_eq(count, dbc_value_table_get_size(vt));
+        ck_assert(!dbc_value_table_next(vt, &cursor, &num, &desc));
+    }
+    dbc_value_table_free(vt);
+}
+END_TEST
+
 int main(void)
 {
     Suite* const s = suite_create("Value Table");
@@ -58,12 +276,31 @@ int main(void)
     {
         TCase* const tc = tcase_create("Single Insert");
         tcase_add_test(tc, tc_insert);
+        tcase_add_test(tc, tc_insert_fractional_negative);
+        tcase_add_test(tc, tc_insert_overwrites);
         suite_add_tcase(s, tc);
     }
 
     {
         TCase* const tc = tcase_create("Many Insert");
         tcase_add_test(tc, tc_insert_many);
+        tcase_add_test(tc, tc_insert_many_fractional);
+        tcase_add_test(tc, tc_insert_dense_then_sparse);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Freeze");
+        tcase_add_test(tc, tc_freeze_sparse);
+        tcase_add_test(tc, tc_freeze_dense);
+        suite_add_tcase(s, tc);
+    }
+
+    {
+        TCase* const tc = tcase_create("Reverse");
+        tcase_add_test(tc, tc_reverse_lookup);
+        tcase_add_test(tc, tc_reverse_shared_and_overwritten);
+        tcase_add_test(tc, tc_iterate);
         suite_add_tcase(s, tc);
     }
 